@@ -423,6 +423,40 @@ function(blender_add_test_lib
   set_property(GLOBAL APPEND PROPERTY BLENDER_TEST_LIBS ${name})
 endfunction()
 
+# Add performance tests for a Blender library, to be called in tandem with blender_add_lib().
+# Like blender_add_test_lib(), but the tests are linked into `bin/tests/blender_performance_test`
+# instead, which is built but not run as part of the regular test suite.
+function(blender_add_performance_test_lib
+  name
+  sources
+  includes
+  includes_sys
+  library_deps
+  )
+
+  add_cc_flags_custom_test(${name} PARENT_SCOPE)
+
+  # Otherwise external projects will produce warnings that we cannot fix.
+  remove_strict_flags()
+
+  LIST(APPEND includes
+    ${CMAKE_SOURCE_DIR}/tests/gtests
+  )
+  LIST(APPEND includes_sys
+    ${GLOG_INCLUDE_DIRS}
+    ${GFLAGS_INCLUDE_DIRS}
+    ${CMAKE_SOURCE_DIR}/extern/gtest/include
+    ${CMAKE_SOURCE_DIR}/extern/gmock/include
+  )
+  add_definitions(-DBLENDER_GFLAGS_NAMESPACE=${GFLAGS_NAMESPACE})
+  add_definitions(${GFLAGS_DEFINES})
+  add_definitions(${GLOG_DEFINES})
+
+  blender_add_lib__impl(${name} "${sources}" "${includes}" "${includes_sys}" "${library_deps}")
+
+  set_property(GLOBAL APPEND PROPERTY BLENDER_PERFORMANCE_TEST_LIBS ${name})
+endfunction()
+
 
 # Add tests for a Blender library, to be called in tandem with blender_add_lib().
 # Test will be compiled into a ${name}_test executable.
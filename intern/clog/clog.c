@@ -75,6 +75,8 @@ typedef struct CLG_IDFilter {
 typedef struct CLogContext {
   /** Single linked list of types.  */
   CLG_LogType *types;
+  /** Single linked list of references, reset on exit since they point to the types. */
+  CLG_LogRef *refs;
 #ifdef WITH_CLOG_PTHREADS
   pthread_mutex_t types_lock;
 #endif
@@ -638,6 +640,15 @@ static CLogContext *CLG_ctx_init(void)
 
 static void CLG_ctx_free(CLogContext *ctx)
 {
+  /* References are static, so they outlive the context and get initialized again by the next
+   * one. */
+  while (ctx->refs != NULL) {
+    CLG_LogRef *item = ctx->refs;
+    ctx->refs = item->next;
+    item->type = NULL;
+    item->next = NULL;
+  }
+
   while (ctx->types != NULL) {
     CLG_LogType *item = ctx->types;
     ctx->types = item->next;
@@ -744,6 +755,8 @@ void CLG_logref_init(CLG_LogRef *clg_ref)
     if (clg_ty == NULL) {
       clg_ty = clg_ctx_type_register(g_ctx, clg_ref->identifier);
     }
+    clg_ref->next = g_ctx->refs;
+    g_ctx->refs = clg_ref;
 #ifdef WITH_CLOG_PTHREADS
     atomic_cas_ptr((void **)&clg_ref->type, clg_ref->type, clg_ty);
 #else
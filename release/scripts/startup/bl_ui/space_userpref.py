@@ -2202,6 +2202,8 @@ class USERPREF_PT_experimental_prototypes(ExperimentalPanel, Panel):
                 ({"property": "use_new_hair_type"}, "T68981"),
                 ({"property": "use_new_point_cloud_type"}, "T75717"),
                 ({"property": "use_new_geometry_nodes"}, "project/profile/121"),
+                ({"property": "use_undo_skip_unchanged"}, None),
+                ({"property": "use_depsgraph_critical_path"}, None),
             ),
         )
 
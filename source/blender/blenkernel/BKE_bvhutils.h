@@ -259,6 +259,10 @@ bool bvhcache_has_tree(const struct BVHCache *bvh_cache, const BVHTree *tree);
 struct BVHCache *bvhcache_init(void);
 void bvhcache_free(struct BVHCache *bvh_cache);
 
+/* Refit the trees of a previous evaluation when the topology didn't change. */
+struct BVHCache *bvhcache_take_for_reuse(struct Mesh *mesh);
+void bvhcache_reuse(struct BVHCache *bvh_cache, struct Mesh *mesh);
+
 #ifdef __cplusplus
 }
 #endif
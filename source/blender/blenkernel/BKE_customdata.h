@@ -74,6 +74,17 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /**
+   * Share data of the source layers, which are kept alive for as long as any of the custom data
+   * uses them. Shared layers get the NOFREE flag, so they are duplicated before being modified
+   * like referenced layers. Layers which do not own their data are duplicated.
+   *
+   * Sharing is copy-on-write: both sides get the layer data for writing with
+   * #CustomData_get_layer_for_write or #CustomData_duplicate_referenced_layer, which copy it while
+   * other custom data still uses it. This includes the source layers, which do not get the NOFREE
+   * flag. Referencing a shared layer (#CD_REFERENCE) shares it too.
+   */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -232,6 +243,10 @@ void *CustomData_duplicate_referenced_layer_named(struct CustomData *data,
                                                   const char *name,
                                                   const int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
+/* Layer data is shared with other custom data, see CD_SHARE. */
+bool CustomData_is_shared_layer(const struct CustomData *data, int type);
+/* Copy the data of all shared layers, returns true when any layer data was replaced. */
+bool CustomData_ensure_unshared_layers(struct CustomData *data, const int totelem);
 
 /* set the CD_FLAG_NOCOPY flag in custom data layers where the mask is
  * zero for the layer type, so only layer types specified by the mask
@@ -254,6 +269,13 @@ void CustomData_copy_data_named(const struct CustomData *source,
                                 int source_index,
                                 int dest_index,
                                 int count);
+/* copies the source elements in src_indices to count dest elements starting at dest_index,
+ * layers are matched like CustomData_copy_data, but only once for all elements */
+void CustomData_copy_data_indices(const struct CustomData *source,
+                                  struct CustomData *dest,
+                                  const int *src_indices,
+                                  int dest_index,
+                                  int count);
 void CustomData_copy_elements(int type, void *src_data_ofs, void *dst_data_ofs, int count);
 void CustomData_bmesh_copy_data(const struct CustomData *source,
                                 struct CustomData *dest,
@@ -297,6 +319,16 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+/* interpolates count dest elements starting at dest_index, each one from src_count source
+ * elements, src_indices and weights hold src_count items for every dest element,
+ * if weights == NULL the source elements are averaged */
+void CustomData_interp_indices(const struct CustomData *source,
+                               struct CustomData *dest,
+                               const int *src_indices,
+                               const float *weights,
+                               int src_count,
+                               int dest_index,
+                               int count);
 void CustomData_bmesh_interp_n(struct CustomData *data,
                                const void **src_blocks,
                                const float *weights,
@@ -339,6 +371,16 @@ const char *CustomData_get_layer_name(const struct CustomData *data, int type, i
 void *CustomData_get_layer(const struct CustomData *data, int type);
 void *CustomData_get_layer_n(const struct CustomData *data, int type, int n);
 void *CustomData_get_layer_named(const struct CustomData *data, int type, const char *name);
+/* Same as above, for layer data which is going to be modified in place: data shared with other
+ * custom data (see CD_SHARE) is copied first, only for the returned layer. Unlike
+ * #CustomData_duplicate_referenced_layer, referenced layers which are not shared are kept as is.
+ */
+void *CustomData_get_layer_for_write(struct CustomData *data, int type, int totelem);
+void *CustomData_get_layer_n_for_write(struct CustomData *data, int type, int n, int totelem);
+void *CustomData_get_layer_named_for_write(struct CustomData *data,
+                                           int type,
+                                           const char *name,
+                                           int totelem);
 int CustomData_get_offset(const struct CustomData *data, int type);
 int CustomData_get_n_offset(const struct CustomData *data, int type, int n);
 
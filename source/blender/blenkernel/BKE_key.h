@@ -68,6 +68,9 @@ struct KeyBlock *BKE_keyblock_add_ctime(struct Key *key, const char *name, const
 struct KeyBlock *BKE_keyblock_from_key(struct Key *key, int index);
 struct KeyBlock *BKE_keyblock_find_name(struct Key *key, const char name[]);
 void BKE_keyblock_copy_settings(struct KeyBlock *kb_dst, const struct KeyBlock *kb_src);
+void *BKE_keyblock_data_ensure(struct Key *key, struct KeyBlock *kb);
+void *BKE_keyblock_data_ensure_unshared(struct Key *key, struct KeyBlock *kb);
+void BKE_keyblock_data_free(struct KeyBlock *kb);
 char *BKE_keyblock_curval_rnapath_get(struct Key *key, struct KeyBlock *kb);
 
 /* conversion functions */
@@ -117,6 +117,20 @@ enum {
   LIB_ID_COPY_NO_ANIMDATA = 1 << 19,
   /** Mesh: Reference CD data layers instead of doing real copy - USE WITH CAUTION! */
   LIB_ID_COPY_CD_REFERENCE = 1 << 20,
+  /**
+   * Mesh: Share CD data layers with the source, the data is only copied when either side
+   * modifies it (see #CD_SHARE). Code writing to arrays of either mesh has to access them for
+   * writing, e.g. with #BKE_mesh_layer_for_write.
+   * Shape-key and curve: Share the key block data and the points of nurbs in the same way, see
+   * #BKE_keyblock_data_ensure_unshared and #BKE_nurb_ensure_unshared.
+   */
+  LIB_ID_COPY_CD_SHARE = 1 << 21,
+  /**
+   * Shape-key: Only copy the elements of key blocks which differ from their relative key, when
+   * few of them do (see #KEYBLOCK_SPARSE). Code reading the key block data of the copy has to
+   * use #BKE_keyblock_data_ensure.
+   */
+  LIB_ID_COPY_KEY_SPARSE = 1 << 22,
 
   /* *** XXX Hackish/not-so-nice specific behaviors needed for some corner cases. *** */
   /* *** Ideally we should not have those, but we need them for now... *** */
@@ -101,6 +101,12 @@ void BKE_mesh_clear_geometry(struct Mesh *me);
 struct Mesh *BKE_mesh_add(struct Main *bmain, const char *name);
 void BKE_mesh_copy_settings(struct Mesh *me_dst, const struct Mesh *me_src);
 void BKE_mesh_update_customdata_pointers(struct Mesh *me, const bool do_ensure_tess_cd);
+bool BKE_mesh_ensure_unshared_customdata(struct Mesh *me);
+void *BKE_mesh_layer_for_write(struct Mesh *me, struct CustomData *data, const int type);
+void *BKE_mesh_layer_named_for_write(struct Mesh *me,
+                                     struct CustomData *data,
+                                     const int type,
+                                     const char *name);
 void BKE_mesh_ensure_skin_customdata(struct Mesh *me);
 
 struct Mesh *BKE_mesh_new_nomain(
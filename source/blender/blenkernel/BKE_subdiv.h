@@ -97,10 +97,22 @@ typedef enum eSubdivStatsValue {
   SUBDIV_STATS_SUBDIV_TO_CCG,
   SUBDIV_STATS_SUBDIV_TO_CCG_ELEMENTS,
   SUBDIV_STATS_TOPOLOGY_COMPARE,
+  SUBDIV_STATS_SUBDIV_TO_PATCH_CACHE,
 
   NUM_SUBDIV_STATS_VALUES,
 } eSubdivStatsValue;
 
+typedef enum eSubdivStatsCounter {
+  /* Topology was re-used because the topology fingerprint of the new mesh matched. */
+  SUBDIV_STATS_TOPOLOGY_FINGERPRINT_MATCH = 0,
+  /* Topology was re-used after a full comparison with the new mesh. */
+  SUBDIV_STATS_TOPOLOGY_COMPARE_MATCH,
+  /* Topology refiner was re-created because topology or settings did change. */
+  SUBDIV_STATS_TOPOLOGY_REFINER_REBUILD,
+
+  NUM_SUBDIV_STATS_COUNTERS,
+} eSubdivStatsCounter;
+
 typedef struct SubdivStats {
   union {
     struct {
@@ -122,6 +134,8 @@ typedef struct SubdivStats {
       double subdiv_to_ccg_elements_time;
       /* Time spent on CCG elements evaluation/initialization. */
       double topology_compare_time;
+      /* Total time spent in BKE_subdiv_to_patch_cache(). */
+      double subdiv_to_patch_cache_time;
     };
     double values_[NUM_SUBDIV_STATS_VALUES];
   };
@@ -129,6 +143,20 @@ typedef struct SubdivStats {
   /* Per-value timestamp on when corresponding BKE_subdiv_stats_begin() was
    * called. */
   double begin_timestamp_[NUM_SUBDIV_STATS_VALUES];
+
+  /* Counters of how the descriptor was re-used for new input meshes.
+   * Unlike timing, they are kept when the topology refiner is re-created. */
+  union {
+    struct {
+      int topology_fingerprint_match_count;
+      int topology_compare_match_count;
+      int topology_refiner_rebuild_count;
+    };
+    int counters_[NUM_SUBDIV_STATS_COUNTERS];
+  };
+
+  /* Memory used by the last patch cache created by BKE_subdiv_to_patch_cache(), in bytes. */
+  size_t patch_cache_memory;
 } SubdivStats;
 
 /* Functor which evaluates displacement at a given (u, v) of given ptex face. */
@@ -216,6 +244,8 @@ void BKE_subdiv_stats_end(SubdivStats *stats, eSubdivStatsValue value);
 
 void BKE_subdiv_stats_reset(SubdivStats *stats, eSubdivStatsValue value);
 
+void BKE_subdiv_stats_count(SubdivStats *stats, eSubdivStatsCounter counter);
+
 void BKE_subdiv_stats_print(const SubdivStats *stats);
 
 /* ================================ SETTINGS ================================ */
@@ -245,6 +275,22 @@ Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const struct Mesh *mesh);
 
+/* Fingerprint of everything the mesh converter uses to build the topology refiner.
+ * Matching fingerprints and settings mean the existing descriptor can be re-used without
+ * converting and comparing topology, so only vertex data needs to be pushed to the evaluator. */
+typedef struct SubdivTopologyFingerprint {
+  /* Hash of faces, edges, creases and UV layers. */
+  uint64_t hash;
+  /* The hash can collide, so element counts are compared as well. Any mismatch in those
+   * would make pushing vertex data to the evaluator read or write out of bounds. */
+  int totvert, totedge, totloop, totpoly;
+} SubdivTopologyFingerprint;
+
+void BKE_subdiv_topology_fingerprint_from_mesh(const struct Mesh *mesh,
+                                               SubdivTopologyFingerprint *r_fingerprint);
+bool BKE_subdiv_topology_fingerprint_equal(const SubdivTopologyFingerprint *a,
+                                           const SubdivTopologyFingerprint *b);
+
 void BKE_subdiv_free(Subdiv *subdiv);
 
 /* ============================ DISPLACEMENT API ============================ */
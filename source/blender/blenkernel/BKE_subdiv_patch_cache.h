@@ -0,0 +1,97 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#pragma once
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Mesh;
+struct Subdiv;
+struct SubdivToMeshSettings;
+
+/* Patch coordinate of a subdivided vertex which is not on the limit surface:
+ * vertices of loose geometry. */
+#define SUBDIV_PATCH_COORD_LOOSE -1
+
+/* Location of a subdivided vertex on the limit surface. */
+typedef struct SubdivPatchCoord {
+  int ptex_face_index;
+  float u, v;
+} SubdivPatchCoord;
+
+/* Compact alternative to a fully subdivided mesh.
+ *
+ * Only stores where every subdivided vertex is on the limit surface, and the subdivided faces
+ * in compressed sparse row form. Positions and normals are evaluated on demand, by consumers
+ * which only need to sample the limit surface (render engines, exporters).
+ *
+ * Nothing here depends on coarse vertex positions, so the cache stays valid for as long as
+ * the topology of the subdiv descriptor does not change: after deformation the evaluator is
+ * refined for the new positions and the cache is sampled again. */
+typedef struct SubdivPatchCache {
+  /* Descriptor used for evaluation, not owned by the cache. */
+  struct Subdiv *subdiv;
+
+  int num_vertices;
+  int num_faces;
+  int num_face_vertices;
+
+  /* Indexed by subdivided vertex index. */
+  SubdivPatchCoord *vertex_patch_coords;
+  /* Vertices of face `i` are `face_vertices[face_offsets[i]]` up to (not including)
+   * `face_vertices[face_offsets[i + 1]]`, in the order of a subdivided mesh's loops. */
+  int *face_offsets;
+  int *face_vertices;
+  /* Index of the coarse polygon every face was created from. */
+  int *face_origindex;
+} SubdivPatchCache;
+
+/* Create patch cache for the given settings, indices of vertices and faces match the ones of
+ * BKE_subdiv_to_mesh() with the same settings.
+ * Returns NULL if the evaluator could not be created for the coarse mesh. */
+SubdivPatchCache *BKE_subdiv_to_patch_cache(struct Subdiv *subdiv,
+                                            const struct SubdivToMeshSettings *settings,
+                                            const struct Mesh *coarse_mesh);
+
+void BKE_subdiv_patch_cache_free(SubdivPatchCache *cache);
+
+/* Memory used by the cache, in bytes. */
+size_t BKE_subdiv_patch_cache_memory_size(const SubdivPatchCache *cache);
+
+/* Evaluate position (and normal) on the limit surface of a subdivided vertex.
+ * Returns false for vertices of loose geometry, which are not on the limit surface. */
+bool BKE_subdiv_patch_cache_eval_vertex(const SubdivPatchCache *cache,
+                                        const int vertex_index,
+                                        float r_P[3]);
+bool BKE_subdiv_patch_cache_eval_vertex_and_normal(const SubdivPatchCache *cache,
+                                                   const int vertex_index,
+                                                   float r_P[3],
+                                                   float r_N[3]);
+
+#ifdef __cplusplus
+}
+#endif
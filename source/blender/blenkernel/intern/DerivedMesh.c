@@ -698,10 +698,10 @@ static float (*get_orco_coords(Object *ob, BMEditMesh *em, int layer, int *free)
     if (!em) {
       ClothModifierData *clmd = (ClothModifierData *)BKE_modifiers_findby_type(
           ob, eModifierType_Cloth);
-      KeyBlock *kb = BKE_keyblock_from_key(BKE_key_from_object(ob),
-                                           clmd->sim_parms->shapekey_rest);
+      Key *key = BKE_key_from_object(ob);
+      KeyBlock *kb = BKE_keyblock_from_key(key, clmd->sim_parms->shapekey_rest);
 
-      if (kb && kb->data) {
+      if (kb && BKE_keyblock_data_ensure(key, kb)) {
         return kb->data;
       }
     }
@@ -799,6 +799,7 @@ static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
       float(*polynors)[3] = CustomData_add_layer(
           &mesh_final->pdata, CD_NORMAL, CD_CALLOC, NULL, mesh_final->totpoly);
+      BKE_mesh_layer_for_write(mesh_final, &mesh_final->vdata, CD_MVERT);
       BKE_mesh_calc_normals_poly(mesh_final->mvert,
                                  NULL,
                                  mesh_final->totvert,
@@ -1360,6 +1361,148 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   }
 }
 
+/**
+ * Check whether the previous evaluated mesh of \a ob can be updated in place by
+ * #mesh_calc_modifiers_deform_reuse, instead of evaluating the modifier stack from scratch.
+ *
+ * This is the case when the stack only contains deform modifiers (armature, lattice, hook,
+ * shape keys...) and the input mesh is the same copy the previous result was evaluated from,
+ * so the previous result still references its topology arrays.
+ */
+static bool mesh_calc_modifiers_deform_reuse_poll(struct Depsgraph *depsgraph,
+                                                  Scene *scene,
+                                                  Object *ob,
+                                                  const CustomData_MeshMasks *dataMask,
+                                                  const bool need_mapping)
+{
+  if (!(ob->runtime.data_eval && ob->runtime.is_data_eval_owned &&
+        (GS(ob->runtime.data_eval->name) == ID_ME))) {
+    return false;
+  }
+  if (ob->mode & OB_MODE_ALL_SCULPT) {
+    return false;
+  }
+
+  /* The object data still points to the previous result until derived caches are freed. */
+  const Mesh *mesh_input = (const Mesh *)(ob->runtime.data_orig ? ob->runtime.data_orig :
+                                                                  ob->data);
+  const Mesh *mesh_prev = (const Mesh *)ob->runtime.data_eval;
+  if (mesh_input->edit_mesh != NULL || mesh_prev->runtime.deformed_only == false ||
+      mesh_prev->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return false;
+  }
+
+  /* The previous result must have been evaluated from the current copy of the input mesh. */
+  if (ob->runtime.last_data_stamp != mesh_input->runtime.data_stamp ||
+      mesh_prev->totvert != mesh_input->totvert || mesh_prev->totedge != mesh_input->totedge ||
+      mesh_prev->totloop != mesh_input->totloop || mesh_prev->totpoly != mesh_input->totpoly ||
+      mesh_prev->medge != mesh_input->medge || mesh_prev->mloop != mesh_input->mloop ||
+      mesh_prev->mpoly != mesh_input->mpoly) {
+    return false;
+  }
+
+  /* Requested data must have been created already, tessellated faces depend on positions. */
+  if ((ob->runtime.last_need_mapping != need_mapping) ||
+      !CustomData_MeshMasks_are_matching(&ob->runtime.last_data_mask, dataMask) ||
+      (dataMask->fmask & CD_MASK_MFACE)) {
+    return false;
+  }
+
+  const bool use_render = (DEG_get_mode(depsgraph) == DAG_EVAL_RENDER);
+  const int required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
+
+  VirtualModifierData virtualModifierData;
+  ModifierData *md = BKE_modifiers_get_virtual_modifierlist(ob, &virtualModifierData);
+  for (; md; md = md->next) {
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+    if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
+      continue;
+    }
+    if (mti->type != eModifierTypeType_OnlyDeform) {
+      return false;
+    }
+    /* Would need the intermediate mesh with up to date normals. */
+    if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Evaluate a stack of deform modifiers, updating \a mesh_prev in place:
+ * only the positions and the data derived from them (normals, tessellation, BVH trees)
+ * are recalculated, the topology and other layers are kept.
+ *
+ * Should only be called when #mesh_calc_modifiers_deform_reuse_poll succeeded.
+ */
+static void mesh_calc_modifiers_deform_reuse(struct Depsgraph *depsgraph,
+                                             Scene *scene,
+                                             Object *ob,
+                                             const CustomData_MeshMasks *dataMask,
+                                             Mesh *mesh_prev,
+                                             /* return args */
+                                             Mesh **r_deform,
+                                             Mesh **r_final)
+{
+  Mesh *mesh_input = ob->data;
+
+  const bool use_render = (DEG_get_mode(depsgraph) == DAG_EVAL_RENDER);
+  const int required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
+  ModifierApplyFlag apply_render = use_render ? MOD_APPLY_RENDER : 0;
+  const ModifierEvalContext mectx = {depsgraph, ob, apply_render | MOD_APPLY_USECACHE};
+
+  VirtualModifierData virtualModifierData;
+  ModifierData *firstmd = BKE_modifiers_get_virtual_modifierlist(ob, &virtualModifierData);
+  ModifierData *md;
+
+  /* Same data masks as the full evaluation, needed to calculate the final normals. */
+  CustomData_MeshMasks final_datamask = *dataMask;
+  CDMaskLink *datamasks = BKE_modifier_calc_data_masks(
+      scene, ob, firstmd, &final_datamask, required_mode, NULL, NULL);
+  BLI_linklist_free((LinkNode *)datamasks, NULL);
+
+  BKE_modifiers_clear_errors(ob);
+
+  int num_deformed_verts;
+  float(*deformed_verts)[3] = BKE_mesh_vert_coords_alloc(mesh_input, &num_deformed_verts);
+  for (md = firstmd; md; md = md->next) {
+    if (BKE_modifier_is_enabled(scene, md, required_mode)) {
+      BKE_modifier_deform_verts(md, &mectx, NULL, deformed_verts, num_deformed_verts);
+    }
+  }
+  for (md = firstmd; md; md = md->next) {
+    BKE_modifier_free_temporary_data(md);
+  }
+
+  if (r_deform) {
+    Mesh *mesh_deform = BKE_mesh_copy_for_eval(mesh_input, true);
+    BKE_mesh_vert_coords_apply(mesh_deform, deformed_verts);
+    if (final_datamask.vmask & CD_MASK_ORCO) {
+      add_orco_mesh(ob, NULL, mesh_deform, NULL, CD_ORCO);
+    }
+    *r_deform = mesh_deform;
+  }
+
+  BKE_mesh_vert_coords_apply(mesh_prev, deformed_verts);
+  MEM_freeN(deformed_verts);
+
+  /* Free everything derived from the previous positions,
+   * BVH trees were already taken by the caller to be refitted. */
+  BKE_mesh_runtime_clear_geometry(mesh_prev);
+  BKE_mesh_tessface_clear(mesh_prev);
+  CustomData_free_layers(&mesh_prev->pdata, CD_NORMAL, mesh_prev->totpoly);
+  CustomData_free_layers(&mesh_prev->ldata, CD_NORMAL, mesh_prev->totloop);
+  CustomData_free_layers(&mesh_prev->ldata, CD_TANGENT, mesh_prev->totloop);
+  BKE_mesh_batch_cache_dirty_tag(mesh_prev, BKE_MESH_BATCH_DIRTY_ALL);
+
+  mesh_calc_modifier_final_normals(mesh_input, &final_datamask, false, mesh_prev);
+
+  *r_final = mesh_prev;
+}
+
 float (*editbmesh_vert_coords_alloc(BMEditMesh *em, int *r_vert_len))[3]
 {
   BMIter iter;
@@ -1419,6 +1562,7 @@ static void editbmesh_calc_modifier_final_normals(Mesh *mesh_final,
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
       float(*polynors)[3] = CustomData_add_layer(
           &mesh_final->pdata, CD_NORMAL, CD_CALLOC, NULL, mesh_final->totpoly);
+      BKE_mesh_layer_for_write(mesh_final, &mesh_final->vdata, CD_MVERT);
       BKE_mesh_calc_normals_poly(mesh_final->mvert,
                                  NULL,
                                  mesh_final->totvert,
@@ -1770,6 +1914,21 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  /* Keep the BVH trees of the previous evaluation,
+   * they are refitted when only the vertex positions changed. */
+  struct BVHCache *bvh_cache_prev = NULL;
+  if (ob->runtime.data_eval && ob->runtime.is_data_eval_owned &&
+      (GS(ob->runtime.data_eval->name) == ID_ME)) {
+    bvh_cache_prev = bvhcache_take_for_reuse((Mesh *)ob->runtime.data_eval);
+  }
+
+  /* Keep the whole evaluated mesh when only its positions need to be updated. */
+  Mesh *mesh_prev = NULL;
+  if (mesh_calc_modifiers_deform_reuse_poll(depsgraph, scene, ob, dataMask, need_mapping)) {
+    mesh_prev = (Mesh *)ob->runtime.data_eval;
+    ob->runtime.data_eval = NULL;
+  }
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1785,17 +1944,23 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
 #endif
 
   Mesh *mesh_eval = NULL, *mesh_deform_eval = NULL;
-  mesh_calc_modifiers(depsgraph,
-                      scene,
-                      ob,
-                      1,
-                      need_mapping,
-                      dataMask,
-                      -1,
-                      true,
-                      true,
-                      &mesh_deform_eval,
-                      &mesh_eval);
+  if (mesh_prev != NULL) {
+    mesh_calc_modifiers_deform_reuse(
+        depsgraph, scene, ob, dataMask, mesh_prev, &mesh_deform_eval, &mesh_eval);
+  }
+  else {
+    mesh_calc_modifiers(depsgraph,
+                        scene,
+                        ob,
+                        1,
+                        need_mapping,
+                        dataMask,
+                        -1,
+                        true,
+                        true,
+                        &mesh_deform_eval,
+                        &mesh_eval);
+  }
 
   /* The modifier stack evaluation is storing result in mesh->runtime.mesh_eval, but this result
    * is not guaranteed to be owned by object.
@@ -1807,9 +1972,19 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (bvh_cache_prev != NULL) {
+    if (is_mesh_eval_owned) {
+      bvhcache_reuse(bvh_cache_prev, mesh_eval);
+    }
+    else {
+      bvhcache_free(bvh_cache_prev);
+    }
+  }
+
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
+  ob->runtime.last_data_stamp = mesh->runtime.data_stamp;
 
   BKE_object_boundbox_calc_from_mesh(ob, mesh_eval);
 
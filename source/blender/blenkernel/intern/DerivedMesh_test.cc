@@ -0,0 +1,187 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "tests/blendfile_loading_base_test.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_listbase.h"
+
+#include "BKE_DerivedMesh.h"
+#include "BKE_customdata.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/* Evaluated copy of a mesh object with a deform only modifier stack. */
+class DerivedMeshTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain;
+  Scene *scene;
+  Object *ob;
+  SimpleDeformModifierData *smd;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    depsgraph = DEG_graph_new(bmain, scene, BKE_view_layer_default_view(scene), DAG_EVAL_VIEWPORT);
+
+    ob = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    ob->id.tag |= LIB_TAG_COPIED_ON_WRITE;
+    input_mesh_set(grid_mesh_create(8));
+
+    smd = (SimpleDeformModifierData *)BKE_modifier_new(eModifierType_SimpleDeform);
+    smd->mode = MOD_SIMPLEDEFORM_MODE_TWIST;
+    smd->factor = 0.5f;
+    BLI_addtail(&ob->modifiers, smd);
+  }
+
+  void TearDown() override
+  {
+    BKE_object_free_derived_caches(ob);
+    BKE_id_free(nullptr, input_mesh_set(nullptr));
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_main_free(bmain);
+  }
+
+  /* Like the copy-on-write update of the object, returns the previous input mesh. */
+  Mesh *input_mesh_set(Mesh *mesh)
+  {
+    Mesh *mesh_prev = (Mesh *)ob->runtime.data_orig;
+    ob->data = mesh;
+    ob->runtime.data_orig = (ID *)mesh;
+    return mesh_prev;
+  }
+
+  /* Unit grid around the origin. */
+  static Mesh *grid_mesh_create(const int size)
+  {
+    Mesh *mesh = test_grid_mesh_create(size);
+    for (int i = 0; i < mesh->totvert; i++) {
+      float *co = mesh->mvert[i].co;
+      co[0] = co[0] / size - 0.5f;
+      co[1] = co[1] / size - 0.5f;
+    }
+    /* Set for copy-on-write copies of original meshes. */
+    mesh->runtime.deformed_only = true;
+    return mesh;
+  }
+
+  /* Unique for each evaluated mesh, unchanged when the previous one is updated in place. */
+  int evaluated_data_stamp()
+  {
+    return ((Mesh *)ob->runtime.data_eval)->runtime.data_stamp;
+  }
+};
+
+/* Loop normals are requested so the reused mesh has to recalculate them too. */
+static const CustomData_MeshMasks derived_mesh_test_mask = {
+    CD_MASK_BAREMESH.vmask,
+    CD_MASK_BAREMESH.emask,
+    CD_MASK_BAREMESH.fmask,
+    CD_MASK_BAREMESH.pmask,
+    CD_MASK_BAREMESH.lmask | CD_MASK_NORMAL,
+};
+
+TEST_F(DerivedMeshTest, DeformReuseMatchesFullEvaluation)
+{
+  makeDerivedMesh(depsgraph, scene, ob, nullptr, &derived_mesh_test_mask);
+  const Mesh *mesh_first = (Mesh *)ob->runtime.data_eval;
+  const int stamp_first = evaluated_data_stamp();
+
+  smd->factor = 1.5f;
+  makeDerivedMesh(depsgraph, scene, ob, nullptr, &derived_mesh_test_mask);
+  const Mesh *mesh_reuse = (Mesh *)ob->runtime.data_eval;
+  ASSERT_EQ(mesh_reuse, mesh_first);
+  EXPECT_EQ(evaluated_data_stamp(), stamp_first);
+
+  /* Evaluate the whole stack again, from the input mesh instead of the assigned result. */
+  ob->data = ob->runtime.data_orig;
+  Mesh *mesh_full = mesh_create_eval_final(depsgraph, scene, ob, &derived_mesh_test_mask);
+  ob->data = ob->runtime.data_eval;
+  ASSERT_EQ(mesh_reuse->totvert, mesh_full->totvert);
+  ASSERT_EQ(mesh_reuse->totloop, mesh_full->totloop);
+  for (int i = 0; i < mesh_full->totvert; i++) {
+    EXPECT_EQ(memcmp(mesh_reuse->mvert[i].co, mesh_full->mvert[i].co, sizeof(float[3])), 0);
+    EXPECT_EQ(memcmp(mesh_reuse->mvert[i].no, mesh_full->mvert[i].no, sizeof(short[3])), 0);
+  }
+
+  const float(*lnors_reuse)[3] = (const float(*)[3])CustomData_get_layer(&mesh_reuse->ldata,
+                                                                         CD_NORMAL);
+  const float(*lnors_full)[3] = (const float(*)[3])CustomData_get_layer(&mesh_full->ldata,
+                                                                        CD_NORMAL);
+  ASSERT_NE(lnors_reuse, nullptr);
+  ASSERT_NE(lnors_full, nullptr);
+  for (int i = 0; i < mesh_full->totloop; i++) {
+    EXPECT_EQ(memcmp(lnors_reuse[i], lnors_full[i], sizeof(float[3])), 0);
+  }
+
+  BKE_id_free(nullptr, mesh_full);
+}
+
+TEST_F(DerivedMeshTest, DeformReusePollTopologyChange)
+{
+  makeDerivedMesh(depsgraph, scene, ob, nullptr, &derived_mesh_test_mask);
+  const int stamp_first = evaluated_data_stamp();
+
+  /* A new copy of the input mesh may have different arrays, even with the same counts. */
+  Mesh *mesh_input = (Mesh *)ob->runtime.data_orig;
+  Mesh *mesh_prev = input_mesh_set(
+      (Mesh *)BKE_id_copy_ex(nullptr, &mesh_input->id, nullptr, LIB_ID_COPY_LOCALIZE));
+  makeDerivedMesh(depsgraph, scene, ob, nullptr, &derived_mesh_test_mask);
+  const int stamp_copy = evaluated_data_stamp();
+  EXPECT_NE(stamp_copy, stamp_first);
+  BKE_id_free(nullptr, mesh_prev);
+
+  mesh_prev = input_mesh_set(grid_mesh_create(4));
+  makeDerivedMesh(depsgraph, scene, ob, nullptr, &derived_mesh_test_mask);
+  EXPECT_NE(evaluated_data_stamp(), stamp_copy);
+  EXPECT_EQ(((Mesh *)ob->runtime.data_eval)->totvert, 5 * 5);
+  BKE_id_free(nullptr, mesh_prev);
+}
+
+TEST_F(DerivedMeshTest, DeformReusePollMaskChange)
+{
+  makeDerivedMesh(depsgraph, scene, ob, nullptr, &CD_MASK_BAREMESH);
+  const int stamp_first = evaluated_data_stamp();
+
+  makeDerivedMesh(depsgraph, scene, ob, nullptr, &derived_mesh_test_mask);
+  EXPECT_NE(evaluated_data_stamp(), stamp_first);
+  EXPECT_NE(CustomData_get_layer(&((Mesh *)ob->runtime.data_eval)->ldata, CD_NORMAL), nullptr);
+}
+
+}  // namespace blender::bke::tests
@@ -602,9 +602,13 @@ static void armature_deform_coords_impl(const Object *ob_arm,
     }
   }
   else {
+    /* The cost per vertex depends a lot on the number of bones and vertex groups,
+     * so let the grain size be tuned from the actual timings. */
+    static TaskParallelAdaptive adaptive = {"armature_deform"};
     TaskParallelSettings settings;
     BLI_parallel_range_settings_defaults(&settings);
     settings.min_iter_per_thread = 32;
+    settings.adaptive = &adaptive;
     BLI_task_parallel_range(0, vert_coords_len, &data, armature_vert_task, &settings);
   }
 
@@ -37,6 +37,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BLI_path_util.h"
 #include "BLI_string.h"
@@ -127,7 +128,9 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
     if (prevfile) {
       BLO_memfile_clear_future(prevfile);
     }
-    /* success = */ /* UNUSED */ BLO_write_file_mem(bmain, prevfile, &mfu->memfile, G.fileflags);
+    const bool use_skip_unchanged = USER_EXPERIMENTAL_TEST(&U, use_undo_skip_unchanged);
+    /* success = */ /* UNUSED */ BLO_write_file_mem(
+        bmain, prevfile, &mfu->memfile, G.fileflags, use_skip_unchanged);
     mfu->undo_size = mfu->memfile.size;
   }
 
@@ -28,8 +28,10 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -46,12 +48,28 @@
 
 typedef struct BVHCacheItem {
   bool is_filled;
+  /** The tree was built for a previous evaluation of the same topology, see #bvhcache_reuse. */
+  bool needs_refit;
+  /** The tree was refitted instead of built, set until it's inserted back in the cache. */
+  bool is_refitted;
+  /** Number of times the tree was refitted since it was built. */
+  int refit_count;
+  /** Surface area of the root bounds when the tree was built. */
+  float build_area;
   BVHTree *tree;
 } BVHCacheItem;
 
+/** Identifies the topology the trees of a cache were built for. */
+typedef struct BVHCacheTopology {
+  int totvert, totedge, totloop, totpoly;
+  uint32_t hash;
+} BVHCacheTopology;
+
 typedef struct BVHCache {
   BVHCacheItem items[BVHTREE_MAX_ITEM];
   ThreadMutex mutex;
+  /** Only set for caches returned by #bvhcache_take_for_reuse. */
+  BVHCacheTopology topology;
 } BVHCache;
 
 /**
@@ -116,7 +134,8 @@ bool bvhcache_has_tree(const BVHCache *bvh_cache, const BVHTree *tree)
   }
 
   for (BVHCacheType i = 0; i < BVHTREE_MAX_ITEM; i++) {
-    if (bvh_cache->items[i].tree == tree) {
+    /* Trees which still need to be refitted don't match the mesh positions yet. */
+    if (bvh_cache->items[i].tree == tree && !bvh_cache->items[i].needs_refit) {
       return true;
     }
   }
@@ -129,6 +148,32 @@ BVHCache *bvhcache_init(void)
   BLI_mutex_init(&cache->mutex);
   return cache;
 }
+
+/** Cache types which only depend on the topology and the vertex positions. */
+static bool bvhcache_type_supports_refit(const BVHCacheType type)
+{
+  switch (type) {
+    case BVHTREE_FROM_VERTS:
+    case BVHTREE_FROM_EDGES:
+    case BVHTREE_FROM_LOOPTRI:
+    case BVHTREE_FROM_LOOPTRI_NO_HIDDEN:
+    case BVHTREE_FROM_LOOSEVERTS:
+    case BVHTREE_FROM_LOOSEEDGES:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** Surface area of the root bounds (halved), see #BVHCACHE_REFIT_AREA_GROWTH. */
+static float bvhtree_root_area(const BVHTree *tree)
+{
+  float min[3], max[3], size[3];
+  BLI_bvhtree_get_bounding_box(tree, min, max);
+  sub_v3_v3v3(size, max, min);
+  return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
 /**
  * Inserts a BVHTree of the given type under the cache
  * After that the caller no longer needs to worry when to free the BVHTree
@@ -143,6 +188,14 @@ static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType typ
   BLI_assert(!item->is_filled);
   item->tree = tree;
   item->is_filled = true;
+
+  if (item->is_refitted) {
+    item->is_refitted = false;
+  }
+  else if (tree && bvhcache_type_supports_refit(type)) {
+    item->refit_count = 0;
+    item->build_area = bvhtree_root_area(tree);
+  }
 }
 
 /**
@@ -160,6 +213,246 @@ void bvhcache_free(BVHCache *bvh_cache)
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name BVHCache Reuse
+ *
+ * Evaluated meshes are created again on every evaluation, even when only the vertex positions
+ * changed (deformation by an armature, lattice, cloth...). In that case the trees of the previous
+ * evaluated mesh are kept and refitted to the new positions, which is much cheaper than building
+ * them from scratch.
+ *
+ * Refitting keeps the hierarchy built for the old positions, so nodes overlap more and more
+ * as the mesh deforms further from them (shape-key morphs, cloth...) and queries get slower.
+ * Trees are built again after #BVHCACHE_REFIT_MAX refits, or as soon as their bounds grew by
+ * #BVHCACHE_REFIT_AREA_GROWTH.
+ * \{ */
+
+#define BVHCACHE_REFIT_MAX 32
+#define BVHCACHE_REFIT_AREA_GROWTH 2.0f
+
+static void bvhcache_topology_calc(const Mesh *mesh, BVHCacheTopology *r_topology)
+{
+  r_topology->totvert = mesh->totvert;
+  r_topology->totedge = mesh->totedge;
+  r_topology->totloop = mesh->totloop;
+  r_topology->totpoly = mesh->totpoly;
+
+  /* Hashing the whole structs is conservative (flags are included),
+   * it's still much cheaper than building the trees again. */
+  uint32_t hash = 0;
+  if (mesh->medge) {
+    hash = BLI_hash_mm2(
+        (const uchar *)mesh->medge, sizeof(*mesh->medge) * (size_t)mesh->totedge, hash);
+  }
+  if (mesh->mloop) {
+    hash = BLI_hash_mm2(
+        (const uchar *)mesh->mloop, sizeof(*mesh->mloop) * (size_t)mesh->totloop, hash);
+  }
+  if (mesh->mpoly) {
+    hash = BLI_hash_mm2(
+        (const uchar *)mesh->mpoly, sizeof(*mesh->mpoly) * (size_t)mesh->totpoly, hash);
+  }
+  r_topology->hash = hash;
+}
+
+/**
+ * Take the cache of \a mesh (which is about to be freed), so its trees can be refitted for
+ * the next evaluated mesh, see #bvhcache_reuse.
+ *
+ * \return NULL when the cache doesn't contain any tree which can be refitted.
+ */
+BVHCache *bvhcache_take_for_reuse(Mesh *mesh)
+{
+  BVHCache *bvh_cache = mesh->runtime.bvh_cache;
+  if (bvh_cache == NULL) {
+    return NULL;
+  }
+  mesh->runtime.bvh_cache = NULL;
+
+  bool has_tree = false;
+  for (BVHCacheType type = 0; type < BVHTREE_MAX_ITEM; type++) {
+    BVHCacheItem *item = &bvh_cache->items[type];
+    if (item->tree && bvhcache_type_supports_refit(type)) {
+      item->is_filled = false;
+      item->needs_refit = true;
+      has_tree = true;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+      item->tree = NULL;
+      item->is_filled = false;
+      item->needs_refit = false;
+    }
+  }
+
+  if (!has_tree) {
+    bvhcache_free(bvh_cache);
+    return NULL;
+  }
+
+  bvhcache_topology_calc(mesh, &bvh_cache->topology);
+  return bvh_cache;
+}
+
+/**
+ * Give a cache taken with #bvhcache_take_for_reuse to \a mesh when its topology matches,
+ * trees are refitted lazily the next time they are requested.
+ * Otherwise the cache is freed.
+ */
+void bvhcache_reuse(BVHCache *bvh_cache, Mesh *mesh)
+{
+  BVHCacheTopology topology;
+  bvhcache_topology_calc(mesh, &topology);
+
+  if ((mesh->runtime.bvh_cache == NULL) &&
+      (memcmp(&topology, &bvh_cache->topology, sizeof(topology)) == 0)) {
+    mesh->runtime.bvh_cache = bvh_cache;
+  }
+  else {
+    bvhcache_free(bvh_cache);
+  }
+}
+
+/**
+ * Remove the tree of a previous evaluation from the cache, to refit it.
+ * Must be called with the cache locked.
+ *
+ * \return NULL when there is no such tree, when it doesn't match the requested tree or when it
+ * was refitted too many times already.
+ */
+static BVHTree *bvhcache_refit_pop(BVHCache *bvh_cache,
+                                   const BVHCacheType type,
+                                   const int leafs_num,
+                                   const int tree_type,
+                                   const float epsilon)
+{
+  BVHCacheItem *item = &bvh_cache->items[type];
+  if (!item->needs_refit) {
+    return NULL;
+  }
+
+  BVHTree *tree = item->tree;
+  item->tree = NULL;
+  item->needs_refit = false;
+
+  if ((item->refit_count >= BVHCACHE_REFIT_MAX) || (BLI_bvhtree_get_len(tree) != leafs_num) ||
+      (BLI_bvhtree_get_tree_type(tree) != tree_type) ||
+      (BLI_bvhtree_get_epsilon(tree) != max_ff(FLT_EPSILON, epsilon))) {
+    BLI_bvhtree_free(tree);
+    return NULL;
+  }
+  return tree;
+}
+
+typedef struct BVHTreeRefitData {
+  BVHTree *tree;
+  /** Element index of each leaf, NULL when all elements are in the tree. */
+  const int *leaf_elem;
+
+  const MVert *vert;
+  const MEdge *edge;
+  const MLoop *loop;
+  const MLoopTri *looptri;
+} BVHTreeRefitData;
+
+BLI_INLINE int bvhtree_refit_elem_index(const BVHTreeRefitData *data, const int leaf_index)
+{
+  return data->leaf_elem ? data->leaf_elem[leaf_index] : leaf_index;
+}
+
+static void bvhtree_refit_verts_cb(void *__restrict userdata,
+                                   const int leaf_index,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHTreeRefitData *data = userdata;
+  const int i = bvhtree_refit_elem_index(data, leaf_index);
+  BLI_bvhtree_update_node(data->tree, leaf_index, data->vert[i].co, NULL, 1);
+}
+
+static void bvhtree_refit_edges_cb(void *__restrict userdata,
+                                   const int leaf_index,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHTreeRefitData *data = userdata;
+  const int i = bvhtree_refit_elem_index(data, leaf_index);
+  float co[2][3];
+  copy_v3_v3(co[0], data->vert[data->edge[i].v1].co);
+  copy_v3_v3(co[1], data->vert[data->edge[i].v2].co);
+  BLI_bvhtree_update_node(data->tree, leaf_index, co[0], NULL, 2);
+}
+
+static void bvhtree_refit_looptri_cb(void *__restrict userdata,
+                                     const int leaf_index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHTreeRefitData *data = userdata;
+  const int i = bvhtree_refit_elem_index(data, leaf_index);
+  float co[3][3];
+  copy_v3_v3(co[0], data->vert[data->loop[data->looptri[i].tri[0]].v].co);
+  copy_v3_v3(co[1], data->vert[data->loop[data->looptri[i].tri[1]].v].co);
+  copy_v3_v3(co[2], data->vert[data->loop[data->looptri[i].tri[2]].v].co);
+  BLI_bvhtree_update_node(data->tree, leaf_index, co[0], NULL, 3);
+}
+
+/**
+ * Update the leafs of \a tree (built from the same elements and mask) and refit its branches.
+ *
+ * Leafs are stored in the order they were inserted,
+ * with a mask the element of each leaf is looked up first.
+ *
+ * \return The refitted tree, or NULL when its bounds grew too much since it was built,
+ * the tree is freed then and has to be built again.
+ */
+static BVHTree *bvhcache_refit(BVHCache *bvh_cache,
+                               const BVHCacheType type,
+                               BVHTree *tree,
+                               BVHTreeRefitData *data,
+                               const int elem_num,
+                               const BLI_bitmap *elem_mask,
+                               TaskParallelRangeFunc refit_fn)
+{
+  const int leafs_num = BLI_bvhtree_get_len(tree);
+  int *leaf_elem = NULL;
+
+  if (elem_mask) {
+    leaf_elem = MEM_malloc_arrayN((size_t)leafs_num, sizeof(*leaf_elem), __func__);
+    int leaf_index = 0;
+    for (int i = 0; i < elem_num; i++) {
+      if (BLI_BITMAP_TEST_BOOL(elem_mask, i)) {
+        leaf_elem[leaf_index++] = i;
+      }
+    }
+    BLI_assert(leaf_index == leafs_num);
+  }
+  else {
+    BLI_assert(elem_num == leafs_num);
+  }
+
+  data->tree = tree;
+  data->leaf_elem = leaf_elem;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, leafs_num, data, refit_fn, &settings);
+
+  BLI_bvhtree_update_tree(tree);
+
+  MEM_SAFE_FREE(leaf_elem);
+
+  BVHCacheItem *item = &bvh_cache->items[type];
+  if (bvhtree_root_area(tree) > item->build_area * BVHCACHE_REFIT_AREA_GROWTH) {
+    BLI_bvhtree_free(tree);
+    return NULL;
+  }
+  item->refit_count++;
+  item->is_refitted = true;
+  return tree;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Local Callbacks
  * \{ */
@@ -708,8 +1001,28 @@ BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    tree = bvhtree_from_mesh_verts_create_tree(
-        epsilon, tree_type, axis, vert, verts_num, verts_mask, verts_num_active);
+    if (bvh_cache_p) {
+      tree = bvhcache_refit_pop(*bvh_cache_p,
+                                bvh_cache_type,
+                                verts_mask ? verts_num_active : verts_num,
+                                tree_type,
+                                epsilon);
+    }
+
+    if (tree) {
+      BVHTreeRefitData refit_data = {.vert = vert};
+      tree = bvhcache_refit(*bvh_cache_p,
+                            bvh_cache_type,
+                            tree,
+                            &refit_data,
+                            verts_num,
+                            verts_mask,
+                            bvhtree_refit_verts_cb);
+    }
+    if (tree == NULL) {
+      tree = bvhtree_from_mesh_verts_create_tree(
+          epsilon, tree_type, axis, vert, verts_num, verts_mask, verts_num_active);
+    }
 
     if (bvh_cache_p) {
       /* Save on cache for later use */
@@ -923,8 +1236,28 @@ BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    tree = bvhtree_from_mesh_edges_create_tree(
-        vert, edge, edges_num, edges_mask, edges_num_active, epsilon, tree_type, axis);
+    if (bvh_cache_p) {
+      tree = bvhcache_refit_pop(*bvh_cache_p,
+                                bvh_cache_type,
+                                edges_mask ? edges_num_active : edges_num,
+                                tree_type,
+                                epsilon);
+    }
+
+    if (tree) {
+      BVHTreeRefitData refit_data = {.vert = vert, .edge = edge};
+      tree = bvhcache_refit(*bvh_cache_p,
+                            bvh_cache_type,
+                            tree,
+                            &refit_data,
+                            edges_num,
+                            edges_mask,
+                            bvhtree_refit_edges_cb);
+    }
+    if (tree == NULL) {
+      tree = bvhtree_from_mesh_edges_create_tree(
+          vert, edge, edges_num, edges_mask, edges_num_active, epsilon, tree_type, axis);
+    }
 
     if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
@@ -1291,16 +1624,36 @@ BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    /* Setup BVHTreeFromMesh */
-    tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
-                                                 tree_type,
-                                                 axis,
-                                                 vert,
-                                                 mloop,
-                                                 looptri,
-                                                 looptri_num,
-                                                 looptri_mask,
-                                                 looptri_num_active);
+    if (bvh_cache_p) {
+      tree = bvhcache_refit_pop(*bvh_cache_p,
+                                bvh_cache_type,
+                                looptri_mask ? looptri_num_active : looptri_num,
+                                tree_type,
+                                epsilon);
+    }
+
+    if (tree) {
+      BVHTreeRefitData refit_data = {.vert = vert, .loop = mloop, .looptri = looptri};
+      tree = bvhcache_refit(*bvh_cache_p,
+                            bvh_cache_type,
+                            tree,
+                            &refit_data,
+                            looptri_num,
+                            looptri_mask,
+                            bvhtree_refit_looptri_cb);
+    }
+    if (tree == NULL) {
+      /* Setup BVHTreeFromMesh */
+      tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
+                                                   tree_type,
+                                                   axis,
+                                                   vert,
+                                                   mloop,
+                                                   looptri,
+                                                   looptri_num,
+                                                   looptri_mask,
+                                                   looptri_num_active);
+    }
 
     if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
@@ -1554,6 +1907,9 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
                                             bvh_cache_type,
                                             bvh_cache_p,
                                             mesh_eval_mutex);
+        if (looptri_mask != NULL) {
+          MEM_freeN(looptri_mask);
+        }
       }
       else {
         /* Setup BVHTreeFromMesh */
@@ -0,0 +1,241 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cfloat>
+#include <cmath>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_kdopbvh.h"
+
+#include "BKE_bvhutils.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/* Trees of a cache re-used by the next evaluation of a deformed mesh give the same query results
+ * as trees built from scratch, whether they were refitted or built again. */
+class BVHCacheReuseTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+ protected:
+  static const int size = 16;
+  Mesh *mesh;
+
+  void SetUp() override
+  {
+    mesh = test_grid_mesh_create(size);
+    /* Some hidden faces, so the masked tree has leafs for part of the looptris only. */
+    for (int i = 0; i < mesh->totpoly; i += 7) {
+      mesh->mpoly[i].flag |= ME_HIDE;
+    }
+    deform(1.0f, 0.0f);
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, mesh);
+  }
+
+  /* Wave along Z, scaled in the XY plane. */
+  void deform(const float scale, const float phase)
+  {
+    for (int i = 0; i < mesh->totvert; i++) {
+      const int x = i % (size + 1);
+      const int y = i / (size + 1);
+      float *co = mesh->mvert[i].co;
+      co[0] = (float)x * scale;
+      co[1] = (float)y * scale;
+      co[2] = sinf((float)x * 0.4f + phase) * cosf((float)y * 0.3f);
+    }
+  }
+
+  /* Like the next evaluation of a deform modifier: the trees of the previous evaluated mesh are
+   * handed to the mesh with the new positions. */
+  void deform_and_reuse(const float scale, const float phase)
+  {
+    BVHCache *bvh_cache = bvhcache_take_for_reuse(mesh);
+    ASSERT_NE(bvh_cache, nullptr);
+    deform(scale, phase);
+    bvhcache_reuse(bvh_cache, mesh);
+  }
+
+  BVHTree *tree_get(BVHTreeFromMesh *data, const BVHCacheType type)
+  {
+    BVHTree *tree = BKE_bvhtree_from_mesh_get(data, mesh, type, 2);
+    EXPECT_TRUE(data->cached);
+    return tree;
+  }
+
+  void tree_build(BVHTreeFromMesh *data, const BVHCacheType type)
+  {
+    if (type == BVHTREE_FROM_VERTS) {
+      bvhtree_from_mesh_verts_ex(
+          data, mesh->mvert, mesh->totvert, false, nullptr, -1, 0.0f, 2, 6, type, nullptr, nullptr);
+      return;
+    }
+
+    const MLoopTri *looptri = BKE_mesh_runtime_looptri_ensure(mesh);
+    const int looptri_len = BKE_mesh_runtime_looptri_len(mesh);
+    BLI_bitmap *looptri_mask = nullptr;
+    int looptri_mask_len = -1;
+    if (type == BVHTREE_FROM_LOOPTRI_NO_HIDDEN) {
+      looptri_mask = BLI_BITMAP_NEW(looptri_len, __func__);
+      looptri_mask_len = 0;
+      for (int i = 0; i < looptri_len; i++) {
+        if (!(mesh->mpoly[looptri[i].poly].flag & ME_HIDE)) {
+          BLI_BITMAP_ENABLE(looptri_mask, i);
+          looptri_mask_len++;
+        }
+      }
+    }
+    bvhtree_from_mesh_looptri_ex(data,
+                                 mesh->mvert,
+                                 false,
+                                 mesh->mloop,
+                                 false,
+                                 looptri,
+                                 looptri_len,
+                                 false,
+                                 looptri_mask,
+                                 looptri_mask_len,
+                                 0.0f,
+                                 2,
+                                 6,
+                                 type,
+                                 nullptr,
+                                 nullptr);
+    MEM_SAFE_FREE(looptri_mask);
+  }
+
+  /* Queries from above the grid. Nearest elements can be at the same distance, so only their
+   * distance is compared. Rays don't go through vertices or edges. */
+  void expect_queries_match(const BVHCacheType type, const float scale)
+  {
+    BVHTreeFromMesh data, data_ref;
+    tree_get(&data, type);
+    tree_build(&data_ref, type);
+    ASSERT_NE(data.tree, nullptr);
+    ASSERT_NE(data_ref.tree, nullptr);
+
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        const float co[3] = {((float)x + 0.37f) * scale, ((float)y + 0.61f) * scale, 0.83f};
+
+        BVHTreeNearest nearest, nearest_ref;
+        nearest.index = nearest_ref.index = -1;
+        nearest.dist_sq = nearest_ref.dist_sq = FLT_MAX;
+        BLI_bvhtree_find_nearest(data.tree, co, &nearest, data.nearest_callback, &data);
+        BLI_bvhtree_find_nearest(
+            data_ref.tree, co, &nearest_ref, data_ref.nearest_callback, &data_ref);
+        EXPECT_NE(nearest.index, -1);
+        EXPECT_FLOAT_EQ(nearest.dist_sq, nearest_ref.dist_sq);
+
+        const float dir[3] = {0.1f, -0.05f, -1.0f};
+        BVHTreeRayHit hit, hit_ref;
+        hit.index = hit_ref.index = -1;
+        hit.dist = hit_ref.dist = FLT_MAX;
+        BLI_bvhtree_ray_cast(data.tree, co, dir, 0.0f, &hit, data.raycast_callback, &data);
+        BLI_bvhtree_ray_cast(
+            data_ref.tree, co, dir, 0.0f, &hit_ref, data_ref.raycast_callback, &data_ref);
+        EXPECT_EQ(hit.index, hit_ref.index);
+        if (hit_ref.index != -1) {
+          EXPECT_FLOAT_EQ(hit.dist, hit_ref.dist);
+        }
+      }
+    }
+
+    free_bvhtree_from_mesh(&data);
+    free_bvhtree_from_mesh(&data_ref);
+  }
+};
+
+static const BVHCacheType bvh_cache_reuse_test_types[] = {
+    BVHTREE_FROM_VERTS,
+    BVHTREE_FROM_LOOPTRI,
+    BVHTREE_FROM_LOOPTRI_NO_HIDDEN,
+};
+
+TEST_F(BVHCacheReuseTest, RefitSmallDeformation)
+{
+  BVHTreeFromMesh data;
+  for (const BVHCacheType type : bvh_cache_reuse_test_types) {
+    BVHTree *tree = tree_get(&data, type);
+    free_bvhtree_from_mesh(&data);
+
+    deform_and_reuse(1.0f, 0.5f);
+    /* The same tree is refitted. */
+    EXPECT_EQ(tree_get(&data, type), tree);
+    free_bvhtree_from_mesh(&data);
+    expect_queries_match(type, 1.0f);
+  }
+}
+
+/* Refitted trees keep the hierarchy of the first positions, which gets worse with each
+ * deformation. They are built again after some time. */
+TEST_F(BVHCacheReuseTest, ManyRefits)
+{
+  BVHTreeFromMesh data;
+  for (int step = 0; step < 100; step++) {
+    for (const BVHCacheType type : bvh_cache_reuse_test_types) {
+      tree_get(&data, type);
+      free_bvhtree_from_mesh(&data);
+    }
+    deform_and_reuse(1.0f, (float)step * 0.3f);
+  }
+  for (const BVHCacheType type : bvh_cache_reuse_test_types) {
+    expect_queries_match(type, 1.0f);
+  }
+}
+
+/* Trees are built again when the mesh grows too much. */
+TEST_F(BVHCacheReuseTest, LargeDeformation)
+{
+  BVHTreeFromMesh data;
+  for (const BVHCacheType type : bvh_cache_reuse_test_types) {
+    tree_get(&data, type);
+    free_bvhtree_from_mesh(&data);
+  }
+
+  deform_and_reuse(4.0f, 1.0f);
+  for (const BVHCacheType type : bvh_cache_reuse_test_types) {
+    expect_queries_match(type, 4.0f);
+  }
+
+  /* Shrinking back is refitted. */
+  deform_and_reuse(1.0f, 2.0f);
+  for (const BVHCacheType type : bvh_cache_reuse_test_types) {
+    expect_queries_match(type, 1.0f);
+  }
+}
+
+}  // namespace blender::bke::tests
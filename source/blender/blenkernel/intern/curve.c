@@ -27,6 +27,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
 #include "BLI_ghash.h"
@@ -81,13 +83,22 @@ static void curve_init_data(ID *id)
   MEMCPY_STRUCT_AFTER(curve, DNA_struct_default_get(Curve), id);
 }
 
+static Nurb *nurb_duplicate_ex(Nurb *nu, const bool use_share);
+
 static void curve_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const int flag)
 {
   Curve *curve_dst = (Curve *)id_dst;
   const Curve *curve_src = (const Curve *)id_src;
 
   BLI_listbase_clear(&curve_dst->nurb);
-  BKE_nurbList_duplicate(&(curve_dst->nurb), &(curve_src->nurb));
+  if (flag & LIB_ID_COPY_CD_SHARE) {
+    LISTBASE_FOREACH (Nurb *, nu, &curve_src->nurb) {
+      BLI_addtail(&curve_dst->nurb, nurb_duplicate_ex(nu, true));
+    }
+  }
+  else {
+    BKE_nurbList_duplicate(&(curve_dst->nurb), &(curve_src->nurb));
+  }
 
   curve_dst->mat = MEM_dupallocN(curve_src->mat);
 
@@ -251,6 +262,7 @@ static void curve_blend_read_data(BlendDataReader *reader, ID *id)
     BLO_read_data_address(reader, &nu->bp);
     BLO_read_data_address(reader, &nu->knotsu);
     BLO_read_data_address(reader, &nu->knotsv);
+    nu->sharing = NULL;
     if (cu->vfont == NULL) {
       nu->charidx = 0;
     }
@@ -270,9 +282,7 @@ static void curve_blend_read_data(BlendDataReader *reader, ID *id)
 static void curve_blend_read_lib(BlendLibReader *reader, ID *id)
 {
   Curve *cu = (Curve *)id;
-  for (int a = 0; a < cu->totcol; a++) {
-    BLO_read_id_address(reader, cu->id.lib, &cu->mat[a]);
-  }
+  BLO_read_id_address_array(reader, cu->id.lib, cu->mat, cu->totcol);
 
   BLO_read_id_address(reader, cu->id.lib, &cu->bevobj);
   BLO_read_id_address(reader, cu->id.lib, &cu->taperobj);
@@ -625,6 +635,85 @@ int BKE_nurbList_verts_count_without_handles(ListBase *nurb)
   return tot;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Nurb Points
+ *
+ * Evaluated copies of curves share the points of the original nurbs (see #LIB_ID_COPY_CD_SHARE),
+ * the last nurb using the points frees them. Code writing to the points of nurbs in place or
+ * reallocating them has to unshare them first with #BKE_nurb_ensure_unshared.
+ * \{ */
+
+typedef struct NurbSharing {
+  int users;
+  /** Either #Nurb.bezt or #Nurb.bp. */
+  void *points;
+} NurbSharing;
+
+static void nurb_points_share(Nurb *nu_src, Nurb *nu_dst)
+{
+  NurbSharing *sharing = nu_src->sharing;
+  if (sharing == NULL) {
+    NurbSharing *new_sharing = MEM_mallocN(sizeof(*new_sharing), __func__);
+    new_sharing->users = 1;
+    new_sharing->points = nu_src->bezt ? (void *)nu_src->bezt : (void *)nu_src->bp;
+    /* Different dependency graphs might share the same original curve. */
+    sharing = atomic_cas_ptr((void **)&nu_src->sharing, NULL, new_sharing);
+    if (sharing == NULL) {
+      sharing = new_sharing;
+    }
+    else {
+      MEM_freeN(new_sharing);
+    }
+  }
+  atomic_add_and_fetch_int32(&sharing->users, 1);
+  nu_dst->bezt = nu_src->bezt;
+  nu_dst->bp = nu_src->bp;
+  nu_dst->sharing = sharing;
+}
+
+/* Stop using the shared points, they are freed when this was their last user. */
+static void nurb_points_sharing_release(Nurb *nu)
+{
+  NurbSharing *sharing = nu->sharing;
+  nu->sharing = NULL;
+  nu->bezt = NULL;
+  nu->bp = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    MEM_freeN(sharing->points);
+    MEM_freeN(sharing);
+  }
+}
+
+/** Make the nurb the only owner of its points, copying them if other nurbs still use them. */
+void BKE_nurb_ensure_unshared(Nurb *nu)
+{
+  NurbSharing *sharing = nu->sharing;
+  if (sharing == NULL) {
+    return;
+  }
+  nu->sharing = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    /* Nobody else uses the points anymore, take them over. */
+    MEM_freeN(sharing);
+    return;
+  }
+  if (nu->bezt) {
+    nu->bezt = MEM_dupallocN(nu->bezt);
+  }
+  else if (nu->bp) {
+    nu->bp = MEM_dupallocN(nu->bp);
+  }
+}
+
+void BKE_nurbList_ensure_unshared(ListBase *lb)
+{
+  LISTBASE_FOREACH (Nurb *, nu, lb) {
+    BKE_nurb_ensure_unshared(nu);
+  }
+}
+
+/** \} */
+
 /* **************** NURBS ROUTINES ******************** */
 
 void BKE_nurb_free(Nurb *nu)
@@ -633,6 +722,9 @@ void BKE_nurb_free(Nurb *nu)
     return;
   }
 
+  if (nu->sharing) {
+    nurb_points_sharing_release(nu);
+  }
   if (nu->bezt) {
     MEM_freeN(nu->bezt);
   }
@@ -666,7 +758,11 @@ void BKE_nurbList_free(ListBase *lb)
   BLI_listbase_clear(lb);
 }
 
-Nurb *BKE_nurb_duplicate(const Nurb *nu)
+/**
+ * \param use_share: Share the points with \a nu instead of copying them,
+ * see #BKE_nurb_ensure_unshared.
+ */
+static Nurb *nurb_duplicate_ex(Nurb *nu, const bool use_share)
 {
   Nurb *newnu;
   int len;
@@ -676,8 +772,12 @@ Nurb *BKE_nurb_duplicate(const Nurb *nu)
     return NULL;
   }
   memcpy(newnu, nu, sizeof(Nurb));
+  newnu->sharing = NULL;
 
-  if (nu->bezt) {
+  if (use_share && (nu->bezt || nu->bp)) {
+    nurb_points_share(nu, newnu);
+  }
+  else if (nu->bezt) {
     newnu->bezt = (BezTriple *)MEM_malloc_arrayN(nu->pntsu, sizeof(BezTriple), "duplicateNurb2");
     memcpy(newnu->bezt, nu->bezt, nu->pntsu * sizeof(BezTriple));
   }
@@ -685,7 +785,9 @@ Nurb *BKE_nurb_duplicate(const Nurb *nu)
     len = nu->pntsu * nu->pntsv;
     newnu->bp = (BPoint *)MEM_malloc_arrayN(len, sizeof(BPoint), "duplicateNurb3");
     memcpy(newnu->bp, nu->bp, len * sizeof(BPoint));
+  }
 
+  if (nu->bezt == NULL) {
     newnu->knotsu = newnu->knotsv = NULL;
 
     if (nu->knotsu) {
@@ -706,11 +808,17 @@ Nurb *BKE_nurb_duplicate(const Nurb *nu)
   return newnu;
 }
 
+Nurb *BKE_nurb_duplicate(const Nurb *nu)
+{
+  return nurb_duplicate_ex((Nurb *)nu, false);
+}
+
 /* copy the nurb but allow for different number of points (to be copied after this) */
 Nurb *BKE_nurb_copy(Nurb *src, int pntsu, int pntsv)
 {
   Nurb *newnu = (Nurb *)MEM_mallocN(sizeof(Nurb), "copyNurb");
   memcpy(newnu, src, sizeof(Nurb));
+  newnu->sharing = NULL;
 
   if (pntsu == 1) {
     SWAP(int, pntsu, pntsv);
@@ -751,6 +859,7 @@ void BKE_nurb_test_2d(Nurb *nu)
   if ((nu->flag & CU_2D) == 0) {
     return;
   }
+  BKE_nurb_ensure_unshared(nu);
 
   if (nu->type == CU_BEZIER) {
     a = nu->pntsu;
@@ -932,6 +1041,7 @@ float BKE_nurb_calc_length(const Nurb *nu, int resolution)
 /* be sure to call makeknots after this */
 void BKE_nurb_points_add(Nurb *nu, int number)
 {
+  BKE_nurb_ensure_unshared(nu);
   nu->bp = MEM_recallocN(nu->bp, (nu->pntsu + number) * sizeof(BPoint));
 
   BPoint *bp;
@@ -948,6 +1058,7 @@ void BKE_nurb_bezierPoints_add(Nurb *nu, int number)
   BezTriple *bezt;
   int i;
 
+  BKE_nurb_ensure_unshared(nu);
   nu->bezt = MEM_recallocN(nu->bezt, (nu->pntsu + number) * sizeof(BezTriple));
 
   for (i = 0, bezt = &nu->bezt[nu->pntsu]; i < number; i++, bezt++) {
@@ -3441,6 +3552,7 @@ static void calchandlesNurb_intern(Nurb *nu, eBezTriple_Flag handle_sel_flag, bo
   if (nu->pntsu < 2) {
     return;
   }
+  BKE_nurb_ensure_unshared(nu);
 
   a = nu->pntsu;
   bezt = nu->bezt;
@@ -4207,6 +4319,7 @@ void BKE_nurb_handles_test(Nurb *nu, const bool use_handle, const bool use_aroun
   if (nu->type != CU_BEZIER) {
     return;
   }
+  BKE_nurb_ensure_unshared(nu);
 
   bezt = nu->bezt;
   a = nu->pntsu;
@@ -4227,6 +4340,7 @@ void BKE_nurb_handles_autocalc(Nurb *nu, uint8_t flag)
   if (nu == NULL || nu->bezt == NULL) {
     return;
   }
+  BKE_nurb_ensure_unshared(nu);
 
   BezTriple *bezt2 = nu->bezt;
   BezTriple *bezt1 = bezt2 + (nu->pntsu - 1);
@@ -4533,6 +4647,7 @@ void BKE_nurb_direction_switch(Nurb *nu)
   if (nu->pntsu == 1 && nu->pntsv == 1) {
     return;
   }
+  BKE_nurb_ensure_unshared(nu);
 
   if (nu->type == CU_BEZIER) {
     a = nu->pntsu;
@@ -4690,6 +4805,7 @@ void BKE_curve_nurbs_vert_coords_apply_with_mat4(ListBase *lb,
   const float *co = vert_coords[0];
 
   LISTBASE_FOREACH (Nurb *, nu, lb) {
+    BKE_nurb_ensure_unshared(nu);
     if (nu->type == CU_BEZIER) {
       BezTriple *bezt = nu->bezt;
 
@@ -4728,6 +4844,7 @@ void BKE_curve_nurbs_vert_coords_apply(ListBase *lb,
   const float *co = vert_coords[0];
 
   LISTBASE_FOREACH (Nurb *, nu, lb) {
+    BKE_nurb_ensure_unshared(nu);
     if (nu->type == CU_BEZIER) {
       BezTriple *bezt = nu->bezt;
 
@@ -4796,6 +4913,7 @@ float (*BKE_curve_nurbs_key_vert_coords_alloc(ListBase *lb, float *key, int *r_v
 void BKE_curve_nurbs_key_vert_tilts_apply(ListBase *lb, const float *key)
 {
   LISTBASE_FOREACH (Nurb *, nu, lb) {
+    BKE_nurb_ensure_unshared(nu);
     if (nu->type == CU_BEZIER) {
       BezTriple *bezt = nu->bezt;
 
@@ -4924,6 +5042,8 @@ bool BKE_nurb_type_convert(Nurb *nu,
   BPoint *bp;
   int a, c, nr;
 
+  BKE_nurb_ensure_unshared(nu);
+
   if (nu->type == CU_POLY) {
     if (type == CU_BEZIER) { /* to Bezier with vecthandles  */
       nr = nu->pntsu;
@@ -5267,6 +5387,7 @@ void BKE_curve_transform_ex(Curve *cu,
   int i;
 
   LISTBASE_FOREACH (Nurb *, nu, &cu->nurb) {
+    BKE_nurb_ensure_unshared(nu);
     if (nu->type == CU_BEZIER) {
       i = nu->pntsu;
       for (bezt = nu->bezt; i--; bezt++) {
@@ -5292,7 +5413,7 @@ void BKE_curve_transform_ex(Curve *cu,
 
   if (do_keys && cu->key) {
     LISTBASE_FOREACH (KeyBlock *, kb, &cu->key->block) {
-      float *fp = kb->data;
+      float *fp = BKE_keyblock_data_ensure_unshared(cu->key, kb);
       int n = kb->totelem;
 
       LISTBASE_FOREACH (Nurb *, nu, &cu->nurb) {
@@ -5332,6 +5453,7 @@ void BKE_curve_translate(Curve *cu, const float offset[3], const bool do_keys)
   ListBase *nurb_lb = BKE_curve_nurbs_get(cu);
 
   LISTBASE_FOREACH (Nurb *, nu, nurb_lb) {
+    BKE_nurb_ensure_unshared(nu);
     if (nu->type == CU_BEZIER) {
       int i = nu->pntsu;
       for (BezTriple *bezt = nu->bezt; i--; bezt++) {
@@ -5350,7 +5472,7 @@ void BKE_curve_translate(Curve *cu, const float offset[3], const bool do_keys)
 
   if (do_keys && cu->key) {
     LISTBASE_FOREACH (KeyBlock *, kb, &cu->key->block) {
-      float *fp = kb->data;
+      float *fp = BKE_keyblock_data_ensure_unshared(cu->key, kb);
       int n = kb->totelem;
 
       LISTBASE_FOREACH (Nurb *, nu, &cu->nurb) {
@@ -0,0 +1,156 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_curve_types.h"
+
+#include "BLI_listbase.h"
+
+#include "BKE_curve.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+
+namespace blender::bke::tests {
+
+/* Copies of curves can share the points of the nurbs, writing to either side has to copy them. */
+class CurveShareTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+ protected:
+  static constexpr int points_len = 16;
+  Curve *curve;
+
+  Nurb *nurb_add(const short type)
+  {
+    Nurb *nu = (Nurb *)MEM_callocN(sizeof(Nurb), __func__);
+    nu->type = type;
+    nu->pntsu = points_len;
+    nu->pntsv = 1;
+    if (type == CU_BEZIER) {
+      nu->bezt = (BezTriple *)MEM_calloc_arrayN(points_len, sizeof(BezTriple), __func__);
+      for (int i = 0; i < points_len; i++) {
+        nu->bezt[i].vec[1][0] = (float)i;
+      }
+    }
+    else {
+      nu->bp = (BPoint *)MEM_calloc_arrayN(points_len, sizeof(BPoint), __func__);
+      for (int i = 0; i < points_len; i++) {
+        nu->bp[i].vec[0] = (float)i;
+      }
+    }
+    BLI_addtail(&curve->nurb, nu);
+    return nu;
+  }
+
+  void SetUp() override
+  {
+    curve = (Curve *)BKE_id_new_nomain(ID_CU, nullptr);
+    nurb_add(CU_BEZIER);
+    nurb_add(CU_POLY);
+  }
+
+  void TearDown() override
+  {
+    if (curve) {
+      BKE_id_free(nullptr, curve);
+    }
+  }
+
+  Curve *curve_copy(const int flag)
+  {
+    return (Curve *)BKE_id_copy_ex(nullptr,
+                                   &curve->id,
+                                   nullptr,
+                                   LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT | flag);
+  }
+};
+
+TEST_F(CurveShareTest, Copy)
+{
+  Curve *curve_share = curve_copy(LIB_ID_COPY_CD_SHARE);
+  Curve *curve_dense = curve_copy(0);
+
+  const Nurb *nu_bezt = (const Nurb *)curve->nurb.first;
+  const Nurb *nu_bp = nu_bezt->next;
+  const Nurb *nu_bezt_share = (const Nurb *)curve_share->nurb.first;
+  const Nurb *nu_bp_share = nu_bezt_share->next;
+  EXPECT_EQ(nu_bezt_share->bezt, nu_bezt->bezt);
+  EXPECT_EQ(nu_bp_share->bp, nu_bp->bp);
+
+  /* Copies without the flag and copies of the shared nurbs have their own points. */
+  const Nurb *nu_bezt_dense = (const Nurb *)curve_dense->nurb.first;
+  EXPECT_NE(nu_bezt_dense->bezt, nu_bezt->bezt);
+  EXPECT_EQ(nu_bezt_dense->sharing, nullptr);
+  Nurb *nu_dup = BKE_nurb_duplicate(nu_bezt_share);
+  EXPECT_NE(nu_dup->bezt, nu_bezt->bezt);
+  EXPECT_EQ(nu_dup->sharing, nullptr);
+  BKE_nurb_free(nu_dup);
+
+  BKE_id_free(nullptr, curve_dense);
+  BKE_id_free(nullptr, curve_share);
+}
+
+TEST_F(CurveShareTest, Write)
+{
+  Curve *curve_share = curve_copy(LIB_ID_COPY_CD_SHARE);
+  Nurb *nu_bezt = (Nurb *)curve->nurb.first;
+  Nurb *nu_bp = nu_bezt->next;
+  const Nurb *nu_bezt_share = (const Nurb *)curve_share->nurb.first;
+  const Nurb *nu_bp_share = nu_bezt_share->next;
+
+  /* Adding points to the original doesn't change the copy. */
+  BKE_nurb_points_add(nu_bp, 2);
+  EXPECT_NE(nu_bp->bp, nu_bp_share->bp);
+  EXPECT_EQ(nu_bp->pntsu, points_len + 2);
+  EXPECT_EQ(nu_bp_share->pntsu, points_len);
+  EXPECT_EQ(nu_bp_share->bp[points_len - 1].vec[0], (float)(points_len - 1));
+
+  /* Nor does writing to its points. */
+  const float offset[3] = {1.0f, 0.0f, 0.0f};
+  BKE_curve_translate(curve, offset, false);
+  EXPECT_NE(nu_bezt->bezt, nu_bezt_share->bezt);
+  EXPECT_EQ(nu_bezt->bezt[1].vec[1][0], 2.0f);
+  EXPECT_EQ(nu_bezt_share->bezt[1].vec[1][0], 1.0f);
+
+  BKE_id_free(nullptr, curve_share);
+}
+
+TEST_F(CurveShareTest, Free)
+{
+  Curve *curve_share = curve_copy(LIB_ID_COPY_CD_SHARE);
+  Nurb *nu_bezt_share = (Nurb *)curve_share->nurb.first;
+  BezTriple *bezt = nu_bezt_share->bezt;
+
+  /* Freeing the original leaves the points to the copy, which doesn't have to copy them. */
+  BKE_id_free(nullptr, curve);
+  curve = nullptr;
+  EXPECT_EQ(nu_bezt_share->bezt[1].vec[1][0], 1.0f);
+  BKE_nurb_ensure_unshared(nu_bezt_share);
+  EXPECT_EQ(nu_bezt_share->bezt, bezt);
+  EXPECT_EQ(nu_bezt_share->sharing, nullptr);
+
+  BKE_id_free(nullptr, curve_share);
+}
+
+}  // namespace blender::bke::tests
@@ -26,6 +26,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* Since we have versioning code here (CustomData_verify_versions()). */
 #define DNA_DEPRECATED_ALLOW
 
@@ -2073,6 +2075,92 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 }
 #endif
 
+/* Shared ownership of layer data, see CD_SHARE. */
+typedef struct CustomDataLayerSharing {
+  int users;
+  void *data;
+} CustomDataLayerSharing;
+
+static void customData_layer_share(CustomDataLayer *source_layer, CustomDataLayer *dest_layer)
+{
+  CustomDataLayerSharing *sharing = source_layer->sharing;
+  if (sharing == NULL) {
+    CustomDataLayerSharing *new_sharing = MEM_mallocN(sizeof(*new_sharing), __func__);
+    new_sharing->users = 1;
+    new_sharing->data = source_layer->data;
+    /* Different dependency graphs might share the same original layer. */
+    sharing = atomic_cas_ptr((void **)&source_layer->sharing, NULL, new_sharing);
+    if (sharing == NULL) {
+      sharing = new_sharing;
+    }
+    else {
+      MEM_freeN(new_sharing);
+    }
+  }
+  atomic_add_and_fetch_int32(&sharing->users, 1);
+  dest_layer->sharing = sharing;
+}
+
+/* Stop using shared data of the layer, the data is freed when this was its last user. */
+static void customData_layer_sharing_release(CustomDataLayer *layer, const int totelem)
+{
+  CustomDataLayerSharing *sharing = layer->sharing;
+  layer->sharing = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) != 0) {
+    return;
+  }
+  if (sharing->data != NULL) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+    if (typeInfo->free) {
+      typeInfo->free(sharing->data, totelem, typeInfo->size);
+    }
+    MEM_freeN(sharing->data);
+  }
+  MEM_freeN(sharing);
+}
+
+/* Stop sharing the layer data without freeing it: the caller is about to replace the data, and
+ * takes care of the current data unless other layers still use it. */
+static void customData_layer_sharing_clear(CustomDataLayer *layer)
+{
+  CustomDataLayerSharing *sharing = layer->sharing;
+  if (sharing == NULL) {
+    return;
+  }
+  layer->sharing = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    MEM_freeN(sharing);
+  }
+}
+
+/* Make the layer the only owner of its data, copying the data if other layers still use it. */
+static void customData_layer_ensure_unshared(CustomDataLayer *layer, const int totelem)
+{
+  CustomDataLayerSharing *sharing = layer->sharing;
+  if (sharing == NULL) {
+    return;
+  }
+  layer->sharing = NULL;
+  layer->flag &= ~CD_FLAG_NOFREE;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    /* Nobody else uses the data anymore, take it over. */
+    MEM_freeN(sharing);
+    return;
+  }
+  if (layer->data != NULL) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+    void *data = MEM_malloc_arrayN(
+        (size_t)totelem, typeInfo->size, layerType_getName(layer->type));
+    if (typeInfo->copy) {
+      typeInfo->copy(layer->data, data, totelem);
+    }
+    else {
+      memcpy(data, layer->data, (size_t)totelem * typeInfo->size);
+    }
+    layer->data = data;
+  }
+}
+
 bool CustomData_merge(const struct CustomData *source,
                       struct CustomData *dest,
                       CustomDataMask mask,
@@ -2124,6 +2212,7 @@ bool CustomData_merge(const struct CustomData *source,
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -2135,8 +2224,22 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if (alloctype == CD_SHARE) {
+      /* Only data owned by the source can be shared, its lifetime is unknown otherwise. */
+      const bool use_share = (data != NULL) && (!(flag & CD_FLAG_NOFREE) || layer->sharing);
+      newlayer = customData_add_layer__internal(
+          dest, type, use_share ? CD_REFERENCE : CD_DUPLICATE, data, totelem, layer->name);
+      if (use_share && newlayer && newlayer->data == data && newlayer->sharing == NULL) {
+        customData_layer_share(layer, newlayer);
+      }
+    }
     else {
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
+      /* References to shared data keep it alive, and have to be unshared before writing to it. */
+      if (alloctype == CD_REFERENCE && layer->sharing && newlayer && newlayer->data == data &&
+          newlayer->sharing == NULL) {
+        customData_layer_share(layer, newlayer);
+      }
     }
 
     if (newlayer) {
@@ -2165,6 +2268,9 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (layer->sharing) {
+      customData_layer_ensure_unshared(layer, MEM_allocN_len(layer->data) / typeInfo->size);
+    }
     layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
   }
 }
@@ -2188,6 +2294,11 @@ static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
   const LayerTypeInfo *typeInfo;
 
+  if (layer->sharing) {
+    customData_layer_sharing_release(layer, totelem);
+    return;
+  }
+
   if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
     typeInfo = layerType_getInfo(layer->type);
 
@@ -2563,6 +2674,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  data->layers[index].sharing = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2744,7 +2856,10 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
 
   CustomDataLayer *layer = &data->layers[layer_index];
 
-  if (layer->flag & CD_FLAG_NOFREE) {
+  if (layer->sharing) {
+    customData_layer_ensure_unshared(layer, totelem);
+  }
+  else if (layer->flag & CD_FLAG_NOFREE) {
     /* MEM_dupallocN won't work in case of complex layers, like e.g.
      * CD_MDEFORMVERT, which has pointers to allocated data...
      * So in case a custom copy function is defined, use it!
@@ -2810,6 +2925,31 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
   return (layer->flag & CD_FLAG_NOFREE) != 0;
 }
 
+bool CustomData_is_shared_layer(const CustomData *data, int type)
+{
+  /* get the layer index of the first layer of type */
+  int layer_index = CustomData_get_active_layer_index(data, type);
+  if (layer_index == -1) {
+    return false;
+  }
+
+  return data->layers[layer_index].sharing != NULL;
+}
+
+bool CustomData_ensure_unshared_layers(CustomData *data, const int totelem)
+{
+  bool changed = false;
+
+  for (int i = 0; i < data->totlayer; i++) {
+    CustomDataLayer *layer = &data->layers[i];
+    const void *data_prev = layer->data;
+    customData_layer_ensure_unshared(layer, totelem);
+    changed |= (layer->data != data_prev);
+  }
+
+  return changed;
+}
+
 void CustomData_free_temporary(CustomData *data, int totelem)
 {
   CustomDataLayer *layer;
@@ -2953,6 +3093,108 @@ void CustomData_copy_data(
   }
 }
 
+/**
+ * Gather \a count elements of \a size bytes, called with constant sizes so the copy of every
+ * element compiles to a few moves instead of a call to `memcpy`.
+ */
+BLI_INLINE void customdata_gather_elements(void *dst_data,
+                                           const void *src_data,
+                                           const int *src_indices,
+                                           const int count,
+                                           const size_t size)
+{
+  for (int i = 0; i < count; i++) {
+    memcpy(POINTER_OFFSET(dst_data, (size_t)i * size),
+           POINTER_OFFSET(src_data, (size_t)src_indices[i] * size),
+           size);
+  }
+}
+
+static void CustomData_copy_data_layer_indices(const CustomData *source,
+                                               CustomData *dest,
+                                               int src_i,
+                                               int dst_i,
+                                               const int *src_indices,
+                                               int dest_index,
+                                               int count)
+{
+  const void *src_data = source->layers[src_i].data;
+  void *dst_data = dest->layers[dst_i].data;
+
+  const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+
+  if (!src_data || !dst_data) {
+    if (!(src_data == NULL && dst_data == NULL)) {
+      CLOG_WARN(&LOG,
+                "null data for %s type (%p --> %p), skipping",
+                layerType_getName(source->layers[src_i].type),
+                (void *)src_data,
+                (void *)dst_data);
+    }
+    return;
+  }
+
+  const size_t size = (size_t)typeInfo->size;
+  dst_data = POINTER_OFFSET(dst_data, (size_t)dest_index * size);
+
+  if (typeInfo->copy) {
+    for (int i = 0; i < count; i++) {
+      typeInfo->copy(POINTER_OFFSET(src_data, (size_t)src_indices[i] * size),
+                     POINTER_OFFSET(dst_data, (size_t)i * size),
+                     1);
+    }
+    return;
+  }
+
+  /* Sizes of the most common layers (ints, floats, edges & loops, vectors, polys & colors). */
+  switch (size) {
+    case 4:
+      customdata_gather_elements(dst_data, src_data, src_indices, count, 4);
+      break;
+    case 8:
+      customdata_gather_elements(dst_data, src_data, src_indices, count, 8);
+      break;
+    case 12:
+      customdata_gather_elements(dst_data, src_data, src_indices, count, 12);
+      break;
+    case 16:
+      customdata_gather_elements(dst_data, src_data, src_indices, count, 16);
+      break;
+    default:
+      customdata_gather_elements(dst_data, src_data, src_indices, count, size);
+      break;
+  }
+}
+
+void CustomData_copy_data_indices(const CustomData *source,
+                                  CustomData *dest,
+                                  const int *src_indices,
+                                  int dest_index,
+                                  int count)
+{
+  if (count <= 0) {
+    return;
+  }
+
+  /* copies a layer at a time, see #CustomData_copy_data */
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+
+    if (dest_i >= dest->totlayer) {
+      return;
+    }
+
+    if (dest->layers[dest_i].type == source->layers[src_i].type) {
+      CustomData_copy_data_layer_indices(
+          source, dest, src_i, dest_i, src_indices, dest_index, count);
+      dest_i++;
+    }
+  }
+}
+
 void CustomData_copy_layer_type_data(const CustomData *source,
                                      CustomData *destination,
                                      int type,
@@ -3088,6 +3330,150 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+/**
+ * Number of floats of layers which interpolate as a plain weighted sum of their values,
+ * zero for all other layers.
+ */
+static int customdata_interp_float_len(const LayerTypeInfo *typeInfo)
+{
+  if (typeInfo->interp == layerInterp_bweight) {
+    return 1;
+  }
+  if (typeInfo->interp == layerInterp_propfloat2) {
+    return 2;
+  }
+  if (ELEM(typeInfo->interp, layerInterp_shapekey, layerInterp_propfloat3)) {
+    return 3;
+  }
+  return 0;
+}
+
+/**
+ * Weighted sums of float layers, matching the layer's own interpolation callback.
+ * Called with a constant \a float_len so the inner loop is unrolled.
+ */
+BLI_INLINE void customdata_interp_float_elements(const float *src_data,
+                                                 float *dst_data,
+                                                 const int *src_indices,
+                                                 const float *weights,
+                                                 const int weights_stride,
+                                                 const int src_count,
+                                                 const int count,
+                                                 const int float_len)
+{
+  for (int i = 0; i < count; i++, src_indices += src_count, weights += weights_stride) {
+    float result[3] = {0.0f, 0.0f, 0.0f};
+    for (int j = 0; j < src_count; j++) {
+      const float *src = &src_data[(size_t)src_indices[j] * (size_t)float_len];
+      for (int k = 0; k < float_len; k++) {
+        result[k] += src[k] * weights[j];
+      }
+    }
+    for (int k = 0; k < float_len; k++) {
+      dst_data[(size_t)i * (size_t)float_len + (size_t)k] = result[k];
+    }
+  }
+}
+
+void CustomData_interp_indices(const CustomData *source,
+                               CustomData *dest,
+                               const int *src_indices,
+                               const float *weights,
+                               int src_count,
+                               int dest_index,
+                               int count)
+{
+  if (src_count <= 0 || count <= 0) {
+    return;
+  }
+
+  const void *source_buf[SOURCE_BUF_SIZE];
+  const void **sources = source_buf;
+  if (src_count > SOURCE_BUF_SIZE) {
+    sources = MEM_malloc_arrayN(src_count, sizeof(*sources), __func__);
+  }
+
+  /* Without weights, the same averaging weights are used for all dest elements. */
+  float default_weights_buf[SOURCE_BUF_SIZE];
+  float *default_weights = NULL;
+  int weights_stride = src_count;
+  if (weights == NULL) {
+    default_weights = (src_count > SOURCE_BUF_SIZE) ?
+                          MEM_mallocN(sizeof(*weights) * (size_t)src_count, __func__) :
+                          default_weights_buf;
+    copy_vn_fl(default_weights, src_count, 1.0f / src_count);
+    weights = default_weights;
+    weights_stride = 0;
+  }
+
+  /* interpolates a layer at a time, see #CustomData_interp */
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+
+    if (dest->layers[dest_i].type != source->layers[src_i].type) {
+      continue;
+    }
+
+    const void *src_data = source->layers[src_i].data;
+    void *dst_data = POINTER_OFFSET(dest->layers[dest_i].data,
+                                    (size_t)dest_index * typeInfo->size);
+
+    switch (customdata_interp_float_len(typeInfo)) {
+      case 1:
+        customdata_interp_float_elements(
+            src_data, dst_data, src_indices, weights, weights_stride, src_count, count, 1);
+        break;
+      case 2:
+        customdata_interp_float_elements(
+            src_data, dst_data, src_indices, weights, weights_stride, src_count, count, 2);
+        break;
+      case 3:
+        customdata_interp_float_elements(
+            src_data, dst_data, src_indices, weights, weights_stride, src_count, count, 3);
+        break;
+      default: {
+        const int *elem_src_indices = src_indices;
+        const float *elem_weights = weights;
+        for (int i = 0; i < count; i++) {
+          for (int j = 0; j < src_count; j++) {
+            sources[j] = POINTER_OFFSET(src_data,
+                                        (size_t)elem_src_indices[j] * typeInfo->size);
+          }
+          typeInfo->interp(sources,
+                           elem_weights,
+                           NULL,
+                           src_count,
+                           POINTER_OFFSET(dst_data, (size_t)i * typeInfo->size));
+          elem_src_indices += src_count;
+          elem_weights += weights_stride;
+        }
+        break;
+      }
+    }
+
+    dest_i++;
+  }
+
+  if (src_count > SOURCE_BUF_SIZE) {
+    MEM_freeN((void *)sources);
+  }
+  if (!ELEM(default_weights, NULL, default_weights_buf)) {
+    MEM_freeN(default_weights);
+  }
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data
@@ -3200,6 +3586,45 @@ void *CustomData_get_layer_named(const struct CustomData *data, int type, const
   return data->layers[layer_index].data;
 }
 
+static void *customData_get_layer_index_for_write(CustomData *data,
+                                                  const int layer_index,
+                                                  const int totelem)
+{
+  if (layer_index == -1) {
+    return NULL;
+  }
+
+  CustomDataLayer *layer = &data->layers[layer_index];
+  customData_layer_ensure_unshared(layer, totelem);
+
+  return layer->data;
+}
+
+void *CustomData_get_layer_for_write(CustomData *data, int type, int totelem)
+{
+  /* get the layer index of the active layer of type */
+  int layer_index = CustomData_get_active_layer_index(data, type);
+
+  return customData_get_layer_index_for_write(data, layer_index, totelem);
+}
+
+void *CustomData_get_layer_n_for_write(CustomData *data, int type, int n, int totelem)
+{
+  int layer_index = CustomData_get_layer_index_n(data, type, n);
+
+  return customData_get_layer_index_for_write(data, layer_index, totelem);
+}
+
+void *CustomData_get_layer_named_for_write(CustomData *data,
+                                           int type,
+                                           const char *name,
+                                           int totelem)
+{
+  int layer_index = CustomData_get_named_layer_index(data, type, name);
+
+  return customData_get_layer_index_for_write(data, layer_index, totelem);
+}
+
 int CustomData_get_offset(const CustomData *data, int type)
 {
   /* get the layer index of the active layer of type */
@@ -3252,6 +3677,7 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return NULL;
   }
 
+  customData_layer_sharing_clear(&data->layers[layer_index]);
   data->layers[layer_index].data = ptr;
 
   return ptr;
@@ -3265,6 +3691,7 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return NULL;
   }
 
+  customData_layer_sharing_clear(&data->layers[layer_index]);
   data->layers[layer_index].data = ptr;
 
   return ptr;
@@ -4245,7 +4672,9 @@ void CustomData_blend_write_prepare(CustomData *data,
         }
         write_layers_size += chunk_size;
       }
-      write_layers[j++] = *layer;
+      write_layers[j] = *layer;
+      /* Sharing is run-time only. */
+      write_layers[j++].sharing = NULL;
     }
   }
   BLI_assert(j == data->totlayer);
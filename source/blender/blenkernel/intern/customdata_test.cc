@@ -0,0 +1,375 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <climits>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_math_vector.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_object_deform.h"
+
+namespace blender::bke::tests {
+
+/* Lifetime of layers shared with #CD_SHARE, all memory is expected to be freed by each test. */
+class CustomDataShareTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+ protected:
+  static const int totelem = 16;
+  CustomData source;
+  CustomData copy;
+  unsigned int blocks_in_use;
+
+  void SetUp() override
+  {
+    blocks_in_use = MEM_get_memory_blocks_in_use();
+    CustomData_reset(&source);
+    CustomData_reset(&copy);
+
+    float *values = (float *)CustomData_add_layer(
+        &source, CD_PROP_FLOAT, CD_CALLOC, nullptr, totelem);
+    for (int i = 0; i < totelem; i++) {
+      values[i] = (float)i;
+    }
+    CustomData_copy(&source, &copy, CD_MASK_PROP_FLOAT, CD_SHARE, totelem);
+  }
+
+  void TearDown() override
+  {
+    EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+  }
+
+  static float *values_get(CustomData *data)
+  {
+    return (float *)CustomData_get_layer(data, CD_PROP_FLOAT);
+  }
+
+  static void expect_values(CustomData *data, const int len)
+  {
+    const float *values = values_get(data);
+    ASSERT_NE(values, nullptr);
+    for (int i = 0; i < len; i++) {
+      EXPECT_EQ(values[i], (float)i);
+    }
+  }
+};
+
+TEST_F(CustomDataShareTest, Share)
+{
+  EXPECT_EQ(values_get(&copy), values_get(&source));
+  EXPECT_TRUE(CustomData_is_shared_layer(&source, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_shared_layer(&copy, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&copy, CD_PROP_FLOAT));
+
+  CustomData_free(&source, totelem);
+  CustomData_free(&copy, totelem);
+}
+
+TEST_F(CustomDataShareTest, FreeSourceFirst)
+{
+  CustomData_free(&source, totelem);
+  expect_values(&copy, totelem);
+  CustomData_free(&copy, totelem);
+}
+
+TEST_F(CustomDataShareTest, FreeCopyFirst)
+{
+  CustomData_free(&copy, totelem);
+  expect_values(&source, totelem);
+  /* The last user takes the data over. */
+  EXPECT_FALSE(CustomData_ensure_unshared_layers(&source, totelem));
+  EXPECT_FALSE(CustomData_is_shared_layer(&source, CD_PROP_FLOAT));
+  CustomData_free(&source, totelem);
+}
+
+TEST_F(CustomDataShareTest, DuplicateReferencedSource)
+{
+  float *values = (float *)CustomData_duplicate_referenced_layer(
+      &source, CD_PROP_FLOAT, totelem);
+  EXPECT_NE(values, values_get(&copy));
+  EXPECT_FALSE(CustomData_is_shared_layer(&source, CD_PROP_FLOAT));
+  values[0] = -1.0f;
+  expect_values(&copy, totelem);
+
+  CustomData_free(&source, totelem);
+  expect_values(&copy, totelem);
+  CustomData_free(&copy, totelem);
+}
+
+TEST_F(CustomDataShareTest, DuplicateReferencedCopy)
+{
+  float *values = (float *)CustomData_duplicate_referenced_layer(&copy, CD_PROP_FLOAT, totelem);
+  EXPECT_NE(values, values_get(&source));
+  EXPECT_FALSE(CustomData_is_shared_layer(&copy, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&copy, CD_PROP_FLOAT));
+  values[0] = -1.0f;
+  expect_values(&source, totelem);
+
+  CustomData_free(&copy, totelem);
+  expect_values(&source, totelem);
+  CustomData_free(&source, totelem);
+}
+
+TEST_F(CustomDataShareTest, Realloc)
+{
+  CustomData_realloc(&source, totelem * 2);
+  EXPECT_NE(values_get(&source), values_get(&copy));
+  EXPECT_FALSE(CustomData_is_shared_layer(&source, CD_PROP_FLOAT));
+  expect_values(&source, totelem);
+  expect_values(&copy, totelem);
+
+  CustomData_free(&copy, totelem);
+  CustomData_free(&source, totelem * 2);
+}
+
+/* A reference to a shared layer keeps its data alive. */
+TEST_F(CustomDataShareTest, ReferenceShared)
+{
+  CustomData reference;
+  CustomData_copy(&copy, &reference, CD_MASK_PROP_FLOAT, CD_REFERENCE, totelem);
+  EXPECT_EQ(values_get(&reference), values_get(&source));
+  EXPECT_TRUE(CustomData_is_shared_layer(&reference, CD_PROP_FLOAT));
+
+  CustomData_free(&source, totelem);
+  CustomData_free(&copy, totelem);
+  expect_values(&reference, totelem);
+
+  /* The last user takes the data over. */
+  const float *values = values_get(&reference);
+  EXPECT_EQ(CustomData_get_layer_for_write(&reference, CD_PROP_FLOAT, totelem), values);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&reference, CD_PROP_FLOAT));
+  CustomData_free(&reference, totelem);
+}
+
+/* Complex layers free their own allocations with the last user. */
+TEST_F(CustomDataShareTest, DeformVert)
+{
+  MDeformVert *dvert = (MDeformVert *)CustomData_add_layer(
+      &source, CD_MDEFORMVERT, CD_CALLOC, nullptr, totelem);
+  for (int i = 0; i < totelem; i++) {
+    dvert[i].dw = (MDeformWeight *)MEM_callocN(sizeof(MDeformWeight), __func__);
+    dvert[i].dw->weight = (float)i;
+    dvert[i].totweight = 1;
+  }
+  CustomData_free(&copy, totelem);
+  CustomData_copy(&source, &copy, CD_MASK_MDEFORMVERT, CD_SHARE, totelem);
+  EXPECT_EQ(CustomData_get_layer(&copy, CD_MDEFORMVERT), dvert);
+
+  MDeformVert *dvert_copy = (MDeformVert *)CustomData_get_layer_for_write(
+      &copy, CD_MDEFORMVERT, totelem);
+  EXPECT_NE(dvert_copy, dvert);
+  EXPECT_NE(dvert_copy[0].dw, dvert[0].dw);
+  EXPECT_EQ(dvert_copy[totelem - 1].dw->weight, (float)(totelem - 1));
+
+  CustomData_free(&source, totelem);
+  CustomData_free(&copy, totelem);
+}
+
+/* Evaluated meshes referencing shared arrays do not write vertex normals into the original. */
+TEST_F(CustomDataShareTest, MeshNormalsOfReference)
+{
+  CustomData_free(&source, totelem);
+  CustomData_free(&copy, totelem);
+
+  Mesh *mesh = BKE_mesh_new_nomain(3, 0, 0, 3, 1);
+  const float cos[3][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+  for (int i = 0; i < 3; i++) {
+    copy_v3_v3(mesh->mvert[i].co, cos[i]);
+    mesh->mloop[i].v = i;
+  }
+  mesh->mpoly[0].totloop = 3;
+
+  Mesh *mesh_cow = (Mesh *)BKE_id_copy_ex(
+      nullptr, &mesh->id, nullptr, LIB_ID_COPY_LOCALIZE | LIB_ID_COPY_CD_SHARE);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+  Mesh *mesh_eval = BKE_mesh_copy_for_eval(mesh_cow, true);
+  EXPECT_EQ(mesh_eval->mvert, mesh->mvert);
+
+  BKE_mesh_calc_normals(mesh_eval);
+  EXPECT_NE(mesh_eval->mvert, mesh->mvert);
+  EXPECT_EQ(mesh_eval->mvert[0].no[2], SHRT_MAX);
+  EXPECT_EQ(mesh->mvert[0].no[2], 0);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+
+  /* Editing the original in place unshares it. */
+  EXPECT_TRUE(BKE_mesh_ensure_unshared_customdata(mesh));
+  EXPECT_NE(mesh_cow->mvert, mesh->mvert);
+  EXPECT_FALSE(BKE_mesh_ensure_unshared_customdata(mesh));
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, mesh_eval);
+  BKE_id_free(nullptr, mesh_cow);
+}
+
+/* Writers only copy the layers they write, the other layers stay shared. */
+TEST_F(CustomDataShareTest, MeshSmoothFlagSet)
+{
+  CustomData_free(&source, totelem);
+  CustomData_free(&copy, totelem);
+
+  Mesh *mesh = BKE_mesh_new_nomain(3, 0, 0, 3, 1);
+  Mesh *mesh_cow = (Mesh *)BKE_id_copy_ex(
+      nullptr, &mesh->id, nullptr, LIB_ID_COPY_LOCALIZE | LIB_ID_COPY_CD_SHARE);
+  EXPECT_EQ(mesh_cow->mpoly, mesh->mpoly);
+
+  BKE_mesh_smooth_flag_set(mesh_cow, true);
+  EXPECT_NE(mesh_cow->mpoly, mesh->mpoly);
+  EXPECT_TRUE(mesh_cow->mpoly[0].flag & ME_SMOOTH);
+  EXPECT_FALSE(mesh->mpoly[0].flag & ME_SMOOTH);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+  EXPECT_EQ(mesh_cow->mloop, mesh->mloop);
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, mesh_cow);
+}
+
+/* Vertex group tools get the weights of the original mesh for editing them in place. */
+TEST_F(CustomDataShareTest, DeformVertArrayGet)
+{
+  CustomData_free(&source, totelem);
+  CustomData_free(&copy, totelem);
+
+  Mesh *mesh = BKE_mesh_new_nomain(totelem, 0, 0, 0, 0);
+  mesh->dvert = (MDeformVert *)CustomData_add_layer(
+      &mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, totelem);
+  Mesh *mesh_cow = (Mesh *)BKE_id_copy_ex(
+      nullptr, &mesh->id, nullptr, LIB_ID_COPY_LOCALIZE | LIB_ID_COPY_CD_SHARE);
+  EXPECT_EQ(mesh_cow->dvert, mesh->dvert);
+
+  MDeformVert *dvert;
+  int dvert_tot;
+  EXPECT_TRUE(BKE_object_defgroup_array_get(&mesh->id, &dvert, &dvert_tot));
+  EXPECT_EQ(dvert_tot, mesh->totvert);
+  EXPECT_EQ(dvert, mesh->dvert);
+  EXPECT_NE(dvert, mesh_cow->dvert);
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, mesh_cow);
+}
+
+/* The bulk functions give the same results as the per-element functions they replace. */
+class CustomDataIndicesTest : public testing::Test {
+ protected:
+  static const int src_len = 8;
+  static const int dst_len = 6;
+  CustomData source;
+  CustomData result;
+  CustomData expected;
+
+  void SetUp() override
+  {
+    CustomData_reset(&source);
+    /* Layers with the float fast path, with generic interpolation and without interpolation. */
+    const int types[] = {CD_PROP_INT32,
+                         CD_SHAPEKEY,
+                         CD_BWEIGHT,
+                         CD_PAINT_MASK,
+                         CD_PROP_COLOR,
+                         CD_PROP_FLOAT3,
+                         CD_PROP_FLOAT2};
+    for (const int type : types) {
+      void *data = CustomData_add_layer(&source, type, CD_CALLOC, nullptr, src_len);
+      const int values_len = src_len * CustomData_sizeof(type) / 4;
+      for (int i = 0; i < values_len; i++) {
+        if (type == CD_PROP_INT32) {
+          ((int *)data)[i] = i * 7 + 1;
+        }
+        else {
+          ((float *)data)[i] = (float)(i * i % 11) * 0.25f;
+        }
+      }
+    }
+    CustomData_copy(&source, &result, CD_MASK_ALL, CD_CALLOC, dst_len);
+    CustomData_copy(&source, &expected, CD_MASK_ALL, CD_CALLOC, dst_len);
+  }
+
+  void TearDown() override
+  {
+    CustomData_free(&source, src_len);
+    CustomData_free(&result, dst_len);
+    CustomData_free(&expected, dst_len);
+  }
+
+  void expect_result_eq()
+  {
+    ASSERT_EQ(result.totlayer, expected.totlayer);
+    for (int i = 0; i < result.totlayer; i++) {
+      const int type = result.layers[i].type;
+      const int size = CustomData_sizeof(type);
+      if (type == CD_PROP_INT32) {
+        EXPECT_EQ(memcmp(result.layers[i].data, expected.layers[i].data, (size_t)(dst_len * size)),
+                  0);
+        continue;
+      }
+      const float *values = (const float *)result.layers[i].data;
+      const float *values_expected = (const float *)expected.layers[i].data;
+      for (int j = 0; j < dst_len * size / (int)sizeof(float); j++) {
+        EXPECT_NEAR(values[j], values_expected[j], 1e-6f) << "layer type " << type;
+      }
+    }
+  }
+};
+
+TEST_F(CustomDataIndicesTest, CopyDataIndices)
+{
+  const int src_indices[4] = {7, 0, 3, 3};
+  CustomData_copy_data_indices(&source, &result, src_indices, 1, 4);
+  for (int i = 0; i < 4; i++) {
+    CustomData_copy_data(&source, &expected, src_indices[i], 1 + i, 1);
+  }
+  expect_result_eq();
+}
+
+TEST_F(CustomDataIndicesTest, InterpIndices)
+{
+  const int src_indices[3][4] = {{0, 1, 2, 3}, {7, 6, 5, 4}, {2, 2, 7, 0}};
+  const float weights[3][4] = {
+      {0.25f, 0.25f, 0.25f, 0.25f}, {1.0f, 0.0f, 0.0f, 0.0f}, {0.1f, 0.2f, 0.3f, 0.4f}};
+  CustomData_interp_indices(&source, &result, &src_indices[0][0], &weights[0][0], 4, 2, 3);
+  for (int i = 0; i < 3; i++) {
+    CustomData_interp(&source, &expected, src_indices[i], weights[i], nullptr, 4, 2 + i);
+  }
+  expect_result_eq();
+}
+
+TEST_F(CustomDataIndicesTest, InterpIndicesAverage)
+{
+  const int src_indices[dst_len][2] = {{0, 1}, {1, 2}, {3, 5}, {7, 7}, {6, 0}, {4, 2}};
+  CustomData_interp_indices(&source, &result, &src_indices[0][0], nullptr, 2, 0, dst_len);
+  for (int i = 0; i < dst_len; i++) {
+    CustomData_interp(&source, &expected, src_indices[i], nullptr, nullptr, 2, i);
+  }
+  expect_result_eq();
+}
+
+}  // namespace blender::bke::tests
@@ -263,9 +263,7 @@ static void greasepencil_blend_read_lib(BlendLibReader *reader, ID *id)
   }
 
   /* materials */
-  for (int a = 0; a < gpd->totcol; a++) {
-    BLO_read_id_address(reader, gpd->id.lib, &gpd->mat[a]);
-  }
+  BLO_read_id_address_array(reader, gpd->id.lib, gpd->mat, gpd->totcol);
 }
 
 static void greasepencil_blend_read_expand(BlendExpander *expander, ID *id)
@@ -161,9 +161,7 @@ static void hair_blend_read_data(BlendDataReader *reader, ID *id)
 static void hair_blend_read_lib(BlendLibReader *reader, ID *id)
 {
   Hair *hair = (Hair *)id;
-  for (int a = 0; a < hair->totcol; a++) {
-    BLO_read_id_address(reader, hair->id.lib, &hair->mat[a]);
-  }
+  BLO_read_id_address_array(reader, hair->id.lib, hair->mat, hair->totcol);
 }
 
 static void hair_blend_read_expand(BlendExpander *expander, ID *id)
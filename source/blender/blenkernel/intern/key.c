@@ -27,10 +27,14 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
+#include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
 #include "BLI_math_vector.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -65,25 +69,297 @@
 
 #include "BLO_read_write.h"
 
+/* -------------------------------------------------------------------- */
+/** \name Sparse Key Blocks
+ *
+ * Corrective shapes usually only move a small part of the mesh. Such key blocks can store
+ * only the elements which differ from their relative key (#KEYBLOCK_SPARSE), which keeps
+ * undo steps small and lets blending visit only these elements.
+ *
+ * Key blocks are stored sparse in undo steps and in evaluated copies of the key, the data of
+ * original keys is always complete, so editing code never has to deal with sparse blocks.
+ * Files always store the full data, older versions can't read sparse blocks.
+ * \{ */
+
+/* Only store differences when less than this part of the elements differ. */
+#define KEYBLOCK_SPARSE_RATIO_MAX 0.25f
+
+static void keyblock_sparse_free(KeyBlock *kb)
+{
+  MEM_SAFE_FREE(kb->sparse_elems);
+  kb->sparse_elems_len = 0;
+  kb->flag &= ~KEYBLOCK_SPARSE;
+}
+
+/**
+ * \return A map of the key blocks used as relative key by other blocks, those always keep
+ * their full data so other blocks can be restored from them.
+ */
+static BLI_bitmap *keyblock_sparse_relative_used_map(const Key *key)
+{
+  const int totkey = BLI_listbase_count(&key->block);
+  BLI_bitmap *relative_used = BLI_BITMAP_NEW(totkey, __func__);
+  int index;
+  LISTBASE_FOREACH_INDEX (const KeyBlock *, kb, &key->block, index) {
+    if (kb->relative != index && kb->relative >= 0 && kb->relative < totkey) {
+      BLI_BITMAP_ENABLE(relative_used, kb->relative);
+    }
+  }
+  return relative_used;
+}
+
+/**
+ * \return The relative key to store the differences of \a kb against,
+ * NULL when \a kb has to keep its full data.
+ */
+static const KeyBlock *keyblock_sparse_relative_get(const Key *key,
+                                                    const KeyBlock *kb,
+                                                    const int index,
+                                                    const BLI_bitmap *relative_used)
+{
+  if (key->type != KEY_RELATIVE || key->elemsize != sizeof(float[3]) || kb == key->refkey ||
+      kb->data == NULL || BLI_BITMAP_TEST(relative_used, index)) {
+    return NULL;
+  }
+  const KeyBlock *refb = BLI_findlink(&key->block, kb->relative);
+  if (refb == NULL || refb == kb || refb->data == NULL || refb->totelem != kb->totelem) {
+    return NULL;
+  }
+  return refb;
+}
+
+/**
+ * Find the elements of \a kb which differ from its relative key \a refb.
+ *
+ * \return False when too many elements differ for sparse storage to be worth it.
+ */
+static bool keyblock_sparse_elems_calc(const KeyBlock *kb,
+                                       const KeyBlock *refb,
+                                       KeyBlockSparseElem **r_elems,
+                                       int *r_elems_len)
+{
+  const float(*co)[3] = kb->data;
+  const float(*co_ref)[3] = refb->data;
+  const int elems_len_max = (int)((float)kb->totelem * KEYBLOCK_SPARSE_RATIO_MAX);
+  int elems_len = 0;
+  /* Compare the bits, so restoring the full data gives back exactly the same values. */
+  for (int i = 0; i < kb->totelem; i++) {
+    if (memcmp(co[i], co_ref[i], sizeof(float[3])) != 0) {
+      if (++elems_len > elems_len_max) {
+        return false;
+      }
+    }
+  }
+
+  KeyBlockSparseElem *elems = NULL;
+  if (elems_len != 0) {
+    elems = MEM_malloc_arrayN((size_t)elems_len, sizeof(*elems), __func__);
+    for (int i = 0, i_elem = 0; i_elem < elems_len; i++) {
+      if (memcmp(co[i], co_ref[i], sizeof(float[3])) != 0) {
+        elems[i_elem].index = i;
+        copy_v3_v3(elems[i_elem].co, co[i]);
+        i_elem++;
+      }
+    }
+  }
+  *r_elems = elems;
+  *r_elems_len = elems_len;
+  return true;
+}
+
+/** Restore the full data of a sparse key block from its relative key. */
+static float (*keyblock_sparse_data_calc(const Key *key, const KeyBlock *kb))[3]
+{
+  const KeyBlock *refb = BLI_findlink(&key->block, kb->relative);
+  float(*co)[3] = MEM_calloc_arrayN((size_t)kb->totelem, sizeof(float[3]), __func__);
+  /* Relative keys are never sparse, an invalid relative key means a corrupt file. */
+  if (refb != NULL && refb != kb && refb->data != NULL && refb->totelem == kb->totelem) {
+    memcpy(co, refb->data, sizeof(float[3]) * (size_t)kb->totelem);
+  }
+  for (int i_elem = 0; i_elem < kb->sparse_elems_len; i_elem++) {
+    const KeyBlockSparseElem *elem = &kb->sparse_elems[i_elem];
+    if (elem->index >= 0 && elem->index < kb->totelem) {
+      copy_v3_v3(co[elem->index], elem->co);
+    }
+  }
+  return co;
+}
+
+/**
+ * \return the position of the first sparse element with an index not smaller than \a index.
+ */
+static int keyblock_sparse_elem_find(const KeyBlockSparseElem *elems,
+                                     const int elems_len,
+                                     const int index)
+{
+  int low = 0, high = elems_len;
+  while (low < high) {
+    const int mid = (low + high) / 2;
+    if (elems[mid].index < index) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/**
+ * Get the full data of a key block, which has to be restored for sparse blocks of
+ * evaluated keys. The restored data is kept until the key is freed.
+ */
+void *BKE_keyblock_data_ensure(Key *key, KeyBlock *kb)
+{
+  if (!(kb->flag & KEYBLOCK_SPARSE)) {
+    return kb->data;
+  }
+  /* Evaluated keys can be shared between objects evaluated on different threads. Instead of
+   * locking, every thread may restore the data and only the first one is kept. Swapping NULL for
+   * NULL reads the data atomically. */
+  void *data = atomic_cas_ptr(&kb->data, NULL, NULL);
+  if (data != NULL) {
+    return data;
+  }
+
+  float(*co)[3] = keyblock_sparse_data_calc(key, kb);
+  data = atomic_cas_ptr(&kb->data, NULL, co);
+  if (data != NULL) {
+    MEM_freeN(co);
+    return data;
+  }
+  return co;
+}
+
+#undef KEYBLOCK_SPARSE_RATIO_MAX
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Shared Key Block Data
+ *
+ * Evaluated copies of keys share the data of the original key blocks (see
+ * #LIB_ID_COPY_CD_SHARE), the last block using the data frees it. Code freeing key block data
+ * has to use #BKE_keyblock_data_free, code writing to it in place has to unshare it first with
+ * #BKE_keyblock_data_ensure_unshared.
+ * \{ */
+
+typedef struct KeyBlockSharing {
+  int users;
+  void *data;
+} KeyBlockSharing;
+
+static void keyblock_data_share(KeyBlock *kb_src, KeyBlock *kb_dst)
+{
+  KeyBlockSharing *sharing = kb_src->sharing;
+  if (sharing == NULL) {
+    KeyBlockSharing *new_sharing = MEM_mallocN(sizeof(*new_sharing), __func__);
+    new_sharing->users = 1;
+    new_sharing->data = kb_src->data;
+    /* Different dependency graphs might share the same original key. */
+    sharing = atomic_cas_ptr((void **)&kb_src->sharing, NULL, new_sharing);
+    if (sharing == NULL) {
+      sharing = new_sharing;
+    }
+    else {
+      MEM_freeN(new_sharing);
+    }
+  }
+  atomic_add_and_fetch_int32(&sharing->users, 1);
+  kb_dst->data = kb_src->data;
+  kb_dst->sharing = sharing;
+}
+
+/** Free the data of the key block, or stop using it when it's shared with other blocks. */
+void BKE_keyblock_data_free(KeyBlock *kb)
+{
+  KeyBlockSharing *sharing = kb->sharing;
+  if (sharing == NULL) {
+    MEM_SAFE_FREE(kb->data);
+    return;
+  }
+  kb->sharing = NULL;
+  kb->data = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    MEM_SAFE_FREE(sharing->data);
+    MEM_freeN(sharing);
+  }
+}
+
+/**
+ * Get the data of a key block for writing in place, copying it first when other key blocks
+ * still use it.
+ */
+void *BKE_keyblock_data_ensure_unshared(Key *key, KeyBlock *kb)
+{
+  BKE_keyblock_data_ensure(key, kb);
+
+  KeyBlockSharing *sharing = kb->sharing;
+  if (sharing == NULL) {
+    return kb->data;
+  }
+  kb->sharing = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    /* Nobody else uses the data anymore, take it over. */
+    MEM_freeN(sharing);
+    return kb->data;
+  }
+  if (kb->data != NULL) {
+    kb->data = MEM_dupallocN(kb->data);
+  }
+  return kb->data;
+}
+
+/** \} */
+
 static void shapekey_copy_data(Main *UNUSED(bmain),
                                ID *id_dst,
                                const ID *id_src,
-                               const int UNUSED(flag))
+                               const int flag)
 {
   Key *key_dst = (Key *)id_dst;
   const Key *key_src = (const Key *)id_src;
   BLI_duplicatelist(&key_dst->block, &key_src->block);
 
+  BLI_bitmap *relative_used = (flag & LIB_ID_COPY_KEY_SPARSE) ?
+                                  keyblock_sparse_relative_used_map(key_src) :
+                                  NULL;
+
   KeyBlock *kb_dst, *kb_src;
-  for (kb_src = key_src->block.first, kb_dst = key_dst->block.first; kb_dst;
-       kb_src = kb_src->next, kb_dst = kb_dst->next) {
-    if (kb_dst->data) {
-      kb_dst->data = MEM_dupallocN(kb_dst->data);
+  int index;
+  for (kb_src = key_src->block.first, kb_dst = key_dst->block.first, index = 0; kb_dst;
+       kb_src = kb_src->next, kb_dst = kb_dst->next, index++) {
+    kb_dst->data = NULL;
+    kb_dst->sharing = NULL;
+    kb_dst->sparse_elems = NULL;
+    kb_dst->sparse_elems_len = 0;
+    kb_dst->flag &= ~KEYBLOCK_SPARSE;
+
+    const KeyBlock *refb = NULL;
+    if (relative_used) {
+      refb = keyblock_sparse_relative_get(key_src, kb_src, index, relative_used);
+    }
+    if (refb && keyblock_sparse_elems_calc(
+                    kb_src, refb, &kb_dst->sparse_elems, &kb_dst->sparse_elems_len)) {
+      kb_dst->flag |= KEYBLOCK_SPARSE;
+    }
+    else if (kb_src->data && (flag & LIB_ID_COPY_CD_SHARE)) {
+      keyblock_data_share(kb_src, kb_dst);
+    }
+    else if (kb_src->data) {
+      kb_dst->data = MEM_dupallocN(kb_src->data);
+    }
+    else if (kb_src->flag & KEYBLOCK_SPARSE) {
+      /* Copies of evaluated keys get the full data again. */
+      kb_dst->data = keyblock_sparse_data_calc(key_src, kb_src);
     }
+
     if (kb_src == key_src->refkey) {
       key_dst->refkey = kb_dst;
     }
   }
+
+  MEM_SAFE_FREE(relative_used);
 }
 
 static void shapekey_free_data(ID *id)
@@ -92,9 +368,8 @@ static void shapekey_free_data(ID *id)
   KeyBlock *kb;
 
   while ((kb = BLI_pophead(&key->block))) {
-    if (kb->data) {
-      MEM_freeN(kb->data);
-    }
+    BKE_keyblock_data_free(kb);
+    keyblock_sparse_free(kb);
     MEM_freeN(kb);
   }
 }
@@ -117,13 +392,43 @@ static void shapekey_blend_write(BlendWriter *writer, ID *id, const void *id_add
       BKE_animdata_blend_write(writer, key->adt);
     }
 
+    /* Only undo steps store sparse blocks, files are written in full so older versions which
+     * don't know #KEYBLOCK_SPARSE can still read them. */
+    BLI_bitmap *relative_used = BLO_write_is_undo(writer) ?
+                                    keyblock_sparse_relative_used_map(key) :
+                                    NULL;
+
     /* direct data */
-    LISTBASE_FOREACH (KeyBlock *, kb, &key->block) {
-      BLO_write_struct(writer, KeyBlock, kb);
-      if (kb->data) {
-        BLO_write_raw(writer, kb->totelem * key->elemsize, kb->data);
+    int index;
+    LISTBASE_FOREACH_INDEX (KeyBlock *, kb, &key->block, index) {
+      const KeyBlock *refb = relative_used ?
+                                 keyblock_sparse_relative_get(key, kb, index, relative_used) :
+                                 NULL;
+      KeyBlockSparseElem *elems;
+      int elems_len;
+      if (refb && keyblock_sparse_elems_calc(kb, refb, &elems, &elems_len)) {
+        KeyBlock kb_write = *kb;
+        kb_write.data = NULL;
+        kb_write.flag |= KEYBLOCK_SPARSE;
+        /* The full data isn't written, so its address is free to identify the elements. */
+        kb_write.sparse_elems = elems ? kb->data : NULL;
+        kb_write.sparse_elems_len = elems_len;
+        BLO_write_struct_at_address(writer, KeyBlock, kb, &kb_write);
+        if (elems) {
+          BLO_write_struct_array_at_address(
+              writer, KeyBlockSparseElem, elems_len, kb->data, elems);
+          MEM_freeN(elems);
+        }
+      }
+      else {
+        BLO_write_struct(writer, KeyBlock, kb);
+        if (kb->data) {
+          BLO_write_raw(writer, kb->totelem * key->elemsize, kb->data);
+        }
       }
     }
+
+    MEM_SAFE_FREE(relative_used);
   }
 }
 
@@ -171,11 +476,26 @@ static void shapekey_blend_read_data(BlendDataReader *reader, ID *id)
 
   LISTBASE_FOREACH (KeyBlock *, kb, &key->block) {
     BLO_read_data_address(reader, &kb->data);
+    BLO_read_data_address(reader, &kb->sparse_elems);
+    kb->sharing = NULL;
+    if (kb->sparse_elems == NULL) {
+      kb->sparse_elems_len = 0;
+    }
 
-    if (BLO_read_requires_endian_switch(reader)) {
+    if (kb->data && BLO_read_requires_endian_switch(reader)) {
       switch_endian_keyblock(key, kb);
     }
   }
+
+  /* Original keys always have the full data. */
+  LISTBASE_FOREACH (KeyBlock *, kb, &key->block) {
+    if (kb->flag & KEYBLOCK_SPARSE) {
+      if (kb->data == NULL) {
+        kb->data = keyblock_sparse_data_calc(key, kb);
+      }
+      keyblock_sparse_free(kb);
+    }
+  }
 }
 
 static void shapekey_blend_read_lib(BlendLibReader *reader, ID *id)
@@ -239,9 +559,8 @@ void BKE_key_free_nolib(Key *key)
   KeyBlock *kb;
 
   while ((kb = BLI_pophead(&key->block))) {
-    if (kb->data) {
-      MEM_freeN(kb->data);
-    }
+    BKE_keyblock_data_free(kb);
+    keyblock_sparse_free(kb);
     MEM_freeN(kb);
   }
 }
@@ -614,37 +933,47 @@ static void rel_flerp(int tot, float *in, const float *ref, const float *out, fl
   }
 }
 
-static char *key_block_get_data(Key *key, KeyBlock *actkb, KeyBlock *kb, char **freedata)
+/* this hack makes it possible to edit shape keys in
+ * edit mode with shape keys blending applied */
+static char *key_block_get_edit_data(Key *key, KeyBlock *kb)
 {
-  if (kb == actkb) {
-    /* this hack makes it possible to edit shape keys in
-     * edit mode with shape keys blending applied */
-    if (GS(key->from->name) == ID_ME) {
-      Mesh *me;
-      BMVert *eve;
-      BMIter iter;
-      float(*co)[3];
-      int a;
-
-      me = (Mesh *)key->from;
-
-      if (me->edit_mesh && me->edit_mesh->bm->totvert == kb->totelem) {
-        a = 0;
-        co = MEM_mallocN(sizeof(float[3]) * me->edit_mesh->bm->totvert, "key_block_get_data");
-
-        BM_ITER_MESH (eve, &iter, me->edit_mesh->bm, BM_VERTS_OF_MESH) {
-          copy_v3_v3(co[a], eve->co);
-          a++;
-        }
+  if (GS(key->from->name) == ID_ME) {
+    Mesh *me;
+    BMVert *eve;
+    BMIter iter;
+    float(*co)[3];
+    int a;
+
+    me = (Mesh *)key->from;
 
-        *freedata = (char *)co;
-        return (char *)co;
+    if (me->edit_mesh && me->edit_mesh->bm->totvert == kb->totelem) {
+      a = 0;
+      co = MEM_mallocN(sizeof(float[3]) * me->edit_mesh->bm->totvert, "key_block_get_data");
+
+      BM_ITER_MESH (eve, &iter, me->edit_mesh->bm, BM_VERTS_OF_MESH) {
+        copy_v3_v3(co[a], eve->co);
+        a++;
       }
+
+      return (char *)co;
+    }
+  }
+
+  return NULL;
+}
+
+static char *key_block_get_data(Key *key, KeyBlock *actkb, KeyBlock *kb, char **freedata)
+{
+  if (kb == actkb) {
+    char *co = key_block_get_edit_data(key, kb);
+    if (co) {
+      *freedata = co;
+      return co;
     }
   }
 
   *freedata = NULL;
-  return kb->data;
+  return BKE_keyblock_data_ensure(key, kb);
 }
 
 /* currently only the first value of 'ofs' may be set. */
@@ -861,6 +1190,173 @@ static void cp_cu_key(Curve *cu,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Relative Key Blending of Coordinates
+ *
+ * Meshes and lattices only store coordinates in their keys, which are blended here
+ * in blocks of elements, so blocks can be processed on multiple threads.
+ * For every element the keys are applied in the same order as #key_evaluate_relative,
+ * so the result is the same.
+ * \{ */
+
+/* Elements per block, also the granularity at which zero vertex group weights are skipped. */
+#define KEY_BLEND_BLOCK_LEN 1024
+/* Below this number of elements blending isn't worth splitting between threads. */
+#define KEY_BLEND_PARALLEL_MIN 8192
+
+typedef struct KeyBlendCoords {
+  const float (*from)[3];
+  const float (*reffrom)[3];
+  /* Indexed from the first element of the blended range, may be NULL. */
+  const float *weights;
+  float influence;
+  char *freefrom;
+  /* Only the #sparse_elems differ from the relative key, #from is NULL then. */
+  bool is_sparse;
+  const KeyBlockSparseElem *sparse_elems;
+  int sparse_elems_len;
+} KeyBlendCoords;
+
+typedef struct KeyBlendCoordsData {
+  float (*out)[3];
+  int start, end;
+  const KeyBlendCoords *blends;
+  int blends_len;
+} KeyBlendCoordsData;
+
+static void key_blend_coords_block_fn(void *__restrict userdata,
+                                      const int block_index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KeyBlendCoordsData *data = userdata;
+  const int block_start = data->start + block_index * KEY_BLEND_BLOCK_LEN;
+  const int block_end = MIN2(block_start + KEY_BLEND_BLOCK_LEN, data->end);
+
+  for (int i_blend = 0; i_blend < data->blends_len; i_blend++) {
+    const KeyBlendCoords *blend = &data->blends[i_blend];
+    const float influence = blend->influence;
+
+    if (blend->is_sparse) {
+      const float *weights = blend->weights ? blend->weights - data->start : NULL;
+      for (int i_elem = keyblock_sparse_elem_find(
+               blend->sparse_elems, blend->sparse_elems_len, block_start);
+           (i_elem < blend->sparse_elems_len) && (blend->sparse_elems[i_elem].index < block_end);
+           i_elem++) {
+        const KeyBlockSparseElem *elem = &blend->sparse_elems[i_elem];
+        const int i = elem->index;
+        const float weight = weights ? (weights[i] * influence) : influence;
+        data->out[i][0] -= weight * (blend->reffrom[i][0] - elem->co[0]);
+        data->out[i][1] -= weight * (blend->reffrom[i][1] - elem->co[1]);
+        data->out[i][2] -= weight * (blend->reffrom[i][2] - elem->co[2]);
+      }
+    }
+    else if (blend->weights) {
+      const float *weights = blend->weights - data->start;
+
+      /* Corrective shapes are often limited to a small region by their vertex group. */
+      int i = block_start;
+      while ((i < block_end) && (weights[i] == 0.0f)) {
+        i++;
+      }
+      for (; i < block_end; i++) {
+        const float weight = weights[i] * influence;
+        data->out[i][0] -= weight * (blend->reffrom[i][0] - blend->from[i][0]);
+        data->out[i][1] -= weight * (blend->reffrom[i][1] - blend->from[i][1]);
+        data->out[i][2] -= weight * (blend->reffrom[i][2] - blend->from[i][2]);
+      }
+    }
+    else {
+      /* Flat loop over all floats of the block, so it can be vectorized. */
+      float *out = data->out[block_start];
+      const float *reffrom = blend->reffrom[block_start];
+      const float *from = blend->from[block_start];
+      const int floats_len = (block_end - block_start) * 3;
+      for (int i = 0; i < floats_len; i++) {
+        out[i] -= influence * (reffrom[i] - from[i]);
+      }
+    }
+  }
+}
+
+static void key_evaluate_relative_coords(const int start,
+                                         const int end,
+                                         const int tot,
+                                         float (*out)[3],
+                                         Key *key,
+                                         KeyBlock *actkb,
+                                         float **per_keyblock_weights)
+{
+  KeyBlendCoords *blends = MEM_malloc_arrayN(
+      (size_t)key->totkey, sizeof(*blends), "KeyBlendCoords");
+  int blends_len = 0;
+
+  /* Gather the keys which have any influence. */
+  KeyBlock *kb;
+  int keyblock_index;
+  for (kb = key->block.first, keyblock_index = 0; kb; kb = kb->next, keyblock_index++) {
+    if (kb == key->refkey || (kb->flag & KEYBLOCK_MUTE) || kb->curval == 0.0f ||
+        kb->totelem != tot) {
+      continue;
+    }
+    /* reference now can be any block */
+    KeyBlock *refb = BLI_findlink(&key->block, kb->relative);
+    if (refb == NULL) {
+      continue;
+    }
+
+    KeyBlendCoords *blend = &blends[blends_len++];
+    blend->freefrom = (kb == actkb) ? key_block_get_edit_data(key, kb) : NULL;
+    blend->is_sparse = (blend->freefrom == NULL) && (kb->flag & KEYBLOCK_SPARSE);
+    if (blend->is_sparse) {
+      blend->from = NULL;
+      blend->sparse_elems = kb->sparse_elems;
+      blend->sparse_elems_len = kb->sparse_elems_len;
+    }
+    else {
+      blend->from = (const float(*)[3])(blend->freefrom ? blend->freefrom : kb->data);
+      blend->sparse_elems = NULL;
+      blend->sparse_elems_len = 0;
+    }
+    /* For meshes, use the original values instead of the bmesh values to
+     * maintain a constant offset. */
+    blend->reffrom = (const float(*)[3])BKE_keyblock_data_ensure(key, refb);
+    blend->weights = per_keyblock_weights ? per_keyblock_weights[keyblock_index] : NULL;
+    blend->influence = kb->curval;
+  }
+
+  if (blends_len != 0) {
+    KeyBlendCoordsData data = {
+        .out = out,
+        .start = start,
+        .end = end,
+        .blends = blends,
+        .blends_len = blends_len,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (end - start) >= KEY_BLEND_PARALLEL_MIN;
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0,
+                            (end - start + KEY_BLEND_BLOCK_LEN - 1) / KEY_BLEND_BLOCK_LEN,
+                            &data,
+                            key_blend_coords_block_fn,
+                            &settings);
+  }
+
+  for (int i_blend = 0; i_blend < blends_len; i_blend++) {
+    if (blends[i_blend].freefrom) {
+      MEM_freeN(blends[i_blend].freefrom);
+    }
+  }
+  MEM_freeN(blends);
+}
+
+#undef KEY_BLEND_BLOCK_LEN
+#undef KEY_BLEND_PARALLEL_MIN
+
+/** \} */
+
 static void key_evaluate_relative(const int start,
                                   int end,
                                   const int tot,
@@ -899,6 +1395,17 @@ static void key_evaluate_relative(const int start,
 
   /* step 2: do it */
 
+  /* Meshes and lattices, only blending coordinates (a single #IPO_FLOAT element). */
+  if ((mode == KEY_MODE_DUMMY) && (key->elemstr[0] != 0) && (key->elemstr[1] == IPO_FLOAT) &&
+      (key->elemstr[2] == 0) && (elemsize == sizeof(float[KEYELEM_FLOAT_LEN_COORD])) &&
+      (poinsize == elemsize)) {
+    if (start < end) {
+      key_evaluate_relative_coords(
+          start, end, tot, (float(*)[3])basispoin, key, actkb, per_keyblock_weights);
+    }
+    return;
+  }
+
   for (kb = key->block.first, keyblock_index = 0; kb; kb = kb->next, keyblock_index++) {
     if (kb != key->refkey) {
       float icuval = kb->curval;
@@ -1688,7 +2195,7 @@ void BKE_keyblock_data_set_with_mat4(Key *key,
   for (KeyBlock *kb = key->block.first; kb; kb = kb->next, index++) {
     if (ELEM(shape_index, -1, index)) {
       const int block_elem_len = kb->totelem;
-      float(*block_data)[3] = (float(*)[3])kb->data;
+      float(*block_data)[3] = BKE_keyblock_data_ensure_unshared(key, kb);
       for (int data_offset = 0; data_offset < block_elem_len; ++data_offset) {
         const float *src_data = (const float *)(elements + data_offset);
         float *dst_data = (float *)(block_data + data_offset);
@@ -1712,7 +2219,8 @@ void BKE_keyblock_curve_data_set_with_mat4(
   for (KeyBlock *kb = key->block.first; kb; kb = kb->next, index++) {
     if (ELEM(shape_index, -1, index)) {
       const int block_elem_size = kb->totelem * key->elemsize;
-      BKE_keyblock_curve_data_transform(nurb, mat, elements, kb->data);
+      BKE_keyblock_curve_data_transform(
+          nurb, mat, elements, BKE_keyblock_data_ensure_unshared(key, kb));
       elements += block_elem_size;
     }
   }
@@ -1728,7 +2236,7 @@ void BKE_keyblock_data_set(Key *key, const int shape_index, const void *data)
   for (KeyBlock *kb = key->block.first; kb; kb = kb->next, index++) {
     if (ELEM(shape_index, -1, index)) {
       const int block_elem_size = kb->totelem * key->elemsize;
-      memcpy(kb->data, elements, block_elem_size);
+      memcpy(BKE_keyblock_data_ensure_unshared(key, kb), elements, block_elem_size);
       elements += block_elem_size;
     }
   }
@@ -1989,7 +2497,7 @@ void BKE_keyblock_update_from_lattice(Lattice *lt, KeyBlock *kb)
   }
 
   bp = lt->def;
-  fp = kb->data;
+  fp = BKE_keyblock_data_ensure_unshared(lt->key, kb);
   for (a = 0; a < kb->totelem; a++, fp++, bp++) {
     copy_v3_v3(*fp, bp->vec);
   }
@@ -2004,7 +2512,7 @@ void BKE_keyblock_convert_from_lattice(Lattice *lt, KeyBlock *kb)
     return;
   }
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   kb->data = MEM_mallocN(lt->key->elemsize * tot, __func__);
   kb->totelem = tot;
@@ -2050,7 +2558,7 @@ int BKE_keyblock_curve_element_count(ListBase *nurb)
   return tot;
 }
 
-void BKE_keyblock_update_from_curve(Curve *UNUSED(cu), KeyBlock *kb, ListBase *nurb)
+void BKE_keyblock_update_from_curve(Curve *cu, KeyBlock *kb, ListBase *nurb)
 {
   Nurb *nu;
   BezTriple *bezt;
@@ -2066,7 +2574,7 @@ void BKE_keyblock_update_from_curve(Curve *UNUSED(cu), KeyBlock *kb, ListBase *n
     return;
   }
 
-  fp = kb->data;
+  fp = BKE_keyblock_data_ensure_unshared(cu->key, kb);
   for (nu = nurb->first; nu; nu = nu->next) {
     if (nu->bezt) {
       for (a = nu->pntsu, bezt = nu->bezt; a; a--, bezt++) {
@@ -2130,7 +2638,7 @@ void BKE_keyblock_convert_from_curve(Curve *cu, KeyBlock *kb, ListBase *nurb)
     return;
   }
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   kb->data = MEM_mallocN(cu->key->elemsize * tot, __func__);
   kb->totelem = tot;
@@ -2189,7 +2697,7 @@ void BKE_keyblock_update_from_mesh(Mesh *me, KeyBlock *kb)
   }
 
   mvert = me->mvert;
-  fp = kb->data;
+  fp = BKE_keyblock_data_ensure_unshared(me->key, kb);
   for (a = 0; a < tot; a++, fp++, mvert++) {
     copy_v3_v3(*fp, mvert->co);
   }
@@ -2203,7 +2711,7 @@ void BKE_keyblock_convert_from_mesh(Mesh *me, Key *key, KeyBlock *kb)
     return;
   }
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   kb->data = MEM_malloc_arrayN((size_t)len, (size_t)key->elemsize, __func__);
   kb->totelem = len;
@@ -2310,7 +2818,7 @@ void BKE_keyblock_mesh_calc_normals(struct KeyBlock *kb,
 void BKE_keyblock_update_from_vertcos(Object *ob, KeyBlock *kb, const float (*vertCos)[3])
 {
   const float(*co)[3] = vertCos;
-  float *fp = kb->data;
+  float *fp = BKE_keyblock_data_ensure_unshared(BKE_key_from_object(ob), kb);
   int tot, a;
 
 #ifndef NDEBUG
@@ -2371,7 +2879,7 @@ void BKE_keyblock_convert_from_vertcos(Object *ob, KeyBlock *kb, const float (*v
 {
   int tot = 0, elemsize;
 
-  MEM_SAFE_FREE(kb->data);
+  BKE_keyblock_data_free(kb);
 
   /* Count of vertex coords in array */
   if (ob->type == OB_MESH) {
@@ -2463,7 +2971,7 @@ float (*BKE_keyblock_convert_to_vertcos(Object *ob, KeyBlock *kb))[3]
 void BKE_keyblock_update_from_offset(Object *ob, KeyBlock *kb, const float (*ofs)[3])
 {
   int a;
-  float *fp = kb->data;
+  float *fp = BKE_keyblock_data_ensure_unshared(BKE_key_from_object(ob), kb);
 
   if (ELEM(ob->type, OB_MESH, OB_LATTICE)) {
     for (a = 0; a < kb->totelem; a++, fp += 3, ofs++) {
@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_key_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_listbase.h"
+
+#include "BKE_idtype.h"
+#include "BKE_key.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/* Evaluated copies of shape keys only store the elements of corrective shapes which differ from
+ * their relative key, blending them has to give the same result as blending the full data. */
+class KeySparseTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+ protected:
+  Mesh *mesh;
+  Key *key;
+  Object *ob;
+  /* Moves a few vertices, relative to the basis. */
+  KeyBlock *kb_few;
+  /* Moves most vertices. */
+  KeyBlock *kb_most;
+  /* Moves a few vertices, but is the relative key of #kb_corrective. */
+  KeyBlock *kb_relative;
+  KeyBlock *kb_corrective;
+
+  KeyBlock *keyblock_add(const char *name, const int relative, const int moved_len)
+  {
+    KeyBlock *kb = BKE_keyblock_add(key, name);
+    KeyBlock *refb = (KeyBlock *)BLI_findlink(&key->block, relative);
+    kb->relative = relative;
+    kb->totelem = mesh->totvert;
+    kb->curval = 0.5f;
+    kb->data = MEM_dupallocN(refb->data);
+    float(*co)[3] = (float(*)[3])kb->data;
+    for (int i = 0; i < moved_len; i++) {
+      co[(i * 7) % mesh->totvert][2] += 1.0f + i;
+    }
+    return kb;
+  }
+
+  void SetUp() override
+  {
+    mesh = test_grid_mesh_create(8);
+
+    key = (Key *)BKE_id_new_nomain(ID_KE, nullptr);
+    key->type = KEY_RELATIVE;
+    key->from = &mesh->id;
+    key->uidgen = 1;
+    key->elemstr[0] = KEYELEM_FLOAT_LEN_COORD;
+    key->elemstr[1] = 4; /* IPO_FLOAT */
+    key->elemsize = sizeof(float[KEYELEM_FLOAT_LEN_COORD]);
+    mesh->key = key;
+
+    KeyBlock *basis = BKE_keyblock_add(key, nullptr);
+    BKE_keyblock_convert_from_mesh(mesh, key, basis);
+
+    kb_few = keyblock_add("Few", 0, 3);
+    kb_most = keyblock_add("Most", 0, mesh->totvert / 2);
+    kb_relative = keyblock_add("Relative", 0, 2);
+    kb_corrective = keyblock_add("Corrective", 3, 4);
+
+    ob = (Object *)BKE_id_new_nomain(ID_OB, nullptr);
+    ob->type = OB_MESH;
+    ob->data = mesh;
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, ob);
+    BKE_id_free(nullptr, key);
+    BKE_id_free(nullptr, mesh);
+  }
+
+  Key *key_copy(const int flag)
+  {
+    return (Key *)BKE_id_copy_ex(
+        nullptr, &key->id, nullptr, LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT | flag);
+  }
+
+  float (*key_evaluate(Key *key_eval))[3]
+  {
+    mesh->key = key_eval;
+    int totelem;
+    float(*co)[3] = (float(*)[3])BKE_key_evaluate_object_ex(ob, &totelem, nullptr, 0);
+    mesh->key = key;
+    EXPECT_EQ(totelem, mesh->totvert);
+    return co;
+  }
+};
+
+TEST_F(KeySparseTest, Copy)
+{
+  Key *key_sparse = key_copy(LIB_ID_COPY_KEY_SPARSE);
+  const KeyBlock *kb_sparse = (const KeyBlock *)key_sparse->block.first;
+  EXPECT_EQ(kb_sparse, key_sparse->refkey);
+
+  /* Only corrective shapes which few elements differ are sparse. */
+  for (const KeyBlock *kb = (const KeyBlock *)key->block.first; kb;
+       kb = kb->next, kb_sparse = kb_sparse->next) {
+    const bool is_sparse = ELEM(kb, kb_few, kb_corrective);
+    EXPECT_EQ((kb_sparse->flag & KEYBLOCK_SPARSE) != 0, is_sparse);
+    EXPECT_EQ(kb_sparse->data == nullptr, is_sparse);
+    if (is_sparse) {
+      EXPECT_EQ(kb_sparse->sparse_elems_len, (kb == kb_few) ? 3 : 4);
+    }
+  }
+
+  /* The full data is restored exactly, as well as by copying without the flag. */
+  Key *key_dense = (Key *)BKE_id_copy_ex(
+      nullptr, &key_sparse->id, nullptr, LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT);
+  KeyBlock *kb_dense = (KeyBlock *)key_dense->block.first;
+  KeyBlock *kb = (KeyBlock *)key->block.first;
+  for (KeyBlock *kb_sparse = (KeyBlock *)key_sparse->block.first; kb_sparse;
+       kb = kb->next, kb_sparse = kb_sparse->next, kb_dense = kb_dense->next) {
+    EXPECT_FALSE(kb_dense->flag & KEYBLOCK_SPARSE);
+    EXPECT_EQ(memcmp(kb_dense->data, kb->data, sizeof(float[3]) * kb->totelem), 0);
+    const void *data = BKE_keyblock_data_ensure(key_sparse, kb_sparse);
+    EXPECT_EQ(data, kb_sparse->data);
+    EXPECT_EQ(memcmp(data, kb->data, sizeof(float[3]) * kb->totelem), 0);
+  }
+
+  BKE_id_free(nullptr, key_dense);
+  BKE_id_free(nullptr, key_sparse);
+}
+
+TEST_F(KeySparseTest, Evaluate)
+{
+  Key *key_sparse = key_copy(LIB_ID_COPY_KEY_SPARSE);
+  float(*co_expect)[3] = key_evaluate(key);
+  float(*co)[3] = key_evaluate(key_sparse);
+
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_V3_NEAR(co[i], co_expect[i], 1e-6f);
+  }
+  /* Blending didn't need the full data. */
+  EXPECT_EQ(((KeyBlock *)BLI_findlink(&key_sparse->block, 1))->data, nullptr);
+
+  MEM_freeN(co);
+  MEM_freeN(co_expect);
+  BKE_id_free(nullptr, key_sparse);
+}
+
+TEST_F(KeySparseTest, Share)
+{
+  Key *key_share = key_copy(LIB_ID_COPY_KEY_SPARSE | LIB_ID_COPY_CD_SHARE);
+  KeyBlock *kb_few_share = (KeyBlock *)BLI_findlink(&key_share->block, 1);
+  KeyBlock *kb_most_share = (KeyBlock *)BLI_findlink(&key_share->block, 2);
+  KeyBlock *kb_relative_share = (KeyBlock *)BLI_findlink(&key_share->block, 3);
+
+  /* Sparse blocks don't need the data of the original, the other blocks use it. */
+  EXPECT_TRUE(kb_few_share->flag & KEYBLOCK_SPARSE);
+  EXPECT_EQ(kb_most_share->data, kb_most->data);
+  EXPECT_EQ(kb_relative_share->data, kb_relative->data);
+
+  /* Writing to the original doesn't change the copy. */
+  const float co_prev = ((float(*)[3])kb_relative->data)[0][0];
+  float(*co)[3] = (float(*)[3])BKE_keyblock_data_ensure_unshared(key, kb_relative);
+  EXPECT_NE(co, kb_relative_share->data);
+  co[0][0] += 1.0f;
+  EXPECT_EQ(((float(*)[3])kb_relative_share->data)[0][0], co_prev);
+
+  /* Freeing the original leaves the data to the copy, which doesn't have to copy it anymore. */
+  void *data_most = kb_most->data;
+  float(*co_most)[3] = (float(*)[3])MEM_dupallocN(data_most);
+  BKE_keyblock_data_free(kb_most);
+  EXPECT_EQ(kb_most->data, nullptr);
+  EXPECT_EQ(BKE_keyblock_data_ensure_unshared(key_share, kb_most_share), data_most);
+  EXPECT_EQ(memcmp(kb_most_share->data, co_most, sizeof(float[3]) * kb_most_share->totelem), 0);
+
+  MEM_freeN(co_most);
+  BKE_id_free(nullptr, key_share);
+}
+
+}  // namespace blender::bke::tests
@@ -51,6 +51,7 @@
 #include "BKE_deform.h"
 #include "BKE_displist.h"
 #include "BKE_idtype.h"
+#include "BKE_key.h"
 #include "BKE_lattice.h"
 #include "BKE_lib_id.h"
 #include "BKE_lib_query.h"
@@ -740,7 +741,7 @@ void BKE_lattice_transform(Lattice *lt, const float mat[4][4], bool do_keys)
     KeyBlock *kb;
 
     for (kb = lt->key->block.first; kb; kb = kb->next) {
-      float *fp = kb->data;
+      float *fp = BKE_keyblock_data_ensure_unshared(lt->key, kb);
       for (i = kb->totelem; i--; fp += 3) {
         mul_m4_v3(mat, fp);
       }
@@ -770,7 +771,7 @@ void BKE_lattice_translate(Lattice *lt, const float offset[3], bool do_keys)
     KeyBlock *kb;
 
     for (kb = lt->key->block.first; kb; kb = kb->next) {
-      float *fp = kb->data;
+      float *fp = BKE_keyblock_data_ensure_unshared(lt->key, kb);
       for (i = kb->totelem; i--; fp += 3) {
         add_v3_v3(fp, offset);
       }
@@ -166,9 +166,7 @@ static void metaball_blend_read_data(BlendDataReader *reader, ID *id)
 static void metaball_blend_read_lib(BlendLibReader *reader, ID *id)
 {
   MetaBall *mb = (MetaBall *)id;
-  for (int a = 0; a < mb->totcol; a++) {
-    BLO_read_id_address(reader, mb->id.lib, &mb->mat[a]);
-  }
+  BLO_read_id_address_array(reader, mb->id.lib, mb->mat, mb->totcol);
 
   BLO_read_id_address(reader, mb->id.lib, &mb->ipo);  // XXX deprecated - old animation system
 }
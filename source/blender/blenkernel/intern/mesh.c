@@ -125,7 +125,13 @@ static void mesh_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const int
 
   mesh_dst->mat = MEM_dupallocN(mesh_src->mat);
 
-  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_REFERENCE : CD_DUPLICATE;
+  eCDAllocType alloc_type = CD_DUPLICATE;
+  if (flag & LIB_ID_COPY_CD_REFERENCE) {
+    alloc_type = CD_REFERENCE;
+  }
+  else if (flag & LIB_ID_COPY_CD_SHARE) {
+    alloc_type = CD_SHARE;
+  }
   CustomData_copy(&mesh_src->vdata, &mesh_dst->vdata, mask.vmask, alloc_type, mesh_dst->totvert);
   CustomData_copy(&mesh_src->edata, &mesh_dst->edata, mask.emask, alloc_type, mesh_dst->totedge);
   CustomData_copy(&mesh_src->ldata, &mesh_dst->ldata, mask.lmask, alloc_type, mesh_dst->totloop);
@@ -288,9 +294,7 @@ static void mesh_blend_read_lib(BlendLibReader *reader, ID *id)
   Mesh *me = (Mesh *)id;
   /* this check added for python created meshes */
   if (me->mat) {
-    for (int i = 0; i < me->totcol; i++) {
-      BLO_read_id_address(reader, me->id.lib, &me->mat[i]);
-    }
+    BLO_read_id_address_array(reader, me->id.lib, me->mat, me->totcol);
   }
   else {
     me->totcol = 0;
@@ -751,6 +755,70 @@ void BKE_mesh_update_customdata_pointers(Mesh *me, const bool do_ensure_tess_cd)
   me->mloopuv = CustomData_get_layer(&me->ldata, CD_MLOOPUV);
 }
 
+/**
+ * Copy the custom data layers shared with other meshes (see #LIB_ID_COPY_CD_SHARE), to edit the
+ * mesh in place. Returns true when any array of the mesh was replaced.
+ */
+bool BKE_mesh_ensure_unshared_customdata(Mesh *me)
+{
+  bool changed = false;
+  changed |= CustomData_ensure_unshared_layers(&me->vdata, me->totvert);
+  changed |= CustomData_ensure_unshared_layers(&me->edata, me->totedge);
+  changed |= CustomData_ensure_unshared_layers(&me->fdata, me->totface);
+  changed |= CustomData_ensure_unshared_layers(&me->ldata, me->totloop);
+  changed |= CustomData_ensure_unshared_layers(&me->pdata, me->totpoly);
+
+  if (changed) {
+    BKE_mesh_update_customdata_pointers(me, false);
+  }
+  return changed;
+}
+
+static int mesh_customdata_totelem(const Mesh *me, const CustomData *data)
+{
+  if (data == &me->vdata) {
+    return me->totvert;
+  }
+  if (data == &me->edata) {
+    return me->totedge;
+  }
+  if (data == &me->fdata) {
+    return me->totface;
+  }
+  if (data == &me->ldata) {
+    return me->totloop;
+  }
+  BLI_assert(data == &me->pdata);
+  return me->totpoly;
+}
+
+/**
+ * Get the data of a custom data layer of the mesh to edit it in place, only this layer stops
+ * being shared with other meshes (see #CustomData_get_layer_for_write). Array pointers of the
+ * mesh are kept up to date.
+ */
+void *BKE_mesh_layer_for_write(Mesh *me, CustomData *data, const int type)
+{
+  const void *data_prev = CustomData_get_layer(data, type);
+  void *layer_data = CustomData_get_layer_for_write(data, type, mesh_customdata_totelem(me, data));
+  if (layer_data != data_prev) {
+    BKE_mesh_update_customdata_pointers(me, false);
+  }
+  return layer_data;
+}
+
+/* Same as #BKE_mesh_layer_for_write, for a named layer. */
+void *BKE_mesh_layer_named_for_write(Mesh *me, CustomData *data, const int type, const char *name)
+{
+  const void *data_prev = CustomData_get_layer_named(data, type, name);
+  void *layer_data = CustomData_get_layer_named_for_write(
+      data, type, name, mesh_customdata_totelem(me, data));
+  if (layer_data != data_prev) {
+    BKE_mesh_update_customdata_pointers(me, false);
+  }
+  return layer_data;
+}
+
 bool BKE_mesh_has_custom_loop_normals(Mesh *me)
 {
   if (me->edit_mesh) {
@@ -1286,6 +1354,9 @@ void BKE_mesh_material_index_remove(Mesh *me, short index)
   MFace *mf;
   int i;
 
+  BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY);
+  BKE_mesh_layer_for_write(me, &me->fdata, CD_MFACE);
+
   for (mp = me->mpoly, i = 0; i < me->totpoly; i++, mp++) {
     if (mp->mat_nr && mp->mat_nr >= index) {
       mp->mat_nr--;
@@ -1326,6 +1397,9 @@ void BKE_mesh_material_index_clear(Mesh *me)
   MFace *mf;
   int i;
 
+  BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY);
+  BKE_mesh_layer_for_write(me, &me->fdata, CD_MFACE);
+
   for (mp = me->mpoly, i = 0; i < me->totpoly; i++, mp++) {
     mp->mat_nr = 0;
   }
@@ -1357,6 +1431,7 @@ void BKE_mesh_material_remap(Mesh *me, const unsigned int *remap, unsigned int r
   }
   else {
     int i;
+    BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY);
     for (i = 0; i < me->totpoly; i++) {
       MAT_NR_REMAP(me->mpoly[i].mat_nr);
     }
@@ -1367,6 +1442,7 @@ void BKE_mesh_material_remap(Mesh *me, const unsigned int *remap, unsigned int r
 
 void BKE_mesh_smooth_flag_set(Mesh *me, const bool use_smooth)
 {
+  BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY);
   if (use_smooth) {
     for (int i = 0; i < me->totpoly; i++) {
       me->mpoly[i].flag |= ME_SMOOTH;
@@ -1475,7 +1551,7 @@ void BKE_mesh_transform(Mesh *me, const float mat[4][4], bool do_keys)
   if (do_keys && me->key) {
     KeyBlock *kb;
     for (kb = me->key->block.first; kb; kb = kb->next) {
-      float *fp = kb->data;
+      float *fp = BKE_keyblock_data_ensure_unshared(me->key, kb);
       for (i = kb->totelem; i--; fp += 3) {
         mul_m4_v3(mat, fp);
       }
@@ -1510,7 +1586,7 @@ void BKE_mesh_translate(Mesh *me, const float offset[3], const bool do_keys)
   if (do_keys && me->key) {
     KeyBlock *kb;
     for (kb = me->key->block.first; kb; kb = kb->next) {
-      float *fp = kb->data;
+      float *fp = BKE_keyblock_data_ensure_unshared(me->key, kb);
       for (i = kb->totelem; i--; fp += 3) {
         add_v3_v3(fp, offset);
       }
@@ -1806,6 +1882,8 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
   }
   else {
     polynors = MEM_malloc_arrayN(mesh->totpoly, sizeof(float[3]), __func__);
+    /* Vertex normals are written too. */
+    BKE_mesh_layer_for_write(mesh, &mesh->vdata, CD_MVERT);
     BKE_mesh_calc_normals_poly(mesh->mvert,
                                NULL,
                                mesh->totvert,
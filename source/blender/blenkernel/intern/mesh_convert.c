@@ -1392,7 +1392,9 @@ static void add_shapekey_layers(Mesh *mesh_dest, Mesh *mesh_src)
     }
     else {
       array = MEM_malloc_arrayN((size_t)mesh_src->totvert, sizeof(float[3]), __func__);
-      memcpy(array, kb->data, sizeof(float[3]) * (size_t)mesh_src->totvert);
+      memcpy(array,
+             BKE_keyblock_data_ensure(key, kb),
+             sizeof(float[3]) * (size_t)mesh_src->totvert);
     }
 
     CustomData_add_layer_named(
@@ -1487,9 +1489,7 @@ static void shapekey_layers_to_keyblocks(Mesh *mesh_src, Mesh *mesh_dst, int act
       kb->uid = layer->uid;
     }
 
-    if (kb->data) {
-      MEM_freeN(kb->data);
-    }
+    BKE_keyblock_data_free(kb);
 
     cos = CustomData_get_layer_n(&mesh_src->vdata, CD_SHAPEKEY, i);
     kb->totelem = mesh_src->totvert;
@@ -1511,9 +1511,7 @@ static void shapekey_layers_to_keyblocks(Mesh *mesh_src, Mesh *mesh_dst, int act
 
   for (kb = mesh_dst->key->block.first; kb; kb = kb->next) {
     if (kb->totelem != mesh_src->totvert) {
-      if (kb->data) {
-        MEM_freeN(kb->data);
-      }
+      BKE_keyblock_data_free(kb);
 
       kb->totelem = mesh_src->totvert;
       kb->data = MEM_calloc_arrayN(kb->totelem, sizeof(float[3]), __func__);
@@ -1696,9 +1694,7 @@ void BKE_mesh_nomain_to_meshkey(Mesh *mesh_src, Mesh *mesh_dst, KeyBlock *kb)
     return;
   }
 
-  if (kb->data) {
-    MEM_freeN(kb->data);
-  }
+  BKE_keyblock_data_free(kb);
   kb->data = MEM_malloc_arrayN(mesh_dst->key->elemsize, mesh_dst->totvert, "kb->data");
   kb->totelem = totvert;
 
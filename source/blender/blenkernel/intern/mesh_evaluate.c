@@ -89,7 +89,8 @@ static void mesh_calc_normals_vert_fallback(MVert *mverts, int numVerts)
  * called anywhere. */
 void BKE_mesh_calc_normals_mapping_simple(struct Mesh *mesh)
 {
-  const bool only_face_normals = CustomData_is_referenced_layer(&mesh->vdata, CD_MVERT);
+  const bool only_face_normals = CustomData_is_referenced_layer(&mesh->vdata, CD_MVERT) ||
+                                 CustomData_is_shared_layer(&mesh->vdata, CD_MVERT);
 
   BKE_mesh_calc_normals_mapping_ex(mesh->mvert,
                                    mesh->totvert,
@@ -416,6 +417,9 @@ void BKE_mesh_ensure_normals_for_display(Mesh *mesh)
     if (do_add_poly_nors_cddata) {
       poly_nors = MEM_malloc_arrayN((size_t)mesh->totpoly, sizeof(*poly_nors), __func__);
     }
+    if (do_vert_normals) {
+      BKE_mesh_layer_for_write(mesh, &mesh->vdata, CD_MVERT);
+    }
 
     /* calculate poly/vert normals */
     BKE_mesh_calc_normals_poly(mesh->mvert,
@@ -444,6 +448,8 @@ void BKE_mesh_calc_normals(Mesh *mesh)
 #ifdef DEBUG_TIME
   TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
+  /* The vertex array may be shared with other meshes. */
+  BKE_mesh_layer_for_write(mesh, &mesh->vdata, CD_MVERT);
   BKE_mesh_calc_normals_poly(mesh->mvert,
                              NULL,
                              mesh->totvert,
@@ -770,6 +776,8 @@ void BKE_lnor_space_custom_normal_to_data(MLoopNorSpace *lnor_space,
   }
 }
 
+/* Minimum number of polygons handled by a task, threading is only used for meshes with at least
+ * eight times as many loops. */
 #define LOOP_SPLIT_TASK_BLOCK_SIZE 1024
 
 typedef struct LoopSplitTaskData {
@@ -800,6 +808,9 @@ typedef struct LoopSplitTaskDataCommon {
   MLoopNorSpaceArray *lnors_spacearr;
   float (*loopnors)[3];
   short (*clnors_data)[2];
+  /* For every loop, the first loop (in poly order) of its fan that walked over it looking for the
+   * start of a cyclic smooth fan, -1 when not walked over yet. Only accessed with atomics. */
+  int *fan_claims;
 
   /* Read-only. */
   const MVert *mverts;
@@ -820,111 +831,136 @@ typedef struct LoopSplitTaskDataCommon {
 /* See comment about edge_to_loops below. */
 #define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
 
-static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
-                                 const bool check_angle,
-                                 const float split_angle,
-                                 const bool do_sharp_edges_tag)
+typedef struct EdgesSharpTagData {
+  LoopSplitTaskDataCommon *common_data;
+  /* Number of loops using each edge. */
+  int *edge_users;
+  bool check_angle;
+  bool do_sharp_edges_tag;
+  float split_angle_cos;
+} EdgesSharpTagData;
+
+static void mesh_edges_sharp_tag_poly_cb(void *__restrict userdata,
+                                         const int mp_index,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  const MVert *mverts = data->mverts;
-  const MEdge *medges = data->medges;
-  const MLoop *mloops = data->mloops;
-
-  const MPoly *mpolys = data->mpolys;
-
-  const int numEdges = data->numEdges;
-  const int numPolys = data->numPolys;
-
-  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
-  const float(*polynors)[3] = data->polynors;
-
-  int(*edge_to_loops)[2] = data->edge_to_loops;
-  int *loop_to_poly = data->loop_to_poly;
+  const EdgesSharpTagData *data = userdata;
+  const LoopSplitTaskDataCommon *common_data = data->common_data;
+  const MVert *mverts = common_data->mverts;
+  const MLoop *mloops = common_data->mloops;
+  float(*loopnors)[3] = common_data->loopnors; /* Note: loopnors may be NULL here. */
+  int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  int *loop_to_poly = common_data->loop_to_poly;
 
-  BLI_bitmap *sharp_edges = do_sharp_edges_tag ? BLI_BITMAP_NEW(numEdges, __func__) : NULL;
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  for (int ml_curr_index = mp->loopstart; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
 
-  const MPoly *mp;
-  int mp_index;
+    loop_to_poly[ml_curr_index] = mp_index;
 
-  const float split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
+    /* Pre-populate all loop normals as if their verts were all-smooth,
+     * this way we don't have to compute those later!
+     */
+    if (loopnors) {
+      normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
+    }
 
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    const MLoop *ml_curr;
-    int *e2l;
-    int ml_curr_index = mp->loopstart;
-    const int ml_last_index = (ml_curr_index + mp->totloop) - 1;
+    /* Only the first two loops using an edge are stored, more make it sharp anyway. */
+    const int users = atomic_add_and_fetch_int32(&data->edge_users[ml_curr->e], 1);
+    if (users <= 2) {
+      edge_to_loops[ml_curr->e][users - 1] = ml_curr_index;
+    }
+  }
+}
 
-    ml_curr = &mloops[ml_curr_index];
+static void mesh_edges_sharp_tag_edge_cb(void *__restrict userdata,
+                                         const int me_index,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const EdgesSharpTagData *data = userdata;
+  const LoopSplitTaskDataCommon *common_data = data->common_data;
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const float(*polynors)[3] = common_data->polynors;
+  int *e2l = common_data->edge_to_loops[me_index];
+  /* Only tagging is allowed to modify edges. */
+  MEdge *me = (MEdge *)&common_data->medges[me_index];
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
-      e2l = edge_to_loops[ml_curr->e];
+  const int users = data->edge_users[me_index];
+  if (users == 0) {
+    /* Loose edge, both values remain 0. */
+    return;
+  }
+  if (users == 1) {
+    /* Set e2l[1] to INDEX_UNSET to tag it as unset, we have to check this here too,
+     * else we might miss some flat faces!!! */
+    e2l[1] = (mpolys[loop_to_poly[e2l[0]]].flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
+    return;
+  }
+  if (users > 2) {
+    /* More than two loops using this edge, tag as sharp. */
+    e2l[1] = INDEX_INVALID;
+    return;
+  }
 
-      loop_to_poly[ml_curr_index] = mp_index;
+  /* Loops were stored in any order by the threads, keep the first one in mesh order first. */
+  if (e2l[0] > e2l[1]) {
+    SWAP(int, e2l[0], e2l[1]);
+  }
 
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
+  const MPoly *mp_a = &mpolys[loop_to_poly[e2l[0]]];
+  const MPoly *mp_b = &mpolys[loop_to_poly[e2l[1]]];
+  const bool is_angle_sharp = (data->check_angle &&
+                               dot_v3v3(polynors[loop_to_poly[e2l[0]]],
+                                        polynors[loop_to_poly[e2l[1]]]) < data->split_angle_cos);
 
-      /* Check whether current edge might be smooth or sharp */
-      if ((e2l[0] | e2l[1]) == 0) {
-        /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
-        e2l[0] = ml_curr_index;
-        /* We have to check this here too, else we might miss some flat faces!!! */
-        e2l[1] = (mp->flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
-      }
-      else if (e2l[1] == INDEX_UNSET) {
-        const bool is_angle_sharp = (check_angle &&
-                                     dot_v3v3(polynors[loop_to_poly[e2l[0]]], polynors[mp_index]) <
-                                         split_angle_cos);
-
-        /* Second loop using this edge, time to test its sharpness.
-         * An edge is sharp if it is tagged as such, or its face is not smooth,
-         * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
-         * same vertex, or angle between both its polys' normals is above split_angle value.
-         */
-        if (!(mp->flag & ME_SMOOTH) || (medges[ml_curr->e].flag & ME_SHARP) ||
-            ml_curr->v == mloops[e2l[0]].v || is_angle_sharp) {
-          /* Note: we are sure that loop != 0 here ;) */
-          e2l[1] = INDEX_INVALID;
-
-          /* We want to avoid tagging edges as sharp when it is already defined as such by
-           * other causes than angle threshold... */
-          if (do_sharp_edges_tag && is_angle_sharp) {
-            BLI_BITMAP_SET(sharp_edges, ml_curr->e, true);
-          }
-        }
-        else {
-          e2l[1] = ml_curr_index;
-        }
-      }
-      else if (!IS_EDGE_SHARP(e2l)) {
-        /* More than two loops using this edge, tag as sharp if not yet done. */
-        e2l[1] = INDEX_INVALID;
-
-        /* We want to avoid tagging edges as sharp when it is already defined as such by
-         * other causes than angle threshold... */
-        if (do_sharp_edges_tag) {
-          BLI_BITMAP_SET(sharp_edges, ml_curr->e, false);
-        }
-      }
-      /* Else, edge is already 'disqualified' (i.e. sharp)! */
+  /* An edge is sharp if it is tagged as such, or its face is not smooth,
+   * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
+   * same vertex, or angle between both its polys' normals is above split_angle value.
+   */
+  if (!(mp_a->flag & ME_SMOOTH) || !(mp_b->flag & ME_SMOOTH) || (me->flag & ME_SHARP) ||
+      mloops[e2l[0]].v == mloops[e2l[1]].v || is_angle_sharp) {
+    /* Note: we are sure that loop != 0 here ;) */
+    e2l[1] = INDEX_INVALID;
+
+    /* We want to avoid tagging edges as sharp when it is already defined as such by
+     * other causes than angle threshold... */
+    if (data->do_sharp_edges_tag && is_angle_sharp && (mp_a->flag & ME_SMOOTH)) {
+      me->flag |= ME_SHARP;
     }
   }
+}
 
-  /* If requested, do actual tagging of edges as sharp in another loop. */
-  if (do_sharp_edges_tag) {
-    MEdge *me;
-    int me_index;
-    for (me = (MEdge *)medges, me_index = 0; me_index < numEdges; me++, me_index++) {
-      if (BLI_BITMAP_TEST(sharp_edges, me_index)) {
-        me->flag |= ME_SHARP;
-      }
-    }
+/**
+ * Fill the edge to loops and loop to poly maps, and classify edges as smooth or sharp.
+ *
+ * Done in two parallel passes, first the loops using every edge are gathered,
+ * then the sharpness of every edge is decided from its loops.
+ */
+static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
+                                 const bool check_angle,
+                                 const float split_angle,
+                                 const bool do_sharp_edges_tag)
+{
+  EdgesSharpTagData tag_data = {
+      .common_data = data,
+      .edge_users = MEM_calloc_arrayN((size_t)data->numEdges, sizeof(int), __func__),
+      .check_angle = check_angle,
+      .do_sharp_edges_tag = do_sharp_edges_tag,
+      .split_angle_cos = check_angle ? cosf(split_angle) : -1.0f,
+  };
 
-    MEM_freeN(sharp_edges);
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (data->numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
+
+  BLI_task_parallel_range(0, data->numPolys, &tag_data, mesh_edges_sharp_tag_poly_cb, &settings);
+  BLI_task_parallel_range(0, data->numEdges, &tag_data, mesh_edges_sharp_tag_edge_cb, &settings);
+
+  MEM_freeN(tag_data.edge_users);
 }
 
 /**
@@ -964,6 +1000,7 @@ void BKE_edges_sharp_from_angle_set(const struct MVert *mverts,
       .loop_to_poly = loop_to_poly,
       .polynors = polynors,
       .numEdges = numEdges,
+      .numLoops = numLoops,
       .numPolys = numPolys,
   };
 
@@ -1312,55 +1349,59 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
+BLI_INLINE bool loop_split_loop_is_before(const int ml_a_index,
+                                          const int mp_a_index,
+                                          const int ml_b_index,
+                                          const int mp_b_index)
 {
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
+  return (mp_a_index < mp_b_index) || (mp_a_index == mp_b_index && ml_a_index < ml_b_index);
+}
 
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
+/**
+ * Claim \a ml_index for the fan walk started from \a ml_start_index.
+ * Returns false when it was already walked over from a loop coming earlier in poly order.
+ */
+static bool loop_split_fan_claim(int *fan_claims,
+                                 const int *loop_to_poly,
+                                 const int ml_index,
+                                 const int ml_start_index,
+                                 const int mp_start_index)
+{
+  int claim = fan_claims[ml_index];
+  while ((claim == -1) ||
+         loop_split_loop_is_before(ml_start_index, mp_start_index, claim, loop_to_poly[claim])) {
+    const int claim_prev = atomic_cas_int32(&fan_claims[ml_index], claim, ml_start_index);
+    if (claim_prev == claim) {
+      return true;
     }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
+    claim = claim_prev;
   }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
+  return claim == ml_start_index;
 }
 
 /**
- * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
+ * Check whether given loop is the first loop (in poly order) of a cyclic smooth fan.
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
+ *
+ * All loops can be checked in parallel. Every walk claims the loops it passes, and stops at
+ * loops claimed by a walk from an earlier loop of the same fan. This way a fan is not walked
+ * again from each of its loops, which would be quadratic in the number of loops around a vertex.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_is_cyclic_smooth_fan_start(const LoopSplitTaskDataCommon *common_data,
+                                                  const int *e2l_prev,
+                                                  const MLoop *ml_curr,
+                                                  const MLoop *ml_prev,
+                                                  const int ml_curr_index,
+                                                  const int ml_prev_index,
+                                                  const int mp_curr_index)
 {
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  int *fan_claims = common_data->fan_claims;
+
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
   const MLoop *mlfan_curr;
@@ -1372,6 +1413,11 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
     /* Sharp loop, so not a cyclic smooth fan... */
     return false;
   }
+  if (!loop_split_fan_claim(
+          fan_claims, loop_to_poly, ml_curr_index, ml_curr_index, mp_curr_index)) {
+    /* Walked over from a loop coming earlier. */
+    return false;
+  }
 
   mlfan_curr = ml_prev;
   mlfan_curr_index = ml_prev_index;
@@ -1382,10 +1428,9 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
-
-  while (true) {
+  /* A fan can't have more loops than the mesh, guards against looping forever on invalid
+   * geometry, where walking around the vertex does not lead back to the start. */
+  for (int i = 0; i < common_data->numLoops; i++) {
     /* Find next loop of the smooth fan. */
     BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
                                                 mpolys,
@@ -1403,197 +1448,204 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
       /* Sharp loop/edge, so not a cyclic smooth fan... */
       return false;
     }
-    /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
-      if (mlfan_vert_index == ml_curr_index) {
-        /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
-         * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
-        return true;
-      }
-      /* ... already checked in some previous looping, we can abort. */
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan without finding any loop coming earlier,
+       * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
+      return true;
+    }
+    if (loop_split_loop_is_before(
+            mlfan_vert_index, mpfan_curr_index, ml_curr_index, mp_curr_index) ||
+        !loop_split_fan_claim(
+            fan_claims, loop_to_poly, mlfan_vert_index, ml_curr_index, mp_curr_index)) {
+      /* ... the fan is handled from a loop coming earlier, we can abort. */
       return false;
     }
-
-    /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
   }
+  return false;
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+/**
+ * How the normal of a loop is computed.
+ * Loops which are not the start of a single loop or a fan space are handled by another loop.
+ */
+typedef enum eLoopSplitType {
+  LOOP_SPLIT_SKIP = 0,
+  LOOP_SPLIT_SINGLE = 1,
+  LOOP_SPLIT_FAN = 2,
+} eLoopSplitType;
+
+static eLoopSplitType loop_split_type_get(const LoopSplitTaskDataCommon *common_data,
+                                          const MLoop *ml_curr,
+                                          const MLoop *ml_prev,
+                                          const int ml_curr_index,
+                                          const int ml_prev_index,
+                                          const int mp_index)
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
-
-  const MLoop *mloops = common_data->mloops;
-  const MPoly *mpolys = common_data->mpolys;
-  const int *loop_to_poly = common_data->loop_to_poly;
-  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
+  const int *e2l_curr = common_data->edge_to_loops[ml_curr->e];
+  const int *e2l_prev = common_data->edge_to_loops[ml_prev->e];
+
+  /* A smooth edge, we have to check for cyclic smooth fan case.
+   * If this loop is the entry point of its cyclic smooth fan, we do it using that loop/edge,
+   * otherwise we can skip it. */
+  if (!IS_EDGE_SHARP(e2l_curr)) {
+    return loop_split_is_cyclic_smooth_fan_start(
+               common_data, e2l_prev, ml_curr, ml_prev, ml_curr_index, ml_prev_index, mp_index) ?
+               LOOP_SPLIT_FAN :
+               LOOP_SPLIT_SKIP;
+  }
+  /* We *do not need* to check/tag loops as already computed!
+   * Due to the fact a loop only links to one of its two edges,
+   * a same fan *will never be walked more than once!*
+   * Since we consider edges having neighbor polys with inverted
+   * (flipped) normals as sharp, we are sure that no fan will be skipped,
+   * even only considering the case (sharp curr_edge, smooth prev_edge),
+   * and not the alternative (smooth curr_edge, sharp prev_edge).
+   * All this due/thanks to link between normals and loop ordering (i.e. winding).
+   */
+  return IS_EDGE_SHARP(e2l_prev) ? LOOP_SPLIT_SINGLE : LOOP_SPLIT_FAN;
+}
 
-  const MPoly *mp;
-  int mp_index;
+typedef struct LoopSplitData {
+  LoopSplitTaskDataCommon *common_data;
+  /* Type of every loop when already known, may be NULL. */
+  char *loop_types;
+} LoopSplitData;
 
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+typedef struct LoopSplitTLS {
+  /* Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+} LoopSplitTLS;
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+static void loop_split_type_poly_cb(void *__restrict userdata,
+                                    const int mp_index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const LoopSplitData *data = userdata;
+  const LoopSplitTaskDataCommon *common_data = data->common_data;
+  const MLoop *mloops = common_data->mloops;
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_prev_index = ml_last_index;
+  for (int ml_curr_index = mp->loopstart; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    data->loop_types[ml_curr_index] = (char)loop_split_type_get(common_data,
+                                                                &mloops[ml_curr_index],
+                                                                &mloops[ml_prev_index],
+                                                                ml_curr_index,
+                                                                ml_prev_index,
+                                                                mp_index);
+    ml_prev_index = ml_curr_index;
+  }
+}
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+static void loop_split_poly_cb(void *__restrict userdata,
+                               const int mp_index,
+                               const TaskParallelTLS *__restrict tls)
+{
+  const LoopSplitData *data = userdata;
+  LoopSplitTaskDataCommon *common_data = data->common_data;
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  LoopSplitTLS *tls_data = tls->userdata_chunk;
+  const MLoop *mloops = common_data->mloops;
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
-#endif
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_prev_index = ml_last_index;
+  for (int ml_curr_index = mp->loopstart; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const eLoopSplitType type = data->loop_types ?
+                                    (eLoopSplitType)data->loop_types[ml_curr_index] :
+                                    loop_split_type_get(common_data,
+                                                        ml_curr,
+                                                        ml_prev,
+                                                        ml_curr_index,
+                                                        ml_prev_index,
+                                                        mp_index);
+
+    if (type != LOOP_SPLIT_SKIP) {
+      LoopSplitTaskData task_data = {NULL};
+      task_data.ml_curr = ml_curr;
+      task_data.ml_prev = ml_prev;
+      task_data.ml_curr_index = ml_curr_index;
+      task_data.mp_index = mp_index;
+      if (type == LOOP_SPLIT_SINGLE) {
+        task_data.lnor = &common_data->loopnors[ml_curr_index];
+      }
+      else {
+        task_data.ml_prev_index = ml_prev_index;
+        /* Also tag as 'fan' task. */
+        task_data.e2l_prev = common_data->edge_to_loops[ml_prev->e];
+      }
+      if (lnors_spacearr) {
+        /* Created beforehand, the loop is added to it while computing the normal. */
+        task_data.lnor_space = lnors_spacearr->lspacearr[ml_curr_index];
+        if (tls_data->edge_vectors == NULL && type == LOOP_SPLIT_FAN) {
+          tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+        }
+      }
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+      loop_split_worker_do(common_data, &task_data, tls_data->edge_vectors);
     }
-  }
-
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
 
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+    ml_prev_index = ml_curr_index;
+  }
+}
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+static void loop_split_free_cb(const void *__restrict UNUSED(userdata), void *__restrict chunk)
+{
+  LoopSplitTLS *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+  }
+}
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+/**
+ * Compute the normals (and spaces) of all smooth fans and single loops in parallel over polys.
+ *
+ * Every loop decides on its own whether it is the entry point of a fan, so no producer has to
+ * walk all loops up-front, see #loop_split_is_cyclic_smooth_fan_start. Lnor spaces are allocated
+ * from a memarena, which is not thread-safe, so when they are needed the loop types are computed
+ * in a first pass and the spaces are created before the normals.
+ */
+static void loop_split_compute(LoopSplitTaskDataCommon *common_data)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  const int numLoops = common_data->numLoops;
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+  LoopSplitData data = {
+      .common_data = common_data,
+      .loop_types = NULL,
+  };
+  LoopSplitTLS tls_data = {NULL};
 
-        //              printf("PROCESSING!\n");
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+  common_data->fan_claims = MEM_malloc_arrayN(
+      (size_t)numLoops, sizeof(*common_data->fan_claims), __func__);
+  copy_vn_i(common_data->fan_claims, numLoops, -1);
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+  if (lnors_spacearr) {
+    data.loop_types = MEM_malloc_arrayN((size_t)numLoops, sizeof(*data.loop_types), __func__);
+    BLI_task_parallel_range(0, common_data->numPolys, &data, loop_split_type_poly_cb, &settings);
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
+    for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+      if (data.loop_types[ml_index] != LOOP_SPLIT_SKIP) {
+        lnors_spacearr->lspacearr[ml_index] = BKE_lnor_space_create(lnors_spacearr);
       }
-
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
     }
   }
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-  MEM_freeN(skip_loops);
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = loop_split_free_cb;
+  BLI_task_parallel_range(0, common_data->numPolys, &data, loop_split_poly_cb, &settings);
 
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_generator);
-#endif
+  MEM_SAFE_FREE(data.loop_types);
+  MEM_SAFE_FREE(common_data->fan_claims);
 }
 
 /**
@@ -1710,19 +1762,7 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
   /* This first loop check which edges are actually smooth, and compute edge vectors. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
-  }
+  loop_split_compute(&common_data);
 
   MEM_freeN(edge_to_loops);
   if (!r_loop_to_poly) {
@@ -2060,6 +2100,7 @@ static void mesh_set_custom_normals(Mesh *mesh, float (*r_custom_nors)[3], const
   bool free_polynors = false;
   if (polynors == NULL) {
     polynors = MEM_mallocN(sizeof(float[3]) * (size_t)mesh->totpoly, __func__);
+    BKE_mesh_layer_for_write(mesh, &mesh->vdata, CD_MVERT);
     BKE_mesh_calc_normals_poly(mesh->mvert,
                                NULL,
                                mesh->totvert,
@@ -3278,147 +3319,242 @@ int BKE_mesh_tessface_calc_ex(CustomData *fdata,
 #undef ML_TO_MF_QUAD
 }
 
+/* Use this to avoid using the polyfill arena for quads and triangles. */
+#define USE_TESSFACE_SPEEDUP
+
+/* Number of polygons below which tessellation isn't worth splitting between threads. */
+#define MESH_LOOPTRI_PARALLEL_POLY_MIN 1024
+
 /**
- * Calculate tessellation into #MLoopTri which exist only for this purpose.
+ * Tessellate a single polygon, writing its triangles from \a mlt.
+ *
+ * \param pf_arena_p: Polyfill memory arena, only allocated when an n-gon is found,
+ * cleared after use so it can be reused for the next polygons.
  */
-void BKE_mesh_recalc_looptri(const MLoop *mloop,
-                             const MPoly *mpoly,
-                             const MVert *mvert,
-                             int totloop,
-                             int totpoly,
-                             MLoopTri *mlooptri)
+BLI_INLINE void mesh_calc_tessellation_for_face(const MLoop *mloop,
+                                                const MPoly *mpoly,
+                                                const MVert *mvert,
+                                                const uint poly_index,
+                                                MLoopTri *mlt,
+                                                MemArena **pf_arena_p)
 {
-  /* use this to avoid locking pthread for _every_ polygon
-   * and calling the fill function */
+  const uint mp_loopstart = (uint)mpoly[poly_index].loopstart;
+  const uint mp_totloop = (uint)mpoly[poly_index].totloop;
 
-#define USE_TESSFACE_SPEEDUP
+#define ML_TO_MLT(i1, i2, i3) \
+  { \
+    ARRAY_SET_ITEMS(mlt->tri, mp_loopstart + i1, mp_loopstart + i2, mp_loopstart + i3); \
+    mlt->poly = poly_index; \
+  } \
+  ((void)0)
 
-  const MPoly *mp;
-  const MLoop *ml;
-  MLoopTri *mlt;
-  MemArena *arena = NULL;
-  int poly_index, mlooptri_index;
-  unsigned int j;
+  if (mp_totloop < 3) {
+    /* do nothing */
+  }
+#ifdef USE_TESSFACE_SPEEDUP
+  else if (mp_totloop == 3) {
+    ML_TO_MLT(0, 1, 2);
+  }
+  else if (mp_totloop == 4) {
+    ML_TO_MLT(0, 1, 2);
+    MLoopTri *mlt_a = mlt++;
+    ML_TO_MLT(0, 2, 3);
+    MLoopTri *mlt_b = mlt;
+
+    if (UNLIKELY(is_quad_flip_v3_first_third_fast(mvert[mloop[mlt_a->tri[0]].v].co,
+                                                  mvert[mloop[mlt_a->tri[1]].v].co,
+                                                  mvert[mloop[mlt_a->tri[2]].v].co,
+                                                  mvert[mloop[mlt_b->tri[2]].v].co))) {
+      /* flip out of degenerate 0-2 state. */
+      mlt_a->tri[2] = mlt_b->tri[2];
+      mlt_b->tri[0] = mlt_a->tri[1];
+    }
+  }
+#endif /* USE_TESSFACE_SPEEDUP */
+  else {
+    const MLoop *ml;
+    const float *co_curr, *co_prev;
 
-  mlooptri_index = 0;
-  mp = mpoly;
-  for (poly_index = 0; poly_index < totpoly; poly_index++, mp++) {
-    const unsigned int mp_loopstart = (unsigned int)mp->loopstart;
-    const unsigned int mp_totloop = (unsigned int)mp->totloop;
-    unsigned int l1, l2, l3;
-    if (mp_totloop < 3) {
-      /* do nothing */
+    float normal[3];
+
+    float axis_mat[3][3];
+    float(*projverts)[2];
+    uint(*tris)[3];
+
+    const uint totfilltri = mp_totloop - 2;
+
+    MemArena *pf_arena = *pf_arena_p;
+    if (UNLIKELY(pf_arena == NULL)) {
+      pf_arena = *pf_arena_p = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
     }
 
-#ifdef USE_TESSFACE_SPEEDUP
+    tris = BLI_memarena_alloc(pf_arena, sizeof(*tris) * (size_t)totfilltri);
+    projverts = BLI_memarena_alloc(pf_arena, sizeof(*projverts) * (size_t)mp_totloop);
 
-#  define ML_TO_MLT(i1, i2, i3) \
-    { \
-      mlt = &mlooptri[mlooptri_index]; \
-      l1 = mp_loopstart + i1; \
-      l2 = mp_loopstart + i2; \
-      l3 = mp_loopstart + i3; \
-      ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3); \
-      mlt->poly = (unsigned int)poly_index; \
-    } \
-    ((void)0)
+    zero_v3(normal);
 
-    else if (mp_totloop == 3) {
-      ML_TO_MLT(0, 1, 2);
-      mlooptri_index++;
+    /* calc normal, flipped: to get a positive 2d cross product */
+    ml = mloop + mp_loopstart;
+    co_prev = mvert[ml[mp_totloop - 1].v].co;
+    for (uint j = 0; j < mp_totloop; j++, ml++) {
+      co_curr = mvert[ml->v].co;
+      add_newell_cross_v3_v3v3(normal, co_prev, co_curr);
+      co_prev = co_curr;
     }
-    else if (mp_totloop == 4) {
-      ML_TO_MLT(0, 1, 2);
-      MLoopTri *mlt_a = mlt;
-      mlooptri_index++;
-      ML_TO_MLT(0, 2, 3);
-      MLoopTri *mlt_b = mlt;
-      mlooptri_index++;
-
-      if (UNLIKELY(is_quad_flip_v3_first_third_fast(mvert[mloop[mlt_a->tri[0]].v].co,
-                                                    mvert[mloop[mlt_a->tri[1]].v].co,
-                                                    mvert[mloop[mlt_a->tri[2]].v].co,
-                                                    mvert[mloop[mlt_b->tri[2]].v].co))) {
-        /* flip out of degenerate 0-2 state. */
-        mlt_a->tri[2] = mlt_b->tri[2];
-        mlt_b->tri[0] = mlt_a->tri[1];
-      }
+    if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
+      normal[2] = 1.0f;
     }
-#endif /* USE_TESSFACE_SPEEDUP */
-    else {
-      const float *co_curr, *co_prev;
 
-      float normal[3];
+    /* project verts to 2d */
+    axis_dominant_v3_to_m3_negate(axis_mat, normal);
 
-      float axis_mat[3][3];
-      float(*projverts)[2];
-      unsigned int(*tris)[3];
+    ml = mloop + mp_loopstart;
+    for (uint j = 0; j < mp_totloop; j++, ml++) {
+      mul_v2_m3v3(projverts[j], axis_mat, mvert[ml->v].co);
+    }
 
-      const unsigned int totfilltri = mp_totloop - 2;
+    BLI_polyfill_calc_arena(projverts, mp_totloop, 1, tris, pf_arena);
 
-      if (UNLIKELY(arena == NULL)) {
-        arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
-      }
+    /* apply fill */
+    for (uint j = 0; j < totfilltri; j++, mlt++) {
+      uint *tri = tris[j];
+      /* set loop indices, transformed to vert indices later */
+      ML_TO_MLT(tri[0], tri[1], tri[2]);
+    }
 
-      tris = BLI_memarena_alloc(arena, sizeof(*tris) * (size_t)totfilltri);
-      projverts = BLI_memarena_alloc(arena, sizeof(*projverts) * (size_t)mp_totloop);
+    BLI_memarena_clear(pf_arena);
+  }
 
-      zero_v3(normal);
+#undef ML_TO_MLT
+}
 
-      /* calc normal, flipped: to get a positive 2d cross product */
-      ml = mloop + mp_loopstart;
-      co_prev = mvert[ml[mp_totloop - 1].v].co;
-      for (j = 0; j < mp_totloop; j++, ml++) {
-        co_curr = mvert[ml->v].co;
-        add_newell_cross_v3_v3v3(normal, co_prev, co_curr);
-        co_prev = co_curr;
-      }
-      if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
-        normal[2] = 1.0f;
-      }
+/**
+ * \return the number of triangles written.
+ */
+static uint mesh_recalc_looptri__single_threaded(const MLoop *mloop,
+                                                 const MPoly *mpoly,
+                                                 const MVert *mvert,
+                                                 int totpoly,
+                                                 MLoopTri *mlooptri)
+{
+  MemArena *pf_arena = NULL;
+  uint mlooptri_index = 0;
 
-      /* project verts to 2d */
-      axis_dominant_v3_to_m3_negate(axis_mat, normal);
+  for (uint poly_index = 0; poly_index < (uint)totpoly; poly_index++) {
+    mesh_calc_tessellation_for_face(
+        mloop, mpoly, mvert, poly_index, &mlooptri[mlooptri_index], &pf_arena);
+    mlooptri_index += (uint)MAX2(mpoly[poly_index].totloop - 2, 0);
+  }
 
-      ml = mloop + mp_loopstart;
-      for (j = 0; j < mp_totloop; j++, ml++) {
-        mul_v2_m3v3(projverts[j], axis_mat, mvert[ml->v].co);
-      }
+  if (pf_arena) {
+    BLI_memarena_free(pf_arena);
+  }
 
-      BLI_polyfill_calc_arena(projverts, mp_totloop, 1, tris, arena);
+  return mlooptri_index;
+}
 
-      /* apply fill */
-      for (j = 0; j < totfilltri; j++) {
-        unsigned int *tri = tris[j];
+typedef struct TessellationUserData {
+  const MLoop *mloop;
+  const MPoly *mpoly;
+  const MVert *mvert;
+  /* Index of the first triangle of each polygon. */
+  const uint *poly_looptri_offsets;
 
-        mlt = &mlooptri[mlooptri_index];
+  MLoopTri *mlooptri;
+} TessellationUserData;
 
-        /* set loop indices, transformed to vert indices later */
-        l1 = mp_loopstart + tri[0];
-        l2 = mp_loopstart + tri[1];
-        l3 = mp_loopstart + tri[2];
+typedef struct TessellationUserTLS {
+  MemArena *pf_arena;
+} TessellationUserTLS;
 
-        ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3);
-        mlt->poly = (unsigned int)poly_index;
+static void mesh_calc_tessellation_for_face_fn(void *__restrict userdata,
+                                               const int index,
+                                               const TaskParallelTLS *__restrict tls)
+{
+  const TessellationUserData *data = userdata;
+  TessellationUserTLS *tm_tls = tls->userdata_chunk;
+  mesh_calc_tessellation_for_face(data->mloop,
+                                  data->mpoly,
+                                  data->mvert,
+                                  (uint)index,
+                                  &data->mlooptri[data->poly_looptri_offsets[index]],
+                                  &tm_tls->pf_arena);
+}
 
-        mlooptri_index++;
-      }
+static void mesh_calc_tessellation_for_face_free_fn(const void *__restrict UNUSED(userdata),
+                                                    void *__restrict tls_v)
+{
+  TessellationUserTLS *tm_tls = tls_v;
+  if (tm_tls->pf_arena) {
+    BLI_memarena_free(tm_tls->pf_arena);
+  }
+}
 
-      BLI_memarena_clear(arena);
-    }
+static uint mesh_recalc_looptri__multi_threaded(const MLoop *mloop,
+                                                const MPoly *mpoly,
+                                                const MVert *mvert,
+                                                int totpoly,
+                                                MLoopTri *mlooptri)
+{
+  /* Prefix sum of the triangles of each polygon, so they can be written independently. */
+  uint *poly_looptri_offsets = MEM_malloc_arrayN(
+      (size_t)totpoly, sizeof(*poly_looptri_offsets), __func__);
+  uint mlooptri_index = 0;
+  for (int poly_index = 0; poly_index < totpoly; poly_index++) {
+    poly_looptri_offsets[poly_index] = mlooptri_index;
+    mlooptri_index += (uint)MAX2(mpoly[poly_index].totloop - 2, 0);
   }
 
-  if (arena) {
-    BLI_memarena_free(arena);
-    arena = NULL;
+  TessellationUserTLS tm_tls = {NULL};
+  TessellationUserData data = {
+      .mloop = mloop,
+      .mpoly = mpoly,
+      .mvert = mvert,
+      .poly_looptri_offsets = poly_looptri_offsets,
+      .mlooptri = mlooptri,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = MESH_LOOPTRI_PARALLEL_POLY_MIN;
+  settings.userdata_chunk = &tm_tls;
+  settings.userdata_chunk_size = sizeof(tm_tls);
+  settings.func_free = mesh_calc_tessellation_for_face_free_fn;
+
+  BLI_task_parallel_range(0, totpoly, &data, mesh_calc_tessellation_for_face_fn, &settings);
+
+  MEM_freeN(poly_looptri_offsets);
+
+  return mlooptri_index;
+}
+
+/**
+ * Calculate tessellation into #MLoopTri which exist only for this purpose.
+ *
+ * Large meshes are tessellated on multiple threads,
+ * the result is the same as when tessellating sequentially.
+ */
+void BKE_mesh_recalc_looptri(const MLoop *mloop,
+                             const MPoly *mpoly,
+                             const MVert *mvert,
+                             int totloop,
+                             int totpoly,
+                             MLoopTri *mlooptri)
+{
+  uint mlooptri_len;
+  if (totpoly < MESH_LOOPTRI_PARALLEL_POLY_MIN * 2) {
+    mlooptri_len = mesh_recalc_looptri__single_threaded(mloop, mpoly, mvert, totpoly, mlooptri);
+  }
+  else {
+    mlooptri_len = mesh_recalc_looptri__multi_threaded(mloop, mpoly, mvert, totpoly, mlooptri);
   }
 
-  BLI_assert(mlooptri_index == poly_to_tri_count(totpoly, totloop));
-  UNUSED_VARS_NDEBUG(totloop);
+  BLI_assert(mlooptri_len == (uint)poly_to_tri_count(totpoly, totloop));
+  UNUSED_VARS_NDEBUG(mlooptri_len, totloop);
+}
 
 #undef USE_TESSFACE_SPEEDUP
-#undef ML_TO_MLT
-}
+#undef MESH_LOOPTRI_PARALLEL_POLY_MIN
 
 static void bm_corners_to_loops_ex(ID *id,
                                    CustomData *fdata,
@@ -3847,6 +3983,8 @@ void BKE_mesh_flush_hidden_from_verts_ex(const MVert *mvert,
 }
 void BKE_mesh_flush_hidden_from_verts(Mesh *me)
 {
+  BKE_mesh_layer_for_write(me, &me->edata, CD_MEDGE);
+  BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY);
   BKE_mesh_flush_hidden_from_verts_ex(
       me->mvert, me->mloop, me->medge, me->totedge, me->mpoly, me->totpoly);
 }
@@ -3884,6 +4022,8 @@ void BKE_mesh_flush_hidden_from_polys_ex(MVert *mvert,
 }
 void BKE_mesh_flush_hidden_from_polys(Mesh *me)
 {
+  BKE_mesh_layer_for_write(me, &me->vdata, CD_MVERT);
+  BKE_mesh_layer_for_write(me, &me->edata, CD_MEDGE);
   BKE_mesh_flush_hidden_from_polys_ex(
       me->mvert, me->mloop, me->medge, me->totedge, me->mpoly, me->totpoly);
 }
@@ -3930,6 +4070,8 @@ void BKE_mesh_flush_select_from_polys_ex(MVert *mvert,
 }
 void BKE_mesh_flush_select_from_polys(Mesh *me)
 {
+  BKE_mesh_layer_for_write(me, &me->vdata, CD_MVERT);
+  BKE_mesh_layer_for_write(me, &me->edata, CD_MEDGE);
   BKE_mesh_flush_select_from_polys_ex(
       me->mvert, me->totvert, me->mloop, me->medge, me->totedge, me->mpoly, me->totpoly);
 }
@@ -3984,6 +4126,8 @@ void BKE_mesh_flush_select_from_verts_ex(const MVert *mvert,
 }
 void BKE_mesh_flush_select_from_verts(Mesh *me)
 {
+  BKE_mesh_layer_for_write(me, &me->edata, CD_MEDGE);
+  BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY);
   BKE_mesh_flush_select_from_verts_ex(
       me->mvert, me->totvert, me->mloop, me->medge, me->totedge, me->mpoly, me->totpoly);
 }
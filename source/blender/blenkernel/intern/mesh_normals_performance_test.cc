@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+
+#include "BKE_mesh.h"
+
+#include "PIL_time.h"
+
+#include "tests/BKE_mesh_normals_test_utils.hh"
+
+namespace blender::bke::tests {
+
+static void test_mesh_normals_loop_split_performance(const int size, const bool use_spaces)
+{
+  printf("\n========== STARTING %s (%d loops, spaces: %d) ==========\n",
+         __func__,
+         size * size * 4,
+         use_spaces);
+
+  MeshNormalsTestContext ctx;
+  RandomNumberGenerator rng;
+  test_mesh_normals_init(&ctx, size, &rng);
+
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  const double time_begin = PIL_check_seconds_timer();
+  test_mesh_normals_loop_split(&ctx, DEG2RADF(30.0f), use_spaces ? &lnors_spacearr : nullptr);
+  const double time_split = PIL_check_seconds_timer() - time_begin;
+  printf("Split normals: %f (sec)\n", time_split);
+
+  if (use_spaces) {
+    BKE_lnor_spacearr_free(&lnors_spacearr);
+  }
+  test_mesh_normals_free(&ctx);
+
+  printf("========== ENDED %s ==========\n\n", __func__);
+}
+
+TEST(mesh_normals_loop_split_performance, performance_10000_loops)
+{
+  test_mesh_normals_loop_split_performance(50, false);
+}
+
+TEST(mesh_normals_loop_split_performance, performance_5000000_loops)
+{
+  test_mesh_normals_loop_split_performance(1118, false);
+}
+
+TEST(mesh_normals_loop_split_performance, performance_5000000_loops_spaces)
+{
+  test_mesh_normals_loop_split_performance(1118, true);
+}
+
+}  // namespace blender::bke::tests
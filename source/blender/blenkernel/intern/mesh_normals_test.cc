@@ -0,0 +1,202 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+
+#include "BKE_mesh.h"
+
+#include "tests/BKE_mesh_normals_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/* Two cones sharing a ring of `ring_len` vertices, the apexes have a cyclic smooth fan of
+ * `ring_len` loops. Polys are in the order of walking around the apexes, or reversed. */
+static void test_mesh_normals_bicone_init(MeshNormalsTestContext *ctx,
+                                          const int ring_len,
+                                          const bool reverse)
+{
+  const int apex_top = ring_len;
+  const int apex_bottom = ring_len + 1;
+  ctx->size = ring_len;
+  ctx->verts_len = ring_len + 2;
+  ctx->edges_len = ring_len * 3;
+  ctx->polys_len = ring_len * 2;
+  ctx->loops_len = ctx->polys_len * 3;
+  ctx->mvert = (MVert *)MEM_calloc_arrayN(ctx->verts_len, sizeof(MVert), __func__);
+  ctx->medge = (MEdge *)MEM_calloc_arrayN(ctx->edges_len, sizeof(MEdge), __func__);
+  ctx->mloop = (MLoop *)MEM_calloc_arrayN(ctx->loops_len, sizeof(MLoop), __func__);
+  ctx->mpoly = (MPoly *)MEM_calloc_arrayN(ctx->polys_len, sizeof(MPoly), __func__);
+  ctx->poly_normals = (float(*)[3])MEM_malloc_arrayN(ctx->polys_len, sizeof(float[3]), __func__);
+  ctx->loop_normals = (float(*)[3])MEM_malloc_arrayN(ctx->loops_len, sizeof(float[3]), __func__);
+
+  ctx->mvert[apex_top].co[2] = 1.0f;
+  ctx->mvert[apex_bottom].co[2] = -1.0f;
+  for (int i = 0; i < ring_len; i++) {
+    const int i_next = (i + 1) % ring_len;
+    const float angle = 2.0f * (float)M_PI * i / ring_len;
+    ctx->mvert[i].co[0] = cosf(angle);
+    ctx->mvert[i].co[1] = sinf(angle);
+
+    /* Ring edge, then the edges to the top and bottom apex. */
+    MEdge *me = &ctx->medge[i * 3];
+    me[0].v1 = i;
+    me[0].v2 = i_next;
+    me[1].v1 = i;
+    me[1].v2 = apex_top;
+    me[2].v1 = i;
+    me[2].v2 = apex_bottom;
+
+    const int p = reverse ? ring_len - 1 - i : i;
+    MPoly *mp_top = &ctx->mpoly[p];
+    MPoly *mp_bottom = &ctx->mpoly[ring_len + p];
+    mp_top->loopstart = p * 3;
+    mp_bottom->loopstart = (ring_len + p) * 3;
+    mp_top->totloop = mp_bottom->totloop = 3;
+    mp_top->flag = mp_bottom->flag = ME_SMOOTH;
+
+    MLoop *ml = &ctx->mloop[mp_top->loopstart];
+    ml[0].v = i;
+    ml[0].e = i * 3;
+    ml[1].v = i_next;
+    ml[1].e = i_next * 3 + 1;
+    ml[2].v = apex_top;
+    ml[2].e = i * 3 + 1;
+
+    ml = &ctx->mloop[mp_bottom->loopstart];
+    ml[0].v = i_next;
+    ml[0].e = i * 3;
+    ml[1].v = i;
+    ml[1].e = i * 3 + 2;
+    ml[2].v = apex_bottom;
+    ml[2].e = i_next * 3 + 2;
+  }
+
+  BKE_mesh_calc_normals_poly(ctx->mvert,
+                             nullptr,
+                             ctx->verts_len,
+                             ctx->mloop,
+                             ctx->mpoly,
+                             ctx->loops_len,
+                             ctx->polys_len,
+                             ctx->poly_normals,
+                             false);
+}
+
+
+TEST(mesh_normals_loop_split, FlatFacesUsePolyNormals)
+{
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, 16, nullptr);
+  for (int i = 0; i < ctx.polys_len; i++) {
+    ctx.mpoly[i].flag &= ~ME_SMOOTH;
+  }
+  test_mesh_normals_loop_split(&ctx, (float)M_PI, nullptr);
+  for (int i = 0; i < ctx.polys_len; i++) {
+    const MPoly *mp = &ctx.mpoly[i];
+    for (int j = 0; j < mp->totloop; j++) {
+      EXPECT_V3_NEAR(ctx.loop_normals[mp->loopstart + j], ctx.poly_normals[i], 1e-6f);
+    }
+  }
+  test_mesh_normals_free(&ctx);
+}
+
+TEST(mesh_normals_loop_split, SmoothFansUseVertexNormals)
+{
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, 16, nullptr);
+
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  test_mesh_normals_loop_split(&ctx, (float)M_PI, &lnors_spacearr);
+
+  /* Every vertex is a single cyclic smooth fan. */
+  EXPECT_EQ(lnors_spacearr.num_spaces, ctx.verts_len);
+  for (int i = 0; i < ctx.loops_len; i++) {
+    float vert_normal[3];
+    normal_short_to_float_v3(vert_normal, ctx.mvert[ctx.mloop[i].v].no);
+    EXPECT_V3_NEAR(ctx.loop_normals[i], vert_normal, 1e-3f);
+  }
+
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+  test_mesh_normals_free(&ctx);
+}
+
+TEST(mesh_normals_loop_split, SharpEdgesSplitFans)
+{
+  MeshNormalsTestContext ctx;
+  test_mesh_normals_init(&ctx, 16, nullptr);
+  /* Split the torus in two halves along a ring of edges. */
+  for (int y = 0; y < ctx.size; y++) {
+    ctx.medge[(y * ctx.size) * 2 + 1].flag |= ME_SHARP;
+  }
+
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  test_mesh_normals_loop_split(&ctx, (float)M_PI, &lnors_spacearr);
+
+  /* Vertices on the sharp ring have one fan on each side. */
+  EXPECT_EQ(lnors_spacearr.num_spaces, ctx.verts_len + ctx.size);
+  for (int i = 0; i < ctx.loops_len; i++) {
+    const MLoopNorSpace *lnor_space = lnors_spacearr.lspacearr[i];
+    ASSERT_NE(lnor_space, nullptr);
+    EXPECT_NEAR(len_v3(ctx.loop_normals[i]), 1.0f, 1e-5f);
+  }
+
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+  test_mesh_normals_free(&ctx);
+}
+
+/* Large cyclic fans, walked from either direction. */
+TEST(mesh_normals_loop_split, HighValenceFans)
+{
+  for (const bool reverse : {false, true}) {
+    MeshNormalsTestContext ctx;
+    test_mesh_normals_bicone_init(&ctx, 2000, reverse);
+
+    MLoopNorSpaceArray lnors_spacearr = {nullptr};
+    test_mesh_normals_loop_split(&ctx, (float)M_PI, &lnors_spacearr);
+
+    /* Every vertex is a single cyclic smooth fan. */
+    EXPECT_EQ(lnors_spacearr.num_spaces, ctx.verts_len);
+    const MLoopNorSpace *apex_spaces[2] = {nullptr, nullptr};
+    const float apex_normals[2][3] = {{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}};
+    for (int i = 0; i < ctx.loops_len; i++) {
+      const int apex = (int)ctx.mloop[i].v - ctx.size;
+      if (apex < 0) {
+        continue;
+      }
+      if (apex_spaces[apex] == nullptr) {
+        apex_spaces[apex] = lnors_spacearr.lspacearr[i];
+      }
+      EXPECT_EQ(lnors_spacearr.lspacearr[i], apex_spaces[apex]);
+      EXPECT_V3_NEAR(ctx.loop_normals[i], apex_normals[apex], 1e-3f);
+    }
+
+    BKE_lnor_spacearr_free(&lnors_spacearr);
+    test_mesh_normals_free(&ctx);
+  }
+}
+
+}  // namespace blender::bke::tests
@@ -43,12 +43,19 @@
 /** \name Mesh Runtime Struct Utils
  * \{ */
 
+static int mesh_runtime_data_stamp_next(void)
+{
+  static int data_stamp = 0;
+  return atomic_add_and_fetch_int32(&data_stamp, 1);
+}
+
 /**
  * Default values defined at read time.
  */
 void BKE_mesh_runtime_reset(Mesh *mesh)
 {
   memset(&mesh->runtime, 0, sizeof(mesh->runtime));
+  mesh->runtime.data_stamp = mesh_runtime_data_stamp_next();
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
   mesh->runtime.bvh_cache = NULL;
@@ -68,6 +75,8 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
   runtime->shrinkwrap_data = NULL;
+  /* The arrays are copied, so they're different from the source mesh ones. */
+  runtime->data_stamp = mesh_runtime_data_stamp_next();
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
@@ -1067,6 +1067,14 @@ bool BKE_mesh_validate(Mesh *me, const bool do_verbose, const bool cddata_check_
                                                true,
                                                &changed);
 
+  /* Arrays are fixed in place. */
+  BKE_mesh_layer_for_write(me, &me->vdata, CD_MVERT);
+  BKE_mesh_layer_for_write(me, &me->vdata, CD_MDEFORMVERT);
+  BKE_mesh_layer_for_write(me, &me->edata, CD_MEDGE);
+  BKE_mesh_layer_for_write(me, &me->fdata, CD_MFACE);
+  BKE_mesh_layer_for_write(me, &me->ldata, CD_MLOOP);
+  BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY);
+
   is_valid &= BKE_mesh_validate_arrays(me,
                                        me->mvert,
                                        me->totvert,
@@ -1156,6 +1164,10 @@ bool BKE_mesh_validate_material_indices(Mesh *me)
 
   for (mp = me->mpoly, i = 0; i < totpoly; i++, mp++) {
     if ((uint16_t)mp->mat_nr > mat_nr_max) {
+      if (is_valid) {
+        /* Only copy polygons shared with other meshes when something needs fixing. */
+        mp = (MPoly *)BKE_mesh_layer_for_write(me, &me->pdata, CD_MPOLY) + i;
+      }
       mp->mat_nr = 0;
       is_valid = false;
     }
@@ -1529,7 +1541,7 @@ void BKE_mesh_calc_edges_legacy(Mesh *me, const bool use_old)
 
 void BKE_mesh_calc_edges_loose(Mesh *mesh)
 {
-  MEdge *med = mesh->medge;
+  MEdge *med = BKE_mesh_layer_for_write(mesh, &mesh->edata, CD_MEDGE);
   for (int i = 0; i < mesh->totedge; i++, med++) {
     med->flag |= ME_LOOSEEDGE;
   }
@@ -933,9 +933,7 @@ static void object_blend_read_lib(BlendLibReader *reader, ID *id)
       ob->mode &= ~OB_MODE_POSE;
     }
   }
-  for (int a = 0; a < ob->totcol; a++) {
-    BLO_read_id_address(reader, ob->id.lib, &ob->mat[a]);
-  }
+  BLO_read_id_address_array(reader, ob->id.lib, ob->mat, ob->totcol);
 
   /* When the object is local and the data is library its possible
    * the material list size gets out of sync. T22663. */
@@ -4582,9 +4580,7 @@ bool BKE_object_shapekey_remove(Main *bmain, Object *ob, KeyBlock *kb)
     }
   }
 
-  if (kb->data) {
-    MEM_freeN(kb->data);
-  }
+  BKE_keyblock_data_free(kb);
   MEM_freeN(kb);
 
   /* Unset active when all are freed. */
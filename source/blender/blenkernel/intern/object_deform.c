@@ -43,6 +43,7 @@
 #include "DNA_scene_types.h"
 
 #include "BKE_action.h"
+#include "BKE_customdata.h"
 #include "BKE_deform.h"
 #include "BKE_editmesh.h"
 #include "BKE_gpencil.h"
@@ -542,6 +543,7 @@ void BKE_object_defgroup_index_map_apply(MDeformVert *dvert,
 
 /**
  * Get MDeformVert vgroup data from given object. Should only be used in Object mode.
+ * The data may be edited in place, it's not shared with evaluated meshes anymore.
  *
  * \return True if the id type supports weights.
  */
@@ -551,6 +553,7 @@ bool BKE_object_defgroup_array_get(ID *id, MDeformVert **dvert_arr, int *dvert_t
     switch (GS(id->name)) {
       case ID_ME: {
         Mesh *me = (Mesh *)id;
+        BKE_mesh_layer_for_write(me, &me->vdata, CD_MDEFORMVERT);
         *dvert_arr = me->dvert;
         *dvert_tot = me->totvert;
         return true;
@@ -1610,6 +1610,14 @@ static void sculpt_update_object(Depsgraph *depsgraph,
 
   ss->scene = scene;
 
+  /* Painting edits the original mesh in place, its arrays can not be shared with the evaluated
+   * mesh. The PBVH uses those arrays, so it is rebuilt when they are replaced. */
+  if (BKE_mesh_ensure_unshared_customdata(me) && ss->pbvh &&
+      BKE_pbvh_type(ss->pbvh) == PBVH_FACES) {
+    BKE_pbvh_free(ss->pbvh);
+    ss->pbvh = NULL;
+  }
+
   if (need_mask) {
     if (mmd == NULL) {
       if (!CustomData_has_layer(&me->vdata, CD_PAINT_MASK)) {
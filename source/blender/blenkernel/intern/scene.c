@@ -2558,6 +2558,15 @@ void BKE_scene_update_tag_audio_volume(Depsgraph *UNUSED(depsgraph), Scene *scen
   scene->id.recalc |= ID_RECALC_AUDIO_VOLUME;
 }
 
+/* Threaded evaluation order of the interactive updates, set by the experimental preference. */
+static void scene_graph_scheduling_mode_update(Depsgraph *depsgraph)
+{
+  DEG_evaluate_scheduling_mode_set(depsgraph,
+                                   USER_EXPERIMENTAL_TEST(&U, use_depsgraph_critical_path) ?
+                                       DEG_SCHEDULING_CRITICAL_PATH :
+                                       DEG_SCHEDULING_DISCOVERY_ORDER);
+}
+
 /* TODO(sergey): This actually should become view_layer_graph or so.
  * Same applies to update_for_newframe.
  *
@@ -2587,6 +2596,7 @@ static void scene_graph_update_tagged(Depsgraph *depsgraph, Main *bmain, bool on
     prepare_mesh_for_viewport_render(bmain, view_layer);
     /* Update all objects: drivers, matrices, displists, etc. flags set
      * by depsgraph or manual, no layer check here, gets correct flushed. */
+    scene_graph_scheduling_mode_update(depsgraph);
     DEG_evaluate_on_refresh(depsgraph);
     /* Update sound system. */
     BKE_scene_update_sound(depsgraph, bmain);
@@ -2657,6 +2667,7 @@ void BKE_scene_graph_update_for_newframe(Depsgraph *depsgraph)
      * NOTE: Only update for new frame on first iteration. Second iteration is for ensuring user
      * edits from callback are properly taken into account. Doing a time update on those would
      * lose any possible unkeyed changes made by the handler. */
+    scene_graph_scheduling_mode_update(depsgraph);
     if (pass == 0) {
       const float ctime = BKE_scene_frame_get(scene);
       DEG_evaluate_on_framechange(depsgraph, ctime);
@@ -2690,6 +2701,204 @@ void BKE_scene_graph_update_for_newframe(Depsgraph *depsgraph)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Multi-Frame Evaluation
+ *
+ * Evaluation of many frames at once in independent dependency graphs, for exporters and baking
+ * which only read the evaluated scene. The original data is shared read-only by all graphs.
+ * \{ */
+
+/* Each dependency graph keeps a full evaluated copy of the scene, so this bounds memory usage. */
+#define SCENE_GRAPH_FRAMES_MAX_GRAPHS 8
+
+/* Frames being evaluated, shared by the tasks as user data of the task pool. */
+typedef struct SceneGraphFrames {
+  ThreadMutex mutex;
+  /* Notified whenever a frame is done evaluating. */
+  ThreadCondition done_cond;
+} SceneGraphFrames;
+
+typedef struct SceneGraphFrameTask {
+  Depsgraph *depsgraph;
+  float ctime;
+  /* Set once the graph is at #ctime, protected by the mutex of #SceneGraphFrames. */
+  bool is_done;
+} SceneGraphFrameTask;
+
+static void scene_graph_evaluate_frame_task(TaskPool *__restrict pool, void *taskdata)
+{
+  SceneGraphFrames *frames_data = (SceneGraphFrames *)BLI_task_pool_user_data(pool);
+  SceneGraphFrameTask *task = (SceneGraphFrameTask *)taskdata;
+  /* Only the evaluated scene of the graph is moved to the frame, the original scene is not
+   * touched so the graphs don't interfere with each other. */
+  DEG_evaluate_on_framechange(task->depsgraph, task->ctime);
+  DEG_ids_clear_recalc(DEG_get_bmain(task->depsgraph), task->depsgraph);
+
+  BLI_mutex_lock(&frames_data->mutex);
+  task->is_done = true;
+  BLI_condition_notify_all(&frames_data->done_cond);
+  BLI_mutex_unlock(&frames_data->mutex);
+}
+
+static void scene_graph_evaluate_frame_push(TaskPool *pool,
+                                            SceneGraphFrameTask *task,
+                                            const double frame)
+{
+  task->ctime = (float)frame;
+  task->is_done = false;
+  BLI_task_pool_push(pool, scene_graph_evaluate_frame_task, task, false, NULL);
+}
+
+static void scene_graph_evaluate_frame_wait(SceneGraphFrames *frames_data,
+                                            const SceneGraphFrameTask *task)
+{
+  BLI_mutex_lock(&frames_data->mutex);
+  while (!task->is_done) {
+    BLI_condition_wait(&frames_data->done_cond, &frames_data->mutex);
+  }
+  BLI_mutex_unlock(&frames_data->mutex);
+}
+
+/**
+ * Whether the frames of the scene can be evaluated in any order, each in its own dependency
+ * graph. This is not the case when a simulation accumulates state from the previous frames.
+ *
+ * Frame change handlers and animated images are only updated when the original scene changes
+ * frame (see #BKE_scene_graph_update_for_newframe), they have to be evaluated one frame at a time
+ * too. Sound is not updated either, which does not change any evaluated data.
+ */
+bool BKE_scene_graph_frames_are_independent(Depsgraph *depsgraph)
+{
+  Main *bmain = DEG_get_bmain(depsgraph);
+  Scene *scene = DEG_get_input_scene(depsgraph);
+  if (scene->rigidbody_world != NULL) {
+    return false;
+  }
+  if (BKE_callback_is_used(BKE_CB_EVT_FRAME_CHANGE_PRE) ||
+      BKE_callback_is_used(BKE_CB_EVT_FRAME_CHANGE_POST)) {
+    return false;
+  }
+  LISTBASE_FOREACH (Image *, ima, &bmain->images) {
+    if (BKE_image_is_animated(ima)) {
+      return false;
+    }
+  }
+
+  bool is_independent = true;
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         object,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_INDIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET) {
+    /* Point caches cover particles, soft bodies, cloth, dynamic paint and fluid domains. */
+    if (is_independent && BKE_ptcache_object_has(scene, object, 0)) {
+      is_independent = false;
+    }
+  }
+  DEG_OBJECT_ITER_END;
+
+  return is_independent;
+}
+
+/**
+ * Number of dependency graphs to use for evaluating \a frames_num frames with
+ * #BKE_scene_graph_evaluate_frames.
+ */
+int BKE_scene_graph_evaluate_frames_num_graphs(const int frames_num)
+{
+  return max_ii(
+      1, min_iii(BLI_task_scheduler_num_threads(), frames_num, SCENE_GRAPH_FRAMES_MAX_GRAPHS));
+}
+
+/**
+ * Evaluate the scene at all \a frames, using up to \a graphs_num dependency graphs at once.
+ * Every evaluated frame is passed to \a frame_fn on the calling thread, in the order of
+ * \a frames, so writers don't need to be thread-safe.
+ *
+ * \a depsgraph is used as the first graph, the other ones are created for the same scene,
+ * view layer and evaluation mode and built by \a build_fn. Frame `i` is evaluated in graph
+ * `i % graphs_num`, which starts on its next frame as soon as \a frame_fn returned. So while a
+ * frame is written, the following `graphs_num - 1` frames are evaluated in the background and no
+ * more than \a graphs_num evaluated scenes exist at any time. \a frame_fn must only read from the
+ * graph it is given.
+ *
+ * Unlike #BKE_scene_graph_update_for_newframe, the frame of the original scene is not changed and
+ * frame change handlers are not called. Only use this when
+ * #BKE_scene_graph_frames_are_independent returns true.
+ *
+ * \return false when \a frame_fn cancelled the evaluation by returning false.
+ */
+bool BKE_scene_graph_evaluate_frames(Depsgraph *depsgraph,
+                                     const double *frames,
+                                     const int frames_num,
+                                     int graphs_num,
+                                     SceneGraphBuildFn build_fn,
+                                     SceneGraphFrameFn frame_fn,
+                                     void *user_data)
+{
+  Main *bmain = DEG_get_bmain(depsgraph);
+  Scene *scene = DEG_get_input_scene(depsgraph);
+  ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
+  const eEvaluationMode mode = DEG_get_mode(depsgraph);
+
+  graphs_num = max_ii(1, min_ii(graphs_num, frames_num));
+
+  /* Build on this thread, building reads and tags the original data. */
+  Depsgraph **graphs = MEM_malloc_arrayN(graphs_num, sizeof(*graphs), __func__);
+  graphs[0] = depsgraph;
+  for (int i = 1; i < graphs_num; i++) {
+    graphs[i] = DEG_graph_new(bmain, scene, view_layer, mode);
+    build_fn(graphs[i], user_data);
+  }
+
+  SceneGraphFrames frames_data;
+  BLI_mutex_init(&frames_data.mutex);
+  BLI_condition_init(&frames_data.done_cond);
+
+  /* A background pool runs the tasks while this thread waits for a frame or writes it, also when
+   * there is only one thread. */
+  TaskPool *task_pool = BLI_task_pool_create_background(&frames_data, TASK_PRIORITY_HIGH);
+  SceneGraphFrameTask *tasks = MEM_malloc_arrayN(graphs_num, sizeof(*tasks), __func__);
+  for (int i = 0; i < graphs_num; i++) {
+    tasks[i].depsgraph = graphs[i];
+    scene_graph_evaluate_frame_push(task_pool, &tasks[i], frames[i]);
+  }
+
+  bool is_cancelled = false;
+  for (int frame_index = 0; frame_index < frames_num; frame_index++) {
+    /* Later frames may be done first, they wait in their graph until it is their turn. */
+    SceneGraphFrameTask *task = &tasks[frame_index % graphs_num];
+    scene_graph_evaluate_frame_wait(&frames_data, task);
+
+    if (!frame_fn(task->depsgraph, frames[frame_index], user_data)) {
+      is_cancelled = true;
+      break;
+    }
+
+    const int next_frame_index = frame_index + graphs_num;
+    if (next_frame_index < frames_num) {
+      scene_graph_evaluate_frame_push(task_pool, task, frames[next_frame_index]);
+    }
+  }
+
+  /* After cancelling, finish the frames which were already pushed rather than cancelling the
+   * pool, which could leave the caller's graph partially evaluated. */
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+  BLI_condition_end(&frames_data.done_cond);
+  BLI_mutex_end(&frames_data.mutex);
+
+  for (int i = 1; i < graphs_num; i++) {
+    DEG_graph_free(graphs[i]);
+  }
+  MEM_freeN(graphs);
+  MEM_freeN(tasks);
+
+  return !is_cancelled;
+}
+
+/** \} */
+
 /**
  * Ensures given scene/view_layer pair has a valid, up-to-date depsgraph.
  *
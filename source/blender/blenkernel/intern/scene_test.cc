@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "tests/blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_image_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_vector.hh"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_callbacks.h"
+#include "BKE_fcurve.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+namespace blender::bke::tests {
+
+/* Scene with an object moving along X by one unit per frame, starting at frame 1. */
+class SceneGraphFramesTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain;
+  Scene *scene;
+  Object *ob;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+    ob = BKE_object_add(bmain, view_layer, OB_EMPTY, "Object");
+
+    AnimData *adt = BKE_animdata_add_id(&ob->id);
+    adt->action = BKE_action_add(bmain, "Action");
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup("location");
+    fcu->bezt = (BezTriple *)MEM_calloc_arrayN(2, sizeof(BezTriple), __func__);
+    fcu->totvert = 2;
+    for (int i = 0; i < 2; i++) {
+      fcu->bezt[i].vec[1][0] = 1.0f + i * 10.0f;
+      fcu->bezt[i].vec[1][1] = i * 10.0f;
+      fcu->bezt[i].ipo = BEZT_IPO_LIN;
+    }
+    BLI_addtail(&adt->action->curves, fcu);
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    graph_build(depsgraph, nullptr);
+  }
+
+  void TearDown() override
+  {
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_main_free(bmain);
+  }
+
+  static void graph_build(Depsgraph *graph, void *UNUSED(user_data))
+  {
+    DEG_graph_build_from_view_layer(graph);
+  }
+
+  struct FrameResults {
+    Object *ob;
+    Vector<double> frames;
+    Vector<float> locations;
+    /* Cancel the evaluation after this many frames when positive. */
+    int cancel_after_num;
+  };
+
+  static bool frame_result_add(Depsgraph *graph, double frame, void *user_data)
+  {
+    FrameResults *results = (FrameResults *)user_data;
+    results->frames.append(frame);
+    results->locations.append(DEG_get_evaluated_object(graph, results->ob)->obmat[3][0]);
+    return results->frames.size() != results->cancel_after_num;
+  }
+};
+
+static void frame_change_noop(Main *UNUSED(bmain),
+                              PointerRNA **UNUSED(pointers),
+                              const int UNUSED(num_pointers),
+                              void *UNUSED(arg))
+{
+}
+
+static bool frame_change_is_used(void *arg)
+{
+  return *(bool *)arg;
+}
+
+TEST_F(SceneGraphFramesTest, EvaluateFramesMatchesSerial)
+{
+  EXPECT_TRUE(BKE_scene_graph_frames_are_independent(depsgraph));
+
+  const double frames[] = {1.0, 2.0, 3.0, 5.0, 4.0, 8.0, 7.0, 6.0, 10.0};
+  const int frames_num = ARRAY_SIZE(frames);
+  FrameResults results = {ob};
+  EXPECT_TRUE(BKE_scene_graph_evaluate_frames(
+      depsgraph, frames, frames_num, 4, graph_build, frame_result_add, &results));
+
+  /* Frames are passed in order, with the same result as moving the graph to each frame. */
+  ASSERT_EQ(results.frames.size(), frames_num);
+  for (int i = 0; i < frames_num; i++) {
+    EXPECT_EQ(results.frames[i], frames[i]);
+    DEG_evaluate_on_framechange(depsgraph, (float)frames[i]);
+    EXPECT_EQ(results.locations[i], DEG_get_evaluated_object(depsgraph, ob)->obmat[3][0]);
+    EXPECT_EQ(results.locations[i], (float)frames[i] - 1.0f);
+  }
+}
+
+TEST_F(SceneGraphFramesTest, EvaluateFramesCancel)
+{
+  const double frames[] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0};
+  FrameResults results = {ob};
+  results.cancel_after_num = 5;
+  EXPECT_FALSE(BKE_scene_graph_evaluate_frames(
+      depsgraph, frames, ARRAY_SIZE(frames), 3, graph_build, frame_result_add, &results));
+
+  /* No frame is passed after cancelling, the ones before are still in order. */
+  ASSERT_EQ(results.frames.size(), 5);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(results.frames[i], frames[i]);
+    EXPECT_EQ(results.locations[i], (float)frames[i] - 1.0f);
+  }
+}
+
+TEST_F(SceneGraphFramesTest, FrameChangeHandlers)
+{
+  bool is_used = false;
+  bCallbackFuncStore funcstore = {nullptr};
+  funcstore.func = frame_change_noop;
+  funcstore.arg = &is_used;
+  funcstore.is_used = frame_change_is_used;
+  BKE_callback_add(&funcstore, BKE_CB_EVT_FRAME_CHANGE_POST);
+
+  EXPECT_TRUE(BKE_scene_graph_frames_are_independent(depsgraph));
+  is_used = true;
+  EXPECT_FALSE(BKE_scene_graph_frames_are_independent(depsgraph));
+
+  BKE_callback_global_finalize();
+  EXPECT_TRUE(BKE_scene_graph_frames_are_independent(depsgraph));
+}
+
+TEST_F(SceneGraphFramesTest, ImageSequence)
+{
+  Image *ima = (Image *)BKE_id_new(bmain, ID_IM, "Image");
+  EXPECT_TRUE(BKE_scene_graph_frames_are_independent(depsgraph));
+  ima->source = IMA_SRC_SEQUENCE;
+  EXPECT_FALSE(BKE_scene_graph_frames_are_independent(depsgraph));
+}
+
+}  // namespace blender::bke::tests
@@ -23,6 +23,8 @@
 
 #include "BKE_subdiv.h"
 
+#include <string.h>
+
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
@@ -164,13 +166,19 @@ Subdiv *BKE_subdiv_update_from_converter(Subdiv *subdiv,
     can_reuse_subdiv = false;
   }
   if (can_reuse_subdiv) {
+    BKE_subdiv_stats_count(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE_MATCH);
     return subdiv;
   }
-  /* Create new subdiv. */
+  /* Create new subdiv, keeping the counters of the old one. */
+  int counters[NUM_SUBDIV_STATS_COUNTERS] = {0};
   if (subdiv != NULL) {
+    memcpy(counters, subdiv->stats.counters_, sizeof(counters));
+    counters[SUBDIV_STATS_TOPOLOGY_REFINER_REBUILD]++;
     BKE_subdiv_free(subdiv);
   }
-  return BKE_subdiv_new_from_converter(settings, converter);
+  Subdiv *new_subdiv = BKE_subdiv_new_from_converter(settings, converter);
+  memcpy(new_subdiv->stats.counters_, counters, sizeof(counters));
+  return new_subdiv;
 }
 
 Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
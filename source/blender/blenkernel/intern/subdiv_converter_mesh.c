@@ -405,3 +405,72 @@ void BKE_subdiv_converter_init_for_mesh(struct OpenSubdiv_Converter *converter,
   init_functions(converter);
   init_user_data(converter, settings, mesh);
 }
+
+/* Mix a value into the fingerprint. Every step is a bijection of the hash, so changing any
+ * single value always gives a different fingerprint. */
+BLI_INLINE uint64_t fingerprint_mix(uint64_t hash, uint64_t value)
+{
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  hash ^= value;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 29;
+  return hash;
+}
+
+BLI_INLINE uint64_t fingerprint_pair(uint32_t a, uint32_t b)
+{
+  return (uint64_t)a | ((uint64_t)b << 32);
+}
+
+static uint64_t topology_hash_from_mesh(const Mesh *mesh)
+{
+  uint64_t hash = 0;
+  hash = fingerprint_mix(hash, fingerprint_pair(mesh->totvert, mesh->totedge));
+  hash = fingerprint_mix(hash, fingerprint_pair(mesh->totloop, mesh->totpoly));
+  /* Faces. */
+  const MPoly *mpoly = mesh->mpoly;
+  for (int poly_index = 0; poly_index < mesh->totpoly; poly_index++) {
+    hash = fingerprint_mix(
+        hash, fingerprint_pair(mpoly[poly_index].loopstart, mpoly[poly_index].totloop));
+  }
+  const MLoop *mloop = mesh->mloop;
+  for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+    hash = fingerprint_mix(hash, fingerprint_pair(mloop[loop_index].v, mloop[loop_index].e));
+  }
+  /* Edges, with their creases (loose edges also define infinitely sharp vertices). */
+  const MEdge *medge = mesh->medge;
+  for (int edge_index = 0; edge_index < mesh->totedge; edge_index++) {
+    hash = fingerprint_mix(hash, fingerprint_pair(medge[edge_index].v1, medge[edge_index].v2));
+    hash = fingerprint_mix(hash, (uint64_t)medge[edge_index].crease);
+  }
+  /* UV coordinates define the face-varying topology, as seams between UV islands. */
+  const int num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  hash = fingerprint_mix(hash, (uint64_t)num_uv_layers);
+  for (int layer_index = 0; layer_index < num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      uint32_t uv[2];
+      memcpy(uv, mloopuv[loop_index].uv, sizeof(uv));
+      hash = fingerprint_mix(hash, fingerprint_pair(uv[0], uv[1]));
+    }
+  }
+  return hash;
+}
+
+void BKE_subdiv_topology_fingerprint_from_mesh(const Mesh *mesh,
+                                               SubdivTopologyFingerprint *r_fingerprint)
+{
+  r_fingerprint->hash = topology_hash_from_mesh(mesh);
+  r_fingerprint->totvert = mesh->totvert;
+  r_fingerprint->totedge = mesh->totedge;
+  r_fingerprint->totloop = mesh->totloop;
+  r_fingerprint->totpoly = mesh->totpoly;
+}
+
+bool BKE_subdiv_topology_fingerprint_equal(const SubdivTopologyFingerprint *a,
+                                           const SubdivTopologyFingerprint *b)
+{
+  return a->hash == b->hash && a->totvert == b->totvert && a->totedge == b->totedge &&
+         a->totloop == b->totloop && a->totpoly == b->totpoly;
+}
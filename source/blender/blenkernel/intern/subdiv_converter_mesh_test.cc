@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/* The subdivision surface modifier re-uses its descriptor while the fingerprint of its input mesh
+ * stays the same, so it has to change with everything the topology refiner is built from. */
+class SubdivTopologyFingerprintTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+ protected:
+  Mesh *mesh;
+  SubdivTopologyFingerprint fingerprint;
+
+  void SetUp() override
+  {
+    mesh = test_grid_mesh_create(4);
+    MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop);
+    for (int i = 0; i < mesh->totloop; i++) {
+      const float *co = mesh->mvert[mesh->mloop[i].v].co;
+      mloopuv[i].uv[0] = co[0] * 0.25f;
+      mloopuv[i].uv[1] = co[1] * 0.25f;
+    }
+    BKE_subdiv_topology_fingerprint_from_mesh(mesh, &fingerprint);
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, mesh);
+  }
+
+  bool fingerprint_matches(const Mesh *other)
+  {
+    SubdivTopologyFingerprint other_fingerprint;
+    BKE_subdiv_topology_fingerprint_from_mesh(other, &other_fingerprint);
+    return BKE_subdiv_topology_fingerprint_equal(&fingerprint, &other_fingerprint);
+  }
+};
+
+TEST_F(SubdivTopologyFingerprintTest, Unchanged)
+{
+  EXPECT_TRUE(fingerprint_matches(mesh));
+
+  Mesh *mesh_copy = BKE_mesh_copy_for_eval(mesh, false);
+  EXPECT_TRUE(fingerprint_matches(mesh_copy));
+  BKE_id_free(nullptr, mesh_copy);
+}
+
+/* Deformation only pushes new vertex data to the evaluator. */
+TEST_F(SubdivTopologyFingerprintTest, Deform)
+{
+  for (int i = 0; i < mesh->totvert; i++) {
+    mesh->mvert[i].co[2] += (float)i;
+  }
+  EXPECT_TRUE(fingerprint_matches(mesh));
+}
+
+TEST_F(SubdivTopologyFingerprintTest, Crease)
+{
+  mesh->medge[3].crease = 255;
+  EXPECT_FALSE(fingerprint_matches(mesh));
+}
+
+TEST_F(SubdivTopologyFingerprintTest, UV)
+{
+  MLoopUV *mloopuv = (MLoopUV *)CustomData_get_layer(&mesh->ldata, CD_MLOOPUV);
+  mloopuv[5].uv[1] += 0.5f;
+  EXPECT_FALSE(fingerprint_matches(mesh));
+}
+
+TEST_F(SubdivTopologyFingerprintTest, UVLayers)
+{
+  CustomData_add_layer(&mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop);
+  EXPECT_FALSE(fingerprint_matches(mesh));
+  CustomData_free_layers(&mesh->ldata, CD_MLOOPUV, mesh->totloop);
+  EXPECT_FALSE(fingerprint_matches(mesh));
+}
+
+/* Same element counts, but a face is rotated. */
+TEST_F(SubdivTopologyFingerprintTest, Topology)
+{
+  MLoop *ml = &mesh->mloop[mesh->mpoly[2].loopstart];
+  const MLoop ml_first = ml[0];
+  for (int i = 0; i < 3; i++) {
+    ml[i] = ml[i + 1];
+  }
+  ml[3] = ml_first;
+  EXPECT_FALSE(fingerprint_matches(mesh));
+}
+
+TEST_F(SubdivTopologyFingerprintTest, ElementCounts)
+{
+  Mesh *mesh_other = test_grid_mesh_create(5);
+  EXPECT_FALSE(fingerprint_matches(mesh_other));
+  BKE_id_free(nullptr, mesh_other);
+
+  /* Element counts are compared even for colliding hashes. */
+  SubdivTopologyFingerprint other_fingerprint = fingerprint;
+  other_fingerprint.totvert++;
+  EXPECT_FALSE(BKE_subdiv_topology_fingerprint_equal(&fingerprint, &other_fingerprint));
+}
+
+}  // namespace blender::bke::tests
@@ -425,29 +425,69 @@ static void loop_interpolation_end(LoopsForInterpolation *loop_interpolation)
 /** \name TLS
  * \{ */
 
+/* Number of elements interpolated at once by an #InterpolationBatch. */
+#define INTERPOLATION_BATCH_SIZE 32
+
+/* Inner vertices and loops are handed out one at a time, but in runs of consecutive elements
+ * interpolated from the same ptex corner. Their custom data is interpolated for the whole run at
+ * once, so layers are only looked up once per batch. */
+typedef struct InterpolationBatch {
+  /* Index of the first subdivided element, the elements of a batch are consecutive. */
+  int start_index;
+  int count;
+  int indices[INTERPOLATION_BATCH_SIZE][4];
+  float weights[INTERPOLATION_BATCH_SIZE][4];
+  /* Used to evaluate UV layers of loops once their custom data is interpolated. */
+  int ptex_face_index[INTERPOLATION_BATCH_SIZE];
+  float uv[INTERPOLATION_BATCH_SIZE][2];
+} InterpolationBatch;
+
+static bool interpolation_batch_fits(const InterpolationBatch *batch, const int index)
+{
+  return (batch->count == 0) ||
+         (batch->count < INTERPOLATION_BATCH_SIZE && index == batch->start_index + batch->count);
+}
+
+static void interpolation_batch_add(InterpolationBatch *batch,
+                                    const int index,
+                                    const int indices[4],
+                                    const int ptex_face_index,
+                                    const float u,
+                                    const float v)
+{
+  BLI_assert(interpolation_batch_fits(batch, index));
+  if (batch->count == 0) {
+    batch->start_index = index;
+  }
+  const int i = batch->count++;
+  copy_v4_v4_int(batch->indices[i], indices);
+  batch->weights[i][0] = (1.0f - u) * (1.0f - v);
+  batch->weights[i][1] = u * (1.0f - v);
+  batch->weights[i][2] = u * v;
+  batch->weights[i][3] = (1.0f - u) * v;
+  batch->ptex_face_index[i] = ptex_face_index;
+  batch->uv[i][0] = u;
+  batch->uv[i][1] = v;
+}
+
 typedef struct SubdivMeshTLS {
+  SubdivMeshContext *ctx;
+
   bool vertex_interpolation_initialized;
   VerticesForInterpolation vertex_interpolation;
   const MPoly *vertex_interpolation_coarse_poly;
   int vertex_interpolation_coarse_corner;
+  /* Inner vertices interpolated from vertex_interpolation. */
+  InterpolationBatch vertex_batch;
 
   bool loop_interpolation_initialized;
   LoopsForInterpolation loop_interpolation;
   const MPoly *loop_interpolation_coarse_poly;
   int loop_interpolation_coarse_corner;
+  /* Loops interpolated from loop_interpolation. */
+  InterpolationBatch loop_batch;
 } SubdivMeshTLS;
 
-static void subdiv_mesh_tls_free(void *tls_v)
-{
-  SubdivMeshTLS *tls = tls_v;
-  if (tls->vertex_interpolation_initialized) {
-    vertex_interpolation_end(&tls->vertex_interpolation);
-  }
-  if (tls->loop_interpolation_initialized) {
-    loop_interpolation_end(&tls->loop_interpolation);
-  }
-}
-
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -555,13 +595,51 @@ static void subdiv_vertex_data_interpolate(const SubdivMeshContext *ctx,
 {
   const int subdiv_vertex_index = subdiv_vertex - ctx->subdiv_mesh->mvert;
   const float weights[4] = {(1.0f - u) * (1.0f - v), u * (1.0f - v), u * v, (1.0f - u) * v};
-  CustomData_interp(vertex_interpolation->vertex_data,
-                    &ctx->subdiv_mesh->vdata,
-                    vertex_interpolation->vertex_indices,
-                    weights,
-                    NULL,
-                    4,
-                    subdiv_vertex_index);
+  CustomData_interp_indices(vertex_interpolation->vertex_data,
+                            &ctx->subdiv_mesh->vdata,
+                            vertex_interpolation->vertex_indices,
+                            weights,
+                            4,
+                            subdiv_vertex_index,
+                            1);
+  if (ctx->vert_origindex != NULL) {
+    ctx->vert_origindex[subdiv_vertex_index] = ORIGINDEX_NONE;
+  }
+}
+
+static void subdiv_vertex_data_interpolate_flush(const SubdivMeshContext *ctx,
+                                                 SubdivMeshTLS *tls)
+{
+  InterpolationBatch *batch = &tls->vertex_batch;
+  if (batch->count == 0) {
+    return;
+  }
+  CustomData_interp_indices(tls->vertex_interpolation.vertex_data,
+                            &ctx->subdiv_mesh->vdata,
+                            &batch->indices[0][0],
+                            &batch->weights[0][0],
+                            4,
+                            batch->start_index,
+                            batch->count);
+  batch->count = 0;
+}
+
+/* Same as #subdiv_vertex_data_interpolate, but interpolated later as part of a batch. */
+static void subdiv_vertex_data_interpolate_batched(const SubdivMeshContext *ctx,
+                                                   SubdivMeshTLS *tls,
+                                                   const int subdiv_vertex_index,
+                                                   const float u,
+                                                   const float v)
+{
+  if (!interpolation_batch_fits(&tls->vertex_batch, subdiv_vertex_index)) {
+    subdiv_vertex_data_interpolate_flush(ctx, tls);
+  }
+  interpolation_batch_add(&tls->vertex_batch,
+                          subdiv_vertex_index,
+                          tls->vertex_interpolation.vertex_indices,
+                          ORIGINDEX_NONE,
+                          u,
+                          v);
   if (ctx->vert_origindex != NULL) {
     ctx->vert_origindex[subdiv_vertex_index] = ORIGINDEX_NONE;
   }
@@ -705,6 +783,7 @@ static void subdiv_mesh_ensure_vertex_interpolation(SubdivMeshContext *ctx,
   if (tls->vertex_interpolation_initialized) {
     if (tls->vertex_interpolation_coarse_poly != coarse_poly ||
         tls->vertex_interpolation_coarse_corner != coarse_corner) {
+      subdiv_vertex_data_interpolate_flush(ctx, tls);
       vertex_interpolation_end(&tls->vertex_interpolation);
       tls->vertex_interpolation_initialized = false;
     }
@@ -791,7 +870,7 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_mvert = subdiv_mesh->mvert;
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
-  subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
+  subdiv_vertex_data_interpolate_batched(ctx, tls, subdiv_vertex_index, u, v);
   eval_final_point_and_vertex_normal(
       subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
@@ -854,24 +933,6 @@ static void subdiv_mesh_edge(const SubdivForeachContext *foreach_context,
 /** \name Loops creation/interpolation
  * \{ */
 
-static void subdiv_interpolate_loop_data(const SubdivMeshContext *ctx,
-                                         MLoop *subdiv_loop,
-                                         const LoopsForInterpolation *loop_interpolation,
-                                         const float u,
-                                         const float v)
-{
-  const int subdiv_loop_index = subdiv_loop - ctx->subdiv_mesh->mloop;
-  const float weights[4] = {(1.0f - u) * (1.0f - v), u * (1.0f - v), u * v, (1.0f - u) * v};
-  CustomData_interp(loop_interpolation->loop_data,
-                    &ctx->subdiv_mesh->ldata,
-                    loop_interpolation->loop_indices,
-                    weights,
-                    NULL,
-                    4,
-                    subdiv_loop_index);
-  /* TODO(sergey): Set ORIGINDEX. */
-}
-
 static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
                                  MLoop *subdiv_loop,
                                  const int ptex_face_index,
@@ -889,6 +950,29 @@ static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
   }
 }
 
+static void subdiv_interpolate_loop_data_flush(SubdivMeshContext *ctx, SubdivMeshTLS *tls)
+{
+  InterpolationBatch *batch = &tls->loop_batch;
+  if (batch->count == 0) {
+    return;
+  }
+  CustomData_interp_indices(tls->loop_interpolation.loop_data,
+                            &ctx->subdiv_mesh->ldata,
+                            &batch->indices[0][0],
+                            &batch->weights[0][0],
+                            4,
+                            batch->start_index,
+                            batch->count);
+  /* TODO(sergey): Set ORIGINDEX. */
+  /* UV layers are interpolated above as well, evaluate them afterwards. */
+  MLoop *subdiv_loop = &ctx->subdiv_mesh->mloop[batch->start_index];
+  for (int i = 0; i < batch->count; i++, subdiv_loop++) {
+    subdiv_eval_uv_layer(
+        ctx, subdiv_loop, batch->ptex_face_index[i], batch->uv[i][0], batch->uv[i][1]);
+  }
+  batch->count = 0;
+}
+
 static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
                                                   SubdivMeshTLS *tls,
                                                   const MPoly *coarse_poly,
@@ -898,6 +982,7 @@ static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
   if (tls->loop_interpolation_initialized) {
     if (tls->loop_interpolation_coarse_poly != coarse_poly ||
         tls->loop_interpolation_coarse_corner != coarse_corner) {
+      subdiv_interpolate_loop_data_flush(ctx, tls);
       loop_interpolation_end(&tls->loop_interpolation);
       tls->loop_interpolation_initialized = false;
     }
@@ -938,8 +1023,16 @@ static void subdiv_mesh_loop(const SubdivForeachContext *foreach_context,
   MLoop *subdiv_mloop = subdiv_mesh->mloop;
   MLoop *subdiv_loop = &subdiv_mloop[subdiv_loop_index];
   subdiv_mesh_ensure_loop_interpolation(ctx, tls, coarse_poly, coarse_corner);
-  subdiv_interpolate_loop_data(ctx, subdiv_loop, &tls->loop_interpolation, u, v);
-  subdiv_eval_uv_layer(ctx, subdiv_loop, ptex_face_index, u, v);
+  /* Custom data and UV layers are interpolated and evaluated with the rest of the batch. */
+  if (!interpolation_batch_fits(&tls->loop_batch, subdiv_loop_index)) {
+    subdiv_interpolate_loop_data_flush(ctx, tls);
+  }
+  interpolation_batch_add(&tls->loop_batch,
+                          subdiv_loop_index,
+                          tls->loop_interpolation.loop_indices,
+                          ptex_face_index,
+                          u,
+                          v);
   subdiv_loop->v = subdiv_vertex_index;
   subdiv_loop->e = subdiv_edge_index;
 }
@@ -1160,6 +1253,19 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
 /** \name Initialization
  * \{ */
 
+static void subdiv_mesh_tls_free(void *tls_v)
+{
+  SubdivMeshTLS *tls = tls_v;
+  if (tls->vertex_interpolation_initialized) {
+    subdiv_vertex_data_interpolate_flush(tls->ctx, tls);
+    vertex_interpolation_end(&tls->vertex_interpolation);
+  }
+  if (tls->loop_interpolation_initialized) {
+    subdiv_interpolate_loop_data_flush(tls->ctx, tls);
+    loop_interpolation_end(&tls->loop_interpolation);
+  }
+}
+
 static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
                                     SubdivForeachContext *foreach_context)
 {
@@ -1223,6 +1329,7 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   SubdivForeachContext foreach_context;
   setup_foreach_callbacks(&subdiv_context, &foreach_context);
   SubdivMeshTLS tls = {0};
+  tls.ctx = &subdiv_context;
   foreach_context.user_data = &subdiv_context;
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
   foreach_context.user_data_tls = &tls;
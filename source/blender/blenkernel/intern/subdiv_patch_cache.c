@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "BKE_subdiv_patch_cache.h"
+
+#include <string.h>
+
+#include "DNA_mesh_types.h"
+
+#include "BLI_utildefines.h"
+
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_eval.h"
+#include "BKE_subdiv_foreach.h"
+#include "BKE_subdiv_mesh.h"
+
+#include "MEM_guardedalloc.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Callbacks
+ * \{ */
+
+static bool patch_cache_topology_info(const SubdivForeachContext *foreach_context,
+                                      const int num_vertices,
+                                      const int UNUSED(num_edges),
+                                      const int num_loops,
+                                      const int num_polygons)
+{
+  SubdivPatchCache *cache = foreach_context->user_data;
+  cache->num_vertices = num_vertices;
+  cache->num_faces = num_polygons;
+  cache->num_face_vertices = num_loops;
+  cache->vertex_patch_coords = MEM_malloc_arrayN(
+      num_vertices, sizeof(*cache->vertex_patch_coords), "subdiv patch coords");
+  cache->face_offsets = MEM_malloc_arrayN(
+      num_polygons + 1, sizeof(*cache->face_offsets), "subdiv face offsets");
+  cache->face_vertices = MEM_malloc_arrayN(
+      num_loops, sizeof(*cache->face_vertices), "subdiv face vertices");
+  cache->face_origindex = MEM_malloc_arrayN(
+      num_polygons, sizeof(*cache->face_origindex), "subdiv face origindex");
+  cache->face_offsets[num_polygons] = num_loops;
+  return true;
+}
+
+static void patch_cache_vertex_set(const SubdivForeachContext *foreach_context,
+                                   const int ptex_face_index,
+                                   const float u,
+                                   const float v,
+                                   const int subdiv_vertex_index)
+{
+  SubdivPatchCache *cache = foreach_context->user_data;
+  SubdivPatchCoord *patch_coord = &cache->vertex_patch_coords[subdiv_vertex_index];
+  patch_coord->ptex_face_index = ptex_face_index;
+  patch_coord->u = u;
+  patch_coord->v = v;
+}
+
+static void patch_cache_vertex_corner(const SubdivForeachContext *foreach_context,
+                                      void *UNUSED(tls),
+                                      const int ptex_face_index,
+                                      const float u,
+                                      const float v,
+                                      const int UNUSED(coarse_vertex_index),
+                                      const int UNUSED(coarse_poly_index),
+                                      const int UNUSED(coarse_corner),
+                                      const int subdiv_vertex_index)
+{
+  patch_cache_vertex_set(foreach_context, ptex_face_index, u, v, subdiv_vertex_index);
+}
+
+static void patch_cache_vertex_edge(const SubdivForeachContext *foreach_context,
+                                    void *UNUSED(tls),
+                                    const int ptex_face_index,
+                                    const float u,
+                                    const float v,
+                                    const int UNUSED(coarse_edge_index),
+                                    const int UNUSED(coarse_poly_index),
+                                    const int UNUSED(coarse_corner),
+                                    const int subdiv_vertex_index)
+{
+  patch_cache_vertex_set(foreach_context, ptex_face_index, u, v, subdiv_vertex_index);
+}
+
+static void patch_cache_vertex_inner(const SubdivForeachContext *foreach_context,
+                                     void *UNUSED(tls),
+                                     const int ptex_face_index,
+                                     const float u,
+                                     const float v,
+                                     const int UNUSED(coarse_poly_index),
+                                     const int UNUSED(coarse_corner),
+                                     const int subdiv_vertex_index)
+{
+  patch_cache_vertex_set(foreach_context, ptex_face_index, u, v, subdiv_vertex_index);
+}
+
+static void patch_cache_vertex_loose(const SubdivForeachContext *foreach_context,
+                                     void *UNUSED(tls),
+                                     const int UNUSED(coarse_vertex_index),
+                                     const int subdiv_vertex_index)
+{
+  patch_cache_vertex_set(
+      foreach_context, SUBDIV_PATCH_COORD_LOOSE, 0.0f, 0.0f, subdiv_vertex_index);
+}
+
+static void patch_cache_vertex_of_loose_edge(const SubdivForeachContext *foreach_context,
+                                             void *UNUSED(tls),
+                                             const int UNUSED(coarse_edge_index),
+                                             const float u,
+                                             const int subdiv_vertex_index)
+{
+  patch_cache_vertex_set(foreach_context, SUBDIV_PATCH_COORD_LOOSE, u, 0.0f, subdiv_vertex_index);
+}
+
+static void patch_cache_loop(const SubdivForeachContext *foreach_context,
+                             void *UNUSED(tls),
+                             const int UNUSED(ptex_face_index),
+                             const float UNUSED(u),
+                             const float UNUSED(v),
+                             const int UNUSED(coarse_loop_index),
+                             const int UNUSED(coarse_poly_index),
+                             const int UNUSED(coarse_corner),
+                             const int subdiv_loop_index,
+                             const int subdiv_vertex_index,
+                             const int UNUSED(subdiv_edge_index))
+{
+  SubdivPatchCache *cache = foreach_context->user_data;
+  cache->face_vertices[subdiv_loop_index] = subdiv_vertex_index;
+}
+
+static void patch_cache_poly(const SubdivForeachContext *foreach_context,
+                             void *UNUSED(tls),
+                             const int coarse_poly_index,
+                             const int subdiv_poly_index,
+                             const int start_loop_index,
+                             const int UNUSED(num_loops))
+{
+  SubdivPatchCache *cache = foreach_context->user_data;
+  cache->face_offsets[subdiv_poly_index] = start_loop_index;
+  cache->face_origindex[subdiv_poly_index] = coarse_poly_index;
+}
+
+static void setup_foreach_callbacks(SubdivForeachContext *foreach_context)
+{
+  memset(foreach_context, 0, sizeof(*foreach_context));
+  foreach_context->topology_info = patch_cache_topology_info;
+  /* Vertices on coarse corners and edges are only stored once, the limit surface is the same
+   * from every ptex face sharing them. */
+  foreach_context->vertex_corner = patch_cache_vertex_corner;
+  foreach_context->vertex_edge = patch_cache_vertex_edge;
+  foreach_context->vertex_inner = patch_cache_vertex_inner;
+  foreach_context->vertex_loose = patch_cache_vertex_loose;
+  foreach_context->vertex_of_loose_edge = patch_cache_vertex_of_loose_edge;
+  foreach_context->loop = patch_cache_loop;
+  foreach_context->poly = patch_cache_poly;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+SubdivPatchCache *BKE_subdiv_to_patch_cache(Subdiv *subdiv,
+                                            const SubdivToMeshSettings *settings,
+                                            const Mesh *coarse_mesh)
+{
+  BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_PATCH_CACHE);
+  /* Same as for the mesh, the evaluator is needed by consumers sampling the cache. */
+  if (!BKE_subdiv_eval_begin_from_mesh(subdiv, coarse_mesh, NULL)) {
+    if (coarse_mesh->totpoly) {
+      BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_PATCH_CACHE);
+      return NULL;
+    }
+  }
+  SubdivPatchCache *cache = MEM_callocN(sizeof(SubdivPatchCache), "subdiv patch cache");
+  cache->subdiv = subdiv;
+  SubdivForeachContext foreach_context;
+  setup_foreach_callbacks(&foreach_context);
+  foreach_context.user_data = cache;
+  if (!BKE_subdiv_foreach_subdiv_geometry(subdiv, &foreach_context, settings, coarse_mesh)) {
+    BKE_subdiv_patch_cache_free(cache);
+    BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_PATCH_CACHE);
+    return NULL;
+  }
+  subdiv->stats.patch_cache_memory = BKE_subdiv_patch_cache_memory_size(cache);
+  BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_PATCH_CACHE);
+  return cache;
+}
+
+void BKE_subdiv_patch_cache_free(SubdivPatchCache *cache)
+{
+  MEM_SAFE_FREE(cache->vertex_patch_coords);
+  MEM_SAFE_FREE(cache->face_offsets);
+  MEM_SAFE_FREE(cache->face_vertices);
+  MEM_SAFE_FREE(cache->face_origindex);
+  MEM_freeN(cache);
+}
+
+size_t BKE_subdiv_patch_cache_memory_size(const SubdivPatchCache *cache)
+{
+  size_t size = sizeof(*cache);
+  if (cache->vertex_patch_coords != NULL) {
+    size += sizeof(*cache->vertex_patch_coords) * (size_t)cache->num_vertices;
+    size += sizeof(*cache->face_offsets) * (size_t)(cache->num_faces + 1);
+    size += sizeof(*cache->face_vertices) * (size_t)cache->num_face_vertices;
+    size += sizeof(*cache->face_origindex) * (size_t)cache->num_faces;
+  }
+  return size;
+}
+
+bool BKE_subdiv_patch_cache_eval_vertex(const SubdivPatchCache *cache,
+                                        const int vertex_index,
+                                        float r_P[3])
+{
+  BLI_assert(vertex_index >= 0 && vertex_index < cache->num_vertices);
+  const SubdivPatchCoord *patch_coord = &cache->vertex_patch_coords[vertex_index];
+  if (patch_coord->ptex_face_index == SUBDIV_PATCH_COORD_LOOSE) {
+    return false;
+  }
+  BKE_subdiv_eval_limit_point(
+      cache->subdiv, patch_coord->ptex_face_index, patch_coord->u, patch_coord->v, r_P);
+  return true;
+}
+
+bool BKE_subdiv_patch_cache_eval_vertex_and_normal(const SubdivPatchCache *cache,
+                                                   const int vertex_index,
+                                                   float r_P[3],
+                                                   float r_N[3])
+{
+  BLI_assert(vertex_index >= 0 && vertex_index < cache->num_vertices);
+  const SubdivPatchCoord *patch_coord = &cache->vertex_patch_coords[vertex_index];
+  if (patch_coord->ptex_face_index == SUBDIV_PATCH_COORD_LOOSE) {
+    return false;
+  }
+  BKE_subdiv_eval_limit_point_and_normal(
+      cache->subdiv, patch_coord->ptex_face_index, patch_coord->u, patch_coord->v, r_P, r_N);
+  return true;
+}
+
+/** \} */
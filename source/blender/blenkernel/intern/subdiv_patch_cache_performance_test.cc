@@ -0,0 +1,120 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cstdio>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_mesh.h"
+#include "BKE_subdiv_patch_cache.h"
+
+#include "PIL_time.h"
+
+#include "tests/BKE_subdiv_test_utils.hh"
+
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::tests {
+
+class SubdivPatchCachePerformanceTest : public SubdivTest {
+};
+
+/* Compare creating a full mesh with creating a patch cache and evaluating all of its vertices. */
+static void test_patch_cache_performance(const int grid_size, const int level)
+{
+  printf("\n========== STARTING %s (%d quads, level %d) ==========\n",
+         __func__,
+         grid_size * grid_size,
+         level);
+
+  Mesh *coarse_mesh = test_wavy_grid_mesh_create(grid_size);
+  Subdiv *subdiv = test_subdiv_create(coarse_mesh);
+  ASSERT_NE(subdiv, nullptr);
+
+  SubdivToMeshSettings mesh_settings;
+  mesh_settings.resolution = (1 << level) + 1;
+  mesh_settings.use_optimal_display = false;
+
+  /* Create the evaluator up-front, so it isn't part of either timing. */
+  Mesh *mesh = BKE_subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh);
+  BKE_id_free(nullptr, mesh);
+
+  const size_t mem_mesh_begin = MEM_get_memory_in_use();
+  double time_begin = PIL_check_seconds_timer();
+  mesh = BKE_subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh);
+  const double time_mesh = PIL_check_seconds_timer() - time_begin;
+  const size_t mem_mesh = MEM_get_memory_in_use() - mem_mesh_begin;
+
+  time_begin = PIL_check_seconds_timer();
+  SubdivPatchCache *cache = BKE_subdiv_to_patch_cache(subdiv, &mesh_settings, coarse_mesh);
+  const double time_cache = PIL_check_seconds_timer() - time_begin;
+  ASSERT_NE(cache, nullptr);
+
+  time_begin = PIL_check_seconds_timer();
+  float co_sum[3] = {0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < cache->num_vertices; i++) {
+    float co[3];
+    BKE_subdiv_patch_cache_eval_vertex(cache, i, co);
+    co_sum[0] += co[0];
+    co_sum[1] += co[1];
+    co_sum[2] += co[2];
+  }
+  const double time_cache_eval = PIL_check_seconds_timer() - time_begin;
+
+  printf("Subdivision to mesh: %f (sec), %.2f (MB)\n",
+         time_mesh,
+         (double)mem_mesh / (1024.0 * 1024.0));
+  printf("Subdivision to patch cache: %f (sec), %.2f (MB), sampling all vertices: %f (sec)\n",
+         time_cache,
+         (double)BKE_subdiv_patch_cache_memory_size(cache) / (1024.0 * 1024.0),
+         time_cache_eval);
+  EXPECT_TRUE(std::isfinite(co_sum[0] + co_sum[1] + co_sum[2]));
+
+  BKE_subdiv_patch_cache_free(cache);
+  BKE_id_free(nullptr, mesh);
+  BKE_subdiv_free(subdiv);
+  BKE_id_free(nullptr, coarse_mesh);
+
+  printf("========== ENDED %s ==========\n\n", __func__);
+}
+
+TEST_F(SubdivPatchCachePerformanceTest, performance_100_level_3)
+{
+  test_patch_cache_performance(10, 3);
+}
+
+TEST_F(SubdivPatchCachePerformanceTest, performance_10000_level_3)
+{
+  test_patch_cache_performance(100, 3);
+}
+
+TEST_F(SubdivPatchCachePerformanceTest, performance_10000_level_5)
+{
+  test_patch_cache_performance(100, 5);
+}
+
+}  // namespace blender::bke::tests
+
+#endif /* WITH_OPENSUBDIV */
@@ -0,0 +1,80 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_mesh.h"
+#include "BKE_subdiv_patch_cache.h"
+
+#include "tests/BKE_subdiv_test_utils.hh"
+
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::tests {
+
+class SubdivPatchCacheTest : public SubdivTest {
+};
+
+TEST_F(SubdivPatchCacheTest, MatchesMesh)
+{
+  Mesh *coarse_mesh = test_wavy_grid_mesh_create(8);
+  Subdiv *subdiv = test_subdiv_create(coarse_mesh);
+  ASSERT_NE(subdiv, nullptr);
+
+  SubdivToMeshSettings mesh_settings;
+  mesh_settings.resolution = (1 << 2) + 1;
+  mesh_settings.use_optimal_display = false;
+
+  Mesh *mesh = BKE_subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh);
+  SubdivPatchCache *cache = BKE_subdiv_to_patch_cache(subdiv, &mesh_settings, coarse_mesh);
+  ASSERT_NE(mesh, nullptr);
+  ASSERT_NE(cache, nullptr);
+
+  EXPECT_EQ(cache->num_vertices, mesh->totvert);
+  EXPECT_EQ(cache->num_faces, mesh->totpoly);
+  EXPECT_EQ(cache->num_face_vertices, mesh->totloop);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    EXPECT_EQ(cache->face_offsets[i], mesh->mpoly[i].loopstart);
+    EXPECT_EQ(cache->face_offsets[i + 1] - cache->face_offsets[i], mesh->mpoly[i].totloop);
+  }
+  for (int i = 0; i < mesh->totloop; i++) {
+    EXPECT_EQ(cache->face_vertices[i], mesh->mloop[i].v);
+  }
+  for (int i = 0; i < mesh->totvert; i++) {
+    float co[3];
+    EXPECT_TRUE(BKE_subdiv_patch_cache_eval_vertex(cache, i, co));
+    EXPECT_V3_NEAR(co, mesh->mvert[i].co, 1e-5f);
+  }
+
+  BKE_subdiv_patch_cache_free(cache);
+  BKE_id_free(nullptr, mesh);
+  BKE_subdiv_free(subdiv);
+  BKE_id_free(nullptr, coarse_mesh);
+}
+
+}  // namespace blender::bke::tests
+
+#endif /* WITH_OPENSUBDIV */
@@ -37,6 +37,11 @@ void BKE_subdiv_stats_init(SubdivStats *stats)
   stats->subdiv_to_ccg_time = 0.0;
   stats->subdiv_to_ccg_elements_time = 0.0;
   stats->topology_compare_time = 0.0;
+  stats->subdiv_to_patch_cache_time = 0.0;
+  stats->topology_fingerprint_match_count = 0;
+  stats->topology_compare_match_count = 0;
+  stats->topology_refiner_rebuild_count = 0;
+  stats->patch_cache_memory = 0;
 }
 
 void BKE_subdiv_stats_begin(SubdivStats *stats, eSubdivStatsValue value)
@@ -54,6 +59,11 @@ void BKE_subdiv_stats_reset(SubdivStats *stats, eSubdivStatsValue value)
   stats->values_[value] = 0.0;
 }
 
+void BKE_subdiv_stats_count(SubdivStats *stats, eSubdivStatsCounter counter)
+{
+  stats->counters_[counter]++;
+}
+
 void BKE_subdiv_stats_print(const SubdivStats *stats)
 {
 #define STATS_PRINT_TIME(stats, value, description) \
@@ -63,6 +73,13 @@ void BKE_subdiv_stats_print(const SubdivStats *stats)
     } \
   } while (false)
 
+#define STATS_PRINT_COUNT(stats, value, description) \
+  do { \
+    if ((stats)->value > 0) { \
+      printf("  %s: %d\n", description, (stats)->value); \
+    } \
+  } while (false)
+
   printf("Subdivision surface statistics:\n");
 
   STATS_PRINT_TIME(stats, topology_refiner_creation_time, "Topology refiner creation time");
@@ -73,6 +90,14 @@ void BKE_subdiv_stats_print(const SubdivStats *stats)
   STATS_PRINT_TIME(stats, subdiv_to_ccg_time, "Subdivision to CCG time");
   STATS_PRINT_TIME(stats, subdiv_to_ccg_elements_time, "    Elements time");
   STATS_PRINT_TIME(stats, topology_compare_time, "Topology comparison time");
+  STATS_PRINT_TIME(stats, subdiv_to_patch_cache_time, "Subdivision to patch cache time");
+  STATS_PRINT_COUNT(stats, topology_fingerprint_match_count, "Topology fingerprint matches");
+  STATS_PRINT_COUNT(stats, topology_compare_match_count, "Topology comparison matches");
+  STATS_PRINT_COUNT(stats, topology_refiner_rebuild_count, "Topology refiner re-creations");
+  if (stats->patch_cache_memory > 0) {
+    printf("  Patch cache memory: %.2f (MB)\n", (double)stats->patch_cache_memory / (1024 * 1024));
+  }
 
 #undef STATS_PRINT_TIME
+#undef STATS_PRINT_COUNT
 }
@@ -0,0 +1,156 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Meshes used by the correctness and performance tests of mesh normals.
+ */
+
+#include <cmath>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+
+#include "BKE_mesh.h"
+
+namespace blender::bke::tests {
+
+/* Closed torus of `size * size` quads, so every vertex has a full fan of smooth loops. */
+struct MeshNormalsTestContext {
+  int size;
+  int verts_len, edges_len, loops_len, polys_len;
+  MVert *mvert;
+  MEdge *medge;
+  MLoop *mloop;
+  MPoly *mpoly;
+  float (*poly_normals)[3];
+  float (*loop_normals)[3];
+};
+
+/* Tag random edges as sharp and random faces as flat when \a rng is given. */
+inline void test_mesh_normals_init(MeshNormalsTestContext *ctx,
+                                   const int size,
+                                   RandomNumberGenerator *rng)
+{
+  ctx->size = size;
+  ctx->verts_len = size * size;
+  ctx->edges_len = size * size * 2;
+  ctx->polys_len = size * size;
+  ctx->loops_len = ctx->polys_len * 4;
+  ctx->mvert = (MVert *)MEM_calloc_arrayN(ctx->verts_len, sizeof(MVert), __func__);
+  ctx->medge = (MEdge *)MEM_calloc_arrayN(ctx->edges_len, sizeof(MEdge), __func__);
+  ctx->mloop = (MLoop *)MEM_calloc_arrayN(ctx->loops_len, sizeof(MLoop), __func__);
+  ctx->mpoly = (MPoly *)MEM_calloc_arrayN(ctx->polys_len, sizeof(MPoly), __func__);
+  ctx->poly_normals = (float(*)[3])MEM_malloc_arrayN(ctx->polys_len, sizeof(float[3]), __func__);
+  ctx->loop_normals = (float(*)[3])MEM_malloc_arrayN(ctx->loops_len, sizeof(float[3]), __func__);
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int v = y * size + x;
+      const float u_angle = 2.0f * (float)M_PI * x / size;
+      const float v_angle = 2.0f * (float)M_PI * y / size;
+      const float radius = rng ? 1.0f + 0.2f * rng->get_float() : 1.0f;
+      float *co = ctx->mvert[v].co;
+      co[0] = (3.0f + radius * cosf(v_angle)) * cosf(u_angle);
+      co[1] = (3.0f + radius * cosf(v_angle)) * sinf(u_angle);
+      co[2] = radius * sinf(v_angle);
+
+      MEdge *me = &ctx->medge[v * 2];
+      me[0].v1 = v;
+      me[0].v2 = y * size + (x + 1) % size;
+      me[1].v1 = v;
+      me[1].v2 = ((y + 1) % size) * size + x;
+      if (rng && rng->get_float() < 0.1f) {
+        me[0].flag |= ME_SHARP;
+      }
+    }
+  }
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int p = y * size + x;
+      const int x_next = (x + 1) % size;
+      const int y_next = (y + 1) % size;
+      MPoly *mp = &ctx->mpoly[p];
+      mp->loopstart = p * 4;
+      mp->totloop = 4;
+      mp->flag = (rng && rng->get_float() < 0.05f) ? 0 : ME_SMOOTH;
+
+      MLoop *ml = &ctx->mloop[mp->loopstart];
+      ml[0].v = y * size + x;
+      ml[0].e = (y * size + x) * 2;
+      ml[1].v = y * size + x_next;
+      ml[1].e = (y * size + x_next) * 2 + 1;
+      ml[2].v = y_next * size + x_next;
+      ml[2].e = (y_next * size + x) * 2;
+      ml[3].v = y_next * size + x;
+      ml[3].e = (y * size + x) * 2 + 1;
+    }
+  }
+
+  BKE_mesh_calc_normals_poly(ctx->mvert,
+                             nullptr,
+                             ctx->verts_len,
+                             ctx->mloop,
+                             ctx->mpoly,
+                             ctx->loops_len,
+                             ctx->polys_len,
+                             ctx->poly_normals,
+                             false);
+}
+
+inline void test_mesh_normals_free(MeshNormalsTestContext *ctx)
+{
+  MEM_freeN(ctx->mvert);
+  MEM_freeN(ctx->medge);
+  MEM_freeN(ctx->mloop);
+  MEM_freeN(ctx->mpoly);
+  MEM_freeN(ctx->poly_normals);
+  MEM_freeN(ctx->loop_normals);
+}
+
+inline void test_mesh_normals_loop_split(MeshNormalsTestContext *ctx,
+                                         const float split_angle,
+                                         MLoopNorSpaceArray *r_lnors_spacearr)
+{
+  BKE_mesh_normals_loop_split(ctx->mvert,
+                              ctx->verts_len,
+                              ctx->medge,
+                              ctx->edges_len,
+                              ctx->mloop,
+                              ctx->loop_normals,
+                              ctx->loops_len,
+                              ctx->mpoly,
+                              ctx->poly_normals,
+                              ctx->polys_len,
+                              true,
+                              split_angle,
+                              r_lnors_spacearr,
+                              nullptr,
+                              nullptr);
+}
+
+}  // namespace blender::bke::tests
@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Meshes used by the tests of mesh algorithms and modifiers.
+ */
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_mesh.h"
+
+namespace blender::bke::tests {
+
+/**
+ * Grid of `size * size` quads in the XY plane, vertices are at whole numbers from zero to `size`.
+ * Vertices and polys are ordered row by row. The grid is repeated \a copies times at the same
+ * place, each copy using its own vertices, for tests of overlapping geometry.
+ *
+ * Positions are expected to be changed by the test afterwards, the vertex at `(x, y)` of a copy
+ * is `copy * (size + 1) * (size + 1) + y * (size + 1) + x`.
+ */
+inline Mesh *test_grid_mesh_create(const int size, const int copies = 1)
+{
+  const int grid_verts_len = (size + 1) * (size + 1);
+  const int grid_polys_len = size * size;
+  Mesh *mesh = BKE_mesh_new_nomain(grid_verts_len * copies,
+                                   0,
+                                   0,
+                                   grid_polys_len * copies * 4,
+                                   grid_polys_len * copies);
+  for (int copy = 0; copy < copies; copy++) {
+    const int vert_offset = grid_verts_len * copy;
+    for (int y = 0; y <= size; y++) {
+      for (int x = 0; x <= size; x++) {
+        float *co = mesh->mvert[vert_offset + y * (size + 1) + x].co;
+        co[0] = (float)x;
+        co[1] = (float)y;
+        co[2] = 0.0f;
+      }
+    }
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        const int poly_index = grid_polys_len * copy + y * size + x;
+        MPoly *mp = &mesh->mpoly[poly_index];
+        mp->loopstart = poly_index * 4;
+        mp->totloop = 4;
+        MLoop *ml = &mesh->mloop[mp->loopstart];
+        ml[0].v = vert_offset + y * (size + 1) + x;
+        ml[1].v = vert_offset + y * (size + 1) + x + 1;
+        ml[2].v = vert_offset + (y + 1) * (size + 1) + x + 1;
+        ml[3].v = vert_offset + (y + 1) * (size + 1) + x;
+      }
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+}  // namespace blender::bke::tests
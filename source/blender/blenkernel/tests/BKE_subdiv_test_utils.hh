@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Meshes and subdivision surfaces used by the correctness and performance tests of subdivision.
+ */
+
+#include <cmath>
+
+#include "testing/testing.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_subdiv.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/* Fixture initializing the ID types and the subdivision library for the test cases. */
+class SubdivTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_subdiv_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_subdiv_exit();
+  }
+};
+
+/* Wavy grid of `size * size` quads. */
+inline Mesh *test_wavy_grid_mesh_create(const int size)
+{
+  Mesh *mesh = test_grid_mesh_create(size);
+  for (int i = 0; i < mesh->totvert; i++) {
+    float *co = mesh->mvert[i].co;
+    co[2] = sinf(co[0] * 0.3f) * cosf(co[1] * 0.3f);
+  }
+  return mesh;
+}
+
+inline Subdiv *test_subdiv_create(const Mesh *mesh)
+{
+  SubdivSettings settings;
+  settings.is_simple = false;
+  settings.is_adaptive = true;
+  settings.level = 2;
+  settings.use_creases = false;
+  settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_ONLY;
+  settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_ALL;
+  return BKE_subdiv_new_from_mesh(&settings, mesh);
+}
+
+}  // namespace blender::bke::tests
@@ -40,6 +40,17 @@ BArrayState *BLI_array_store_state_add(BArrayStore *bs,
                                        const void *data,
                                        const size_t data_len,
                                        const BArrayState *state_reference);
+
+typedef struct BArrayStateAddParams {
+  BArrayStore *bs;
+  const void *data;
+  size_t data_len;
+  const BArrayState *state_reference;
+  /** The new state is written here. */
+  BArrayState **r_state;
+} BArrayStateAddParams;
+
+void BLI_array_store_state_add_many(BArrayStateAddParams *params, const unsigned int params_len);
 void BLI_array_store_state_remove(BArrayStore *bs, BArrayState *state);
 
 size_t BLI_array_store_state_size_get(BArrayState *state);
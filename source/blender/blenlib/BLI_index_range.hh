@@ -58,10 +58,15 @@
 
 #include "BLI_utildefines.h"
 
+#ifdef WITH_TBB
+/* oneTBB declares tbb::blocked_range as an alias, which can't be forward declared. */
+#  include <tbb/blocked_range.h>
+#else
 /* Forward declare tbb::blocked_range for conversion operations. */
 namespace tbb {
 template<typename Value> class blocked_range;
 }
+#endif
 
 namespace blender {
 
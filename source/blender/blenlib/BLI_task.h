@@ -132,6 +132,36 @@ typedef void (*TaskParallelReduceFunc)(const void *__restrict userdata,
 
 typedef void (*TaskParallelFreeFunc)(const void *__restrict userdata, void *__restrict chunk);
 
+/* Adaptive grain size for a parallel range call-site, declared as a static variable there:
+ *
+ *   static TaskParallelAdaptive adaptive = {"my_function"};
+ *   settings.adaptive = &adaptive;
+ *
+ * The time spent in each chunk of iterations is measured, and the grain size of the next calls
+ * is adjusted so that chunks are long enough for the threading overhead to be negligible.
+ * Once a grain size was measured, ranges that don't fill more than one chunk run in the calling
+ * thread, without going through the scheduler.
+ * Statistics are gathered for every call-site, see #BLI_task_parallel_adaptive_stats_print.
+ */
+typedef struct TaskParallelAdaptive {
+  /* Name of the call-site, used when printing statistics. */
+  const char *name;
+  /* Grain size used for the next call, zero until the first call was measured. */
+  int grain_size;
+
+  /* Statistics, accumulated over all calls. */
+  uint64_t calls_num;
+  uint64_t iterations_num;
+  uint64_t chunks_num;
+  /* Time spent in chunks on all threads, and wall-clock time of the calls, in seconds. */
+  double time_chunks;
+  double time_total;
+
+  /* Registered call-sites, for printing statistics. */
+  struct TaskParallelAdaptive *next;
+  bool is_registered;
+} TaskParallelAdaptive;
+
 typedef struct TaskParallelSettings {
   /* Whether caller allows to do threading of the particular range.
    * Usually set by some equation, which forces threading off when threading
@@ -166,6 +196,9 @@ typedef struct TaskParallelSettings {
    * having a global use_threading switch based on just range size.
    */
   int min_iter_per_thread;
+  /* When set, the grain size is tuned at runtime for this call-site,
+   * #min_iter_per_thread is then only used for the first call. */
+  TaskParallelAdaptive *adaptive;
 } TaskParallelSettings;
 
 BLI_INLINE void BLI_parallel_range_settings_defaults(TaskParallelSettings *settings);
@@ -176,6 +209,17 @@ void BLI_task_parallel_range(const int start,
                              TaskParallelRangeFunc func,
                              const TaskParallelSettings *settings);
 
+int BLI_task_parallel_adaptive_grain_size(TaskParallelAdaptive *adaptive,
+                                          const int64_t range_len,
+                                          const int grain_size_init,
+                                          bool *r_is_measured);
+void BLI_task_parallel_adaptive_update(TaskParallelAdaptive *adaptive,
+                                       const int64_t iterations_num,
+                                       const int64_t chunks_num,
+                                       const double time_chunks,
+                                       const double time_total);
+void BLI_task_parallel_adaptive_stats_print(void);
+
 /* This data is shared between all tasks, its access needs thread lock or similar protection.
  */
 typedef struct TaskParallelIteratorStateShared {
@@ -41,9 +41,14 @@
 #  endif
 #endif
 
+#include <atomic>
+
 #include "BLI_index_range.hh"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
+#include "PIL_time.h"
+
 namespace blender {
 
 template<typename Range, typename Function>
@@ -75,4 +80,50 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
 #endif
 }
 
+/**
+ * Same as above, but the grain size is tuned at runtime from the time spent in each chunk,
+ * see #TaskParallelAdaptive. The \a adaptive state is usually a static variable of the caller.
+ */
+template<typename Function>
+void parallel_for(IndexRange range, TaskParallelAdaptive &adaptive, const Function &function)
+{
+  if (range.size() == 0) {
+    return;
+  }
+  const double time_start = PIL_check_seconds_timer();
+#ifdef WITH_TBB
+  bool is_measured;
+  const int64_t grain_size = BLI_task_parallel_adaptive_grain_size(
+      &adaptive, range.size(), 0, &is_measured);
+  if (is_measured && range.size() <= grain_size) {
+    /* The whole range fits in a single chunk, run it in the calling thread. */
+    function(range);
+    const double time = PIL_check_seconds_timer() - time_start;
+    BLI_task_parallel_adaptive_update(&adaptive, range.size(), 1, time, time);
+    return;
+  }
+  std::atomic<int64_t> chunks_num{0};
+  std::atomic<double> time_chunks{0.0};
+  tbb::parallel_for(tbb::blocked_range<int64_t>(range.first(), range.one_after_last(), grain_size),
+                    [&](const tbb::blocked_range<int64_t> &subrange) {
+                      const double time_chunk_start = PIL_check_seconds_timer();
+                      function(IndexRange(subrange.begin(), subrange.size()));
+                      const double time = PIL_check_seconds_timer() - time_chunk_start;
+                      double time_prev = time_chunks.load();
+                      while (!time_chunks.compare_exchange_weak(time_prev, time_prev + time)) {
+                      }
+                      chunks_num++;
+                    });
+  BLI_task_parallel_adaptive_update(&adaptive,
+                                    range.size(),
+                                    chunks_num,
+                                    time_chunks,
+                                    PIL_check_seconds_timer() - time_start);
+#else
+  function(range);
+  const double time = PIL_check_seconds_timer() - time_start;
+  BLI_task_parallel_adaptive_update(&adaptive, range.size(), 1, time, time);
+#endif
+}
+
 }  // namespace blender
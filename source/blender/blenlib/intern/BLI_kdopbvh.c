@@ -30,6 +30,8 @@
  *
  * - Ray-cast:
  *   #BLI_bvhtree_ray_cast, #BVHRayCastData
+ * - Packet ray-cast:
+ *   #BLI_bvhtree_ray_cast_batch, #BVHRayCastPacket
  * - Nearest point on surface:
  *   #BLI_bvhtree_find_nearest, #BVHNearestData
  * - Overlapping 2 trees:
@@ -38,12 +40,19 @@
  *   #BLI_bvhtree_range_query
  */
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_alloca.h"
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -97,9 +106,12 @@ struct BVHTree {
   float epsilon;       /* epslion is used for inflation of the k-dop      */
   int totleaf;         /* leafs */
   int totbranch;
-  axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
-  axis_t axis;                  /* kdop type (6 => OBB, 7 => AABB, ...) */
-  char tree_type;               /* type of tree (4 => quadtree) */
+  /* bvhtree_kdop_axes array indices according to axis (at most 13, packed to make room for
+   * build_flag) */
+  axis_t start_axis : 4, stop_axis : 4;
+  axis_t axis;     /* kdop type (6 => OBB, 7 => AABB, ...) */
+  char tree_type;  /* type of tree (4 => quadtree) */
+  char build_flag; /* BVH_BUILD_* flags */
 };
 
 /* optimization, ensure we stay small */
@@ -863,14 +875,328 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Binned SAH Build
+ *
+ * Optional build (#BVH_BUILD_SAH) which splits nodes using the surface area heuristic,
+ * evaluated over a fixed number of bins along each of the X/Y/Z axes.
+ *
+ * Unlike #non_recursive_bvh_div_nodes the resulting tree isn't implicit (sub-trees don't hold a
+ * predictable number of leafs), so branches are allocated as they are created.
+ * Branches are always allocated after their parent, so children keep having an index greater
+ * than their parent, as #BLI_bvhtree_update_tree relies on that.
+ *
+ * The first levels are split breadth first on a single thread,
+ * once there are enough independent sub-trees they are built in parallel.
+ * \{ */
+
+#define BVH_SAH_BINS 16
+/* Number of sub-trees to collect before building them in parallel. */
+#define BVH_SAH_PARALLEL_SUBTREES 256
+
+typedef struct BVHBuildRange {
+  BVHNode *node;
+  /* Range of leafs in the leafs array. */
+  int begin, end;
+} BVHBuildRange;
+
+typedef struct BVHSAHBuildData {
+  BVHTree *tree;
+  BVHNode **leafs_array;
+  /* Sub-trees built in parallel. */
+  const BVHBuildRange *subtrees;
+  /* Index of the next free branch in #BVHTree.nodearray. */
+  int branch_next;
+} BVHSAHBuildData;
+
+typedef struct BVHSAHBin {
+  float bv[6];
+  int count;
+} BVHSAHBin;
+
+BLI_INLINE float bvh_sah_centroid(const BVHNode *node, const int axis)
+{
+  return (node->bv[2 * axis] + node->bv[2 * axis + 1]) * 0.5f;
+}
+
+BLI_INLINE void bvh_sah_bv_init(float bv[6])
+{
+  bv[0] = bv[2] = bv[4] = FLT_MAX;
+  bv[1] = bv[3] = bv[5] = -FLT_MAX;
+}
+
+BLI_INLINE void bvh_sah_bv_join(float bv[6], const float bv_other[6])
+{
+  for (int i = 0; i < 6; i += 2) {
+    bv[i] = min_ff(bv[i], bv_other[i]);
+    bv[i + 1] = max_ff(bv[i + 1], bv_other[i + 1]);
+  }
+}
+
+/* Half the surface area, only used for comparisons. */
+BLI_INLINE float bvh_sah_bv_area(const float bv[6])
+{
+  const float x = bv[1] - bv[0], y = bv[3] - bv[2], z = bv[5] - bv[4];
+  return (x * y) + (y * z) + (z * x);
+}
+
+BLI_INLINE int bvh_sah_bin_index(const float centroid, const float min, const float scale)
+{
+  const int bin = (int)((centroid - min) * scale);
+  return min_ii(max_ii(bin, 0), BVH_SAH_BINS - 1);
+}
+
+/**
+ * Split the leafs in `[begin, end)` in two, using the binned surface area heuristic.
+ *
+ * \return The first leaf of the second half.
+ */
+static int bvh_sah_split(BVHNode **leafs_array, const int begin, const int end, int *r_axis)
+{
+  float centroid_bv[6];
+  float best_cost = FLT_MAX;
+  int best_axis = -1, best_bin = 0;
+  int i, axis;
+
+  bvh_sah_bv_init(centroid_bv);
+  for (i = begin; i < end; i++) {
+    for (axis = 0; axis < 3; axis++) {
+      const float centroid = bvh_sah_centroid(leafs_array[i], axis);
+      centroid_bv[2 * axis] = min_ff(centroid_bv[2 * axis], centroid);
+      centroid_bv[2 * axis + 1] = max_ff(centroid_bv[2 * axis + 1], centroid);
+    }
+  }
+
+  for (axis = 0; axis < 3; axis++) {
+    const float extent = centroid_bv[2 * axis + 1] - centroid_bv[2 * axis];
+    if (!(extent > FLT_EPSILON)) {
+      continue;
+    }
+    const float scale = (float)BVH_SAH_BINS / extent;
+
+    BVHSAHBin bins[BVH_SAH_BINS];
+    for (i = 0; i < BVH_SAH_BINS; i++) {
+      bvh_sah_bv_init(bins[i].bv);
+      bins[i].count = 0;
+    }
+    for (i = begin; i < end; i++) {
+      BVHSAHBin *bin = &bins[bvh_sah_bin_index(
+          bvh_sah_centroid(leafs_array[i], axis), centroid_bv[2 * axis], scale)];
+      bvh_sah_bv_join(bin->bv, leafs_array[i]->bv);
+      bin->count++;
+    }
+
+    /* Sweep from the right, storing the cost of everything after each split. */
+    float right_cost[BVH_SAH_BINS - 1];
+    float bv[6];
+    int count = 0;
+    bvh_sah_bv_init(bv);
+    for (i = BVH_SAH_BINS - 1; i > 0; i--) {
+      bvh_sah_bv_join(bv, bins[i].bv);
+      count += bins[i].count;
+      right_cost[i - 1] = count ? bvh_sah_bv_area(bv) * (float)count : 0.0f;
+    }
+
+    /* Sweep from the left, splitting after bin `i`. */
+    count = 0;
+    bvh_sah_bv_init(bv);
+    for (i = 0; i < BVH_SAH_BINS - 1; i++) {
+      bvh_sah_bv_join(bv, bins[i].bv);
+      count += bins[i].count;
+      if (count == 0 || count == end - begin) {
+        continue;
+      }
+      const float cost = bvh_sah_bv_area(bv) * (float)count + right_cost[i];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = i;
+      }
+    }
+  }
+
+  if (best_axis == -1) {
+    /* All centroids are (nearly) the same, split in the middle. */
+    const int mid = (begin + end) / 2;
+    *r_axis = 0;
+    partition_nth_element(leafs_array, begin, end, mid, 0);
+    return mid;
+  }
+
+  /* Partition in place, leafs in bins up to `best_bin` come first. */
+  const float min = centroid_bv[2 * best_axis];
+  const float scale = (float)BVH_SAH_BINS /
+                      (centroid_bv[2 * best_axis + 1] - centroid_bv[2 * best_axis]);
+  int mid = begin;
+  for (i = begin; i < end; i++) {
+    if (bvh_sah_bin_index(bvh_sah_centroid(leafs_array[i], best_axis), min, scale) <= best_bin) {
+      SWAP(BVHNode *, leafs_array[i], leafs_array[mid]);
+      mid++;
+    }
+  }
+  BLI_assert(mid > begin && mid < end);
+
+  *r_axis = best_axis;
+  return mid;
+}
+
+/**
+ * Calculate the bounds of `range->node`, split its leafs into up to `tree_type` children
+ * and link them. Children with more than one leaf are allocated as new branches,
+ * which are returned in \a r_children to be split further.
+ */
+static int bvh_sah_build_node(BVHSAHBuildData *data,
+                              const BVHBuildRange *range,
+                              BVHBuildRange r_children[MAX_TREETYPE])
+{
+  BVHTree *tree = data->tree;
+  BVHNode *parent = range->node;
+  int ranges_begin[MAX_TREETYPE + 1];
+  int ranges_len = 1;
+  int i, k;
+
+  refit_kdop_hull(tree, parent, range->begin, range->end);
+
+  /* Split the biggest range until there is one range for each child. */
+  ranges_begin[0] = range->begin;
+  ranges_begin[1] = range->end;
+  while (ranges_len < tree->tree_type) {
+    int split = -1, split_size = 1;
+    for (i = 0; i < ranges_len; i++) {
+      const int size = ranges_begin[i + 1] - ranges_begin[i];
+      if (size > split_size) {
+        split = i;
+        split_size = size;
+      }
+    }
+    if (split == -1) {
+      break;
+    }
+
+    int axis;
+    const int mid = bvh_sah_split(
+        data->leafs_array, ranges_begin[split], ranges_begin[split + 1], &axis);
+    if (ranges_len == 1) {
+      parent->main_axis = (char)axis;
+    }
+
+    memmove(&ranges_begin[split + 2],
+            &ranges_begin[split + 1],
+            sizeof(*ranges_begin) * (size_t)(ranges_len - split));
+    ranges_begin[split + 1] = mid;
+    ranges_len++;
+  }
+
+  int children_len = 0;
+  for (k = 0; k < ranges_len; k++) {
+    const int child_begin = ranges_begin[k];
+    const int child_end = ranges_begin[k + 1];
+
+    if (child_end - child_begin == 1) {
+      parent->children[k] = data->leafs_array[child_begin];
+    }
+    else {
+      const int branch_index = atomic_fetch_and_add_int32(&data->branch_next, 1);
+      BLI_assert(branch_index < tree->totleaf * 2);
+      parent->children[k] = &tree->nodearray[branch_index];
+
+      BVHBuildRange *child_range = &r_children[children_len++];
+      child_range->node = parent->children[k];
+      child_range->begin = child_begin;
+      child_range->end = child_end;
+    }
+    parent->children[k]->parent = parent;
+  }
+  parent->totnode = (char)ranges_len;
+
+  return children_len;
+}
+
+static void bvh_sah_build_subtree_task_cb(void *__restrict userdata,
+                                          const int index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHSAHBuildData *data = userdata;
+  BVHBuildRange children[MAX_TREETYPE];
+
+  BLI_Stack *stack = BLI_stack_new(sizeof(BVHBuildRange), __func__);
+  BLI_stack_push(stack, &data->subtrees[index]);
+
+  while (!BLI_stack_is_empty(stack)) {
+    BVHBuildRange range;
+    BLI_stack_pop(stack, &range);
+
+    const int children_len = bvh_sah_build_node(data, &range, children);
+    for (int i = 0; i < children_len; i++) {
+      BLI_stack_push(stack, &children[i]);
+    }
+  }
+
+  BLI_stack_free(stack);
+}
+
+/**
+ * Build the tree from the given leafs (at least two), the root is the first branch.
+ *
+ * \return The number of branches used.
+ */
+static int bvh_sah_build(BVHTree *tree, BVHNode **leafs_array, int num_leafs)
+{
+  BVHSAHBuildData data = {
+      .tree = tree,
+      .leafs_array = leafs_array,
+      .subtrees = NULL,
+      .branch_next = tree->totleaf + 1,
+  };
+
+  BVHNode *root = &tree->nodearray[tree->totleaf];
+  root->parent = NULL;
+
+  /* Split breadth first until there are enough sub-trees to build in parallel.
+   * Each range in the queue is a branch, so there can't be more ranges than leafs. */
+  BVHBuildRange *queue = MEM_malloc_arrayN((size_t)num_leafs, sizeof(*queue), __func__);
+  int queue_begin = 0, queue_end = 0;
+
+  queue[queue_end].node = root;
+  queue[queue_end].begin = 0;
+  queue[queue_end].end = num_leafs;
+  queue_end++;
+
+  while ((queue_begin != queue_end) && (queue_end - queue_begin < BVH_SAH_PARALLEL_SUBTREES)) {
+    queue_end += bvh_sah_build_node(&data, &queue[queue_begin], &queue[queue_end]);
+    queue_begin++;
+  }
+
+  data.subtrees = &queue[queue_begin];
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (num_leafs > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, queue_end - queue_begin, &data, bvh_sah_build_subtree_task_cb, &settings);
+
+  MEM_freeN(queue);
+
+  return data.branch_next - tree->totleaf;
+}
+
+#undef BVH_SAH_BINS
+#undef BVH_SAH_PARALLEL_SUBTREES
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
 
 /**
+ * \param build_flag: #BVH_BUILD_SAH to build a tree optimized for queries,
+ * see #bvh_sah_build.
+ *
  * \note many callers don't check for ``NULL`` return.
  */
-BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int build_flag)
 {
   BVHTree *tree;
   int numnodes, i;
@@ -889,6 +1215,7 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
     tree->epsilon = epsilon;
     tree->tree_type = tree_type;
     tree->axis = axis;
+    tree->build_flag = (char)build_flag;
 
     if (axis == 26) {
       tree->start_axis = 0;
@@ -918,7 +1245,13 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
     }
 
     /* Allocate arrays */
-    numnodes = maxsize + implicit_needed_branches(tree_type, maxsize) + tree_type;
+    if (build_flag & BVH_BUILD_SAH) {
+      /* Sub-trees aren't always full, in the worst case there is a branch for each leaf. */
+      numnodes = maxsize + max_ii(1, maxsize) + tree_type;
+    }
+    else {
+      numnodes = maxsize + implicit_needed_branches(tree_type, maxsize) + tree_type;
+    }
 
     tree->nodes = MEM_callocN(sizeof(BVHNode *) * (size_t)numnodes, "BVHNodes");
     tree->nodebv = MEM_callocN(sizeof(float) * (size_t)(axis * numnodes), "BVHNodeBV");
@@ -942,6 +1275,11 @@ fail:
   return NULL;
 }
 
+BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+{
+  return BLI_bvhtree_new_ex(maxsize, epsilon, tree_type, axis, 0);
+}
+
 void BLI_bvhtree_free(BVHTree *tree)
 {
   if (tree) {
@@ -961,13 +1299,19 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+  if ((tree->build_flag & BVH_BUILD_SAH) && (tree->totleaf > 1) && (tree->start_axis == 0)) {
+    /* The SAH build only bins along the X/Y/Z axes, 18-DOP trees use the implicit tree. */
+    tree->totbranch = bvh_sah_build(tree, leafs_array, tree->totleaf);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+  }
 
   /* current code expects the branches to be linked to the nodes array
    * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
   for (int i = 0; i < tree->totbranch; i++) {
     tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
   }
@@ -1038,11 +1382,55 @@ bool BLI_bvhtree_update_node(
   return true;
 }
 
+typedef struct BVHUpdateTreeData {
+  BVHTree *tree;
+  /* Number of children of each branch which have been updated. */
+  int *branch_children_done;
+} BVHUpdateTreeData;
+
+static void bvhtree_update_tree_task_cb(void *__restrict userdata,
+                                        const int leaf_index,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHUpdateTreeData *data = userdata;
+  BVHTree *tree = data->tree;
+
+  /* Walk up from the leaf, the last child to finish joins its parent. */
+  for (BVHNode *node = tree->nodes[leaf_index]->parent; node; node = node->parent) {
+    const int branch_index = (int)(node - tree->nodearray) - tree->totleaf;
+    if (atomic_add_and_fetch_int32(&data->branch_children_done[branch_index], 1) !=
+        node->totnode) {
+      break;
+    }
+    node_join(tree, node);
+  }
+}
+
 /**
  * Call #BLI_bvhtree_update_node() first for every node/point/triangle.
+ *
+ * \note Large trees are refitted in parallel, branches are joined as soon as all their children
+ * are up to date. #BLI_bvhtree_update_node may be called from multiple threads as well,
+ * as long as each thread updates different nodes.
  */
 void BLI_bvhtree_update_tree(BVHTree *tree)
 {
+  if ((tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD) && (tree->totleaf > 1)) {
+    BVHUpdateTreeData data = {
+        .tree = tree,
+        .branch_children_done = MEM_calloc_arrayN(
+            (size_t)tree->totbranch, sizeof(int), __func__),
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, tree->totleaf, &data, bvhtree_update_tree_task_cb, &settings);
+
+    MEM_freeN(data.branch_children_done);
+    return;
+  }
+
   /* Update bottom=>top
    * TRICKY: the way we build the tree all the children have an index greater than the parent
    * This allows us todo a bottom up update by starting on the bigger numbered branch. */
@@ -1076,6 +1464,25 @@ float BLI_bvhtree_get_epsilon(const BVHTree *tree)
   return tree->epsilon;
 }
 
+/**
+ * Bounds of the root node, for all trees using the X/Y/Z axes (all but 18-DOP).
+ * Empty trees have zero bounds.
+ */
+void BLI_bvhtree_get_bounding_box(const BVHTree *tree, float r_bb_min[3], float r_bb_max[3])
+{
+  BLI_assert(tree->start_axis == 0);
+  const BVHNode *root = (tree->totbranch > 0) ? tree->nodes[tree->totleaf] : NULL;
+  if (root == NULL) {
+    zero_v3(r_bb_min);
+    zero_v3(r_bb_max);
+    return;
+  }
+  for (int i = 0; i < 3; i++) {
+    r_bb_min[i] = root->bv[2 * i];
+    r_bb_max[i] = root->bv[2 * i + 1];
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -2058,6 +2465,300 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_batch
+ *
+ * Packet ray-cast: coherent rays share one DFS over the tree,
+ * the slab test against each node is done for the whole packet at once (using SSE2 when
+ * available). Only rays with matching direction signs are grouped, as they share the near/far
+ * slab indices. When a packet diverges down to a single active ray, traversal continues with the
+ * regular #dfs_raycast for that ray.
+ *
+ * \{ */
+
+#define BVH_RAYCAST_PACKET_SIZE 4
+
+typedef struct BVHRayCastPacket {
+  BVHRayCastData rays[BVH_RAYCAST_PACKET_SIZE];
+
+  /* Structure of arrays copies of the ray data, used by the packet slab test. */
+  float origin[3][BVH_RAYCAST_PACKET_SIZE];
+  float idot_axis[3][BVH_RAYCAST_PACKET_SIZE];
+
+  /* Near/far slab indices, shared by all rays of the active mask. */
+  int index[6];
+} BVHRayCastPacket;
+
+typedef struct BVHRayCastBatchData {
+  const BVHTree *tree;
+  const float (*co)[3];
+  const float (*dir)[3];
+  int rays_num;
+  float radius;
+  BVHTreeRayHit *hits;
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHRayCastBatchData;
+
+/* Bit-mask with one bit per axis, set when the ray goes in the negative direction. */
+static int ray_cast_data_octant(const BVHRayCastData *data)
+{
+  return (data->index[0] & 1) | ((data->index[2] & 1) << 1) | ((data->index[4] & 1) << 2);
+}
+
+/**
+ * Packet version of #fast_ray_nearest_hit, tests all rays in \a active against \a node.
+ *
+ * \return The mask of the rays which hit the bounding volume closer than their current hit,
+ * \a r_dist is filled in for those rays.
+ */
+static int packet_ray_nearest_hit(const BVHRayCastPacket *packet,
+                                  const BVHNode *node,
+                                  const int active,
+                                  float r_dist[BVH_RAYCAST_PACKET_SIZE])
+{
+  const float *bv = node->bv;
+  int result = 0;
+
+#ifdef __SSE2__
+  const __m128 hit_dist = _mm_setr_ps(packet->rays[0].hit.dist,
+                                      packet->rays[1].hit.dist,
+                                      packet->rays[2].hit.dist,
+                                      packet->rays[3].hit.dist);
+  const __m128 zero = _mm_setzero_ps();
+  __m128 t1[3], t2[3];
+
+  for (int i = 0; i < 3; i++) {
+    const __m128 origin = _mm_loadu_ps(packet->origin[i]);
+    const __m128 idot = _mm_loadu_ps(packet->idot_axis[i]);
+    t1[i] = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[packet->index[2 * i]]), origin), idot);
+    t2[i] = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[packet->index[2 * i + 1]]), origin), idot);
+  }
+
+  /* Same conditions as #fast_ray_nearest_hit. */
+  __m128 miss = _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[1]), _mm_cmplt_ps(t2[0], t1[1]));
+  miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[2]), _mm_cmplt_ps(t2[0], t1[2])));
+  miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[1], t2[2]), _mm_cmplt_ps(t2[1], t1[2])));
+  miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmplt_ps(t2[0], zero), _mm_cmplt_ps(t2[1], zero)));
+  miss = _mm_or_ps(miss, _mm_cmplt_ps(t2[2], zero));
+  miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[0], hit_dist), _mm_cmpgt_ps(t1[1], hit_dist)));
+  miss = _mm_or_ps(miss, _mm_cmpgt_ps(t1[2], hit_dist));
+
+  const __m128 dist = _mm_max_ps(_mm_max_ps(t1[0], t1[1]), t1[2]);
+  const __m128 closer = _mm_andnot_ps(miss, _mm_cmplt_ps(dist, hit_dist));
+
+  _mm_storeu_ps(r_dist, dist);
+  result = _mm_movemask_ps(closer) & active;
+#else
+  for (int i = 0; i < BVH_RAYCAST_PACKET_SIZE; i++) {
+    if (active & (1 << i)) {
+      r_dist[i] = fast_ray_nearest_hit(&packet->rays[i], node);
+      if (r_dist[i] < packet->rays[i].hit.dist) {
+        result |= (1 << i);
+      }
+    }
+  }
+#endif
+
+  return result;
+}
+
+static void dfs_raycast_packet(BVHRayCastPacket *packet, BVHNode *node, int active)
+{
+  float dist[BVH_RAYCAST_PACKET_SIZE];
+  int i;
+
+  active = packet_ray_nearest_hit(packet, node, active, dist);
+  if (active == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    while (active) {
+      BVHRayCastData *data = &packet->rays[bitscan_forward_clear_i(&active)];
+      const int ray_index = (int)(data - packet->rays);
+      if (data->callback) {
+        data->callback(data->userdata, node->index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = node->index;
+        data->hit.dist = dist[ray_index];
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[ray_index]);
+      }
+    }
+    return;
+  }
+
+  /* All rays in the mask have the same direction signs, use the first one to pick the order. */
+  const BVHRayCastData *data_first = &packet->rays[bitscan_forward_i(active)];
+  const bool forward = data_first->ray_dot_axis[node->main_axis] > 0.0f;
+
+  if (count_bits_i((uint)active) == 1) {
+    /* The packet diverged, continue with a single ray. */
+    BVHRayCastData *data = &packet->rays[bitscan_forward_i(active)];
+    if (forward) {
+      for (i = 0; i != node->totnode; i++) {
+        dfs_raycast(data, node->children[i]);
+      }
+    }
+    else {
+      for (i = node->totnode - 1; i >= 0; i--) {
+        dfs_raycast(data, node->children[i]);
+      }
+    }
+    return;
+  }
+
+  if (forward) {
+    for (i = 0; i != node->totnode; i++) {
+      dfs_raycast_packet(packet, node->children[i], active);
+    }
+  }
+  else {
+    for (i = node->totnode - 1; i >= 0; i--) {
+      dfs_raycast_packet(packet, node->children[i], active);
+    }
+  }
+}
+
+static void bvhtree_ray_cast_batch_packet(const BVHRayCastBatchData *batch,
+                                          BVHRayCastPacket *packet,
+                                          const int ray_start,
+                                          const int rays_num)
+{
+  BVHNode *root = batch->tree->nodes[batch->tree->totleaf];
+  int i;
+
+  for (i = 0; i < BVH_RAYCAST_PACKET_SIZE; i++) {
+    BVHRayCastData *data = &packet->rays[i];
+
+    if (i >= rays_num) {
+      /* Padding, these lanes are never part of the active mask. */
+      data->hit.index = -1;
+      data->hit.dist = 0.0f;
+      for (int axis = 0; axis < 3; axis++) {
+        packet->origin[axis][i] = 0.0f;
+        packet->idot_axis[axis][i] = 0.0f;
+      }
+      continue;
+    }
+
+    data->tree = batch->tree;
+    data->callback = batch->callback;
+    data->userdata = batch->userdata;
+
+    BLI_ASSERT_UNIT_V3(batch->dir[ray_start + i]);
+    copy_v3_v3(data->ray.origin, batch->co[ray_start + i]);
+    copy_v3_v3(data->ray.direction, batch->dir[ray_start + i]);
+    data->ray.radius = batch->radius;
+
+    bvhtree_ray_cast_data_precalc(data, batch->flag);
+    memcpy(&data->hit, &batch->hits[ray_start + i], sizeof(data->hit));
+
+    for (int axis = 0; axis < 3; axis++) {
+      packet->origin[axis][i] = data->ray.origin[axis];
+      packet->idot_axis[axis][i] = data->idot_axis[axis];
+    }
+  }
+
+  if (root) {
+    if (batch->radius != 0.0f) {
+      /* #fast_ray_nearest_hit doesn't support a radius, neither does the packet test. */
+      for (i = 0; i < rays_num; i++) {
+        dfs_raycast(&packet->rays[i], root);
+      }
+    }
+    else {
+      /* Trace each group of rays sharing direction signs as a packet. */
+      int remaining = (1 << rays_num) - 1;
+      while (remaining) {
+        const BVHRayCastData *data_first = &packet->rays[bitscan_forward_i(remaining)];
+        const int octant = ray_cast_data_octant(data_first);
+        int active = 0;
+        for (i = 0; i < rays_num; i++) {
+          if ((remaining & (1 << i)) && (ray_cast_data_octant(&packet->rays[i]) == octant)) {
+            active |= (1 << i);
+          }
+        }
+        remaining &= ~active;
+
+        memcpy(packet->index, data_first->index, sizeof(packet->index));
+        if (count_bits_i((uint)active) == 1) {
+          dfs_raycast(&packet->rays[bitscan_forward_i(active)], root);
+        }
+        else {
+          dfs_raycast_packet(packet, root, active);
+        }
+      }
+    }
+  }
+
+  for (i = 0; i < rays_num; i++) {
+    memcpy(&batch->hits[ray_start + i], &packet->rays[i].hit, sizeof(BVHTreeRayHit));
+  }
+}
+
+static void bvhtree_ray_cast_batch_task_cb(void *__restrict userdata,
+                                           const int packet_index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRayCastBatchData *batch = userdata;
+  BVHRayCastPacket packet;
+
+  const int ray_start = packet_index * BVH_RAYCAST_PACKET_SIZE;
+  const int rays_num = min_ii(BVH_RAYCAST_PACKET_SIZE, batch->rays_num - ray_start);
+
+  bvhtree_ray_cast_batch_packet(batch, &packet, ray_start, rays_num);
+}
+
+/**
+ * Cast many rays at once, tracing coherent rays as packets.
+ *
+ * This gives the same results as calling #BLI_bvhtree_ray_cast_ex for each ray,
+ * it's faster when neighboring rays in the arrays take similar paths through the tree
+ * (as is the case for bake and projection rays).
+ *
+ * \param hits: Array of \a rays_num hits, which must be initialized by the caller
+ * (index & dist), the same way as the \a hit argument of #BLI_bvhtree_ray_cast_ex.
+ * \param flag: #BVH_RAYCAST_USE_THREADING may be used when \a callback is thread-safe.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                const int rays_num,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag)
+{
+  BVHRayCastBatchData batch = {
+      .tree = tree,
+      .co = co,
+      .dir = dir,
+      .rays_num = rays_num,
+      .radius = radius,
+      .hits = hits,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  const int packets_num = (rays_num + BVH_RAYCAST_PACKET_SIZE - 1) / BVH_RAYCAST_PACKET_SIZE;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (flag & BVH_RAYCAST_USE_THREADING) &&
+                           (rays_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, packets_num, &batch, bvhtree_ray_cast_batch_task_cb, &settings);
+}
+
+#undef BVH_RAYCAST_PACKET_SIZE
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
@@ -104,6 +104,7 @@
 
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BLI_strict_flags.h"
 
@@ -173,6 +174,18 @@
  */
 #define BCHUNK_HASH_TABLE_MUL 3
 
+/* Hash arrays with multiple threads when they are at least this many items long,
+ * each thread handling blocks of this length.
+ */
+#define BCHUNK_HASH_PARALLEL_BLOCK_LEN (1 << 16)
+
+/* Use the CRC32C instruction to hash 4 bytes at once (when supported by the target CPU).
+ */
+#ifdef __SSE4_2__
+#  include <nmmintrin.h>
+#  define USE_HASH_CRC32C
+#endif
+
 /* Merge too small/large chunks:
  *
  * Using this means chunks below a threshold will be merged together.
@@ -753,13 +766,41 @@ BLI_INLINE uint hash_data_single(const uchar p)
   return ((HASH_INIT << 5) + HASH_INIT) + (unsigned int)(*((signed char *)&p));
 }
 
-/* hash bytes, from BLI_ghashutil_strhash_n */
+#ifndef USE_HASH_CRC32C
+#  define HASH_PRIME_1 (2654435761u)
+#  define HASH_PRIME_2 (2246822519u)
+
+/* Single round of xxHash32, mixing 4 bytes into the hash. */
+BLI_INLINE uint hash_data_word(uint h, const uint word)
+{
+  h += word * HASH_PRIME_2;
+  h = (h << 13) | (h >> 19);
+  return h * HASH_PRIME_1;
+}
+
+#  undef HASH_PRIME_1
+#  undef HASH_PRIME_2
+#endif
+
+/**
+ * Hash bytes, 4 at a time (most strides are a multiple of 4 bytes),
+ * the remaining bytes are hashed like #BLI_ghashutil_strhash_n.
+ */
 static uint hash_data(const uchar *key, size_t n)
 {
-  const signed char *p;
   unsigned int h = HASH_INIT;
 
-  for (p = (const signed char *)key; n--; p++) {
+  for (; n >= sizeof(uint); key += sizeof(uint), n -= sizeof(uint)) {
+    uint word;
+    memcpy(&word, key, sizeof(word));
+#ifdef USE_HASH_CRC32C
+    h = _mm_crc32_u32(h, word);
+#else
+    h = hash_data_word(h, word);
+#endif
+  }
+
+  for (const signed char *p = (const signed char *)key; n--; p++) {
     h = ((h << 5) + h) + (unsigned int)*p;
   }
 
@@ -774,6 +815,7 @@ static void hash_array_from_data(const BArrayInfo *info,
                                  const size_t data_slice_len,
                                  hash_key *hash_array)
 {
+  /* The loops are kept free of dependencies between items, so they can be vectorized. */
   if (info->chunk_stride != 1) {
     for (size_t i = 0, i_step = 0; i_step < data_slice_len; i++, i_step += info->chunk_stride) {
       hash_array[i] = hash_data(&data_slice[i_step], info->chunk_stride);
@@ -833,6 +875,106 @@ static void hash_accum(hash_key *hash_array, const size_t hash_array_len, size_t
   }
 }
 
+typedef struct HashArrayParallelData {
+  const BArrayInfo *info;
+  const uchar *data;
+  hash_key *hash_array;
+  size_t hash_array_len;
+  /** Values following each block, read before they are modified by the next block. */
+  hash_key *block_tails;
+  size_t hash_offset;
+  size_t hash_array_search_len;
+} HashArrayParallelData;
+
+static void hash_array_from_data_parallel_cb(void *__restrict userdata,
+                                             const int index,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const HashArrayParallelData *data = userdata;
+  const size_t i_start = (size_t)index * BCHUNK_HASH_PARALLEL_BLOCK_LEN;
+  const size_t i_end = MIN2(i_start + BCHUNK_HASH_PARALLEL_BLOCK_LEN, data->hash_array_len);
+  const size_t stride = data->info->chunk_stride;
+  hash_array_from_data(data->info,
+                       &data->data[i_start * stride],
+                       (i_end - i_start) * stride,
+                       &data->hash_array[i_start]);
+}
+
+static void hash_accum_parallel_cb(void *__restrict userdata,
+                                   const int index,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const HashArrayParallelData *data = userdata;
+  hash_key *hash_array = data->hash_array;
+  const hash_key *block_tail = &data->block_tails[(size_t)index * data->hash_offset];
+  const size_t hash_offset = data->hash_offset;
+  const size_t i_start = (size_t)index * BCHUNK_HASH_PARALLEL_BLOCK_LEN;
+  const size_t i_end = MIN2(i_start + BCHUNK_HASH_PARALLEL_BLOCK_LEN,
+                            data->hash_array_search_len);
+  const size_t i_tail = MAX2(i_start, i_end - hash_offset);
+
+  for (size_t i = i_start; i < i_tail; i++) {
+    hash_array[i] += (hash_array[i + hash_offset]) * ((hash_array[i] & 0xff) + 1);
+  }
+  /* The next block may have been accumulated already, use the values it had before. */
+  for (size_t i = i_tail; i < i_end; i++) {
+    hash_array[i] += (block_tail[i + hash_offset - i_end]) * ((hash_array[i] & 0xff) + 1);
+  }
+}
+
+/**
+ * Same as #hash_array_from_data followed by #hash_accum,
+ * using multiple threads for big arrays.
+ */
+static void hash_array_from_data_accum(const BArrayInfo *info,
+                                       const uchar *data_slice,
+                                       const size_t data_slice_len,
+                                       hash_key *hash_array,
+                                       size_t iter_steps)
+{
+  const size_t hash_array_len = data_slice_len / info->chunk_stride;
+  if (hash_array_len < BCHUNK_HASH_PARALLEL_BLOCK_LEN * 2) {
+    hash_array_from_data(info, data_slice, data_slice_len, hash_array);
+    hash_accum(hash_array, hash_array_len, iter_steps);
+    return;
+  }
+
+  const int blocks_len = (int)((hash_array_len + BCHUNK_HASH_PARALLEL_BLOCK_LEN - 1) /
+                               BCHUNK_HASH_PARALLEL_BLOCK_LEN);
+  HashArrayParallelData data = {
+      .info = info,
+      .data = data_slice,
+      .hash_array = hash_array,
+      .hash_array_len = hash_array_len,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  BLI_task_parallel_range(0, blocks_len, &data, hash_array_from_data_parallel_cb, &settings);
+
+  /* Matches #hash_accum, the last item of each block needs the values following it from
+   * before the current step, so they are stored before accumulating the blocks in parallel. */
+  if (UNLIKELY((iter_steps > hash_array_len))) {
+    iter_steps = hash_array_len;
+  }
+  data.hash_array_search_len = hash_array_len - iter_steps;
+  data.block_tails = MEM_mallocN(sizeof(hash_key) * (size_t)blocks_len * iter_steps, __func__);
+  while (iter_steps != 0) {
+    data.hash_offset = iter_steps;
+    for (int block = 0; block < blocks_len; block++) {
+      const size_t i_end = MIN2((size_t)(block + 1) * BCHUNK_HASH_PARALLEL_BLOCK_LEN,
+                                data.hash_array_search_len);
+      for (size_t i = 0; i < iter_steps && i_end + i < hash_array_len; i++) {
+        data.block_tails[(size_t)block * iter_steps + i] = hash_array[i_end + i];
+      }
+    }
+    BLI_task_parallel_range(0, blocks_len, &data, hash_accum_parallel_cb, &settings);
+    iter_steps -= 1;
+  }
+  MEM_freeN(data.block_tails);
+}
+
 /**
  * When we only need a single value, can use a small optimization.
  * we can avoid accumulating the tail of the array a little, each iteration.
@@ -1206,9 +1348,8 @@ static BChunkList *bchunk_list_from_data_merge(const BArrayInfo *info,
     const size_t table_hash_array_len = (data_len - i_prev) / info->chunk_stride;
     hash_key *table_hash_array = MEM_mallocN(sizeof(*table_hash_array) * table_hash_array_len,
                                              __func__);
-    hash_array_from_data(info, &data[i_prev], data_len - i_prev, table_hash_array);
-
-    hash_accum(table_hash_array, table_hash_array_len, info->accum_steps);
+    hash_array_from_data_accum(
+        info, &data[i_prev], data_len - i_prev, table_hash_array, info->accum_steps);
 #else
     /* dummy vars */
     uint i_table_start = 0;
@@ -1602,6 +1743,76 @@ BArrayState *BLI_array_store_state_add(BArrayStore *bs,
   return state;
 }
 
+typedef struct StateAddManyData {
+  BArrayStateAddParams *params;
+  /** Indices into #params, grouped by store. */
+  uint *params_order;
+  /** Start of each group in #params_order, followed by the total length. */
+  uint *group_offsets;
+} StateAddManyData;
+
+static void array_store_state_add_many_cb(void *__restrict userdata,
+                                          const int index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const StateAddManyData *data = userdata;
+  for (uint i = data->group_offsets[index]; i < data->group_offsets[index + 1]; i++) {
+    BArrayStateAddParams *params = &data->params[data->params_order[i]];
+    *params->r_state = BLI_array_store_state_add(
+        params->bs, params->data, params->data_len, params->state_reference);
+  }
+}
+
+/**
+ * Add many states at once, the same as calling #BLI_array_store_state_add for each of them.
+ *
+ * A #BArrayStore can't be modified from multiple threads, so states of the same store are added
+ * in order on a single thread, while different stores are handled in parallel.
+ */
+void BLI_array_store_state_add_many(BArrayStateAddParams *params, const uint params_len)
+{
+  if (params_len == 0) {
+    return;
+  }
+
+  uint *params_order = MEM_mallocN(sizeof(*params_order) * params_len, __func__);
+  uint *group_offsets = MEM_mallocN(sizeof(*group_offsets) * (params_len + 1), __func__);
+  bool *params_done = MEM_callocN(sizeof(*params_done) * params_len, __func__);
+  uint groups_len = 0;
+  uint order_len = 0;
+
+  /* There are only a few different stores in practice (one for each stride). */
+  for (uint i = 0; i < params_len; i++) {
+    if (params_done[i]) {
+      continue;
+    }
+    group_offsets[groups_len++] = order_len;
+    for (uint j = i; j < params_len; j++) {
+      if (!params_done[j] && (params[j].bs == params[i].bs)) {
+        params_done[j] = true;
+        params_order[order_len++] = j;
+      }
+    }
+  }
+  group_offsets[groups_len] = order_len;
+  BLI_assert(order_len == params_len);
+
+  StateAddManyData data = {
+      .params = params,
+      .params_order = params_order,
+      .group_offsets = group_offsets,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (groups_len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, (int)groups_len, &data, array_store_state_add_many_cb, &settings);
+
+  MEM_freeN(params_order);
+  MEM_freeN(group_offsets);
+  MEM_freeN(params_done);
+}
+
 /**
  * Remove a state and free any unused #BChunk data.
  *
@@ -131,6 +131,10 @@ class TBBTaskGroup : public tbb::task_group {
  public:
   TBBTaskGroup(TaskPriority priority)
   {
+#  if TBB_INTERFACE_VERSION_MAJOR >= 12
+    /* oneTBB only supports priorities for task arenas, not for task groups. */
+    UNUSED_VARS(priority);
+#  else
     switch (priority) {
       case TASK_PRIORITY_LOW:
         my_context.set_priority(tbb::priority_low);
@@ -139,6 +143,7 @@ class TBBTaskGroup : public tbb::task_group {
         my_context.set_priority(tbb::priority_normal);
         break;
     }
+#  endif
   }
 
   ~TBBTaskGroup()
@@ -268,7 +273,11 @@ static bool tbb_task_pool_canceled(TaskPool *pool)
 {
 #ifdef WITH_TBB
   if (pool->use_threads) {
+#  if TBB_INTERFACE_VERSION_MAJOR >= 12
+    return tbb::is_current_task_group_canceling();
+#  else
     return pool->tbb_group.is_canceling();
+#  endif
   }
 #else
   UNUSED_VARS(pool);
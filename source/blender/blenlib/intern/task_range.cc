@@ -20,6 +20,10 @@
  * Task parallel range functions.
  */
 
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <mutex>
 #include <stdlib.h>
 
 #include "MEM_guardedalloc.h"
@@ -29,6 +33,8 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "PIL_time.h"
+
 #include "atomic_ops.h"
 
 #ifdef WITH_TBB
@@ -37,33 +43,145 @@
 #  include <tbb/tbb.h>
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name Adaptive Grain Size
+ * \{ */
+
+/* Chunks should take long enough for the scheduling overhead to be negligible,
+ * while still splitting ranges in enough chunks for threads to balance the work. */
+#define ADAPTIVE_CHUNK_TIME_TARGET 50e-6
+
+/* Protects #TaskParallelAdaptive, only locked once for each parallel range. */
+static std::mutex adaptive_mutex;
+static TaskParallelAdaptive *adaptive_first = nullptr;
+
+/**
+ * Grain size for the next call of an adaptive parallel range. \a r_is_measured is set when the
+ * grain size was measured by previous calls, the grain size is read under the same lock that
+ * updates it so callers must not read #TaskParallelAdaptive.grain_size themselves.
+ */
+int BLI_task_parallel_adaptive_grain_size(TaskParallelAdaptive *adaptive,
+                                          const int64_t range_len,
+                                          const int grain_size_init,
+                                          bool *r_is_measured)
+{
+  int grain_size;
+  {
+    std::lock_guard<std::mutex> lock(adaptive_mutex);
+    grain_size = adaptive->grain_size;
+  }
+  *r_is_measured = (grain_size != 0);
+  if (grain_size != 0) {
+    return grain_size;
+  }
+  if (grain_size_init > 0) {
+    return grain_size_init;
+  }
+  /* Nothing measured yet, give a few chunks to each thread. */
+  const int64_t chunks_num = (int64_t)BLI_task_scheduler_num_threads() * 4;
+  return (int)MIN2(MAX2(range_len / chunks_num, 1), INT_MAX);
+}
+
+void BLI_task_parallel_adaptive_update(TaskParallelAdaptive *adaptive,
+                                       const int64_t iterations_num,
+                                       const int64_t chunks_num,
+                                       const double time_chunks,
+                                       const double time_total)
+{
+  std::lock_guard<std::mutex> lock(adaptive_mutex);
+
+  if (!adaptive->is_registered) {
+    adaptive->next = adaptive_first;
+    adaptive_first = adaptive;
+    adaptive->is_registered = true;
+  }
+
+  adaptive->calls_num += 1;
+  adaptive->iterations_num += (uint64_t)iterations_num;
+  adaptive->chunks_num += (uint64_t)chunks_num;
+  adaptive->time_chunks += time_chunks;
+  adaptive->time_total += time_total;
+
+  if (iterations_num > 0 && time_chunks > 0.0) {
+    const double time_per_iteration = time_chunks / (double)iterations_num;
+    const int grain_size = (int)MIN2(
+        MAX2(ADAPTIVE_CHUNK_TIME_TARGET / time_per_iteration, 1.0), (double)(INT_MAX / 2));
+    /* Average with the previous value, timings of a single call are noisy. */
+    adaptive->grain_size = (adaptive->grain_size == 0) ?
+                               grain_size :
+                               (adaptive->grain_size + grain_size) / 2;
+  }
+}
+
+/**
+ * Print statistics of all parallel ranges using an adaptive grain size which ran so far.
+ */
+void BLI_task_parallel_adaptive_stats_print(void)
+{
+  std::lock_guard<std::mutex> lock(adaptive_mutex);
+
+  printf("Parallel range statistics:\n");
+  for (const TaskParallelAdaptive *adaptive = adaptive_first; adaptive != nullptr;
+       adaptive = adaptive->next) {
+    printf(
+        "  %s: %llu calls, %llu iterations, %llu chunks, grain size %d, "
+        "%.3f ms per call, %.3f us per chunk, %.2fx parallel\n",
+        adaptive->name,
+        (unsigned long long)adaptive->calls_num,
+        (unsigned long long)adaptive->iterations_num,
+        (unsigned long long)adaptive->chunks_num,
+        adaptive->grain_size,
+        adaptive->time_total * 1e3 / (double)MAX2(adaptive->calls_num, 1),
+        adaptive->time_chunks * 1e6 / (double)MAX2(adaptive->chunks_num, 1),
+        adaptive->time_chunks / MAX2(adaptive->time_total, 1e-9));
+  }
+}
+
+/** \} */
+
 #ifdef WITH_TBB
 
+/* Time spent in chunks of a single parallel range call. */
+struct RangeTaskTimings {
+  std::atomic<int64_t> chunks_num{0};
+  std::atomic<double> time{0.0};
+};
+
 /* Functor for running TBB parallel_for and parallel_reduce. */
 struct RangeTask {
   TaskParallelRangeFunc func;
   void *userdata;
   const TaskParallelSettings *settings;
+  RangeTaskTimings *timings;
 
   void *userdata_chunk;
 
   /* Root constructor. */
-  RangeTask(TaskParallelRangeFunc func, void *userdata, const TaskParallelSettings *settings)
-      : func(func), userdata(userdata), settings(settings)
+  RangeTask(TaskParallelRangeFunc func,
+            void *userdata,
+            const TaskParallelSettings *settings,
+            RangeTaskTimings *timings)
+      : func(func), userdata(userdata), settings(settings), timings(timings)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Copy constructor. */
   RangeTask(const RangeTask &other)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        timings(other.timings)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Splitting constructor for parallel reduce. */
   RangeTask(RangeTask &other, tbb::split /* unused */)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        timings(other.timings)
   {
     init_chunk(settings->userdata_chunk);
   }
@@ -89,6 +207,8 @@ struct RangeTask {
 
   void operator()(const tbb::blocked_range<int> &r) const
   {
+    const double time_start = (timings != nullptr) ? PIL_check_seconds_timer() : 0.0;
+
     tbb::this_task_arena::isolate([this, r] {
       TaskParallelTLS tls;
       tls.userdata_chunk = userdata_chunk;
@@ -96,6 +216,14 @@ struct RangeTask {
         func(userdata, i, &tls);
       }
     });
+
+    if (timings != nullptr) {
+      const double time = PIL_check_seconds_timer() - time_start;
+      double time_prev = timings->time.load();
+      while (!timings->time.compare_exchange_weak(time_prev, time_prev + time)) {
+      }
+      timings->chunks_num += 1;
+    }
   }
 
   void join(const RangeTask &other)
@@ -112,23 +240,45 @@ void BLI_task_parallel_range(const int start,
                              TaskParallelRangeFunc func,
                              const TaskParallelSettings *settings)
 {
+  TaskParallelAdaptive *adaptive = settings->adaptive;
+  const double time_start = (adaptive != nullptr) ? PIL_check_seconds_timer() : 0.0;
+
 #ifdef WITH_TBB
   /* Multithreading. */
   if (settings->use_threading && BLI_task_scheduler_num_threads() > 1) {
-    RangeTask task(func, userdata, settings);
-    const size_t grainsize = MAX2(settings->min_iter_per_thread, 1);
-    const tbb::blocked_range<int> range(start, stop, grainsize);
-
-    if (settings->func_reduce) {
-      parallel_reduce(range, task);
-      if (settings->userdata_chunk) {
-        memcpy(settings->userdata_chunk, task.userdata_chunk, settings->userdata_chunk_size);
-      }
+    bool is_measured = false;
+    size_t grainsize = MAX2(settings->min_iter_per_thread, 1);
+    if (adaptive != nullptr) {
+      grainsize = BLI_task_parallel_adaptive_grain_size(
+          adaptive, stop - start, settings->min_iter_per_thread, &is_measured);
     }
-    else {
-      parallel_for(range, task);
+    /* With a measured grain size, a range that doesn't fill a chunk runs in the calling thread,
+     * avoiding the overhead of the scheduler and of copying the user-data chunk. */
+    const bool use_threading = !is_measured || ((size_t)(stop - start) > grainsize);
+    if (use_threading) {
+      RangeTaskTimings timings;
+      RangeTask task(func, userdata, settings, (adaptive != nullptr) ? &timings : nullptr);
+      const tbb::blocked_range<int> range(start, stop, grainsize);
+
+      if (settings->func_reduce) {
+        parallel_reduce(range, task);
+        if (settings->userdata_chunk) {
+          memcpy(settings->userdata_chunk, task.userdata_chunk, settings->userdata_chunk_size);
+        }
+      }
+      else {
+        parallel_for(range, task);
+      }
+
+      if (adaptive != nullptr) {
+        BLI_task_parallel_adaptive_update(adaptive,
+                                          stop - start,
+                                          timings.chunks_num,
+                                          timings.time,
+                                          PIL_check_seconds_timer() - time_start);
+      }
+      return;
     }
-    return;
   }
 #endif
 
@@ -142,6 +292,12 @@ void BLI_task_parallel_range(const int start,
   if (settings->func_free != nullptr) {
     settings->func_free(userdata, settings->userdata_chunk);
   }
+
+  if (adaptive != nullptr) {
+    /* The whole range is a single chunk. */
+    const double time = PIL_check_seconds_timer() - time_start;
+    BLI_task_parallel_adaptive_update(adaptive, stop - start, 1, time, time);
+  }
 }
 
 int BLI_task_parallel_thread_id(const TaskParallelTLS *UNUSED(tls))
@@ -384,6 +384,81 @@ TEST(array_store, DoubleDiff)
   BLI_array_store_destroy(bs);
 }
 
+TEST(array_store, AddMany)
+{
+  BArrayStore *bs_a = BLI_array_store_create(1, 32);
+  BArrayStore *bs_b = BLI_array_store_create(4, 32);
+  const char data_src_a[] = "test";
+  const char data_src_b[] = "####";
+  const int data_src_c[] = {1, 2, 3, 4};
+
+  BArrayState *states[4];
+  BArrayStateAddParams params[3] = {
+      {bs_a, data_src_a, sizeof(data_src_a), nullptr, &states[0]},
+      {bs_b, data_src_c, sizeof(data_src_c), nullptr, &states[1]},
+      {bs_a, data_src_b, sizeof(data_src_b), nullptr, &states[2]},
+  };
+  BLI_array_store_state_add_many(params, ARRAY_SIZE(params));
+
+  /* Using a state added by the previous call as reference. */
+  BArrayStateAddParams params_next = {bs_b, data_src_c, sizeof(data_src_c), states[1], &states[3]};
+  BLI_array_store_state_add_many(&params_next, 1);
+
+  EXPECT_TRUE(BLI_array_store_is_valid(bs_a));
+  EXPECT_TRUE(BLI_array_store_is_valid(bs_b));
+  EXPECT_EQ(BLI_array_store_calc_size_compacted_get(bs_a), sizeof(data_src_a) * 2);
+  EXPECT_EQ(BLI_array_store_calc_size_compacted_get(bs_b), sizeof(data_src_c));
+
+  size_t data_dst_len;
+  char *data_dst = (char *)BLI_array_store_state_data_get_alloc(states[2], &data_dst_len);
+  EXPECT_STREQ(data_src_b, data_dst);
+  MEM_freeN(data_dst);
+
+  int *data_dst_c = (int *)BLI_array_store_state_data_get_alloc(states[3], &data_dst_len);
+  EXPECT_EQ(data_dst_len, sizeof(data_src_c));
+  EXPECT_EQ(memcmp(data_src_c, data_dst_c, sizeof(data_src_c)), 0);
+  MEM_freeN(data_dst_c);
+
+  BLI_array_store_destroy(bs_a);
+  BLI_array_store_destroy(bs_b);
+}
+
+/* Big enough for the hashes of the lookup table to be calculated on multiple threads. */
+TEST(array_store, LargeShifted)
+{
+  const size_t items_len = 1 << 20;
+  BArrayStore *bs = BLI_array_store_create(sizeof(int), 256);
+  int *data_a = (int *)MEM_mallocN(sizeof(int) * items_len, __func__);
+  int *data_b = (int *)MEM_mallocN(sizeof(int) * (items_len + 1), __func__);
+  RNG *rng = BLI_rng_new(0);
+  for (size_t i = 0; i < items_len; i++) {
+    data_a[i] = BLI_rng_get_int(rng);
+  }
+  BLI_rng_free(rng);
+  /* Insert an item in the middle, so the chunks don't align. */
+  memcpy(data_b, data_a, sizeof(int) * (items_len / 2));
+  data_b[items_len / 2] = 0;
+  memcpy(&data_b[items_len / 2 + 1], &data_a[items_len / 2], sizeof(int) * (items_len / 2));
+
+  BArrayState *state_a = BLI_array_store_state_add(bs, data_a, sizeof(int) * items_len, nullptr);
+  BArrayState *state_b = BLI_array_store_state_add(
+      bs, data_b, sizeof(int) * (items_len + 1), state_a);
+
+  EXPECT_TRUE(BLI_array_store_is_valid(bs));
+  /* Only the chunks around the inserted item are not shared. */
+  EXPECT_LT(BLI_array_store_calc_size_compacted_get(bs), sizeof(int) * (items_len + 1024));
+
+  size_t data_dst_len;
+  int *data_dst = (int *)BLI_array_store_state_data_get_alloc(state_b, &data_dst_len);
+  EXPECT_EQ(data_dst_len, sizeof(int) * (items_len + 1));
+  EXPECT_EQ(memcmp(data_b, data_dst, data_dst_len), 0);
+  MEM_freeN(data_dst);
+
+  MEM_freeN(data_a);
+  MEM_freeN(data_b);
+  BLI_array_store_destroy(bs);
+}
+
 TEST(array_store, TextMixed)
 {
   TESTBUFFER_STRINGS(1, 4, "", );
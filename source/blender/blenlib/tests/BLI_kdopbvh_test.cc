@@ -2,7 +2,7 @@
 
 #include "testing/testing.h"
 
-/* TODO: ray intersection, overlap ... etc.*/
+/* TODO: overlap ... etc.*/
 
 #include "MEM_guardedalloc.h"
 
@@ -66,11 +66,15 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int build_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
-  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+  BVHTree *tree = BLI_bvhtree_new_ex(points_len, 0.0, 8, 8, build_flag);
 
   void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
   float(*points)[3] = (float(*)[3])mem;
@@ -132,3 +136,153 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, SAHFindNearest_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVH_BUILD_SAH);
+}
+TEST(kdopbvh, SAHFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVH_BUILD_SAH);
+}
+TEST(kdopbvh, SAHFindNearest_5000)
+{
+  /* Enough leafs to build sub-trees in parallel. */
+  find_nearest_points_test(5000, 1.0, 1000, 12, true, BVH_BUILD_SAH);
+}
+TEST(kdopbvh, SAHFindNearest_Duplicates)
+{
+  /* Many leafs on the same location, which can't be split by the SAH. */
+  find_nearest_points_test(500, 1.0, 2, 12, false, BVH_BUILD_SAH);
+}
+
+static void update_tree_test(int points_len, int random_seed, int build_flag = 0)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new_ex(points_len, 0.0, 4, 8, build_flag);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Move all points, as a deformation would. */
+  for (int i = 0; i < points_len; i++) {
+    mul_v3_fl(points[i], 2.0f);
+    points[i][2] += 10.0f;
+    EXPECT_TRUE(BLI_bvhtree_update_node(tree, i, points[i], nullptr, 1));
+  }
+  BLI_bvhtree_update_tree(tree);
+
+  for (int i = 0; i < points_len; i++) {
+    const int j = BLI_bvhtree_find_nearest(tree, points[i], nullptr, nullptr, nullptr);
+    EXPECT_GE(j, 0);
+    EXPECT_LT(j, points_len);
+    EXPECT_EQ_ARRAY(points[i], points[j], 3);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+}
+
+TEST(kdopbvh, UpdateTree_1)
+{
+  update_tree_test(1, 1234);
+}
+TEST(kdopbvh, UpdateTree_5000)
+{
+  update_tree_test(5000, 12);
+}
+TEST(kdopbvh, UpdateTree_SAH_5000)
+{
+  update_tree_test(5000, 12, BVH_BUILD_SAH);
+}
+
+static void raycast_batch_test(
+    int points_len, int rays_len, float radius, int random_seed, int build_flag = 0)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new_ex(points_len, 0.0, 4, 6, build_flag);
+
+  /* Small boxes, so rays have a reasonable chance of hitting them. */
+  const float box_size[3] = {0.05f, 0.05f, 0.05f};
+  float(*points)[2][3] = (float(*)[2][3])MEM_mallocN(sizeof(float[2][3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i][0], 3, rng, 1000, 1.0f);
+    add_v3_v3v3(points[i][1], points[i][0], box_size);
+    BLI_bvhtree_insert(tree, i, points[i][0], 2);
+  }
+  BLI_bvhtree_balance(tree);
+
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+
+  for (int i = 0; i < rays_len; i++) {
+    /* Mostly coherent rays, with some diverging ones mixed in. */
+    if (i % 7 == 0) {
+      rng_v3_round(dir[i], 3, rng, 1000, 1.0f);
+    }
+    else {
+      dir[i][0] = 0.1f * BLI_rng_get_float(rng);
+      dir[i][1] = 0.1f * BLI_rng_get_float(rng);
+      dir[i][2] = -1.0f;
+    }
+    if (normalize_v3(dir[i]) == 0.0f) {
+      dir[i][2] = 1.0f;
+    }
+    rng_v3_round(co[i], 2, rng, 1000, 1.0f);
+    co[i][2] = 2.0f;
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(tree,
+                             (const float(*)[3])co,
+                             (const float(*)[3])dir,
+                             rays_len,
+                             radius,
+                             hits,
+                             nullptr,
+                             nullptr,
+                             BVH_RAYCAST_DEFAULT);
+
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co[i], dir[i], radius, &hit, nullptr, nullptr);
+
+    EXPECT_EQ(hit.index, hits[i].index);
+    if (hit.index != -1) {
+      EXPECT_FLOAT_EQ(hit.dist, hits[i].dist);
+    }
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hits);
+}
+
+TEST(kdopbvh, RayCastBatch_1)
+{
+  raycast_batch_test(1, 1, 0.0f, 1234);
+}
+TEST(kdopbvh, RayCastBatch_Unaligned)
+{
+  raycast_batch_test(500, 1001, 0.0f, 123);
+}
+TEST(kdopbvh, RayCastBatch_Radius)
+{
+  raycast_batch_test(500, 1000, 0.05f, 12);
+}
+TEST(kdopbvh, RayCastBatch_SAH)
+{
+  raycast_batch_test(5000, 1000, 0.0f, 1234, BVH_BUILD_SAH);
+}
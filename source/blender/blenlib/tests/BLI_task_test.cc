@@ -65,6 +65,80 @@ TEST(task, RangeIter)
   BLI_threadapi_exit();
 }
 
+TEST(task, RangeIterAdaptive)
+{
+  int data[NUM_ITEMS];
+  static TaskParallelAdaptive adaptive = {"task_test_adaptive"};
+
+  BLI_threadapi_init();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.adaptive = &adaptive;
+
+  for (int run = 0; run < 4; run++) {
+    int sum = 0;
+    settings.userdata_chunk = &sum;
+    settings.userdata_chunk_size = sizeof(sum);
+    settings.func_reduce = task_range_iter_reduce_func;
+
+    memset(data, 0, sizeof(data));
+    BLI_task_parallel_range(0, NUM_ITEMS, data, task_range_iter_func, &settings);
+
+    int expected_sum = 0;
+    for (int i = 0; i < NUM_ITEMS; i++) {
+      EXPECT_EQ(data[i], i);
+      expected_sum += i;
+    }
+    EXPECT_EQ(sum, expected_sum);
+  }
+
+  /* Each call was measured, and a grain size was chosen from the timings. */
+  EXPECT_EQ(adaptive.calls_num, (uint64_t)4);
+  EXPECT_EQ(adaptive.iterations_num, (uint64_t)(4 * NUM_ITEMS));
+  EXPECT_GE(adaptive.chunks_num, (uint64_t)4);
+  if (adaptive.time_chunks > 0.0) {
+    EXPECT_GE(adaptive.grain_size, 1);
+  }
+
+  BLI_threadapi_exit();
+}
+
+TEST(task, RangeIterAdaptiveSingleChunk)
+{
+  int data[NUM_ITEMS];
+  static TaskParallelAdaptive adaptive = {"task_test_adaptive_single_chunk"};
+  /* As if earlier calls measured chunks to need more iterations than the range has. */
+  adaptive.grain_size = NUM_ITEMS;
+
+  BLI_threadapi_init();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.adaptive = &adaptive;
+
+  int sum = 0;
+  settings.userdata_chunk = &sum;
+  settings.userdata_chunk_size = sizeof(sum);
+  settings.func_reduce = task_range_iter_reduce_func;
+
+  memset(data, 0, sizeof(data));
+  BLI_task_parallel_range(0, NUM_ITEMS, data, task_range_iter_func, &settings);
+
+  int expected_sum = 0;
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    EXPECT_EQ(data[i], i);
+    expected_sum += i;
+  }
+  EXPECT_EQ(sum, expected_sum);
+
+  /* The range ran in the calling thread, as a single chunk. */
+  EXPECT_EQ(adaptive.calls_num, (uint64_t)1);
+  EXPECT_EQ(adaptive.chunks_num, (uint64_t)1);
+
+  BLI_threadapi_exit();
+}
+
 /* *** Parallel iterations over mempool items. *** */
 
 static void task_mempool_iter_func(void *userdata, MempoolIterData *item)
@@ -0,0 +1,157 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array_store.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time_utildefines.h"
+
+/* Vertex positions. */
+#define STRIDE (sizeof(float[3]))
+#define CHUNK_COUNT 256
+#define INSERT_LEN 4
+
+/* Change a random range of items, sometimes also inserting items,
+ * similar to successive edits of a big mesh. */
+static void array_store_mutate(RNG *rng, char *data, size_t *items_len, const size_t items_len_max)
+{
+  const size_t edit_len = 1 + BLI_rng_get_uint(rng) % (*items_len / 100);
+  const size_t edit_start = BLI_rng_get_uint(rng) % (*items_len - edit_len);
+  for (size_t i = edit_start * STRIDE; i < (edit_start + edit_len) * STRIDE; i++) {
+    data[i] = (char)BLI_rng_get_uint(rng);
+  }
+
+  if ((BLI_rng_get_uint(rng) % 2) && (*items_len + edit_len <= items_len_max)) {
+    /* Insert items. */
+    memmove(&data[(edit_start + edit_len) * STRIDE],
+            &data[edit_start * STRIDE],
+            (*items_len - edit_start) * STRIDE);
+    *items_len += edit_len;
+  }
+}
+
+static void array_store_versions_test(const size_t items_len_init, const int versions_len)
+{
+  printf("\n========== STARTING %s (%d items, %d versions) ==========\n",
+         __func__,
+         (int)items_len_init,
+         versions_len);
+
+  const size_t items_len_max = items_len_init * 2;
+  char *data = (char *)MEM_mallocN(items_len_max * STRIDE, __func__);
+  RNG *rng = BLI_rng_new(0);
+  BLI_rng_get_char_n(rng, data, items_len_init * STRIDE);
+  size_t items_len = items_len_init;
+
+  BArrayStore *bs = BLI_array_store_create(STRIDE, CHUNK_COUNT);
+  BArrayState **states = (BArrayState **)MEM_malloc_arrayN(
+      (size_t)versions_len, sizeof(*states), __func__);
+
+  TIMEIT_START(array_store_add_first);
+  states[0] = BLI_array_store_state_add(bs, data, items_len * STRIDE, nullptr);
+  TIMEIT_END(array_store_add_first);
+
+  TIMEIT_START(array_store_add_versions);
+  for (int i = 1; i < versions_len; i++) {
+    array_store_mutate(rng, data, &items_len, items_len_max);
+    states[i] = BLI_array_store_state_add(bs, data, items_len * STRIDE, states[i - 1]);
+  }
+  TIMEIT_END(array_store_add_versions);
+
+  printf("Memory used: %.2f%% of expanded size\n",
+         100.0 * (double)BLI_array_store_calc_size_compacted_get(bs) /
+             (double)BLI_array_store_calc_size_expanded_get(bs));
+
+  size_t data_test_len;
+  char *data_test = (char *)BLI_array_store_state_data_get_alloc(states[versions_len - 1],
+                                                                 &data_test_len);
+  EXPECT_EQ(data_test_len, items_len * STRIDE);
+  EXPECT_EQ(memcmp(data, data_test, data_test_len), 0);
+  MEM_freeN(data_test);
+
+  BLI_array_store_destroy(bs);
+  BLI_rng_free(rng);
+  MEM_freeN(states);
+  MEM_freeN(data);
+
+  printf("========== ENDED %s ==========\n\n", __func__);
+}
+
+/* Several layers of the same size (as stored by edit-mesh undo),
+ * added one by one then all at once. */
+static void array_store_layers_test(const size_t items_len, const int layers_len)
+{
+  printf("\n========== STARTING %s (%d items, %d layers) ==========\n",
+         __func__,
+         (int)items_len,
+         layers_len);
+
+  BArrayStore **stores = (BArrayStore **)MEM_malloc_arrayN(
+      (size_t)layers_len, sizeof(*stores), __func__);
+  char **layers = (char **)MEM_malloc_arrayN((size_t)layers_len, sizeof(*layers), __func__);
+  BArrayState **states = (BArrayState **)MEM_malloc_arrayN(
+      (size_t)layers_len * 3, sizeof(*states), __func__);
+  BArrayStateAddParams *params = (BArrayStateAddParams *)MEM_malloc_arrayN(
+      (size_t)layers_len, sizeof(*params), __func__);
+
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < layers_len; i++) {
+    stores[i] = BLI_array_store_create(STRIDE, CHUNK_COUNT);
+    layers[i] = (char *)MEM_mallocN((items_len + INSERT_LEN) * STRIDE, __func__);
+    BLI_rng_get_char_n(rng, layers[i], items_len * STRIDE);
+    states[i] = BLI_array_store_state_add(stores[i], layers[i], items_len * STRIDE, nullptr);
+    /* Insert items along the array, so the chunks don't align with the first state. */
+    for (size_t j = 1; j < INSERT_LEN; j++) {
+      const size_t offset = (items_len / INSERT_LEN) * j + j;
+      memmove(&layers[i][(offset + 1) * STRIDE],
+              &layers[i][offset * STRIDE],
+              (items_len + j - 1 - offset) * STRIDE);
+    }
+  }
+  BLI_rng_free(rng);
+
+  TIMEIT_START(array_store_add_layers);
+  for (int i = 0; i < layers_len; i++) {
+    states[layers_len + i] = BLI_array_store_state_add(
+        stores[i], layers[i], (items_len + INSERT_LEN - 1) * STRIDE, states[i]);
+  }
+  TIMEIT_END(array_store_add_layers);
+
+  for (int i = 0; i < layers_len; i++) {
+    params[i] = {stores[i],
+                 layers[i],
+                 (items_len + INSERT_LEN - 1) * STRIDE,
+                 states[i],
+                 &states[layers_len * 2 + i]};
+  }
+  TIMEIT_START(array_store_add_layers_many);
+  BLI_array_store_state_add_many(params, (uint)layers_len);
+  TIMEIT_END(array_store_add_layers_many);
+
+  for (int i = 0; i < layers_len; i++) {
+    EXPECT_EQ(BLI_array_store_state_size_get(states[layers_len * 2 + i]),
+              (items_len + INSERT_LEN - 1) * STRIDE);
+    BLI_array_store_destroy(stores[i]);
+    MEM_freeN(layers[i]);
+  }
+  MEM_freeN(stores);
+  MEM_freeN(layers);
+  MEM_freeN(states);
+  MEM_freeN(params);
+
+  printf("========== ENDED %s ==========\n\n", __func__);
+}
+
+TEST(array_store, Versions_10M)
+{
+  array_store_versions_test(10000000, 8);
+}
+
+TEST(array_store, Layers_2M_x8)
+{
+  array_store_layers_test(2000000, 8);
+}
@@ -0,0 +1,194 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time_utildefines.h"
+
+/* Run the longest tests! */
+//#define KDOPBVH_RUN_BIG
+
+struct RayCastTestData {
+  BVHTree *tree;
+  float (*co)[3];
+  float (*dir)[3];
+  BVHTreeRayHit *hits;
+  int rays_len;
+};
+
+static void raycast_test_data_init(RayCastTestData *data,
+                                   const int boxes_len,
+                                   const int rays_len,
+                                   const float spread,
+                                   const int build_flag)
+{
+  RNG *rng = BLI_rng_new(1234);
+
+  data->tree = BLI_bvhtree_new_ex(boxes_len, 0.0f, 2, 6, build_flag);
+  for (int i = 0; i < boxes_len; i++) {
+    float box[2][3];
+    BLI_rng_get_float_unit_v3(rng, box[0]);
+    mul_v3_fl(box[0], 10.0f);
+    copy_v3_v3(box[1], box[0]);
+    add_v3_fl(box[1], 0.01f);
+    BLI_bvhtree_insert(data->tree, i, box[0], 2);
+  }
+
+  TIMEIT_START(balance);
+  BLI_bvhtree_balance(data->tree);
+  TIMEIT_END(balance);
+
+  data->rays_len = rays_len;
+  data->co = (float(*)[3])MEM_mallocN(sizeof(*data->co) * (size_t)rays_len, __func__);
+  data->dir = (float(*)[3])MEM_mallocN(sizeof(*data->dir) * (size_t)rays_len, __func__);
+  data->hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*data->hits) * (size_t)rays_len, __func__);
+
+  /* A grid of rays (like a bake or projection), neighbors have similar directions. */
+  const int grid_size = (int)sqrtf((float)rays_len);
+  for (int i = 0; i < rays_len; i++) {
+    const float u = (float)(i % grid_size) / (float)grid_size - 0.5f;
+    const float v = (float)(i / grid_size) / (float)grid_size - 0.5f;
+    copy_v3_fl3(data->co[i], 0.0f, 0.0f, 20.0f);
+    copy_v3_fl3(data->dir[i], u * spread, v * spread, -1.0f);
+    normalize_v3(data->dir[i]);
+  }
+
+  BLI_rng_free(rng);
+}
+
+static void raycast_test_data_reset_hits(RayCastTestData *data)
+{
+  for (int i = 0; i < data->rays_len; i++) {
+    data->hits[i].index = -1;
+    data->hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+}
+
+static void raycast_test_data_free(RayCastTestData *data)
+{
+  BLI_bvhtree_free(data->tree);
+  MEM_freeN(data->co);
+  MEM_freeN(data->dir);
+  MEM_freeN(data->hits);
+}
+
+static void raycast_tests(const char *id,
+                          const int boxes_len,
+                          const int rays_len,
+                          float spread,
+                          const int build_flag = 0)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  RayCastTestData data;
+  raycast_test_data_init(&data, boxes_len, rays_len, spread, build_flag);
+
+  int hits_single = 0, hits_batch = 0;
+
+  {
+    raycast_test_data_reset_hits(&data);
+
+    TIMEIT_START(ray_cast_single);
+
+    for (int i = 0; i < rays_len; i++) {
+      BLI_bvhtree_ray_cast(
+          data.tree, data.co[i], data.dir[i], 0.0f, &data.hits[i], nullptr, nullptr);
+    }
+
+    TIMEIT_END(ray_cast_single);
+
+    for (int i = 0; i < rays_len; i++) {
+      hits_single += (data.hits[i].index != -1);
+    }
+  }
+
+  {
+    raycast_test_data_reset_hits(&data);
+
+    TIMEIT_START(ray_cast_batch);
+
+    BLI_bvhtree_ray_cast_batch(data.tree,
+                               (const float(*)[3])data.co,
+                               (const float(*)[3])data.dir,
+                               rays_len,
+                               0.0f,
+                               data.hits,
+                               nullptr,
+                               nullptr,
+                               BVH_RAYCAST_DEFAULT);
+
+    TIMEIT_END(ray_cast_batch);
+
+    for (int i = 0; i < rays_len; i++) {
+      hits_batch += (data.hits[i].index != -1);
+    }
+  }
+
+  {
+    raycast_test_data_reset_hits(&data);
+
+    TIMEIT_START(ray_cast_batch_threaded);
+
+    BLI_bvhtree_ray_cast_batch(data.tree,
+                               (const float(*)[3])data.co,
+                               (const float(*)[3])data.dir,
+                               rays_len,
+                               0.0f,
+                               data.hits,
+                               nullptr,
+                               nullptr,
+                               BVH_RAYCAST_DEFAULT | BVH_RAYCAST_USE_THREADING);
+
+    TIMEIT_END(ray_cast_batch_threaded);
+  }
+
+  EXPECT_EQ(hits_single, hits_batch);
+  printf("%d rays, %d hits\n", rays_len, hits_batch);
+
+  raycast_test_data_free(&data);
+
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, RayCastCoherent100000)
+{
+  raycast_tests("RayCast - Coherent - 100000 boxes, 1000000 rays", 100000, 1000000, 0.5f);
+}
+
+TEST(kdopbvh, RayCastIncoherent100000)
+{
+  raycast_tests("RayCast - Incoherent - 100000 boxes, 1000000 rays", 100000, 1000000, 20.0f);
+}
+
+TEST(kdopbvh, RayCastCoherentSAH100000)
+{
+  raycast_tests(
+      "RayCast - Coherent - SAH - 100000 boxes, 1000000 rays", 100000, 1000000, 0.5f, BVH_BUILD_SAH);
+}
+
+TEST(kdopbvh, RayCastIncoherentSAH100000)
+{
+  raycast_tests("RayCast - Incoherent - SAH - 100000 boxes, 1000000 rays",
+                100000,
+                1000000,
+                20.0f,
+                BVH_BUILD_SAH);
+}
+
+#ifdef KDOPBVH_RUN_BIG
+TEST(kdopbvh, RayCastCoherent1000000)
+{
+  raycast_tests("RayCast - Coherent - 1000000 boxes, 10000000 rays", 1000000, 10000000, 0.5f);
+}
+#endif
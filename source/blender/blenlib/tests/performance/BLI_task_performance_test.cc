@@ -208,3 +208,99 @@ TEST(task, ListBaseIter100k)
 {
   task_listbase_test("ListBase parallel iteration - Threaded - 100000 items", 100000, true);
 }
+
+/* *** Parallel range with fixed and adaptive grain size. *** */
+
+static void task_range_cheap_iter_func(void *userdata,
+                                       int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  float *data = (float *)userdata;
+  data[index] = data[index] * 0.5f + 1.0f;
+}
+
+static void task_range_heavy_iter_func(void *userdata,
+                                       int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  float *data = (float *)userdata;
+  /* 'Random' number of iterations. */
+  const uint num = gen_pseudo_random_number((uint)index);
+  float value = data[index];
+  for (uint i = 0; i < num; i++) {
+    value = value * 0.999f + 0.001f;
+  }
+  data[index] = value;
+}
+
+static void task_range_test_do(const char *id,
+                               const int num_items,
+                               TaskParallelRangeFunc func,
+                               const int min_iter_per_thread,
+                               TaskParallelAdaptive *adaptive)
+{
+  float *data = (float *)MEM_calloc_arrayN(num_items, sizeof(*data), __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = min_iter_per_thread;
+  settings.adaptive = adaptive;
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    BLI_task_parallel_range(0, num_items, data, func, &settings);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+
+  printf("\t%s: done in %fs on average over %d runs",
+         id,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  if (adaptive != nullptr) {
+    printf(" (grain size %d)", adaptive->grain_size);
+  }
+  printf("\n");
+
+  MEM_freeN(data);
+}
+
+static void task_range_test(const char *id,
+                            const int num_items,
+                            TaskParallelRangeFunc func,
+                            TaskParallelAdaptive *adaptive)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  task_range_test_do("Grain size 1", num_items, func, 1, nullptr);
+  task_range_test_do("Grain size 64", num_items, func, 64, nullptr);
+  task_range_test_do("Grain size 4096", num_items, func, 4096, nullptr);
+
+  task_range_test_do("Adaptive grain size", num_items, func, 0, adaptive);
+  BLI_task_parallel_adaptive_stats_print();
+
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(task, RangeCheapIter1M)
+{
+  /* Registered for statistics, so must outlive the test. */
+  static TaskParallelAdaptive adaptive = {"task_range_cheap_iter"};
+  task_range_test("Range parallel iteration - Cheap iter - 1000000 items",
+                  1000000,
+                  task_range_cheap_iter_func,
+                  &adaptive);
+}
+
+TEST(task, RangeHeavyIter2k)
+{
+  static TaskParallelAdaptive adaptive = {"task_range_heavy_iter"};
+  task_range_test("Range parallel iteration - Heavy iter - 2000 items",
+                  2000,
+                  task_range_heavy_iter_func,
+                  &adaptive);
+}
@@ -229,6 +229,15 @@ ID *BLO_read_get_new_id_address(BlendLibReader *reader, struct Library *lib, str
 #define BLO_read_id_address(reader, lib, id_ptr_p) \
   *((void **)id_ptr_p) = (void *)BLO_read_get_new_id_address((reader), (lib), (ID *)*(id_ptr_p))
 
+/* Update every pointer in an array of ID pointers, faster than looking them up one by one. */
+void BLO_read_get_new_id_address_array(BlendLibReader *reader,
+                                       struct Library *lib,
+                                       struct ID **id_array,
+                                       int len);
+
+#define BLO_read_id_address_array(reader, lib, id_array, len) \
+  BLO_read_get_new_id_address_array((reader), (lib), (ID **)(id_array), (len))
+
 /* Misc. */
 bool BLO_read_lib_is_undo(BlendLibReader *reader);
 struct Main *BLO_read_lib_get_main(BlendLibReader *reader);
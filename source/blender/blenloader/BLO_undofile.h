@@ -24,6 +24,10 @@
  * \ingroup blenloader
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct GHash;
 struct Scene;
 
@@ -34,6 +38,11 @@ typedef struct {
   size_t size;
   /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
   bool is_identical;
+  /** When true, this chunk doesn't own the memory either, it's shared with a #MemFileChunk of
+   * the previous step with the same content, but stored at a different position (e.g. because
+   * some data before it grew or shrank). Unlike #is_identical, this does not mean that the
+   * data-block using it is unchanged. */
+  bool is_shared;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -41,6 +50,11 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the chunk content, used to quickly reject or find matching chunks. */
+  uint hash;
+  /** Hash of the ID in memory when it was written, only set in the first chunk of an ID.
+   * Used to check that IDs not tagged for update didn't change before re-using their chunks. */
+  uint id_hash;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -53,10 +67,14 @@ typedef struct MemFileWriteData {
   MemFile *reference_memfile;
 
   uint current_id_session_uuid;
+  /** Hash of the ID being written, stored in the next chunk that is added. */
+  uint current_id_hash;
   MemFileChunk *reference_current_chunk;
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Maps a content hash to a reference MemFileChunk, if existing. */
+  struct GHash *hash_mapping;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -73,6 +91,14 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size);
+void BLO_memfile_chunk_add_array(MemFileWriteData *mem_data,
+                                 const char *buf,
+                                 size_t size,
+                                 size_t chunk_size);
+bool BLO_memfile_id_reuse(MemFileWriteData *mem_data,
+                          const void *id_address,
+                          uint id_session_uuid,
+                          uint id_hash);
 
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
@@ -84,3 +110,7 @@ extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
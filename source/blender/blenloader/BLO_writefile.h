@@ -24,6 +24,10 @@
  * \brief external writefile function prototypes.
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct BlendThumbnail;
 struct Main;
 struct MemFile;
@@ -69,6 +73,11 @@ extern bool BLO_write_file(struct Main *mainvar,
 extern bool BLO_write_file_mem(struct Main *mainvar,
                                struct MemFile *compare,
                                struct MemFile *current,
-                               int write_flags);
+                               int write_flags,
+                               bool use_skip_unchanged);
 
 /** \} */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,533 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup blenloader
+ *
+ * Seekable gzip frames, see #BLO_GZIP_FRAME_SIZE.
+ */
+
+#include "zlib.h"
+
+#include <fcntl.h>
+#include <string.h>
+
+#include "BLI_utildefines.h"
+#ifndef WIN32
+#  include <unistd.h> /* for read write close */
+#else
+#  include "BLI_winstuff.h"
+#  include <io.h>
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_task.h"
+
+#include "gzip_frames.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Writing
+ * \{ */
+
+typedef struct GZipFrame {
+  /** Uncompressed data (#BLO_GZIP_FRAME_SIZE). */
+  char *data;
+  size_t data_len;
+  /** Compressed gzip member. */
+  char *compressed;
+  size_t compressed_len;
+  size_t compressed_alloc;
+  bool error;
+} GZipFrame;
+
+struct GZipFramesWriter {
+  int file_handle;
+  /** Frames to compress together, the frame at `frames_used` is being filled. */
+  GZipFrame *frames;
+  int frames_len;
+  int frames_used;
+  /** Compressed & uncompressed size of every frame written (for the seek table). */
+  uint32_t *table;
+  int table_frames_len;
+  int table_frames_alloc;
+  uint64_t file_offset;
+  bool error;
+};
+
+static void gzip_frames_compress_cb(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  GZipFramesWriter *gz = userdata;
+  GZipFrame *frame = &gz->frames[index];
+  z_stream strm = {NULL};
+
+  /* Use the same (fastest) compression level as before frames were used. */
+  if (deflateInit2(&strm, 1, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    frame->error = true;
+    return;
+  }
+  const size_t bound = deflateBound(&strm, (uLong)frame->data_len);
+  if (frame->compressed_alloc < bound) {
+    MEM_SAFE_FREE(frame->compressed);
+    frame->compressed = MEM_mallocN(bound, __func__);
+    frame->compressed_alloc = bound;
+  }
+  strm.next_in = (Bytef *)frame->data;
+  strm.avail_in = (uInt)frame->data_len;
+  strm.next_out = (Bytef *)frame->compressed;
+  strm.avail_out = (uInt)frame->compressed_alloc;
+  if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+    frame->compressed_len = strm.total_out;
+  }
+  else {
+    frame->error = true;
+  }
+  deflateEnd(&strm);
+}
+
+static bool gzip_frames_write_raw(GZipFramesWriter *gz, const char *buf, size_t buf_len)
+{
+  if (write(gz->file_handle, buf, buf_len) != (ssize_t)buf_len) {
+    gz->error = true;
+    return false;
+  }
+  gz->file_offset += buf_len;
+  return true;
+}
+
+/** Compress all filled frames on multiple threads, then write them in order. */
+static void gzip_frames_flush(GZipFramesWriter *gz, const bool use_partial)
+{
+  int frames_len = gz->frames_used;
+  if (use_partial && (frames_len < gz->frames_len) && (gz->frames[frames_len].data_len != 0)) {
+    frames_len += 1;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (frames_len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, frames_len, gz, gzip_frames_compress_cb, &settings);
+
+  for (int i = 0; i < frames_len; i++) {
+    GZipFrame *frame = &gz->frames[i];
+    if (gz->error == false) {
+      if (frame->error || !gzip_frames_write_raw(gz, frame->compressed, frame->compressed_len)) {
+        gz->error = true;
+      }
+    }
+    if (gz->table_frames_len == gz->table_frames_alloc) {
+      gz->table_frames_alloc = MAX2(gz->table_frames_alloc * 2, 1024);
+      gz->table = MEM_reallocN(gz->table, sizeof(*gz->table) * 2 * (size_t)gz->table_frames_alloc);
+    }
+    gz->table[gz->table_frames_len * 2 + 0] = (uint32_t)frame->compressed_len;
+    gz->table[gz->table_frames_len * 2 + 1] = (uint32_t)frame->data_len;
+    gz->table_frames_len += 1;
+
+    frame->data_len = 0;
+    frame->error = false;
+  }
+  gz->frames_used = 0;
+}
+
+static void gzip_frames_write_uint_le(uchar *buf, uint64_t value, const int bytes)
+{
+  for (int i = 0; i < bytes; i++) {
+    buf[i] = (uchar)(value >> (i * 8));
+  }
+}
+
+/** Write an empty gzip member with a single extra sub-field holding `data`. */
+static bool gzip_frames_write_extra_member(GZipFramesWriter *gz,
+                                           const char id[2],
+                                           const uchar *data,
+                                           const size_t data_len)
+{
+  BLI_assert(data_len <= UINT16_MAX - 4);
+  const size_t member_len = BLO_GZIP_MEMBER_EXTRA_LEN + data_len;
+  uchar *member = MEM_callocN(member_len, __func__);
+  uchar *iter = member;
+
+  /* Magic, deflate, #FEXTRA flag, no modification time, unknown OS. */
+  const uchar header[10] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff};
+  memcpy(iter, header, sizeof(header));
+  iter += sizeof(header);
+  gzip_frames_write_uint_le(iter, 4 + data_len, 2);
+  iter += 2;
+  iter[0] = (uchar)id[0];
+  iter[1] = (uchar)id[1];
+  gzip_frames_write_uint_le(iter + 2, data_len, 2);
+  iter += 4;
+  memcpy(iter, data, data_len);
+  iter += data_len;
+  /* Empty deflate block, the CRC & size of empty data are zero. */
+  iter[0] = 0x03;
+  iter[1] = 0x00;
+
+  const bool ok = gzip_frames_write_raw(gz, (const char *)member, member_len);
+  MEM_freeN(member);
+  return ok;
+}
+
+static bool gzip_frames_write_table(GZipFramesWriter *gz)
+{
+  const uint64_t table_offset = gz->file_offset;
+  uchar *data = MEM_mallocN(BLO_GZIP_FRAMES_TABLE_MEMBER_FRAMES * 8, __func__);
+  bool ok = true;
+
+  for (int frame = 0; ok && (frame < gz->table_frames_len);
+       frame += BLO_GZIP_FRAMES_TABLE_MEMBER_FRAMES) {
+    const int frames_len = MIN2(gz->table_frames_len - frame, BLO_GZIP_FRAMES_TABLE_MEMBER_FRAMES);
+    for (int i = 0; i < frames_len * 2; i++) {
+      gzip_frames_write_uint_le(&data[i * 4], gz->table[frame * 2 + i], 4);
+    }
+    ok = gzip_frames_write_extra_member(
+        gz, BLO_GZIP_FRAMES_TABLE_ID, data, (size_t)frames_len * 8);
+  }
+  MEM_freeN(data);
+
+  if (ok) {
+    uchar footer[BLO_GZIP_FRAMES_FOOTER_DATA_LEN];
+    gzip_frames_write_uint_le(&footer[0], table_offset, 8);
+    gzip_frames_write_uint_le(&footer[8], (uint64_t)gz->table_frames_len, 4);
+    ok = gzip_frames_write_extra_member(gz, BLO_GZIP_FRAMES_FOOTER_ID, footer, sizeof(footer));
+  }
+  return ok;
+}
+
+/**
+ * Start writing compressed frames to \a file_handle, which is closed by
+ * #blo_gzip_frames_writer_close.
+ */
+GZipFramesWriter *blo_gzip_frames_writer_new(int file_handle)
+{
+  GZipFramesWriter *gz = MEM_callocN(sizeof(*gz), __func__);
+  gz->file_handle = file_handle;
+  /* Enough frames to keep all threads busy, without holding on to too much memory. */
+  gz->frames_len = MAX2(BLI_task_scheduler_num_threads() * 2, 2);
+  gz->frames = MEM_callocN(sizeof(*gz->frames) * (size_t)gz->frames_len, __func__);
+  return gz;
+}
+
+bool blo_gzip_frames_writer_write(GZipFramesWriter *gz, const char *buf, size_t buf_len)
+{
+  size_t buf_offset = 0;
+
+  while ((buf_offset < buf_len) && (gz->error == false)) {
+    GZipFrame *frame = &gz->frames[gz->frames_used];
+    if (frame->data == NULL) {
+      frame->data = MEM_mallocN(BLO_GZIP_FRAME_SIZE, __func__);
+    }
+    const size_t len = MIN2(buf_len - buf_offset, BLO_GZIP_FRAME_SIZE - frame->data_len);
+    memcpy(frame->data + frame->data_len, buf + buf_offset, len);
+    frame->data_len += len;
+    buf_offset += len;
+
+    if (frame->data_len == BLO_GZIP_FRAME_SIZE) {
+      gz->frames_used += 1;
+      if (gz->frames_used == gz->frames_len) {
+        gzip_frames_flush(gz, false);
+      }
+    }
+  }
+
+  return (gz->error == false);
+}
+
+/**
+ * Write the remaining frames and the seek table, close the file and free \a gz.
+ *
+ * \return false when any write failed.
+ */
+bool blo_gzip_frames_writer_close(GZipFramesWriter *gz)
+{
+  gzip_frames_flush(gz, true);
+  if (gz->error == false) {
+    gzip_frames_write_table(gz);
+  }
+  if (close(gz->file_handle) == -1) {
+    gz->error = true;
+  }
+
+  const bool ok = (gz->error == false);
+  for (int i = 0; i < gz->frames_len; i++) {
+    MEM_SAFE_FREE(gz->frames[i].data);
+    MEM_SAFE_FREE(gz->frames[i].compressed);
+  }
+  MEM_freeN(gz->frames);
+  MEM_SAFE_FREE(gz->table);
+  MEM_freeN(gz);
+  return ok;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Reading
+ * \{ */
+
+struct GZipFramesReader {
+  int file_handle;
+  int frames_len;
+  /** Offset of each frame in the file, `frames_len + 1` items (the last is the seek table). */
+  off64_t *compressed_offset;
+  /** Offset of each frame in the uncompressed data, `frames_len + 1` items. */
+  off64_t *uncompressed_offset;
+
+  /** The frame currently decompressed into `buffer` (-1 for none). */
+  int frame_index;
+  char *buffer;
+  char *compressed_buffer;
+  size_t compressed_buffer_len;
+  z_stream strm;
+};
+
+static uint64_t gzip_frames_read_uint_le(const uchar *buf, const int bytes)
+{
+  uint64_t value = 0;
+  for (int i = bytes - 1; i >= 0; i--) {
+    value = (value << 8) | buf[i];
+  }
+  return value;
+}
+
+/**
+ * Check an empty gzip member with a single extra sub-field as written by #BLO_write_file.
+ *
+ * \return The sub-field data or NULL when the member doesn't match.
+ */
+static const uchar *gzip_frames_extra_member_data(const uchar *member,
+                                                  const size_t member_len,
+                                                  const char id[2],
+                                                  size_t *r_data_len)
+{
+  const uchar header[10] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff};
+  const uchar tail[10] = {0x03, 0x00, 0, 0, 0, 0, 0, 0, 0, 0};
+  if ((member_len < BLO_GZIP_MEMBER_EXTRA_LEN) || (memcmp(member, header, sizeof(header)) != 0) ||
+      (member[12] != (uchar)id[0]) || (member[13] != (uchar)id[1])) {
+    return NULL;
+  }
+  const size_t data_len = (size_t)gzip_frames_read_uint_le(&member[14], 2);
+  if ((gzip_frames_read_uint_le(&member[10], 2) != data_len + 4) ||
+      (BLO_GZIP_MEMBER_EXTRA_LEN + data_len > member_len) ||
+      (memcmp(&member[16 + data_len], tail, sizeof(tail)) != 0)) {
+    return NULL;
+  }
+  *r_data_len = data_len;
+  return &member[16];
+}
+
+void blo_gzip_frames_reader_free(GZipFramesReader *frames)
+{
+  inflateEnd(&frames->strm);
+  MEM_SAFE_FREE(frames->compressed_offset);
+  MEM_SAFE_FREE(frames->uncompressed_offset);
+  MEM_SAFE_FREE(frames->buffer);
+  MEM_SAFE_FREE(frames->compressed_buffer);
+  MEM_freeN(frames);
+}
+
+/**
+ * Read the seek table of a compressed file, \a file is used for reading frames later on but isn't
+ * owned by the reader. The file position is left undefined.
+ *
+ * \return NULL for regular gzip files (written without frames or by other applications).
+ */
+GZipFramesReader *blo_gzip_frames_reader_open(int file)
+{
+  const size_t footer_len = BLO_GZIP_MEMBER_EXTRA_LEN + BLO_GZIP_FRAMES_FOOTER_DATA_LEN;
+  const size_t file_size = BLI_file_descriptor_size(file);
+  if ((file_size == (size_t)-1) || (file_size < footer_len)) {
+    return NULL;
+  }
+
+  uchar footer[BLO_GZIP_MEMBER_EXTRA_LEN + BLO_GZIP_FRAMES_FOOTER_DATA_LEN];
+  if ((BLI_lseek(file, (off64_t)(file_size - footer_len), SEEK_SET) == -1) ||
+      (read(file, footer, footer_len) != (ssize_t)footer_len)) {
+    return NULL;
+  }
+  size_t footer_data_len;
+  const uchar *footer_data = gzip_frames_extra_member_data(
+      footer, footer_len, BLO_GZIP_FRAMES_FOOTER_ID, &footer_data_len);
+  if ((footer_data == NULL) || (footer_data_len != BLO_GZIP_FRAMES_FOOTER_DATA_LEN)) {
+    return NULL;
+  }
+  const uint64_t table_offset = gzip_frames_read_uint_le(&footer_data[0], 8);
+  const uint64_t frames_len = gzip_frames_read_uint_le(&footer_data[8], 4);
+  if ((frames_len == 0) || (frames_len > INT_MAX) || (table_offset >= file_size - footer_len)) {
+    return NULL;
+  }
+
+  /* Read all table members at once. */
+  const size_t table_len = file_size - footer_len - (size_t)table_offset;
+  uchar *table = MEM_mallocN(table_len, __func__);
+  if ((BLI_lseek(file, (off64_t)table_offset, SEEK_SET) == -1) ||
+      (read(file, table, table_len) != (ssize_t)table_len)) {
+    MEM_freeN(table);
+    return NULL;
+  }
+
+  GZipFramesReader *frames = MEM_callocN(sizeof(*frames), __func__);
+  frames->file_handle = file;
+  frames->frames_len = (int)frames_len;
+  frames->frame_index = -1;
+  frames->compressed_offset = MEM_mallocN(sizeof(off64_t) * (frames_len + 1), __func__);
+  frames->uncompressed_offset = MEM_mallocN(sizeof(off64_t) * (frames_len + 1), __func__);
+  frames->compressed_offset[0] = 0;
+  frames->uncompressed_offset[0] = 0;
+
+  bool ok = (inflateInit2(&frames->strm, MAX_WBITS + 16) == Z_OK);
+  size_t buffer_len = 0;
+  size_t table_iter = 0;
+  int frame = 0;
+  while (ok && (frame < frames->frames_len)) {
+    size_t data_len;
+    const uchar *data = gzip_frames_extra_member_data(
+        &table[table_iter], table_len - table_iter, BLO_GZIP_FRAMES_TABLE_ID, &data_len);
+    if ((data == NULL) || (data_len == 0) || (data_len % 8) ||
+        (data_len / 8 > (size_t)(frames->frames_len - frame))) {
+      ok = false;
+      break;
+    }
+    for (size_t i = 0; i < data_len; i += 8, frame++) {
+      const uint64_t compressed_len = gzip_frames_read_uint_le(&data[i], 4);
+      const uint64_t uncompressed_len = gzip_frames_read_uint_le(&data[i + 4], 4);
+      frames->compressed_offset[frame + 1] = frames->compressed_offset[frame] +
+                                             (off64_t)compressed_len;
+      frames->uncompressed_offset[frame + 1] = frames->uncompressed_offset[frame] +
+                                               (off64_t)uncompressed_len;
+      buffer_len = MAX2(buffer_len, (size_t)uncompressed_len);
+    }
+    table_iter += BLO_GZIP_MEMBER_EXTRA_LEN + data_len;
+  }
+  MEM_freeN(table);
+
+  /* Frames must be followed by the table and can't be larger than they're written. */
+  if (!ok || (table_iter != table_len) ||
+      (frames->compressed_offset[frames->frames_len] != (off64_t)table_offset) ||
+      (buffer_len > BLO_GZIP_FRAME_SIZE)) {
+    blo_gzip_frames_reader_free(frames);
+    return NULL;
+  }
+
+  frames->buffer = MEM_mallocN(MAX2(buffer_len, 1), __func__);
+  return frames;
+}
+
+static int gzip_frames_find(const GZipFramesReader *frames, off64_t offset)
+{
+  const int frame_index = frames->frame_index;
+  if ((frame_index != -1) && (offset >= frames->uncompressed_offset[frame_index]) &&
+      (offset < frames->uncompressed_offset[frame_index + 1])) {
+    return frame_index;
+  }
+  if ((offset < 0) || (offset >= frames->uncompressed_offset[frames->frames_len])) {
+    return -1;
+  }
+  /* Binary search for the last frame starting at or before the offset. */
+  int low = 0, high = frames->frames_len - 1;
+  while (low < high) {
+    const int mid = (low + high + 1) / 2;
+    if (frames->uncompressed_offset[mid] <= offset) {
+      low = mid;
+    }
+    else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
+static bool gzip_frames_decompress(GZipFramesReader *frames, const int frame)
+{
+  if (frames->frame_index == frame) {
+    return true;
+  }
+  frames->frame_index = -1;
+
+  const size_t compressed_len = (size_t)(frames->compressed_offset[frame + 1] -
+                                         frames->compressed_offset[frame]);
+  const size_t uncompressed_len = (size_t)(frames->uncompressed_offset[frame + 1] -
+                                           frames->uncompressed_offset[frame]);
+  if (frames->compressed_buffer_len < compressed_len) {
+    MEM_SAFE_FREE(frames->compressed_buffer);
+    frames->compressed_buffer = MEM_mallocN(compressed_len, __func__);
+    frames->compressed_buffer_len = compressed_len;
+  }
+  if ((BLI_lseek(frames->file_handle, frames->compressed_offset[frame], SEEK_SET) == -1) ||
+      (read(frames->file_handle, frames->compressed_buffer, compressed_len) !=
+       (ssize_t)compressed_len)) {
+    return false;
+  }
+
+  z_stream *strm = &frames->strm;
+  if (inflateReset(strm) != Z_OK) {
+    return false;
+  }
+  strm->next_in = (Bytef *)frames->compressed_buffer;
+  strm->avail_in = (uInt)compressed_len;
+  strm->next_out = (Bytef *)frames->buffer;
+  strm->avail_out = (uInt)uncompressed_len;
+  if ((inflate(strm, Z_FINISH) != Z_STREAM_END) || (strm->total_out != uncompressed_len)) {
+    return false;
+  }
+
+  frames->frame_index = frame;
+  return true;
+}
+
+/**
+ * Read \a size bytes of uncompressed data starting at \a offset.
+ *
+ * \return The number of bytes read (less than \a size at the end of the data), or -1 on error.
+ */
+ssize_t blo_gzip_frames_reader_read(GZipFramesReader *frames,
+                                    off64_t offset,
+                                    void *buffer,
+                                    size_t size)
+{
+  size_t readsize = 0;
+
+  while (readsize < size) {
+    const int frame = gzip_frames_find(frames, offset);
+    if (frame == -1) {
+      break;
+    }
+    if (!gzip_frames_decompress(frames, frame)) {
+      return -1;
+    }
+    const size_t frame_offset = (size_t)(offset - frames->uncompressed_offset[frame]);
+    const size_t frame_len = (size_t)(frames->uncompressed_offset[frame + 1] -
+                                      frames->uncompressed_offset[frame]);
+    const size_t len = MIN2(size - readsize, frame_len - frame_offset);
+    memcpy((char *)buffer + readsize, frames->buffer + frame_offset, len);
+    readsize += len;
+    offset += (off64_t)len;
+  }
+
+  return (ssize_t)readsize;
+}
+
+/** Size of the uncompressed data. */
+off64_t blo_gzip_frames_reader_size(const GZipFramesReader *frames)
+{
+  return frames->uncompressed_offset[frames->frames_len];
+}
+
+/** \} */
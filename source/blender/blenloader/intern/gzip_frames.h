@@ -0,0 +1,65 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup blenloader
+ *
+ * Compressed files are written as a sequence of independently compressed gzip members
+ * (frames), so they can be compressed on multiple threads and read with random access.
+ * Concatenated gzip members are a valid gzip stream, older versions read these files as before.
+ *
+ * The seek table is stored in the extra field of empty gzip members following the frames:
+ * - Table members with a #BLO_GZIP_FRAMES_TABLE_ID sub-field,
+ *   holding the compressed & uncompressed size of each frame (little endian `uint32_t` pairs).
+ * - A footer member with a #BLO_GZIP_FRAMES_FOOTER_ID sub-field, holding the file offset
+ *   of the first table member (little endian `uint64_t`) and the number of frames (`uint32_t`).
+ */
+
+#pragma once
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLO_GZIP_FRAME_SIZE (1 << 20)
+#define BLO_GZIP_FRAMES_TABLE_ID "BT"
+#define BLO_GZIP_FRAMES_FOOTER_ID "BF"
+/** Frames per table member, the extra field can't be larger than 64 KiB. */
+#define BLO_GZIP_FRAMES_TABLE_MEMBER_FRAMES 8000
+/** Size of an empty gzip member with a single extra sub-field (excluding the sub-field data). */
+#define BLO_GZIP_MEMBER_EXTRA_LEN (10 + 2 + 4 + 2 + 8)
+#define BLO_GZIP_FRAMES_FOOTER_DATA_LEN (8 + 4)
+
+typedef struct GZipFramesWriter GZipFramesWriter;
+typedef struct GZipFramesReader GZipFramesReader;
+
+GZipFramesWriter *blo_gzip_frames_writer_new(int file_handle);
+bool blo_gzip_frames_writer_write(GZipFramesWriter *gz, const char *buf, size_t buf_len);
+bool blo_gzip_frames_writer_close(GZipFramesWriter *gz);
+
+GZipFramesReader *blo_gzip_frames_reader_open(int file_handle);
+ssize_t blo_gzip_frames_reader_read(GZipFramesReader *frames,
+                                    off64_t offset,
+                                    void *buffer,
+                                    size_t size);
+off64_t blo_gzip_frames_reader_size(const GZipFramesReader *frames);
+void blo_gzip_frames_reader_free(GZipFramesReader *frames);
+
+#ifdef __cplusplus
+}
+#endif
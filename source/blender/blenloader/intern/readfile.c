@@ -33,7 +33,8 @@
 
 #include "BLI_utildefines.h"
 #ifndef WIN32
-#  include <unistd.h> /* for read close */
+#  include <sys/mman.h> /* for mmap */
+#  include <unistd.h>   /* for read close */
 #else
 #  include "BLI_winstuff.h"
 #  include "winsock2.h"
@@ -65,6 +66,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -103,6 +105,7 @@
 
 #include "SEQ_sequencer.h"
 
+#include "gzip_frames.h"
 #include "readfile.h"
 
 #include <errno.h>
@@ -166,9 +169,28 @@
  *
  * \note This is disabled when using compression,
  * while zlib supports seek it's unusably slow, see: T61880.
+ * Except for compressed files written with seekable frames, see: #BLO_GZIP_FRAME_SIZE.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
+/**
+ * Map uncompressed files into memory instead of reading them through `read()`.
+ *
+ * Blocks that are read on demand are copied directly out of the mapping into their final
+ * allocation (or passed to #DNA_struct_reconstruct without any intermediate copy),
+ * the pages are shared with the file-system cache so loading the same file again is cheap.
+ */
+#if defined(USE_BHEAD_READ_ON_DEMAND) && !defined(WIN32)
+#  define USE_BHEAD_READ_MMAP
+#endif
+
+/**
+ * When loading a file which needs converting (older versions or different endianness),
+ * convert large data blocks on multiple threads before reading the data-blocks.
+ * See #read_struct_prepare_parallel.
+ */
+#define USE_BHEAD_RECONSTRUCT_PARALLEL
+
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
@@ -200,6 +222,10 @@ typedef struct BHeadN {
   bool has_data;
 #endif
   bool is_memchunk_identical;
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+  /** The result of #read_struct, converted ahead of time (owned until it's read). */
+  void *data_prepared;
+#endif
   struct BHead bhead;
 } BHeadN;
 
@@ -252,54 +278,74 @@ typedef struct OldNew {
   int nr;
 } OldNew;
 
+/**
+ * Open addressing hash table which stores the entries in the slots directly,
+ * so most lookups only access a single cache line.
+ * Empty slots have a NULL `oldp` (NULL pointers are never inserted).
+ */
 typedef struct OldNewMap {
-  /* Array that stores the actual entries. */
-  OldNew *entries;
-  int nentries;
-  /* Hashmap that stores indices into the `entries` array. */
-  int32_t *map;
-
+  OldNew *slots;
+  int slots_used;
   int capacity_exp;
 } OldNewMap;
 
-#define ENTRIES_CAPACITY(onm) (1ll << (onm)->capacity_exp)
-#define MAP_CAPACITY(onm) (1ll << ((onm)->capacity_exp + 1))
-#define SLOT_MASK(onm) (MAP_CAPACITY(onm) - 1)
-#define DEFAULT_SIZE_EXP 6
+#define SLOTS_CAPACITY(onm) (1ll << (onm)->capacity_exp)
+/* Grow the map before more than half of the slots are used. */
+#define SLOTS_USABLE(onm) (SLOTS_CAPACITY(onm) >> 1)
+#define SLOT_MASK(onm) (SLOTS_CAPACITY(onm) - 1)
+#define DEFAULT_SIZE_EXP 7
 #define PERTURB_SHIFT 5
+/* Number of lookups to prefetch ahead, see #blo_oldnewmap_lookup_array. */
+#define LOOKUP_BATCH_SIZE 8
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define PREFETCH_SLOT(slot) __builtin_prefetch(slot)
+#else
+#  define PREFETCH_SLOT(slot) (void)(slot)
+#endif
+
+/* Same as #BLI_ghashutil_ptrhash, inlined since it's called for every pointer that's read. */
+BLI_INLINE uint oldnewmap_hash(const void *key)
+{
+  size_t y = (size_t)key;
+  /* Bottom 3 or 4 bits are likely to be 0; rotate y by 4 to avoid
+   * excessive hash collisions. */
+  y = (y >> 4) | (y << (8 * sizeof(void *) - 4));
+  return (uint)y;
+}
 
 /* based on the probing algorithm used in Python dicts. */
-#define ITER_SLOTS(onm, KEY, SLOT_NAME, INDEX_NAME) \
-  uint32_t hash = BLI_ghashutil_ptrhash(KEY); \
+#define ITER_SLOTS(onm, KEY, SLOT_NAME) \
+  uint32_t hash = oldnewmap_hash(KEY); \
   uint32_t mask = SLOT_MASK(onm); \
   uint perturb = hash; \
-  int SLOT_NAME = mask & hash; \
-  int INDEX_NAME = onm->map[SLOT_NAME]; \
-  for (;; SLOT_NAME = mask & ((5 * SLOT_NAME) + 1 + perturb), \
-          perturb >>= PERTURB_SHIFT, \
-          INDEX_NAME = onm->map[SLOT_NAME])
+  uint32_t SLOT_NAME = mask & hash; \
+  for (;; SLOT_NAME = mask & ((5 * SLOT_NAME) + 1 + perturb), perturb >>= PERTURB_SHIFT)
 
-static void oldnewmap_insert_index_in_map(OldNewMap *onm, const void *ptr, int index)
+/* Insert an entry known not to be in the map. */
+static void oldnewmap_insert_new(OldNewMap *onm, const OldNew *entry)
 {
-  ITER_SLOTS (onm, ptr, slot, stored_index) {
-    if (stored_index == -1) {
-      onm->map[slot] = index;
+  ITER_SLOTS (onm, entry->oldp, slot) {
+    OldNew *slot_entry = &onm->slots[slot];
+    if (slot_entry->oldp == NULL) {
+      *slot_entry = *entry;
+      onm->slots_used++;
       break;
     }
   }
 }
 
-static void oldnewmap_insert_or_replace(OldNewMap *onm, OldNew entry)
+static void oldnewmap_insert_or_replace(OldNewMap *onm, const OldNew *entry)
 {
-  ITER_SLOTS (onm, entry.oldp, slot, index) {
-    if (index == -1) {
-      onm->entries[onm->nentries] = entry;
-      onm->map[slot] = onm->nentries;
-      onm->nentries++;
+  ITER_SLOTS (onm, entry->oldp, slot) {
+    OldNew *slot_entry = &onm->slots[slot];
+    if (slot_entry->oldp == NULL) {
+      *slot_entry = *entry;
+      onm->slots_used++;
       break;
     }
-    if (onm->entries[index].oldp == entry.oldp) {
-      onm->entries[index] = entry;
+    if (slot_entry->oldp == entry->oldp) {
+      *slot_entry = *entry;
       break;
     }
   }
@@ -307,57 +353,62 @@ static void oldnewmap_insert_or_replace(OldNewMap *onm, OldNew entry)
 
 static OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
 {
-  ITER_SLOTS (onm, addr, slot, index) {
-    if (index >= 0) {
-      OldNew *entry = &onm->entries[index];
-      if (entry->oldp == addr) {
-        return entry;
-      }
+  if (addr == NULL) {
+    return NULL;
+  }
+  ITER_SLOTS (onm, addr, slot) {
+    OldNew *entry = &onm->slots[slot];
+    if (entry->oldp == addr) {
+      return entry;
     }
-    else {
+    if (entry->oldp == NULL) {
       return NULL;
     }
   }
 }
 
-static void oldnewmap_clear_map(OldNewMap *onm)
+/** Number of slots, for iterating over all entries (skipping slots with a NULL `oldp`). */
+static int64_t oldnewmap_slots_len(const OldNewMap *onm)
 {
-  memset(onm->map, 0xFF, MAP_CAPACITY(onm) * sizeof(*onm->map));
+  return SLOTS_CAPACITY(onm);
+}
+
+static void oldnewmap_slots_alloc(OldNewMap *onm, int capacity_exp)
+{
+  onm->capacity_exp = capacity_exp;
+  onm->slots = MEM_calloc_arrayN(SLOTS_CAPACITY(onm), sizeof(*onm->slots), "OldNewMap.slots");
+  onm->slots_used = 0;
 }
 
 static void oldnewmap_increase_size(OldNewMap *onm)
 {
-  onm->capacity_exp++;
-  onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * ENTRIES_CAPACITY(onm));
-  onm->map = MEM_reallocN(onm->map, sizeof(*onm->map) * MAP_CAPACITY(onm));
-  oldnewmap_clear_map(onm);
-  for (int i = 0; i < onm->nentries; i++) {
-    oldnewmap_insert_index_in_map(onm, onm->entries[i].oldp, i);
+  OldNew *slots_old = onm->slots;
+  const int64_t slots_old_len = SLOTS_CAPACITY(onm);
+  oldnewmap_slots_alloc(onm, onm->capacity_exp + 1);
+  for (int64_t i = 0; i < slots_old_len; i++) {
+    if (slots_old[i].oldp != NULL) {
+      oldnewmap_insert_new(onm, &slots_old[i]);
+    }
   }
+  MEM_freeN(slots_old);
 }
 
 /* Public OldNewMap API */
 
-static OldNewMap *oldnewmap_new(void)
+OldNewMap *blo_oldnewmap_new(void)
 {
   OldNewMap *onm = MEM_callocN(sizeof(*onm), "OldNewMap");
-
-  onm->capacity_exp = DEFAULT_SIZE_EXP;
-  onm->entries = MEM_malloc_arrayN(
-      ENTRIES_CAPACITY(onm), sizeof(*onm->entries), "OldNewMap.entries");
-  onm->map = MEM_malloc_arrayN(MAP_CAPACITY(onm), sizeof(*onm->map), "OldNewMap.map");
-  oldnewmap_clear_map(onm);
-
+  oldnewmap_slots_alloc(onm, DEFAULT_SIZE_EXP);
   return onm;
 }
 
-static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
+void blo_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
 {
   if (oldaddr == NULL || newaddr == NULL) {
     return;
   }
 
-  if (UNLIKELY(onm->nentries == ENTRIES_CAPACITY(onm))) {
+  if (UNLIKELY(onm->slots_used == SLOTS_USABLE(onm))) {
     oldnewmap_increase_size(onm);
   }
 
@@ -365,15 +416,15 @@ static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr,
   entry.oldp = oldaddr;
   entry.newp = newaddr;
   entry.nr = nr;
-  oldnewmap_insert_or_replace(onm, entry);
+  oldnewmap_insert_or_replace(onm, &entry);
 }
 
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
 {
-  oldnewmap_insert(onm, oldaddr, newaddr, nr);
+  blo_oldnewmap_insert(onm, oldaddr, newaddr, nr);
 }
 
-static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
+void *blo_oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
 {
   OldNew *entry = oldnewmap_lookup_entry(onm, addr);
   if (entry == NULL) {
@@ -385,14 +436,32 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool inc
   return entry->newp;
 }
 
+/**
+ * Look up an array of pointers in place, prefetching the first slot of the following lookups
+ * to hide the memory latency of large maps.
+ */
+void blo_oldnewmap_lookup_array(OldNewMap *onm, void **addr_array, int len, bool increase_users)
+{
+  const uint32_t mask = SLOT_MASK(onm);
+  for (int i = 0; i < len; i += LOOKUP_BATCH_SIZE) {
+    const int batch_len = min_ii(len - i, LOOKUP_BATCH_SIZE);
+    for (int j = 0; j < batch_len; j++) {
+      PREFETCH_SLOT(&onm->slots[mask & oldnewmap_hash(addr_array[i + j])]);
+    }
+    for (int j = 0; j < batch_len; j++) {
+      addr_array[i + j] = blo_oldnewmap_lookup_and_inc(onm, addr_array[i + j], increase_users);
+    }
+  }
+}
+
 /* for libdata, OldNew.nr has ID code, no increment */
-static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *lib)
+void *blo_oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *lib)
 {
   if (addr == NULL) {
     return NULL;
   }
 
-  ID *id = oldnewmap_lookup_and_inc(onm, addr, false);
+  ID *id = blo_oldnewmap_lookup_and_inc(onm, addr, false);
   if (id == NULL) {
     return NULL;
   }
@@ -402,34 +471,42 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
   return NULL;
 }
 
-static void oldnewmap_clear(OldNewMap *onm)
+void blo_oldnewmap_clear(OldNewMap *onm)
 {
   /* Free unused data. */
-  for (int i = 0; i < onm->nentries; i++) {
-    OldNew *entry = &onm->entries[i];
-    if (entry->nr == 0) {
+  const int64_t slots_len = SLOTS_CAPACITY(onm);
+  for (int64_t i = 0; i < slots_len; i++) {
+    OldNew *entry = &onm->slots[i];
+    if (entry->oldp != NULL && entry->nr == 0) {
       MEM_freeN(entry->newp);
       entry->newp = NULL;
     }
   }
 
-  onm->capacity_exp = DEFAULT_SIZE_EXP;
-  oldnewmap_clear_map(onm);
-  onm->nentries = 0;
+  /* Shrink back to the default size, keeping small maps cache friendly. */
+  if (onm->capacity_exp != DEFAULT_SIZE_EXP) {
+    MEM_freeN(onm->slots);
+    oldnewmap_slots_alloc(onm, DEFAULT_SIZE_EXP);
+  }
+  else {
+    memset(onm->slots, 0, sizeof(*onm->slots) * (size_t)slots_len);
+    onm->slots_used = 0;
+  }
 }
 
-static void oldnewmap_free(OldNewMap *onm)
+void blo_oldnewmap_free(OldNewMap *onm)
 {
-  MEM_freeN(onm->entries);
-  MEM_freeN(onm->map);
+  MEM_freeN(onm->slots);
   MEM_freeN(onm);
 }
 
-#undef ENTRIES_CAPACITY
-#undef MAP_CAPACITY
+#undef SLOTS_CAPACITY
+#undef SLOTS_USABLE
 #undef SLOT_MASK
 #undef DEFAULT_SIZE_EXP
 #undef PERTURB_SHIFT
+#undef LOOKUP_BATCH_SIZE
+#undef PREFETCH_SLOT
 #undef ITER_SLOTS
 
 /** \} */
@@ -812,6 +889,9 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = fd->file_offset;
           new_bhead->has_data = false;
           new_bhead->is_memchunk_identical = false;
+#  ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+          new_bhead->data_prepared = NULL;
+#  endif
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->seek(fd, bhead.len, SEEK_CUR);
           if (seek_new == -1) {
@@ -835,6 +915,9 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->has_data = true;
 #endif
           new_bhead->is_memchunk_identical = false;
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+          new_bhead->data_prepared = NULL;
+#endif
           new_bhead->bhead = bhead;
 
           readsize = fd->read(
@@ -918,11 +1001,41 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
 }
 
 #ifdef USE_BHEAD_READ_ON_DEMAND
+
+#  ifdef USE_BHEAD_READ_MMAP
+/**
+ * Access the data of a block which hasn't been read, directly from the file mapping.
+ *
+ * \return NULL when the file isn't mapped.
+ * \note The data must be treated as read-only.
+ */
+static const void *blo_bhead_data_mapped(const FileData *fd, const BHead *thisblock)
+{
+  if (fd->mmap_data == NULL) {
+    return NULL;
+  }
+  const BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  /* Bounds are checked by #fd_seek_from_mmap when skipping over the data in #get_bhead. */
+  BLI_assert((size_t)new_bhead->file_offset + (size_t)thisblock->len <= fd->mmap_size);
+  return fd->mmap_data + new_bhead->file_offset;
+}
+#  endif
+
 static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
 {
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+#  ifdef USE_BHEAD_READ_MMAP
+  {
+    const void *data_mapped = blo_bhead_data_mapped(fd, thisblock);
+    if (data_mapped != NULL) {
+      memcpy(buf, data_mapped, (size_t)thisblock->len);
+      return true;
+    }
+  }
+#  endif
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -947,6 +1060,9 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
   new_bhead_data->is_memchunk_identical = false;
+#  ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+  new_bhead_data->data_prepared = NULL;
+#  endif
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
     return NULL;
@@ -1124,6 +1240,54 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+#ifdef USE_BHEAD_READ_MMAP
+
+/* Memory mapped file reading. */
+
+static ssize_t fd_read_from_mmap(FileData *filedata,
+                                 void *buffer,
+                                 size_t size,
+                                 bool *UNUSED(r_is_memchunck_identical))
+{
+  const size_t offset = (size_t)filedata->file_offset;
+  /* Don't read more bytes than there are available in the mapping. */
+  const size_t readsize = (offset < filedata->mmap_size) ?
+                              MIN2(size, filedata->mmap_size - offset) :
+                              0;
+
+  memcpy(buffer, filedata->mmap_data + offset, readsize);
+  filedata->file_offset += (off64_t)readsize;
+
+  return (ssize_t)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t offset_new;
+  switch (whence) {
+    case SEEK_SET:
+      offset_new = offset;
+      break;
+    case SEEK_CUR:
+      offset_new = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      offset_new = (off64_t)filedata->mmap_size + offset;
+      break;
+    default:
+      return -1;
+  }
+  /* Unlike `lseek`, seeking past the end is an error,
+   * since it means the file is truncated. */
+  if (offset_new < 0 || offset_new > (off64_t)filedata->mmap_size) {
+    return -1;
+  }
+  filedata->file_offset = offset_new;
+  return offset_new;
+}
+
+#endif /* USE_BHEAD_READ_MMAP */
+
 /* GZip file reading. */
 
 static ssize_t fd_read_gzip_from_file(FileData *filedata,
@@ -1145,6 +1309,47 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+/* Seekable GZip frames reading (see #BLO_GZIP_FRAME_SIZE). */
+
+static ssize_t fd_read_gzip_frames_from_file(FileData *filedata,
+                                             void *buffer,
+                                             size_t size,
+                                             bool *UNUSED(r_is_memchunck_identical))
+{
+  const ssize_t readsize = blo_gzip_frames_reader_read(
+      filedata->gzip_frames, filedata->file_offset, buffer, size);
+  if (readsize < 0) {
+    return EOF;
+  }
+  filedata->file_offset += (off64_t)readsize;
+  return readsize;
+}
+
+static off64_t fd_seek_gzip_frames_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  const off64_t size = blo_gzip_frames_reader_size(filedata->gzip_frames);
+  off64_t offset_new;
+  switch (whence) {
+    case SEEK_SET:
+      offset_new = offset;
+      break;
+    case SEEK_CUR:
+      offset_new = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      offset_new = size + offset;
+      break;
+    default:
+      return -1;
+  }
+  if (offset_new < 0 || offset_new > size) {
+    return -1;
+  }
+  /* Frames are only decompressed when reading. */
+  filedata->file_offset = offset_new;
+  return offset_new;
+}
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1252,9 +1457,9 @@ static FileData *filedata_new(void)
 
   fd->memsdna = DNA_sdna_current_get();
 
-  fd->datamap = oldnewmap_new();
-  fd->globmap = oldnewmap_new();
-  fd->libmap = oldnewmap_new();
+  fd->datamap = blo_oldnewmap_new();
+  fd->globmap = blo_oldnewmap_new();
+  fd->libmap = blo_oldnewmap_new();
 
   return fd;
 }
@@ -1290,6 +1495,11 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  GZipFramesReader *gzip_frames = NULL;
+#ifdef USE_BHEAD_READ_MMAP
+  const char *mmap_data = NULL;
+  size_t mmap_size = 0;
+#endif
 
   char header[7];
 
@@ -1310,6 +1520,32 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
     read_fn = fd_read_data_from_file;
     seek_fn = fd_seek_data_from_file;
+
+#ifdef USE_BHEAD_READ_MMAP
+    /* Map the file when possible, otherwise fall back to regular reading. */
+    const size_t file_size = BLI_file_descriptor_size(file);
+    if (!ELEM(file_size, 0, (size_t)-1)) {
+      void *mem = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, file, 0);
+      if (mem != MAP_FAILED) {
+        mmap_data = mem;
+        mmap_size = file_size;
+        read_fn = fd_read_from_mmap;
+        seek_fn = fd_seek_from_mmap;
+      }
+    }
+#endif
+  }
+
+  /* Gzip file with seekable frames. */
+  if ((read_fn == NULL) &&
+      /* Check header magic. */
+      (header[0] == 0x1f && header[1] == 0x8b)) {
+    gzip_frames = blo_gzip_frames_reader_open(file);
+    BLI_lseek(file, 0, SEEK_SET);
+    if (gzip_frames != NULL) {
+      read_fn = fd_read_gzip_frames_from_file;
+      seek_fn = fd_seek_gzip_frames_from_file;
+    }
   }
 
   /* Gzip file. */
@@ -1342,6 +1578,11 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->gzip_frames = gzip_frames;
+#ifdef USE_BHEAD_READ_MMAP
+  fd->mmap_data = mmap_data;
+  fd->mmap_size = mmap_size;
+#endif
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1502,6 +1743,17 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->gzip_frames != NULL) {
+      blo_gzip_frames_reader_free(fd->gzip_frames);
+    }
+
+#ifdef USE_BHEAD_READ_MMAP
+    if (fd->mmap_data != NULL) {
+      munmap((void *)fd->mmap_data, fd->mmap_size);
+      fd->mmap_data = NULL;
+    }
+#endif
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1513,6 +1765,13 @@ void blo_filedata_free(FileData *fd)
       fd->buffer = NULL;
     }
 
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+    /* Free converted data which was never read. */
+    LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+      MEM_SAFE_FREE(new_bhead->data_prepared);
+    }
+#endif
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -1537,16 +1796,16 @@ void blo_filedata_free(FileData *fd)
     }
 
     if (fd->datamap) {
-      oldnewmap_free(fd->datamap);
+      blo_oldnewmap_free(fd->datamap);
     }
     if (fd->globmap) {
-      oldnewmap_free(fd->globmap);
+      blo_oldnewmap_free(fd->globmap);
     }
     if (fd->packedmap) {
-      oldnewmap_free(fd->packedmap);
+      blo_oldnewmap_free(fd->packedmap);
     }
     if (fd->libmap && !(fd->flags & FD_FLAGS_NOT_MY_LIBMAP)) {
-      oldnewmap_free(fd->libmap);
+      blo_oldnewmap_free(fd->libmap);
     }
     if (fd->old_idmap != NULL) {
       BKE_main_idmap_destroy(fd->old_idmap);
@@ -1703,35 +1962,35 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 /* only direct databocks */
 static void *newdataadr(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* only direct databocks */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, false);
 }
 
 /* direct datablocks with global linking */
 void *blo_read_get_new_globaldata_address(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->globmap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->globmap, adr, true);
 }
 
 /* used to restore packed data after undo */
 static void *newpackedadr(FileData *fd, const void *adr)
 {
   if (fd->packedmap && adr) {
-    return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
+    return blo_oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* only lib data */
 static void *newlibadr(FileData *fd, const void *lib, const void *adr)
 {
-  return oldnewmap_liblookup(fd->libmap, adr, lib);
+  return blo_oldnewmap_liblookup(fd->libmap, adr, lib);
 }
 
 /* only lib data */
@@ -1743,10 +2002,11 @@ void *blo_do_versions_newlibadr(FileData *fd, const void *lib, const void *adr)
 /* increases user number */
 static void change_link_placeholder_to_real_ID_pointer_fd(FileData *fd, const void *old, void *new)
 {
-  for (int i = 0; i < fd->libmap->nentries; i++) {
-    OldNew *entry = &fd->libmap->entries[i];
+  const int64_t slots_len = oldnewmap_slots_len(fd->libmap);
+  for (int64_t i = 0; i < slots_len; i++) {
+    OldNew *entry = &fd->libmap->slots[i];
 
-    if (old == entry->newp && entry->nr == ID_LINK_PLACEHOLDER) {
+    if (entry->oldp != NULL && old == entry->newp && entry->nr == ID_LINK_PLACEHOLDER) {
       entry->newp = new;
       if (new) {
         entry->nr = GS(((ID *)new)->name);
@@ -1796,13 +2056,13 @@ void blo_clear_proxy_pointers_from_lib(Main *oldmain)
 
 static void insert_packedmap(FileData *fd, PackedFile *pf)
 {
-  oldnewmap_insert(fd->packedmap, pf, pf, 0);
-  oldnewmap_insert(fd->packedmap, pf->data, pf->data, 0);
+  blo_oldnewmap_insert(fd->packedmap, pf, pf, 0);
+  blo_oldnewmap_insert(fd->packedmap, pf->data, pf->data, 0);
 }
 
 void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
 {
-  fd->packedmap = oldnewmap_new();
+  fd->packedmap = blo_oldnewmap_new();
 
   LISTBASE_FOREACH (Image *, ima, &oldmain->images) {
     if (ima->packedfile) {
@@ -1845,11 +2105,12 @@ void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
 /* this works because freeing old main only happens after this call */
 void blo_end_packed_pointer_map(FileData *fd, Main *oldmain)
 {
-  OldNew *entry = fd->packedmap->entries;
+  OldNew *entry = fd->packedmap->slots;
 
   /* used entries were restored, so we put them to zero */
-  for (int i = 0; i < fd->packedmap->nentries; i++, entry++) {
-    if (entry->nr > 0) {
+  const int64_t slots_len = oldnewmap_slots_len(fd->packedmap);
+  for (int64_t i = 0; i < slots_len; i++, entry++) {
+    if (entry->oldp != NULL && entry->nr > 0) {
       entry->newp = NULL;
     }
   }
@@ -1888,7 +2149,7 @@ void blo_add_library_pointer_map(ListBase *old_mainlist, FileData *fd)
     int i = set_listbasepointers(ptr, lbarray);
     while (i--) {
       LISTBASE_FOREACH (ID *, id, lbarray[i]) {
-        oldnewmap_insert(fd->libmap, id, id, GS(id->name));
+        blo_oldnewmap_insert(fd->libmap, id, id, GS(id->name));
       }
     }
   }
@@ -2052,12 +2313,10 @@ void blo_cache_storage_end(FileData *fd)
 /** \name DNA Struct Loading
  * \{ */
 
-static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
+static void switch_endian_structs_data(const struct SDNA *filesdna, BHead *bhead, char *data)
 {
   int blocksize, nblocks;
-  char *data;
 
-  data = (char *)(bhead + 1);
   blocksize = filesdna->types_size[filesdna->structs[bhead->SDNAnr]->type];
 
   nblocks = bhead->nr;
@@ -2068,11 +2327,27 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
+static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
+{
+  switch_endian_structs_data(filesdna, bhead, (char *)(bhead + 1));
+}
+
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 {
   void *temp = NULL;
 
   if (bh->len) {
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+    {
+      BHeadN *new_bhead = BHEADN_FROM_BHEAD(bh);
+      if (new_bhead->data_prepared != NULL) {
+        temp = new_bhead->data_prepared;
+        new_bhead->data_prepared = NULL;
+        return temp;
+      }
+    }
+#endif
+
 #ifdef USE_BHEAD_READ_ON_DEMAND
     BHead *bh_orig = bh;
 #endif
@@ -2093,16 +2368,29 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+#  ifdef USE_BHEAD_READ_MMAP
+          const void *data_mapped = blo_bhead_data_mapped(fd, bh);
+#  else
+          const void *data_mapped = NULL;
+#  endif
+          if (data_mapped != NULL) {
+            /* Reconstruct directly from the mapping, the data is only read from. */
+            data = data_mapped;
+          }
+          else {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data);
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2136,6 +2424,152 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+
+/** Only convert blocks ahead of time when they're large enough to be worth the overhead. */
+#  define READ_STRUCT_PREPARE_MIN_LEN (1 << 16)
+/** Limit the memory used by temporary copies of blocks that haven't been read yet. */
+#  define READ_STRUCT_PREPARE_BATCH_LEN ((size_t)1 << 28)
+
+typedef struct ReadStructPrepareData {
+  FileData *fd;
+  BHead **bheads;
+  /** Data to convert for each block (from the mapping, the #BHeadN or a temporary copy). */
+  const void **bheads_data;
+  /** Temporary copies of blocks which were read on demand, freed once converted. */
+  BHeadN **bheads_tmp;
+} ReadStructPrepareData;
+
+static bool read_struct_prepare_check(const FileData *fd, const BHead *bh)
+{
+  if ((bh->code != DATA) || (bh->len < READ_STRUCT_PREPARE_MIN_LEN)) {
+    return false;
+  }
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_REMOVED) {
+    return false;
+  }
+  return ((bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) ||
+          (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL));
+}
+
+static void read_struct_prepare_cb(void *__restrict userdata,
+                                   const int index,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReadStructPrepareData *data = userdata;
+  FileData *fd = data->fd;
+  BHead *bh = data->bheads[index];
+  const void *bh_data = data->bheads_data[index];
+  char *data_switch = NULL;
+  void *temp;
+
+  if (bh_data == NULL) {
+    /* Reading failed, leave error handling to #read_struct. */
+    return;
+  }
+
+  if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    /* Switch a copy, the source may be mapped read-only or read again. */
+    data_switch = MEM_mallocN((size_t)bh->len, "read_struct");
+    memcpy(data_switch, bh_data, (size_t)bh->len);
+    switch_endian_structs_data(fd->filesdna, bh, data_switch);
+    bh_data = data_switch;
+  }
+
+  if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+    temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, bh_data);
+    MEM_SAFE_FREE(data_switch);
+  }
+  else {
+    /* SDNA_CMP_EQUAL */
+    temp = data_switch;
+  }
+
+  if (data->bheads_tmp[index] != NULL) {
+    MEM_freeN(data->bheads_tmp[index]);
+  }
+
+  BHEADN_FROM_BHEAD(bh)->data_prepared = temp;
+}
+
+/**
+ * Convert large data blocks (mesh & custom-data arrays for example) on multiple threads,
+ * #read_struct then returns the converted data without any further work.
+ *
+ * This reads all block headers, so it's only useful when loading the whole file.
+ */
+static void read_struct_prepare_parallel(FileData *fd)
+{
+  int bheads_len = 0;
+  for (BHead *bh = blo_bhead_first(fd); bh && (bh->code != ENDB); bh = blo_bhead_next(fd, bh)) {
+    if (read_struct_prepare_check(fd, bh)) {
+      bheads_len++;
+    }
+  }
+  if (bheads_len == 0) {
+    return;
+  }
+
+  ReadStructPrepareData data = {
+      .fd = fd,
+      .bheads = MEM_mallocN(sizeof(*data.bheads) * (size_t)bheads_len, __func__),
+      .bheads_data = MEM_mallocN(sizeof(*data.bheads_data) * (size_t)bheads_len, __func__),
+      .bheads_tmp = MEM_mallocN(sizeof(*data.bheads_tmp) * (size_t)bheads_len, __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  BHead *bh = blo_bhead_first(fd);
+  while (bh && (bh->code != ENDB)) {
+    /* Gather a batch, reading blocks serially when they can't be accessed directly. */
+    size_t batch_tmp_len = 0;
+    int batch_len = 0;
+    for (; bh && (bh->code != ENDB) && (batch_tmp_len < READ_STRUCT_PREPARE_BATCH_LEN);
+         bh = blo_bhead_next(fd, bh)) {
+      if (!read_struct_prepare_check(fd, bh)) {
+        continue;
+      }
+      BHeadN *new_bhead = BHEADN_FROM_BHEAD(bh);
+      const void *bh_data = NULL;
+      BHeadN *bh_tmp = NULL;
+#  ifdef USE_BHEAD_READ_ON_DEMAND
+      if (new_bhead->has_data == false) {
+#    ifdef USE_BHEAD_READ_MMAP
+        bh_data = blo_bhead_data_mapped(fd, bh);
+#    endif
+        if (bh_data == NULL) {
+          BHead *bh_full = blo_bhead_read_full(fd, bh);
+          if (bh_full != NULL) {
+            bh_tmp = BHEADN_FROM_BHEAD(bh_full);
+            bh_data = bh_full + 1;
+            batch_tmp_len += (size_t)bh->len;
+          }
+        }
+      }
+      else
+#  endif
+      {
+        bh_data = &new_bhead->bhead + 1;
+      }
+      data.bheads[batch_len] = bh;
+      data.bheads_data[batch_len] = bh_data;
+      data.bheads_tmp[batch_len] = bh_tmp;
+      batch_len++;
+    }
+
+    settings.use_threading = (batch_len > 1);
+    BLI_task_parallel_range(0, batch_len, &data, read_struct_prepare_cb, &settings);
+  }
+
+  MEM_freeN(data.bheads);
+  MEM_freeN(data.bheads_data);
+  MEM_freeN(data.bheads_tmp);
+}
+
+#endif /* USE_BHEAD_RECONSTRUCT_PARALLEL */
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -2155,7 +2589,7 @@ static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
   }
   poin = newdataadr(fd, lb->first);
   if (lb->first) {
-    oldnewmap_insert(fd->globmap, lb->first, poin, 0);
+    blo_oldnewmap_insert(fd->globmap, lb->first, poin, 0);
   }
   lb->first = poin;
 
@@ -2164,7 +2598,7 @@ static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
   while (ln) {
     poin = newdataadr(fd, ln->next);
     if (ln->next) {
-      oldnewmap_insert(fd->globmap, ln->next, poin, 0);
+      blo_oldnewmap_insert(fd->globmap, ln->next, poin, 0);
     }
     ln->next = poin;
     ln->prev = prev;
@@ -3251,7 +3685,7 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
 
     void *data = read_struct(fd, bhead, allocname);
     if (data) {
-      oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+      blo_oldnewmap_insert(fd->datamap, bhead->old, data, 0);
     }
 
     bhead = blo_bhead_next(fd, bhead);
@@ -3333,7 +3767,7 @@ static bool read_libblock_undo_restore_linked(FileData *fd, Main *main, const ID
     /* Even though we found our linked ID, there is no guarantee its address
      * is still the same. */
     if (id_old != bhead->old) {
-      oldnewmap_insert(fd->libmap, bhead->old, id_old, GS(id_old->name));
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id_old, GS(id_old->name));
     }
 
     /* No need to do anything else for ID_LINK_PLACEHOLDER, it's assumed
@@ -3479,7 +3913,7 @@ static bool read_libblock_undo_restore(
     /* Insert into library map for lookup by newly read datablocks (with pointer value bhead->old).
      * Note that existing datablocks in memory (which pointer value would be id_old) are not
      * remapped anymore, so no need to store this info here. */
-    oldnewmap_insert(fd->libmap, bhead->old, id_old, bhead->code);
+    blo_oldnewmap_insert(fd->libmap, bhead->old, id_old, bhead->code);
 
     *r_id_old = id_old;
     return true;
@@ -3553,7 +3987,7 @@ static BHead *read_libblock(FileData *fd,
    * Note that existing datablocks in memory (which pointer value would be id_old) are not remapped
    * remapped anymore, so no need to store this info here. */
   ID *id_target = id_old ? id_old : id;
-  oldnewmap_insert(fd->libmap, bhead->old, id_target, bhead->code);
+  blo_oldnewmap_insert(fd->libmap, bhead->old, id_target, bhead->code);
 
   if (r_id) {
     *r_id = id_target;
@@ -3585,7 +4019,7 @@ static BHead *read_libblock(FileData *fd,
   const char *allocname = dataname(idcode);
   bhead = read_data_into_datamap(fd, bhead, allocname);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
-  oldnewmap_clear(fd->datamap);
+  blo_oldnewmap_clear(fd->datamap);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -3925,7 +4359,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->edit_studio_light = 0;
 
   /* free fd->datamap again */
-  oldnewmap_clear(fd->datamap);
+  blo_oldnewmap_clear(fd->datamap);
 
   return bhead;
 }
@@ -3981,6 +4415,12 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+  if ((fd->memfile == NULL) && (fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
+    read_struct_prepare_parallel(fd);
+  }
+#endif
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -4314,7 +4754,7 @@ static void expand_doit_library(void *fdhandle, Main *mainvar, void *old)
        * (B) forest.blend: contains Forest collection linking in Tree from tree.blend.
        * (C) shot.blend: links in both Tree from tree.blend and Forest from forest.blend.
        */
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
 
       /* If "id" is a real data-lock and not a placeholder, we need to
        * update fd->libmap to replace ID_LINK_PLACEHOLDER with the real
@@ -4356,7 +4796,7 @@ static void expand_doit_library(void *fdhandle, Main *mainvar, void *old)
       /* this is actually only needed on UI call? when ID was already read before,
        * and another append happens which invokes same ID...
        * in that case the lookup table needs this entry */
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
       /* commented because this can print way too much */
       // if (G.debug & G_DEBUG) printf("expand: already read %s\n", id->name);
     }
@@ -4732,7 +5172,7 @@ static ID *link_named_part(
       if (G.debug) {
         printf("append: already linked\n");
       }
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
       if (!force_indirect && (id->tag & LIB_TAG_INDIRECT)) {
         id->tag &= ~LIB_TAG_INDIRECT;
         id->flag &= ~LIB_INDIRECT_WEAK_LINK;
@@ -5278,10 +5718,10 @@ static FileData *read_library_file_data(FileData *basefd,
     fd->reports = basefd->reports;
 
     if (fd->libmap) {
-      oldnewmap_free(fd->libmap);
+      blo_oldnewmap_free(fd->libmap);
     }
 
-    fd->libmap = oldnewmap_new();
+    fd->libmap = blo_oldnewmap_new();
 
     mainptr->curlib->filedata = fd;
     mainptr->versionfile = fd->fileversion;
@@ -5418,6 +5858,22 @@ ID *BLO_read_get_new_id_address(BlendLibReader *reader, Library *lib, ID *id)
   return newlibadr(reader->fd, lib, id);
 }
 
+void BLO_read_get_new_id_address_array(BlendLibReader *reader,
+                                       Library *lib,
+                                       ID **id_array,
+                                       int len)
+{
+  blo_oldnewmap_lookup_array(reader->fd->libmap, (void **)id_array, len, false);
+  /* Match #blo_oldnewmap_liblookup. */
+  if (lib != NULL) {
+    for (int i = 0; i < len; i++) {
+      if ((id_array[i] != NULL) && (id_array[i]->lib == NULL)) {
+        id_array[i] = NULL;
+      }
+    }
+  }
+}
+
 bool BLO_read_requires_endian_switch(BlendDataReader *reader)
 {
   return (reader->fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
@@ -5575,7 +6031,7 @@ bool BLO_read_data_is_undo(BlendDataReader *reader)
 
 void BLO_read_data_globmap_add(BlendDataReader *reader, void *oldaddr, void *newaddr)
 {
-  oldnewmap_insert(reader->fd->globmap, oldaddr, newaddr, 0);
+  blo_oldnewmap_insert(reader->fd->globmap, oldaddr, newaddr, 0);
 }
 
 void BLO_read_glob_list(BlendDataReader *reader, ListBase *list)
@@ -85,6 +85,9 @@ typedef struct FileData {
 
   /** Regular file reading. */
   int filedes;
+  /** Memory mapped file reading (uncompressed files only), unmapped when freeing. */
+  const char *mmap_data;
+  size_t mmap_size;
 
   /** Variables needed for reading from memory / stream. */
   const char *buffer;
@@ -98,6 +101,8 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Seekable gzip frames, see #BLO_GZIP_FRAME_SIZE. */
+  struct GZipFramesReader *gzip_frames;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
@@ -171,6 +176,19 @@ BHead *blo_bhead_prev(FileData *fd, BHead *thisblock);
 
 const char *blo_bhead_id_name(const FileData *fd, const BHead *bhead);
 
+/* Old to new pointer map. */
+
+struct OldNewMap *blo_oldnewmap_new(void);
+void blo_oldnewmap_insert(struct OldNewMap *onm, const void *oldaddr, void *newaddr, int nr);
+void *blo_oldnewmap_lookup_and_inc(struct OldNewMap *onm, const void *addr, bool increase_users);
+void blo_oldnewmap_lookup_array(struct OldNewMap *onm,
+                                void **addr_array,
+                                int len,
+                                bool increase_users);
+void *blo_oldnewmap_liblookup(struct OldNewMap *onm, const void *addr, const void *lib);
+void blo_oldnewmap_clear(struct OldNewMap *onm);
+void blo_oldnewmap_free(struct OldNewMap *onm);
+
 /* do versions stuff */
 
 void blo_do_versions_dna(struct SDNA *sdna, const int versionfile, const int subversionfile);
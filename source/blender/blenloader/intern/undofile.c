@@ -39,9 +39,12 @@
 #include "MEM_guardedalloc.h"
 
 #include "DNA_listBase.h"
+#include "DNA_sdna_types.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_task.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -60,7 +63,7 @@ void BLO_memfile_free(MemFile *memfile)
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
+    if (chunk->is_identical == false && chunk->is_shared == false) {
       MEM_freeN((void *)chunk->buf);
     }
     MEM_freeN(chunk);
@@ -79,19 +82,24 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
 
   /* First, detect all memchunks in second memfile that are not owned by it. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (sc->is_identical || sc->is_shared) {
+      /* Several chunks may share the same buffer, only one of them needs to get its ownership. */
+      void **entry;
+      if (!BLI_ghash_ensure_p(buffer_to_second_memchunk, (void *)sc->buf, &entry)) {
+        *entry = sc;
+      }
     }
   }
 
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
+    if (!fc->is_identical && !fc->is_shared) {
       MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
       if (sc != NULL) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(sc->is_identical || sc->is_shared);
         sc->is_identical = false;
+        sc->is_shared = false;
         fc->is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -119,18 +127,31 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 {
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
+  mem_data->current_id_hash = 0;
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
+  mem_data->id_session_uuid_mapping = NULL;
+  mem_data->hash_mapping = NULL;
 
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
    * us to easily find the existing undo memory storage of IDs even when some re-ordering in
    * current Main data-base broke the order matching with the memchunks from previous step.
+   *
+   * We also map the content hashes of the memchunks, to find data that moved to another position
+   * in the file (e.g. when an array before it grew or shrank).
    */
   if (reference_memfile != NULL) {
     mem_data->id_session_uuid_mapping = BLI_ghash_new(
         BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
+    mem_data->hash_mapping = BLI_ghash_new(
+        BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
     uint current_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
     LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      void **hash_entry;
+      if (!BLI_ghash_ensure_p(
+              mem_data->hash_mapping, POINTER_FROM_UINT(mem_chunk->hash), &hash_entry)) {
+        *hash_entry = mem_chunk;
+      }
       if (!ELEM(mem_chunk->id_session_uuid, MAIN_ID_SESSION_UUID_UNSET, current_session_uuid)) {
         current_session_uuid = mem_chunk->id_session_uuid;
         void **entry;
@@ -152,46 +173,210 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->hash_mapping != NULL) {
+    BLI_ghash_free(mem_data->hash_mapping, NULL, NULL);
+  }
 }
 
-void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
+static MemFileChunk *memfile_chunk_new(MemFileWriteData *mem_data, size_t size)
 {
   MemFile *memfile = mem_data->written_memfile;
-  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
 
   MemFileChunk *curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
   curchunk->size = size;
   curchunk->buf = NULL;
   curchunk->is_identical = false;
+  curchunk->is_shared = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  curchunk->hash = 0;
+  curchunk->id_hash = mem_data->current_id_hash;
+  mem_data->current_id_hash = 0;
   BLI_addtail(&memfile->chunks, curchunk);
 
-  /* we compare compchunk with buf */
-  if (*compchunk_step != NULL) {
-    MemFileChunk *compchunk = *compchunk_step;
-    if (compchunk->size == curchunk->size) {
-      if (memcmp(compchunk->buf, buf, size) == 0) {
-        curchunk->buf = compchunk->buf;
-        curchunk->is_identical = true;
-        compchunk->is_identical_future = true;
+  return curchunk;
+}
+
+/**
+ * Share the buffer of \a compchunk (or of another chunk of the reference memfile with the same
+ * content) when it matches \a buf, otherwise store a copy of \a buf in \a curchunk.
+ *
+ * Only writes to \a curchunk and \a compchunk, so different chunks can be handled in parallel.
+ */
+static void memfile_chunk_compare_and_copy(const MemFileWriteData *mem_data,
+                                           MemFileChunk *curchunk,
+                                           MemFileChunk *compchunk,
+                                           const char *buf)
+{
+  const size_t size = curchunk->size;
+  curchunk->hash = BLI_hash_mm2((const uchar *)buf, size, 0);
+
+  /* we compare compchunk with buf, the hash avoids most comparisons of changed data */
+  if (compchunk != NULL && compchunk->size == size && compchunk->hash == curchunk->hash) {
+    if (memcmp(compchunk->buf, buf, size) == 0) {
+      curchunk->buf = compchunk->buf;
+      curchunk->is_identical = true;
+      compchunk->is_identical_future = true;
+      return;
+    }
+  }
+
+  /* Same content may still exist at another position in the reference memfile. */
+  if (mem_data->hash_mapping != NULL) {
+    const MemFileChunk *hashchunk = BLI_ghash_lookup(mem_data->hash_mapping,
+                                                     POINTER_FROM_UINT(curchunk->hash));
+    if (hashchunk != NULL && hashchunk != compchunk && hashchunk->size == size) {
+      if (memcmp(hashchunk->buf, buf, size) == 0) {
+        curchunk->buf = hashchunk->buf;
+        curchunk->is_shared = true;
+        return;
       }
     }
-    *compchunk_step = compchunk->next;
   }
 
   /* not equal... */
-  if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
+  char *buf_new = MEM_mallocN(size, "Chunk buffer");
+  memcpy(buf_new, buf, size);
+  curchunk->buf = buf_new;
+}
+
+void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
+{
+  MemFile *memfile = mem_data->written_memfile;
+  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
+
+  MemFileChunk *curchunk = memfile_chunk_new(mem_data, size);
+  MemFileChunk *compchunk = *compchunk_step;
+  if (compchunk != NULL) {
+    *compchunk_step = compchunk->next;
+  }
+
+  memfile_chunk_compare_and_copy(mem_data, curchunk, compchunk, buf);
+  if (!curchunk->is_identical && !curchunk->is_shared) {
     memfile->size += size;
   }
 }
 
+typedef struct MemFileChunkArrayData {
+  const MemFileWriteData *mem_data;
+  MemFileChunk **chunks;
+  MemFileChunk **compchunks;
+  const char *buf;
+  size_t chunk_size;
+} MemFileChunkArrayData;
+
+static void memfile_chunk_add_array_cb(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MemFileChunkArrayData *data = userdata;
+  memfile_chunk_compare_and_copy(data->mem_data,
+                                 data->chunks[index],
+                                 data->compchunks[index],
+                                 data->buf + data->chunk_size * (size_t)index);
+}
+
+/**
+ * Add a big buffer, split in chunks of \a chunk_size bytes.
+ *
+ * The chunks are matched with the ones from the reference memfile in order, but compared and
+ * copied on multiple threads, since for big arrays (e.g. mesh data) this is where most of the
+ * time of an undo push is spent.
+ */
+void BLO_memfile_chunk_add_array(MemFileWriteData *mem_data,
+                                 const char *buf,
+                                 size_t size,
+                                 size_t chunk_size)
+{
+  MemFile *memfile = mem_data->written_memfile;
+  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
+
+  const int chunks_len = (int)((size + chunk_size - 1) / chunk_size);
+  MemFileChunk **chunks = MEM_malloc_arrayN((size_t)chunks_len * 2, sizeof(*chunks), __func__);
+  MemFileChunk **compchunks = chunks + chunks_len;
+
+  for (int i = 0; i < chunks_len; i++) {
+    const size_t offset = chunk_size * (size_t)i;
+    chunks[i] = memfile_chunk_new(mem_data, MIN2(chunk_size, size - offset));
+    compchunks[i] = *compchunk_step;
+    if (*compchunk_step != NULL) {
+      *compchunk_step = (*compchunk_step)->next;
+    }
+  }
+
+  MemFileChunkArrayData data = {
+      .mem_data = mem_data,
+      .chunks = chunks,
+      .compchunks = compchunks,
+      .buf = buf,
+      .chunk_size = chunk_size,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 4;
+  BLI_task_parallel_range(0, chunks_len, &data, memfile_chunk_add_array_cb, &settings);
+
+  for (int i = 0; i < chunks_len; i++) {
+    if (!chunks[i]->is_identical && !chunks[i]->is_shared) {
+      memfile->size += chunks[i]->size;
+    }
+  }
+
+  MEM_freeN(chunks);
+}
+
+/**
+ * Share all the chunks written for an ID in the reference memfile, instead of writing it again.
+ *
+ * The caller is responsible for checking that the ID was not tagged for update since the
+ * reference undo step was written. Chunks are only re-used when \a id_hash also matches the hash
+ * the ID had when it was written, which catches changes made without tagging an update.
+ *
+ * \return false when no usable chunks were found, the ID then has to be written as usual.
+ */
+bool BLO_memfile_id_reuse(MemFileWriteData *mem_data,
+                          const void *id_address,
+                          uint id_session_uuid,
+                          uint id_hash)
+{
+  if (mem_data->id_session_uuid_mapping == NULL) {
+    return false;
+  }
+
+  MemFileChunk *refchunk = BLI_ghash_lookup(mem_data->id_session_uuid_mapping,
+                                            POINTER_FROM_UINT(id_session_uuid));
+  if (refchunk == NULL) {
+    return false;
+  }
+
+  /* The first chunk of an ID starts with its own BHead. If the ID was re-allocated, all pointers
+   * to it stored in other data-blocks changed too, so it has to be written again. */
+  if (refchunk->size < sizeof(BHead) || ((const BHead *)refchunk->buf)->old != id_address) {
+    return false;
+  }
+  if (refchunk->id_hash != id_hash) {
+    return false;
+  }
+
+  MemFileChunk *compchunk;
+  for (compchunk = refchunk; compchunk != NULL && compchunk->id_session_uuid == id_session_uuid;
+       compchunk = compchunk->next) {
+    MemFileChunk *curchunk = memfile_chunk_new(mem_data, compchunk->size);
+    curchunk->id_session_uuid = id_session_uuid;
+    curchunk->buf = compchunk->buf;
+    curchunk->hash = compchunk->hash;
+    curchunk->id_hash = compchunk->id_hash;
+    curchunk->is_identical = true;
+    compchunk->is_identical_future = true;
+  }
+  mem_data->reference_current_chunk = compchunk;
+
+  return true;
+}
+
 struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                   struct Main *bmain,
                                   struct Scene **r_scene)
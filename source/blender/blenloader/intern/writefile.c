@@ -99,6 +99,7 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_mempool.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
@@ -123,6 +124,7 @@
 #include "BLO_undofile.h"
 #include "BLO_writefile.h"
 
+#include "gzip_frames.h"
 #include "readfile.h"
 
 #include <errno.h>
@@ -161,7 +163,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct GZipFramesWriter *gz_frames;
   } _user_data;
 };
 
@@ -191,17 +193,17 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib (seekable frames, see #BLO_GZIP_FRAME_SIZE) */
+#define FILE_HANDLE(ww) (ww)->_user_data.gz_frames
 
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-  gzFile file;
+  int file;
 
-  file = BLI_gzopen(filepath, "wb1");
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
+  if (file != -1) {
+    FILE_HANDLE(ww) = blo_gzip_frames_writer_new(file);
     return true;
   }
 
@@ -209,11 +211,11 @@ static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  return blo_gzip_frames_writer_close(FILE_HANDLE(ww));
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  return blo_gzip_frames_writer_write(FILE_HANDLE(ww), buf, buf_len) ? buf_len : 0;
 }
 #undef FILE_HANDLE
 
@@ -379,6 +381,12 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
         wd->buf_used_len = 0;
       }
 
+      if (wd->use_memfile) {
+        /* Compare the pieces with the previous undo step on multiple threads. */
+        BLO_memfile_chunk_add_array(&wd->mem, adr, len, MYWRITE_MAX_CHUNK);
+        return;
+      }
+
       do {
         size_t writelen = MIN2(len, MYWRITE_MAX_CHUNK);
         writedata_do_write(wd, adr, writelen);
@@ -904,6 +912,69 @@ static void write_thumb(WriteData *wd, const BlendThumbnail *thumb)
 /** \name File Writing (Private)
  * \{ */
 
+/**
+ * Whether nothing was tagged for update in the ID (or its embedded data) since the last undo push,
+ * in which case its data can be taken from the previous undo step as is.
+ *
+ * \note Changes which don't tag an update (e.g. of user counts, runtime flags or RNA properties
+ * set without an update) are only caught when they are made in the ID structs themselves, see
+ * #write_undo_id_hash. This is why re-using unchanged IDs is an experimental option.
+ */
+static bool write_undo_id_is_unchanged(ID *id)
+{
+  if (id->recalc_after_undo_push != 0) {
+    return false;
+  }
+  bNodeTree *nodetree = ntreeFromID(id);
+  if (nodetree != NULL && nodetree->id.recalc_after_undo_push != 0) {
+    return false;
+  }
+  if (GS(id->name) == ID_SCE) {
+    Scene *scene = (Scene *)id;
+    if (scene->master_collection != NULL &&
+        scene->master_collection->id.recalc_after_undo_push != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static uint write_undo_id_struct_hash(const ID *id, uint hash)
+{
+  /* Ignore the members that change without the ID itself changing. */
+  ID id_header = *id;
+  id_header.next = id_header.prev = NULL;
+  id_header.newid = NULL;
+  id_header.tag = 0;
+  id_header.recalc = id_header.recalc_up_to_undo_push = id_header.recalc_after_undo_push = 0;
+  id_header.py_instance = NULL;
+  hash = BLI_hash_mm2((const uchar *)&id_header, sizeof(ID), hash);
+
+  const size_t struct_size = BKE_idtype_get_info_from_id(id)->struct_size;
+  return BLI_hash_mm2((const uchar *)(id + 1), struct_size - sizeof(ID), hash);
+}
+
+/**
+ * Hash of the ID struct and of its embedded IDs, as a cheap check that IDs which were not tagged
+ * for update since the last undo push really are unchanged. Data the ID owns outside of its struct
+ * (e.g. mesh arrays) is not included.
+ */
+static uint write_undo_id_hash(const ID *id)
+{
+  uint hash = write_undo_id_struct_hash(id, 0);
+  const bNodeTree *nodetree = ntreeFromID((ID *)id);
+  if (nodetree != NULL) {
+    hash = write_undo_id_struct_hash(&nodetree->id, hash);
+  }
+  if (GS(id->name) == ID_SCE) {
+    const Scene *scene = (const Scene *)id;
+    if (scene->master_collection != NULL) {
+      hash = write_undo_id_struct_hash(&scene->master_collection->id, hash);
+    }
+  }
+  return hash;
+}
+
 /* if MemFile * there's filesave to memory */
 static bool write_file_handle(Main *mainvar,
                               WriteWrap *ww,
@@ -911,6 +982,7 @@ static bool write_file_handle(Main *mainvar,
                               MemFile *current,
                               int write_flags,
                               bool use_userdef,
+                              bool use_undo_skip_unchanged,
                               const BlendThumbnail *thumb)
 {
   BHead bhead;
@@ -979,7 +1051,14 @@ static bool write_file_handle(Main *mainvar,
           BKE_lib_override_library_operations_store_start(bmain, override_storage, id);
         }
 
+        bool use_undo_reuse = false;
+        uint undo_id_hash = 0;
         if (wd->use_memfile) {
+          use_undo_reuse = use_undo_skip_unchanged && write_undo_id_is_unchanged(id);
+          if (use_undo_skip_unchanged) {
+            undo_id_hash = write_undo_id_hash(id);
+          }
+
           /* Record the changes that happened up to this undo push in
            * recalc_up_to_undo_push, and clear recalc_after_undo_push again
            * to start accumulating for the next undo push. */
@@ -1001,7 +1080,17 @@ static bool write_file_handle(Main *mainvar,
           }
         }
 
+        if (use_undo_reuse &&
+            BLO_memfile_id_reuse(&wd->mem, id, id->session_uuid, undo_id_hash)) {
+          BLI_assert(!do_override);
+          continue;
+        }
+
         mywrite_id_begin(wd, id);
+        if (wd->use_memfile) {
+          /* Stored in the first chunk of the ID, to be compared with on the next undo push. */
+          wd->mem.current_id_hash = undo_id_hash;
+        }
 
         memcpy(id_buffer, id, idtype_struct_size);
 
@@ -1220,9 +1309,12 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, false, thumb);
 
-  ww.close(&ww);
+  /* Closing may write buffered data (compressed files). */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -1260,14 +1352,17 @@ bool BLO_write_file(Main *mainvar,
 }
 
 /**
+ * \param use_skip_unchanged: Re-use the data stored in \a compare for IDs that were not tagged
+ * for update since it was written, instead of writing and comparing them again.
  * \return Success.
  */
-bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int write_flags)
+bool BLO_write_file_mem(
+    Main *mainvar, MemFile *compare, MemFile *current, int write_flags, bool use_skip_unchanged)
 {
   bool use_userdef = false;
 
   const bool err = write_file_handle(
-      mainvar, NULL, compare, current, write_flags, use_userdef, NULL);
+      mainvar, NULL, compare, current, write_flags, use_userdef, use_skip_unchanged, NULL);
 
   return (err == 0);
 }
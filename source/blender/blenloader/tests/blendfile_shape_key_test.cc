@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_key.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_undofile.h"
+#include "BLO_writefile.h"
+
+#include "DNA_key_types.h"
+#include "DNA_mesh_types.h"
+
+/* Corrective shape keys are only stored as the elements which differ from their relative key in
+ * undo steps, files keep the full data. Reading them back has to give the full data either way. */
+class BlendfileShapeKeyTest : public BlendfileLoadingBaseTest {
+ protected:
+  static const int totelem = 100;
+
+  KeyBlock *keyblock_add(Key *key, const int relative, const int moved_len)
+  {
+    KeyBlock *kb = BKE_keyblock_add(key, nullptr);
+    kb->relative = relative;
+    kb->totelem = totelem;
+    kb->data = MEM_calloc_arrayN(totelem, sizeof(float[3]), __func__);
+    float(*co)[3] = (float(*)[3])kb->data;
+    for (int i = 0; i < totelem; i++) {
+      co[i][0] = (float)i;
+    }
+    for (int i = 0; i < moved_len; i++) {
+      co[(i * 7) % totelem][2] = 1.0f + i;
+    }
+    return kb;
+  }
+
+  /* Not the global main, which only has a dummy window manager. */
+  Main *main_with_key_create()
+  {
+    Main *bmain = BKE_main_new();
+    Mesh *mesh = BKE_mesh_add(bmain, "Mesh");
+    key = BKE_key_add(bmain, &mesh->id);
+    key->type = KEY_RELATIVE;
+    mesh->key = key;
+
+    keyblock_add(key, 0, 0);
+    /* Few moved elements, stored sparse in undo steps. */
+    keyblock_add(key, 0, 3);
+    /* Too many moved elements. */
+    keyblock_add(key, 0, totelem / 2);
+    /* Relative key of the next block, which is always stored in full. */
+    keyblock_add(key, 0, 2);
+    keyblock_add(key, 3, 4);
+    /* Identical to its relative key. */
+    keyblock_add(key, 0, 0);
+    return bmain;
+  }
+
+  void expect_key_read(const Main *bmain_read)
+  {
+    const Key *key_read = (const Key *)bmain_read->shapekeys.first;
+    ASSERT_NE(key_read, nullptr);
+    ASSERT_EQ(BLI_listbase_count(&key_read->block), BLI_listbase_count(&key->block));
+
+    const KeyBlock *kb_read = (const KeyBlock *)key_read->block.first;
+    LISTBASE_FOREACH (const KeyBlock *, kb, &key->block) {
+      EXPECT_FALSE(kb_read->flag & KEYBLOCK_SPARSE);
+      EXPECT_EQ(kb_read->sparse_elems, nullptr);
+      EXPECT_EQ(kb_read->relative, kb->relative);
+      EXPECT_EQ(kb_read->totelem, kb->totelem);
+      ASSERT_NE(kb_read->data, nullptr);
+      EXPECT_EQ(memcmp(kb_read->data, kb->data, sizeof(float[3]) * totelem), 0);
+      kb_read = kb_read->next;
+    }
+  }
+
+  Key *key;
+};
+
+TEST_F(BlendfileShapeKeyTest, WriteReadFile)
+{
+  Main *bmain = main_with_key_create();
+
+  BKE_tempdir_init(nullptr);
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "shape_key_test.blend");
+  BlendFileWriteParams params{};
+  ASSERT_TRUE(BLO_write_file(bmain, filepath, 0, &params, nullptr));
+
+  bfile = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr);
+  BLI_delete(filepath, false, false);
+  ASSERT_NE(bfile, nullptr);
+  expect_key_read(bfile->main);
+
+  BKE_main_free(bmain);
+}
+
+TEST_F(BlendfileShapeKeyTest, WriteReadUndo)
+{
+  Main *bmain = main_with_key_create();
+
+  MemFile memfile = {{nullptr}};
+  ASSERT_TRUE(BLO_write_file_mem(bmain, nullptr, &memfile, 0, false));
+
+  BlendFileReadParams params = {0};
+  params.skip_flags = BLO_READ_SKIP_UNDO_OLD_MAIN;
+  bfile = BLO_read_from_memfile(bmain, "", &memfile, &params, nullptr);
+  BLO_memfile_free(&memfile);
+  ASSERT_NE(bfile, nullptr);
+  expect_key_read(bfile->main);
+
+  BKE_main_free(bmain);
+}
+
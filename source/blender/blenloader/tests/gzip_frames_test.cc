@@ -0,0 +1,196 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#include "testing/testing.h"
+
+#include <fcntl.h>
+#include <string>
+#include <vector>
+
+#include "zlib.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_rand.hh"
+#include "BLI_utildefines.h"
+
+#include "BKE_appdir.h"
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
+#include "intern/gzip_frames.h"
+
+namespace blender::blenloader::tests {
+
+class GZipFramesTest : public testing::Test {
+ protected:
+  std::string filepath_;
+
+  void SetUp() override
+  {
+    BKE_tempdir_init(nullptr);
+    char filepath[FILE_MAX];
+    BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_base(), "gzip_frames_test.blend");
+    filepath_ = filepath;
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath_.c_str(), false, false);
+  }
+
+  /* Compressible data that differs per frame, so misplaced frames are detected. */
+  static std::vector<char> test_data(const size_t size)
+  {
+    std::vector<char> data(size);
+    RandomNumberGenerator rng(42);
+    for (size_t i = 0; i < size; i++) {
+      data[i] = (i % 64 < 48) ? (char)(i / BLO_GZIP_FRAME_SIZE + 'a') : (char)rng.get_uint32();
+    }
+    return data;
+  }
+
+  /* Write in chunks that don't line up with the frames. */
+  void write_frames(const std::vector<char> &data, const size_t chunk_size)
+  {
+    const int file = BLI_open(filepath_.c_str(), O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    ASSERT_NE(file, -1);
+    GZipFramesWriter *gz = blo_gzip_frames_writer_new(file);
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+      const size_t len = std::min(chunk_size, data.size() - offset);
+      EXPECT_TRUE(blo_gzip_frames_writer_write(gz, data.data() + offset, len));
+    }
+    EXPECT_TRUE(blo_gzip_frames_writer_close(gz));
+  }
+
+  int open_for_reading()
+  {
+    return BLI_open(filepath_.c_str(), O_BINARY | O_RDONLY, 0);
+  }
+};
+
+TEST_F(GZipFramesTest, RoundTrip)
+{
+  const std::vector<char> data = test_data(BLO_GZIP_FRAME_SIZE * 5 + 12345);
+  write_frames(data, 7777);
+
+  const int file = open_for_reading();
+  ASSERT_NE(file, -1);
+  GZipFramesReader *frames = blo_gzip_frames_reader_open(file);
+  ASSERT_NE(frames, nullptr);
+  EXPECT_EQ(blo_gzip_frames_reader_size(frames), (off64_t)data.size());
+
+  std::vector<char> result(data.size());
+  EXPECT_EQ(blo_gzip_frames_reader_read(frames, 0, result.data(), result.size()),
+            (ssize_t)data.size());
+  EXPECT_TRUE(result == data);
+
+  /* Reads across frame boundaries, backwards through the file. */
+  for (int frame = 5; frame > 0; frame--) {
+    const off64_t offset = (off64_t)frame * BLO_GZIP_FRAME_SIZE - 100;
+    char buffer[200];
+    EXPECT_EQ(blo_gzip_frames_reader_read(frames, offset, buffer, sizeof(buffer)),
+              (ssize_t)sizeof(buffer));
+    EXPECT_EQ(memcmp(buffer, data.data() + offset, sizeof(buffer)), 0);
+  }
+
+  /* Reads at the end of the data are truncated. */
+  char buffer[200];
+  EXPECT_EQ(blo_gzip_frames_reader_read(frames, (off64_t)data.size() - 50, buffer, sizeof(buffer)),
+            50);
+  EXPECT_EQ(memcmp(buffer, data.data() + data.size() - 50, 50), 0);
+  EXPECT_EQ(blo_gzip_frames_reader_read(frames, (off64_t)data.size(), buffer, sizeof(buffer)), 0);
+
+  blo_gzip_frames_reader_free(frames);
+  close(file);
+}
+
+/* Frames and seek table are a valid gzip stream for readers not aware of frames. */
+TEST_F(GZipFramesTest, ReadAsGZipStream)
+{
+  const std::vector<char> data = test_data(BLO_GZIP_FRAME_SIZE * 2 + 100);
+  write_frames(data, data.size());
+
+  gzFile gzfile = (gzFile)BLI_gzopen(filepath_.c_str(), "rb");
+  ASSERT_NE(gzfile, (gzFile)Z_NULL);
+  std::vector<char> result(data.size() + 100);
+  EXPECT_EQ(gzread(gzfile, result.data(), (unsigned int)result.size()), (int)data.size());
+  result.resize(data.size());
+  EXPECT_TRUE(result == data);
+  gzclose(gzfile);
+}
+
+/* Files written by regular gzip writers have no seek table, these are read as a stream. */
+TEST_F(GZipFramesTest, PlainGZipFallback)
+{
+  const std::vector<char> data = test_data(BLO_GZIP_FRAME_SIZE + 100);
+  gzFile gzfile = (gzFile)BLI_gzopen(filepath_.c_str(), "wb1");
+  ASSERT_NE(gzfile, (gzFile)Z_NULL);
+  EXPECT_EQ(gzwrite(gzfile, data.data(), (unsigned int)data.size()), (int)data.size());
+  gzclose(gzfile);
+
+  const int file = open_for_reading();
+  ASSERT_NE(file, -1);
+  EXPECT_EQ(blo_gzip_frames_reader_open(file), nullptr);
+  close(file);
+}
+
+/* A damaged seek table is rejected instead of reading wrong data. */
+TEST_F(GZipFramesTest, DamagedSeekTable)
+{
+  const std::vector<char> data = test_data(BLO_GZIP_FRAME_SIZE * 2);
+  write_frames(data, data.size());
+
+  size_t file_size = BLI_file_size(filepath_.c_str());
+  const size_t footer_len = BLO_GZIP_MEMBER_EXTRA_LEN + BLO_GZIP_FRAMES_FOOTER_DATA_LEN;
+  /* The table member is right before the footer, with two frames. */
+  const size_t table_len = BLO_GZIP_MEMBER_EXTRA_LEN + 2 * 8;
+  const size_t frame_size_offset = file_size - footer_len - table_len + 16 + 4;
+
+  int file = BLI_open(filepath_.c_str(), O_BINARY | O_RDWR, 0);
+  ASSERT_NE(file, -1);
+  GZipFramesReader *frames = blo_gzip_frames_reader_open(file);
+  ASSERT_NE(frames, nullptr);
+  blo_gzip_frames_reader_free(frames);
+
+  /* Claim the first frame is larger than frames are written. */
+  const uchar frame_size[4] = {0, 0, 0x20, 0};
+  ASSERT_EQ(BLI_lseek(file, (off64_t)frame_size_offset, SEEK_SET), (off64_t)frame_size_offset);
+  ASSERT_EQ(write(file, frame_size, sizeof(frame_size)), (ssize_t)sizeof(frame_size));
+  EXPECT_EQ(blo_gzip_frames_reader_open(file), nullptr);
+  close(file);
+
+  /* Files ending with something else than the footer are regular gzip files. */
+  write_frames(data, data.size());
+  file_size = BLI_file_size(filepath_.c_str());
+  file = BLI_open(filepath_.c_str(), O_BINARY | O_RDWR, 0);
+  ASSERT_NE(file, -1);
+  const off64_t footer_id_offset = (off64_t)(file_size - footer_len + 12);
+  ASSERT_EQ(BLI_lseek(file, footer_id_offset, SEEK_SET), footer_id_offset);
+  ASSERT_EQ(write(file, "XX", 2), 2);
+  EXPECT_EQ(blo_gzip_frames_reader_open(file), nullptr);
+  close(file);
+}
+
+}  // namespace blender::blenloader::tests
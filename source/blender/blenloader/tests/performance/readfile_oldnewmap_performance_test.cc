@@ -0,0 +1,99 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time_utildefines.h"
+
+#include "DNA_listBase.h"
+
+#include "BLO_readfile.h"
+
+extern "C" {
+#include "intern/readfile.h"
+}
+
+/* Fake old addresses, spaced like allocations written to a file. */
+static const void *oldnewmap_test_old_address(const int index)
+{
+  return POINTER_OFFSET((void *)0x7f0000001000, (size_t)index * 48);
+}
+
+static void *oldnewmap_test_new_address(const int index)
+{
+  return POINTER_OFFSET((void *)0x100000, (size_t)index * 16);
+}
+
+/* Simulate reading a file: insert all data, then look up every pointer in random order. */
+static void oldnewmap_benchmark(const int items_num, const int lookups_num)
+{
+  printf("\n========== STARTING %s (%d items, %d lookups) ==========\n",
+         __func__,
+         items_num,
+         lookups_num);
+
+  const void **lookups = (const void **)MEM_malloc_arrayN(
+      lookups_num, sizeof(*lookups), __func__);
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < lookups_num; i++) {
+    lookups[i] = oldnewmap_test_old_address((int)(BLI_rng_get_uint(rng) % (uint)items_num));
+  }
+  BLI_rng_free(rng);
+
+  OldNewMap *onm = blo_oldnewmap_new();
+
+  TIMEIT_START(oldnewmap_insert);
+  for (int i = 0; i < items_num; i++) {
+    blo_oldnewmap_insert(onm, oldnewmap_test_old_address(i), oldnewmap_test_new_address(i), 0);
+  }
+  TIMEIT_END(oldnewmap_insert);
+
+  uintptr_t checksum = 0;
+  TIMEIT_START(oldnewmap_lookup);
+  for (int i = 0; i < lookups_num; i++) {
+    checksum += (uintptr_t)blo_oldnewmap_lookup_and_inc(onm, lookups[i], true);
+  }
+  TIMEIT_END(oldnewmap_lookup);
+
+  void **addr_array = (void **)MEM_malloc_arrayN(lookups_num, sizeof(void *), __func__);
+  memcpy(addr_array, lookups, sizeof(void *) * (size_t)lookups_num);
+  uintptr_t checksum_array = 0;
+  TIMEIT_START(oldnewmap_lookup_array);
+  blo_oldnewmap_lookup_array(onm, addr_array, lookups_num, true);
+  TIMEIT_END(oldnewmap_lookup_array);
+  for (int i = 0; i < lookups_num; i++) {
+    checksum_array += (uintptr_t)addr_array[i];
+  }
+  EXPECT_EQ(checksum, checksum_array);
+
+  MEM_freeN(addr_array);
+  MEM_freeN((void *)lookups);
+  blo_oldnewmap_free(onm);
+
+  printf("========== ENDED %s ==========\n\n", __func__);
+}
+
+TEST(oldnewmap, Benchmark)
+{
+  oldnewmap_benchmark(1 << 20, 1 << 22);
+}
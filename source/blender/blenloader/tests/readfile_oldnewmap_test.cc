@@ -0,0 +1,129 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+
+#include "DNA_listBase.h"
+
+#include "BLO_readfile.h"
+
+extern "C" {
+#include "intern/readfile.h"
+}
+
+/* Fake old addresses, spaced like allocations written to a file. */
+static const void *oldnewmap_test_old_address(const int index)
+{
+  return POINTER_OFFSET((void *)0x7f0000001000, (size_t)index * 48);
+}
+
+static void *oldnewmap_test_new_address(const int index)
+{
+  return POINTER_OFFSET((void *)0x100000, (size_t)index * 16);
+}
+
+TEST(oldnewmap, InsertLookup)
+{
+  const int items_num = 10000;
+  OldNewMap *onm = blo_oldnewmap_new();
+
+  for (int i = 0; i < items_num; i++) {
+    blo_oldnewmap_insert(onm, oldnewmap_test_old_address(i), oldnewmap_test_new_address(i), 1);
+  }
+  for (int i = 0; i < items_num; i++) {
+    EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, oldnewmap_test_old_address(i), true),
+              oldnewmap_test_new_address(i));
+  }
+
+  /* Missing and NULL addresses. */
+  EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, oldnewmap_test_old_address(items_num), true),
+            nullptr);
+  EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, nullptr, true), nullptr);
+
+  /* NULL pointers are never inserted. */
+  blo_oldnewmap_insert(onm, nullptr, oldnewmap_test_new_address(0), 1);
+  blo_oldnewmap_insert(onm, oldnewmap_test_old_address(items_num), nullptr, 1);
+  EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, nullptr, false), nullptr);
+  EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, oldnewmap_test_old_address(items_num), false),
+            nullptr);
+
+  blo_oldnewmap_free(onm);
+}
+
+TEST(oldnewmap, Replace)
+{
+  OldNewMap *onm = blo_oldnewmap_new();
+
+  blo_oldnewmap_insert(onm, oldnewmap_test_old_address(0), oldnewmap_test_new_address(0), 1);
+  blo_oldnewmap_insert(onm, oldnewmap_test_old_address(0), oldnewmap_test_new_address(1), 1);
+  EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, oldnewmap_test_old_address(0), false),
+            oldnewmap_test_new_address(1));
+
+  blo_oldnewmap_free(onm);
+}
+
+TEST(oldnewmap, LookupArray)
+{
+  const int items_num = 1000;
+  OldNewMap *onm = blo_oldnewmap_new();
+
+  for (int i = 0; i < items_num; i += 2) {
+    blo_oldnewmap_insert(onm, oldnewmap_test_old_address(i), oldnewmap_test_new_address(i), 1);
+  }
+
+  void **addr_array = (void **)MEM_malloc_arrayN(items_num, sizeof(void *), __func__);
+  for (int i = 0; i < items_num; i++) {
+    addr_array[i] = (void *)oldnewmap_test_old_address(i);
+  }
+  blo_oldnewmap_lookup_array(onm, addr_array, items_num, false);
+  for (int i = 0; i < items_num; i++) {
+    EXPECT_EQ(addr_array[i], (i % 2) ? nullptr : oldnewmap_test_new_address(i));
+  }
+
+  MEM_freeN(addr_array);
+  blo_oldnewmap_free(onm);
+}
+
+TEST(oldnewmap, Clear)
+{
+  const int items_num = 1000;
+  OldNewMap *onm = blo_oldnewmap_new();
+
+  /* Data that was never looked up (user count of zero) is freed. */
+  for (int i = 0; i < items_num; i++) {
+    blo_oldnewmap_insert(onm, oldnewmap_test_old_address(i), MEM_mallocN(1, __func__), 0);
+  }
+  void *data_used = blo_oldnewmap_lookup_and_inc(onm, oldnewmap_test_old_address(0), true);
+  blo_oldnewmap_clear(onm);
+  MEM_freeN(data_used);
+
+  for (int i = 0; i < items_num; i++) {
+    EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, oldnewmap_test_old_address(i), false), nullptr);
+  }
+
+  /* The map can still be used after clearing. */
+  blo_oldnewmap_insert(onm, oldnewmap_test_old_address(0), oldnewmap_test_new_address(0), 1);
+  EXPECT_EQ(blo_oldnewmap_lookup_and_inc(onm, oldnewmap_test_old_address(0), false),
+            oldnewmap_test_new_address(0));
+
+  blo_oldnewmap_free(onm);
+}
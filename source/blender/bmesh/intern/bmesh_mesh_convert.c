@@ -592,10 +592,16 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
 #if 0
   oldverts = MEM_dupallocN(me->mvert);
 #else
-    oldverts = me->mvert;
-    me->mvert = NULL;
     CustomData_update_typemap(&me->vdata);
-    CustomData_set_layer(&me->vdata, CD_MVERT, NULL);
+    if (CustomData_is_shared_layer(&me->vdata, CD_MVERT)) {
+      /* Evaluated copies still use the array, it is freed with the last of them. */
+      oldverts = MEM_dupallocN(me->mvert);
+    }
+    else {
+      oldverts = me->mvert;
+      me->mvert = NULL;
+      CustomData_set_layer(&me->vdata, CD_MVERT, NULL);
+    }
 #endif
   }
 
@@ -954,9 +960,7 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
       }
 
       currkey->totelem = bm->totvert;
-      if (currkey->data) {
-        MEM_freeN(currkey->data);
-      }
+      BKE_keyblock_data_free(currkey);
       currkey->data = newkey;
     }
 
@@ -62,6 +62,15 @@ typedef enum eEvaluationMode {
   DAG_EVAL_RENDER = 1,   /* evaluate for render purposes */
 } eEvaluationMode;
 
+/* Order in which operations which are ready for evaluation are dispatched to threads. */
+typedef enum eDepsgraphSchedulingMode {
+  /* Operations are dispatched in the order in which their dependencies got evaluated. */
+  DEG_SCHEDULING_DISCOVERY_ORDER = 0,
+  /* Operations heading the longest remaining chain of work are dispatched first. The length of
+   * the chains is estimated from timing of operations in previous evaluations of the graph. */
+  DEG_SCHEDULING_CRITICAL_PATH = 1,
+} eDepsgraphSchedulingMode;
+
 /* DagNode->eval_flags */
 enum {
   /* Regardless to curve->path animation flag path is to be evaluated anyway,
@@ -161,6 +170,9 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float ctime);
 /* Data changed recalculation entry point. */
 void DEG_evaluate_on_refresh(Depsgraph *graph);
 
+/* Order of dispatching operations during threaded evaluation of the graph. */
+void DEG_evaluate_scheduling_mode_set(Depsgraph *graph, eDepsgraphSchedulingMode mode);
+
 /* Editors Integration  -------------------------- */
 
 /* Mechanism to allow editors to be informed of depsgraph updates,
@@ -72,12 +72,24 @@ void DEG_graph_build_from_ids(struct Depsgraph *graph, struct ID **ids, const in
 /* Tag relations from the given graph for update. */
 void DEG_graph_tag_relations_update(struct Depsgraph *graph);
 
+/* Tag relations of a single ID from the given graph for update.
+ *
+ * Only nodes of the ID and relations of the ID and its direct neighbors are built again, so this
+ * is only to be used for changes of relations coming from the ID itself, such as its constraints,
+ * modifiers and drivers. Anything else, like changes to which other IDs depend on the ID, needs
+ * all relations to be tagged for update. */
+void DEG_graph_id_tag_relations_update(struct Depsgraph *graph, struct ID *id);
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(struct Depsgraph *graph);
 
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of a single ID in all graphs for update.
+ * See DEG_graph_id_tag_relations_update() for when this can be used. */
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
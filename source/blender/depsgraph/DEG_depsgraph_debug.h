@@ -62,6 +62,12 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* Timing of the builder pipeline steps and graph size of the latest relations build. */
+void DEG_debug_build_stats_gnuplot(const struct Depsgraph *graph,
+                                   FILE *fp,
+                                   const char *label,
+                                   const char *output_filename);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
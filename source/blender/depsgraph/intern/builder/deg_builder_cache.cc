@@ -31,6 +31,8 @@
 
 #include "BKE_animsys.h"
 
+#include "intern/depsgraph.h"
+
 namespace blender::deg {
 
 /* Animated property storage. */
@@ -92,6 +94,7 @@ void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
     return;
   }
   AnimatedPropertyCallbackData *data = static_cast<AnimatedPropertyCallbackData *>(data_v);
+  data->builder_cache->num_rna_path_resolves++;
   /* Resolve property. */
   PointerRNA pointer_rna;
   PropertyRNA *property_rna = nullptr;
@@ -105,6 +108,7 @@ void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
   if (pointer_rna.owner_id != data->pointer_rna.owner_id) {
     animated_property_storage = data->builder_cache->ensureAnimatedPropertyStorage(
         pointer_rna.owner_id);
+    animated_property_storage->animated_by_ids.add(data->pointer_rna.owner_id);
   }
   /* Set the property as animated. */
   animated_property_storage->tagPropertyAsAnimated(&pointer_rna, property_rna);
@@ -112,7 +116,7 @@ void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
 
 }  // namespace
 
-AnimatedPropertyStorage::AnimatedPropertyStorage() : is_fully_initialized(false)
+AnimatedPropertyStorage::AnimatedPropertyStorage() : is_fully_initialized(false), session_uuid(0)
 {
 }
 
@@ -150,6 +154,7 @@ bool AnimatedPropertyStorage::isPropertyAnimated(const PointerRNA *pointer_rna,
 /* Builder cache itself. */
 
 DepsgraphBuilderCache::DepsgraphBuilderCache()
+    : num_rna_path_resolves(0), num_animated_property_storage_initialized(0)
 {
 }
 
@@ -163,8 +168,19 @@ DepsgraphBuilderCache::~DepsgraphBuilderCache()
 
 AnimatedPropertyStorage *DepsgraphBuilderCache::ensureAnimatedPropertyStorage(ID *id)
 {
-  return animated_property_storage_map_.lookup_or_add_cb(
-      id, []() { return new AnimatedPropertyStorage(); });
+  AnimatedPropertyStorage *animated_property_storage =
+      animated_property_storage_map_.lookup_default(id, nullptr);
+  if (animated_property_storage != nullptr) {
+    if (animated_property_storage->session_uuid == id->session_uuid) {
+      return animated_property_storage;
+    }
+    /* Storage of a freed ID, the address got re-used by another one. */
+    invalidateAnimatedPropertyStorage(id);
+  }
+  animated_property_storage = new AnimatedPropertyStorage();
+  animated_property_storage->session_uuid = id->session_uuid;
+  animated_property_storage_map_.add_new(id, animated_property_storage);
+  return animated_property_storage;
 }
 
 AnimatedPropertyStorage *DepsgraphBuilderCache::ensureInitializedAnimatedPropertyStorage(ID *id)
@@ -173,8 +189,46 @@ AnimatedPropertyStorage *DepsgraphBuilderCache::ensureInitializedAnimatedPropert
   if (!animated_property_storage->is_fully_initialized) {
     animated_property_storage->initializeFromID(this, id);
     animated_property_storage->is_fully_initialized = true;
+    num_animated_property_storage_initialized++;
   }
   return animated_property_storage;
 }
 
+void DepsgraphBuilderCache::invalidateAnimatedPropertyStorage(ID *id)
+{
+  AnimatedPropertyStorage *animated_property_storage = animated_property_storage_map_.pop_default(
+      id, nullptr);
+  if (animated_property_storage == nullptr) {
+    return;
+  }
+  /* Properties tagged by the F-Curves of other IDs are only added when those IDs are initialized,
+   * so they are to be initialized again. */
+  for (ID *animated_by_id : animated_property_storage->animated_by_ids) {
+    invalidateAnimatedPropertyStorage(animated_by_id);
+  }
+  delete animated_property_storage;
+}
+
+void DepsgraphBuilderCache::clearAnimatedPropertyStorage()
+{
+  for (AnimatedPropertyStorage *animated_property_storage :
+       animated_property_storage_map_.values()) {
+    delete animated_property_storage;
+  }
+  animated_property_storage_map_.clear();
+}
+
+void DepsgraphBuilderCache::removeUnusedAnimatedPropertyStorage(const Depsgraph *graph)
+{
+  Vector<ID *> unused_ids;
+  for (ID *id : animated_property_storage_map_.keys()) {
+    if (graph->find_id_node(id) == nullptr) {
+      unused_ids.append(id);
+    }
+  }
+  for (ID *id : unused_ids) {
+    invalidateAnimatedPropertyStorage(id);
+  }
+}
+
 }  // namespace blender::deg
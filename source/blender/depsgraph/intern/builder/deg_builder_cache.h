@@ -37,6 +37,7 @@ namespace blender {
 namespace deg {
 
 class DepsgraphBuilderCache;
+struct Depsgraph;
 
 /* Identifier for animated property. */
 class AnimatedPropertyID {
@@ -72,13 +73,27 @@ class AnimatedPropertyStorage {
   /* The storage is fully initialized from all F-Curves from corresponding ID. */
   bool is_fully_initialized;
 
+  /* Session UUID of the ID the storage was created for, allows to detect the storage outliving
+   * the ID when the ID is freed and a new one is allocated at the same address. */
+  uint session_uuid;
+
+  /* Other IDs whose F-Curves animate properties of this ID (nested datablocks animated by their
+   * parent). Properties they tagged are lost when this storage is invalidated. */
+  Set<ID *> animated_by_ids;
+
   /* indexed by PointerRNA.data. */
   Set<AnimatedPropertyID> animated_properties_set;
 
   MEM_CXX_CLASS_ALLOC_FUNCS("AnimatedPropertyStorage");
 };
 
-/* Cached data which can be re-used by multiple builders. */
+/* Cached data which can be re-used by multiple builders.
+ *
+ * The cache is owned by the dependency graph. It is cleared by every full build, since relations
+ * updates are tagged by edits (of F-Curve paths, for example) which do not tag the ID they change.
+ * It only persists across incremental relations updates, for which storage of an ID is invalidated
+ * when the ID is tagged for an update which might have changed its animation data or the layout of
+ * its data. */
 class DepsgraphBuilderCache {
  public:
   DepsgraphBuilderCache();
@@ -88,6 +103,13 @@ class DepsgraphBuilderCache {
   AnimatedPropertyStorage *ensureAnimatedPropertyStorage(ID *id);
   AnimatedPropertyStorage *ensureInitializedAnimatedPropertyStorage(ID *id);
 
+  /* Forget animated properties of the given ID, and of IDs which animate it. */
+  void invalidateAnimatedPropertyStorage(ID *id);
+  /* Free storage of all IDs. */
+  void clearAnimatedPropertyStorage();
+  /* Free storage of all IDs which are not in the given dependency graph. */
+  void removeUnusedAnimatedPropertyStorage(const Depsgraph *graph);
+
   /* Shortcuts to go through ensureInitializedAnimatedPropertyStorage and its
    * isPropertyAnimated.
    *
@@ -105,6 +127,10 @@ class DepsgraphBuilderCache {
 
   Map<ID *, AnimatedPropertyStorage *> animated_property_storage_map_;
 
+  /* Statistics of the current build, reset by the builder pipeline. */
+  int num_rna_path_resolves;
+  int num_animated_property_storage_initialized;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("DepsgraphBuilderCache");
 };
 
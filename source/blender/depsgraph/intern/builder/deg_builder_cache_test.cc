@@ -0,0 +1,159 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_constraint.h"
+#include "BKE_fcurve.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_constraint_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/deg_builder_cache.h"
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node_id.h"
+
+namespace blender::deg::tests {
+
+/* Bases of objects hidden in the viewport are only pulled into the graph when their visibility is
+ * animated, which is looked up in the builder cache. The hidden object is a constraint target of
+ * the visible one, so it is in the graph and its cached data is kept. */
+class DepsgraphBuilderCacheTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  ::Depsgraph *graph = nullptr;
+  Object *ob_hidden = nullptr;
+  Object *ob_visible = nullptr;
+  FCurve *fcu = nullptr;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = BKE_view_layer_default_view(scene);
+
+    ob_visible = BKE_object_add(bmain, view_layer, OB_EMPTY, "Visible");
+    ob_hidden = BKE_object_add(bmain, view_layer, OB_EMPTY, "Hidden");
+    bConstraint *con = BKE_constraint_add_for_object(
+        ob_visible, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+    ((bLocateLikeConstraint *)con->data)->tar = ob_hidden;
+    ob_hidden->restrictflag |= OB_RESTRICT_VIEWPORT;
+    BKE_base_eval_flags(BKE_view_layer_base_find(view_layer, ob_hidden));
+
+    AnimData *adt = BKE_animdata_add_id(&ob_hidden->id);
+    adt->action = BKE_action_add(bmain, "Action");
+    fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup("location");
+    BLI_addtail(&adt->action->curves, fcu);
+
+    graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(graph);
+    /* Copy-on-write datablocks are only re-used by later builds once they are expanded. */
+    DEG_evaluate_on_refresh(graph);
+  }
+
+  void TearDown() override
+  {
+    DEG_graph_free(graph);
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_main_free(bmain);
+  }
+
+  Depsgraph *deg_graph()
+  {
+    return reinterpret_cast<Depsgraph *>(graph);
+  }
+
+  bool hidden_object_has_base()
+  {
+    return deg_graph()->find_id_node(&ob_hidden->id)->has_base;
+  }
+
+  AnimatedPropertyStorage *hidden_object_storage()
+  {
+    return deg_graph()->builder_cache->animated_property_storage_map_.lookup_default(
+        &ob_hidden->id, nullptr);
+  }
+};
+
+/* Editing the F-Curve path only tags relations of all graphs for update. */
+TEST_F(DepsgraphBuilderCacheTest, FullBuildAfterFCurvePathEdit)
+{
+  EXPECT_FALSE(hidden_object_has_base());
+  ASSERT_NE(hidden_object_storage(), nullptr);
+
+  MEM_freeN(fcu->rna_path);
+  fcu->rna_path = BLI_strdup("hide_viewport");
+  DEG_relations_tag_update(bmain);
+  DEG_graph_relations_update(graph);
+
+  EXPECT_FALSE(deg_graph()->debug.build_stats.is_incremental);
+  EXPECT_TRUE(hidden_object_has_base());
+}
+
+/* Storage of IDs which are not tagged is re-used by incremental relations updates. */
+TEST_F(DepsgraphBuilderCacheTest, IncrementalBuildReuse)
+{
+  AnimatedPropertyStorage *storage = hidden_object_storage();
+  ASSERT_NE(storage, nullptr);
+
+  DEG_graph_id_tag_relations_update(graph, &ob_visible->id);
+  DEG_graph_relations_update(graph);
+
+  EXPECT_TRUE(deg_graph()->debug.build_stats.is_incremental);
+  EXPECT_EQ(deg_graph()->debug.build_stats.num_animated_ids_initialized, 0);
+  EXPECT_EQ(hidden_object_storage(), storage);
+}
+
+TEST_F(DepsgraphBuilderCacheTest, InvalidateOnTag)
+{
+  ASSERT_NE(hidden_object_storage(), nullptr);
+
+  /* Transform updates can not change animation data. */
+  DEG_graph_id_tag_update(bmain, graph, &ob_hidden->id, ID_RECALC_TRANSFORM);
+  EXPECT_NE(hidden_object_storage(), nullptr);
+
+  DEG_graph_id_tag_update(bmain, graph, &ob_hidden->id, ID_RECALC_ANIMATION);
+  EXPECT_EQ(hidden_object_storage(), nullptr);
+}
+
+}  // namespace blender::deg::tests
@@ -99,6 +99,9 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   }
 
   virtual void begin_build();
+  /* Remove nodes of the given IDs, so they can be built again. Nodes of all other IDs are kept,
+   * and are considered to be built already. */
+  virtual void begin_build_incremental(const Set<ID *> &ids);
   virtual void end_build();
 
   IDNode *add_id_node(ID *id);
@@ -162,6 +165,10 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build nodes of IDs removed by begin_build_incremental(). */
+  virtual void build_view_layer_incremental(Scene *scene,
+                                            ViewLayer *view_layer,
+                                            const Set<ID *> &ids);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
@@ -259,6 +266,17 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   };
   Vector<SavedEntryTag> saved_entry_tags_;
 
+  /* State of an ID node removed by an incremental build, which is not restored when building it
+   * again from a different place than the original build. */
+  struct SavedIDState {
+    eDepsNode_LinkedState_Type linked_state;
+    bool is_directly_visible;
+  };
+  Map<const ID *, SavedIDState> saved_id_states_;
+
+  void save_id_info(IDNode *id_node);
+  void save_entry_tag(OperationNode *op_node);
+
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
     /* Denotes whether object the walk is invoked from is visible. */
@@ -174,4 +174,28 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphNodeBuilder::build_view_layer_incremental(Scene *scene,
+                                                        ViewLayer *view_layer,
+                                                        const Set<ID *> &ids)
+{
+  BLI_assert(scene->set == nullptr);
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+  /* Objects with a base need the same base index as given by build_view_layer(). */
+  int base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (need_pull_base_into_graph(base)) {
+      if (ids.contains(&base->object->id)) {
+        build_object(base_index, base->object, DEG_ID_LINKED_DIRECTLY, true);
+      }
+      base_index++;
+    }
+  }
+  /* Everything else is built as a dependency, visibility is restored by end_build(). */
+  for (ID *id : ids) {
+    build_id(id);
+  }
+}
+
 }  // namespace blender::deg
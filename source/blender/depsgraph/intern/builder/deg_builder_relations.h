@@ -164,6 +164,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
   void begin_build();
+  /* Build relations on top of the existing ones: only builders of the given IDs and IDs which
+   * are not in the graph yet are invoked, and relations which already exist are not added again.
+   * Nodes of IDs in kept_node_ids are kept from the previous state of the graph, and so are all
+   * relations of the ones which are not in ids, including copy-on-write and driver ones. */
+  void begin_build_incremental(const Set<ID *> &ids, const Set<ID *> &kept_node_ids);
 
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
@@ -209,6 +214,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build relations of IDs given to begin_build_incremental(), including the ones which are only
+   * reachable through IDs kept from the previous state of the graph. */
+  virtual void build_view_layer_incremental(Scene *scene,
+                                            ViewLayer *view_layer,
+                                            const Set<ID *> &ids);
   virtual void build_collection(LayerCollection *from_layer_collection,
                                 Object *object,
                                 Collection *collection);
@@ -337,6 +347,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
                                    OperationNode *node_to,
                                    const char *description,
                                    int flags = 0);
+  /* Wrapper around Depsgraph::add_new_relation() which takes incremental build into account. */
+  Relation *add_new_relation(Node *node_from,
+                             Node *node_to,
+                             const char *description,
+                             int flags = 0);
 
   template<typename KeyType>
   DepsNodeHandle create_node_handle(const KeyType &key, const char *default_name = "");
@@ -373,6 +388,10 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
+
+  /* Relations are being built on top of the existing ones, see begin_build_incremental(). */
+  bool is_incremental_build_;
+  Set<ID *> kept_relation_ids_;
 };
 
 struct DepsNodeHandle {
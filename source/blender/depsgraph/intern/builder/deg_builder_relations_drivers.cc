@@ -155,6 +155,9 @@ static bool is_reachable(const Node *const from, const Node *const to)
 void DepsgraphRelationBuilder::build_driver_relations()
 {
   for (IDNode *id_node : graph_->id_nodes) {
+    if (kept_relation_ids_.contains(id_node->id_orig)) {
+      continue;
+    }
     build_driver_relations(id_node);
   }
 }
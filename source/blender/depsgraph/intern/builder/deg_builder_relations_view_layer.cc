@@ -153,4 +153,20 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphRelationBuilder::build_view_layer_incremental(Scene *scene,
+                                                            ViewLayer *view_layer,
+                                                            const Set<ID *> &ids)
+{
+  BLI_assert(scene->set == nullptr);
+  /* Relations which are built from the scene itself, such as rigid body ones, are not owned by
+   * any of the IDs. */
+  build_view_layer(scene, view_layer, DEG_ID_LINKED_DIRECTLY);
+  /* The walk above stops at kept IDs, so IDs which are only used by them (shape keys of a kept
+   * mesh, embedded node trees, objects of an instanced collection, constraint targets) are not
+   * reached by it. */
+  for (ID *id : ids) {
+    build_id(id);
+  }
+}
+
 }  // namespace blender::deg
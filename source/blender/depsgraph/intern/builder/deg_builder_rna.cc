@@ -127,6 +127,7 @@ Node *RNANodeQuery::find_node(const PointerRNA *ptr,
                               const PropertyRNA *prop,
                               RNAPointerSource source)
 {
+  depsgraph_->debug.build_stats.num_rna_node_queries++;
   const RNANodeIdentifier node_identifier = construct_node_identifier(ptr, prop, source);
   if (!node_identifier.is_valid()) {
     return nullptr;
@@ -22,6 +22,7 @@
 #include "PIL_time.h"
 
 #include "BKE_global.h"
+#include "BKE_lib_query.h"
 
 #include "DNA_scene_types.h"
 
@@ -30,13 +31,19 @@
 #include "deg_builder_relations.h"
 #include "deg_builder_transitive.h"
 
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
 namespace blender::deg {
 
 AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
     : deg_graph_(reinterpret_cast<Depsgraph *>(graph)),
       bmain_(deg_graph_->bmain),
       scene_(deg_graph_->scene),
-      view_layer_(deg_graph_->view_layer)
+      view_layer_(deg_graph_->view_layer),
+      builder_cache_(*deg_graph_->builder_cache)
 {
 }
 
@@ -46,21 +53,104 @@ AbstractBuilderPipeline::~AbstractBuilderPipeline()
 
 void AbstractBuilderPipeline::build()
 {
-  double start_time = 0.0;
-  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
-    start_time = PIL_check_seconds_timer();
-  }
+  const double start_time = PIL_check_seconds_timer();
+  build_stats_begin(false);
+  /* Full builds are requested by changes which might not have tagged the IDs they affect. */
+  builder_cache_.clearAnimatedPropertyStorage();
 
   build_step_sanity_check();
   build_step_nodes();
   build_step_relations();
   build_step_finalize();
 
+  build_stats_end(start_time);
   if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
-    printf("Depsgraph built in %f seconds.\n", PIL_check_seconds_timer() - start_time);
+    printf("Depsgraph built in %f seconds.\n", deg_graph_->debug.build_stats.time_total);
+  }
+}
+
+static void add_relation_neighbor(Set<ID *> &ids, Node *node)
+{
+  if (node->type == NodeType::OPERATION) {
+    ids.add(static_cast<OperationNode *>(node)->owner->owner->id_orig);
   }
 }
 
+static int add_referenced_id(LibraryIDLinkCallbackData *cb_data)
+{
+  ID *id = *cb_data->id_pointer;
+  if (id != nullptr) {
+    static_cast<Set<ID *> *>(cb_data->user_data)->add(id);
+  }
+  return IDWALK_RET_NOP;
+}
+
+bool AbstractBuilderPipeline::build_incremental()
+{
+  const Set<ID *> ids = deg_graph_->relations_update_ids;
+  if (!supports_incremental_build() || ids.is_empty()) {
+    return false;
+  }
+  /* Relations of the tagged IDs are built again, as well as relations of all IDs they were
+   * connected to: those IDs could have been building relations to the removed nodes. */
+  Set<ID *> relation_ids;
+  Set<ID *> dependency_ids;
+  for (ID *id : ids) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    /* IDs which are not in the graph yet can only be reached by building it from scratch.
+     * Scene nodes are built by the view layer itself. */
+    if (id_node == nullptr || GS(id->name) == ID_SCE) {
+      return false;
+    }
+    relation_ids.add(id);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        for (Relation *rel : op_node->inlinks) {
+          add_relation_neighbor(relation_ids, rel->from);
+          add_relation_neighbor(dependency_ids, rel->from);
+        }
+        for (Relation *rel : op_node->outlinks) {
+          add_relation_neighbor(relation_ids, rel->to);
+        }
+      }
+    }
+  }
+  /* Nodes of IDs which are no longer used by the tagged ones might not be needed anymore, which
+   * is only known by building the graph from scratch. */
+  Set<ID *> referenced_ids;
+  for (ID *id : ids) {
+    BKE_library_foreach_ID_link(nullptr, id, add_referenced_id, &referenced_ids, IDWALK_READONLY);
+  }
+  for (ID *id : dependency_ids) {
+    if (!ids.contains(id) && !referenced_ids.contains(id) && GS(id->name) != ID_SCE) {
+      return false;
+    }
+  }
+  Set<ID *> kept_node_ids;
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    if (!ids.contains(id_node->id_orig)) {
+      kept_node_ids.add(id_node->id_orig);
+    }
+  }
+
+  const double start_time = PIL_check_seconds_timer();
+  build_stats_begin(true);
+
+  build_step_sanity_check();
+  build_step_nodes_incremental(ids);
+  build_step_relations_incremental(relation_ids, kept_node_ids);
+  build_step_finalize();
+
+  build_stats_end(start_time);
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph updated for %d IDs (%d with relations) in %f seconds.\n",
+           (int)ids.size(),
+           (int)relation_ids.size(),
+           deg_graph_->debug.build_stats.time_total);
+  }
+  return true;
+}
+
 void AbstractBuilderPipeline::build_step_sanity_check()
 {
   BLI_assert(BLI_findindex(&scene_->view_layers, view_layer_) != -1);
@@ -70,25 +160,52 @@ void AbstractBuilderPipeline::build_step_sanity_check()
 
 void AbstractBuilderPipeline::build_step_nodes()
 {
+  const double start_time = PIL_check_seconds_timer();
   /* Generate all the nodes in the graph first */
   unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
   node_builder->begin_build();
   build_nodes(*node_builder);
   node_builder->end_build();
+  deg_graph_->debug.build_stats.time_nodes = PIL_check_seconds_timer() - start_time;
+}
+
+void AbstractBuilderPipeline::build_step_nodes_incremental(const Set<ID *> &ids)
+{
+  const double start_time = PIL_check_seconds_timer();
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->begin_build_incremental(ids);
+  build_nodes_incremental(*node_builder, ids);
+  node_builder->end_build();
+  deg_graph_->debug.build_stats.time_nodes = PIL_check_seconds_timer() - start_time;
 }
 
 void AbstractBuilderPipeline::build_step_relations()
 {
+  const double start_time = PIL_check_seconds_timer();
   /* Hook up relationships between operations - to determine evaluation order. */
   unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
   relation_builder->begin_build();
   build_relations(*relation_builder);
   relation_builder->build_copy_on_write_relations();
   relation_builder->build_driver_relations();
+  deg_graph_->debug.build_stats.time_relations = PIL_check_seconds_timer() - start_time;
+}
+
+void AbstractBuilderPipeline::build_step_relations_incremental(const Set<ID *> &ids,
+                                                               const Set<ID *> &kept_node_ids)
+{
+  const double start_time = PIL_check_seconds_timer();
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_build_incremental(ids, kept_node_ids);
+  build_relations_incremental(*relation_builder, ids);
+  relation_builder->build_copy_on_write_relations();
+  relation_builder->build_driver_relations();
+  deg_graph_->debug.build_stats.time_relations = PIL_check_seconds_timer() - start_time;
 }
 
 void AbstractBuilderPipeline::build_step_finalize()
 {
+  const double start_time = PIL_check_seconds_timer();
   /* Detect and solve cycles. */
   deg_graph_detect_cycles(deg_graph_);
   /* Simplify the graph by removing redundant relations (to optimize
@@ -109,8 +226,53 @@ void AbstractBuilderPipeline::build_step_finalize()
     abort();
   }
 #endif
+  /* Cached data of IDs which are no longer in the graph is not needed anymore. Their memory might
+   * also be re-used by other data before the next build. */
+  builder_cache_.removeUnusedAnimatedPropertyStorage(deg_graph_);
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  deg_graph_->relations_update_ids.clear();
+  deg_graph_->debug.build_stats.time_finalize = PIL_check_seconds_timer() - start_time;
+}
+
+void AbstractBuilderPipeline::build_stats_begin(const bool is_incremental)
+{
+  DepsgraphBuildStats &stats = deg_graph_->debug.build_stats;
+  stats.reset();
+  stats.is_incremental = is_incremental;
+  builder_cache_.num_rna_path_resolves = 0;
+  builder_cache_.num_animated_property_storage_initialized = 0;
+}
+
+void AbstractBuilderPipeline::build_stats_end(const double start_time)
+{
+  DepsgraphBuildStats &stats = deg_graph_->debug.build_stats;
+  stats.num_id_nodes = deg_graph_->id_nodes.size();
+  stats.num_operations = deg_graph_->operations.size();
+  for (OperationNode *op_node : deg_graph_->operations) {
+    stats.num_relations += op_node->inlinks.size();
+  }
+  stats.num_rna_path_resolves = builder_cache_.num_rna_path_resolves;
+  stats.num_animated_ids_initialized = builder_cache_.num_animated_property_storage_initialized;
+  stats.num_animated_ids_cached = builder_cache_.animated_property_storage_map_.size();
+  stats.time_total = PIL_check_seconds_timer() - start_time;
+}
+
+bool AbstractBuilderPipeline::supports_incremental_build() const
+{
+  return false;
+}
+
+void AbstractBuilderPipeline::build_nodes_incremental(DepsgraphNodeBuilder & /*node_builder*/,
+                                                      const Set<ID *> & /*ids*/)
+{
+  BLI_assert(!"Pipeline does not support incremental build");
+}
+
+void AbstractBuilderPipeline::build_relations_incremental(
+    DepsgraphRelationBuilder & /*relation_builder*/, const Set<ID *> & /*ids*/)
+{
+  BLI_assert(!"Pipeline does not support incremental build");
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
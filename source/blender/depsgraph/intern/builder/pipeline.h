@@ -28,6 +28,7 @@
 #include "intern/depsgraph_type.h"
 
 struct Depsgraph;
+struct ID;
 struct Main;
 struct Scene;
 struct ViewLayer;
@@ -53,24 +54,43 @@ class AbstractBuilderPipeline {
   virtual ~AbstractBuilderPipeline();
 
   void build();
+  /* Build nodes of IDs tagged with DEG_graph_id_tag_relations_update() again, together with
+   * relations of those IDs and their direct neighbors. Everything else is kept as-is.
+   *
+   * Returns false when the graph can not be updated incrementally, without changing it. */
+  bool build_incremental();
 
  protected:
   Depsgraph *deg_graph_;
   Main *bmain_;
   Scene *scene_;
   ViewLayer *view_layer_;
-  DepsgraphBuilderCache builder_cache_;
+  /* Owned by the dependency graph, persists across builds. */
+  DepsgraphBuilderCache &builder_cache_;
 
   virtual unique_ptr<DepsgraphNodeBuilder> construct_node_builder();
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder();
 
   virtual void build_step_sanity_check();
   void build_step_nodes();
+  void build_step_nodes_incremental(const Set<ID *> &ids);
   void build_step_relations();
+  void build_step_relations_incremental(const Set<ID *> &ids, const Set<ID *> &kept_node_ids);
   void build_step_finalize();
 
+  /* Gather statistics of the build, see DepsgraphBuildStats. */
+  void build_stats_begin(bool is_incremental);
+  void build_stats_end(double start_time);
+
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) = 0;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) = 0;
+
+  /* Pipelines which support incremental build need to be able to build nodes of individual IDs,
+   * with the same state as given by build_nodes(). */
+  virtual bool supports_incremental_build() const;
+  virtual void build_nodes_incremental(DepsgraphNodeBuilder &node_builder, const Set<ID *> &ids);
+  virtual void build_relations_incremental(DepsgraphRelationBuilder &relation_builder,
+                                           const Set<ID *> &ids);
 };
 
 }  // namespace deg
@@ -0,0 +1,237 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include <string>
+
+#include "BLI_set.hh"
+
+#include "BKE_constraint.h"
+#include "BKE_key.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_key_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+#include "intern/node/deg_node_time.h"
+
+namespace blender::deg::tests {
+
+/* Relations of a graph updated for tagged IDs only are the same as the ones of a graph built from
+ * scratch. */
+class DepsgraphPipelineTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = BKE_view_layer_default_view(scene);
+  }
+
+  void TearDown() override
+  {
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_main_free(bmain);
+  }
+
+  ::Depsgraph *depsgraph_build()
+  {
+    ::Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(graph);
+    /* Copy-on-write datablocks are only re-used by later builds once they are expanded. */
+    DEG_evaluate_on_refresh(graph);
+    return graph;
+  }
+
+  static void constraint_add(Object *ob, Object *target)
+  {
+    bConstraint *con = BKE_constraint_add_for_object(ob, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+    ((bLocateLikeConstraint *)con->data)->tar = target;
+  }
+
+  static std::string node_identifier(const Node *node)
+  {
+    if (node->type != NodeType::OPERATION) {
+      return node->name;
+    }
+    const OperationNode *op_node = static_cast<const OperationNode *>(node);
+    return std::string(nodeTypeAsString(op_node->owner->type)) + " " +
+           op_node->full_identifier();
+  }
+
+  static Set<std::string> relations_get(::Depsgraph *graph)
+  {
+    const Depsgraph *deg_graph = reinterpret_cast<const Depsgraph *>(graph);
+    Set<std::string> relations;
+    auto add_relations = [&](const Node *node) {
+      for (const Relation *rel : node->outlinks) {
+        relations.add(node_identifier(rel->from) + " -> " + node_identifier(rel->to) + " (" +
+                      rel->name + ")");
+      }
+    };
+    add_relations(deg_graph->time_source);
+    for (const OperationNode *op_node : deg_graph->operations) {
+      add_relations(op_node);
+    }
+    return relations;
+  }
+
+  static bool is_incremental_build(::Depsgraph *graph)
+  {
+    return reinterpret_cast<Depsgraph *>(graph)->debug.build_stats.is_incremental;
+  }
+
+  static const Relation *copy_on_write_relation_find(::Depsgraph *graph, ID *id_from, ID *id_to)
+  {
+    Depsgraph *deg_graph = reinterpret_cast<Depsgraph *>(graph);
+    const OperationNode *op_from = deg_graph->find_id_node(id_from)
+                                       ->find_component(NodeType::COPY_ON_WRITE)
+                                       ->get_exit_operation();
+    for (const Relation *rel : op_from->outlinks) {
+      const OperationNode *op_to = static_cast<const OperationNode *>(rel->to);
+      if (op_to->owner->owner->id_orig == id_to && op_to->owner->type == NodeType::COPY_ON_WRITE) {
+        return rel;
+      }
+    }
+    return nullptr;
+  }
+
+  /* Update relations of the given ID only, and compare them with a graph built from scratch. */
+  void expect_incremental_update_matches_full_build(::Depsgraph *graph, ID *id)
+  {
+    DEG_graph_id_tag_relations_update(graph, id);
+    DEG_graph_relations_update(graph);
+    DEG_evaluate_on_refresh(graph);
+    ::Depsgraph *graph_full = depsgraph_build();
+
+    const Set<std::string> relations = relations_get(graph);
+    const Set<std::string> relations_full = relations_get(graph_full);
+    for (const std::string &relation : relations_full) {
+      EXPECT_TRUE(relations.contains(relation)) << "Missing: " << relation;
+    }
+    for (const std::string &relation : relations) {
+      EXPECT_TRUE(relations_full.contains(relation)) << "Unexpected: " << relation;
+    }
+    EXPECT_EQ(reinterpret_cast<Depsgraph *>(graph)->id_nodes.size(),
+              reinterpret_cast<Depsgraph *>(graph_full)->id_nodes.size());
+
+    DEG_graph_free(graph_full);
+  }
+};
+
+/* Constraint targets without a base are only reached through the object which uses them. */
+TEST_F(DepsgraphPipelineTest, IncrementalConstraintTargetOfKeptObject)
+{
+  Object *ob = BKE_object_add(bmain, view_layer, OB_EMPTY, "Object");
+  Object *ob_target = BKE_object_add_only_object(bmain, OB_EMPTY, "Target");
+  Object *ob_target_target = BKE_object_add_only_object(bmain, OB_EMPTY, "TargetTarget");
+  Object *ob_new_target = BKE_object_add_only_object(bmain, OB_EMPTY, "NewTarget");
+  constraint_add(ob, ob_target);
+  constraint_add(ob_target, ob_target_target);
+
+  ::Depsgraph *graph = depsgraph_build();
+  expect_incremental_update_matches_full_build(graph, &ob_target_target->id);
+
+  EXPECT_TRUE(is_incremental_build(graph));
+
+  /* New relations of the tagged ID are added. */
+  constraint_add(ob_target_target, ob_new_target);
+  expect_incremental_update_matches_full_build(graph, &ob_target_target->id);
+  EXPECT_TRUE(is_incremental_build(graph));
+  EXPECT_NE(reinterpret_cast<Depsgraph *>(graph)->find_id_node(&ob_new_target->id), nullptr);
+
+  DEG_graph_free(graph);
+}
+
+/* Shape keys are only reached through the mesh which uses them. */
+TEST_F(DepsgraphPipelineTest, IncrementalShapeKeyOfKeptMesh)
+{
+  Object *ob = BKE_object_add(bmain, view_layer, OB_MESH, "Object");
+  Mesh *mesh = (Mesh *)ob->data;
+  mesh->key = BKE_key_add(bmain, &mesh->id);
+  BKE_keyblock_add(mesh->key, "Basis");
+
+  ::Depsgraph *graph = depsgraph_build();
+  expect_incremental_update_matches_full_build(graph, &mesh->key->id);
+  EXPECT_TRUE(is_incremental_build(graph));
+
+  DEG_graph_free(graph);
+}
+
+/* Relations of the object which uses the tagged data are built again, including copy-on-write
+ * ones. */
+TEST_F(DepsgraphPipelineTest, IncrementalMeshOfKeptObject)
+{
+  Object *ob = BKE_object_add(bmain, view_layer, OB_MESH, "Object");
+  Mesh *mesh = (Mesh *)ob->data;
+
+  ::Depsgraph *graph = depsgraph_build();
+  expect_incremental_update_matches_full_build(graph, &mesh->id);
+  EXPECT_TRUE(is_incremental_build(graph));
+
+  const Relation *rel = copy_on_write_relation_find(graph, &mesh->id, &ob->id);
+  ASSERT_NE(rel, nullptr);
+  EXPECT_STREQ(rel->name, "Eval Order");
+  EXPECT_TRUE(rel->flag & RELATION_FLAG_GODMODE);
+
+  DEG_graph_free(graph);
+}
+
+/* Nodes of IDs which are no longer used are removed. */
+TEST_F(DepsgraphPipelineTest, IncrementalConstraintRemove)
+{
+  Object *ob = BKE_object_add(bmain, view_layer, OB_EMPTY, "Object");
+  Object *ob_target = BKE_object_add_only_object(bmain, OB_EMPTY, "Target");
+  Object *ob_target_target = BKE_object_add_only_object(bmain, OB_EMPTY, "TargetTarget");
+  constraint_add(ob, ob_target);
+  constraint_add(ob_target, ob_target_target);
+
+  ::Depsgraph *graph = depsgraph_build();
+  BKE_constraint_remove(&ob->constraints, (bConstraint *)ob->constraints.first);
+  expect_incremental_update_matches_full_build(graph, &ob->id);
+  EXPECT_EQ(reinterpret_cast<Depsgraph *>(graph)->find_id_node(&ob_target->id), nullptr);
+  EXPECT_EQ(reinterpret_cast<Depsgraph *>(graph)->find_id_node(&ob_target_target->id), nullptr);
+
+  DEG_graph_free(graph);
+}
+
+}  // namespace blender::deg::tests
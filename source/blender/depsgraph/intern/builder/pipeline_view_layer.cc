@@ -19,6 +19,8 @@
 
 #include "pipeline_view_layer.h"
 
+#include "DNA_scene_types.h"
+
 #include "intern/builder/deg_builder_nodes.h"
 #include "intern/builder/deg_builder_relations.h"
 #include "intern/depsgraph.h"
@@ -40,4 +42,23 @@ void ViewLayerBuilderPipeline::build_relations(DepsgraphRelationBuilder &relatio
   relation_builder.build_view_layer(scene_, view_layer_, DEG_ID_LINKED_DIRECTLY);
 }
 
+bool ViewLayerBuilderPipeline::supports_incremental_build() const
+{
+  /* Objects of set scenes are linked differently, which is not handled by the incremental
+   * build. */
+  return scene_->set == nullptr;
+}
+
+void ViewLayerBuilderPipeline::build_nodes_incremental(DepsgraphNodeBuilder &node_builder,
+                                                       const Set<ID *> &ids)
+{
+  node_builder.build_view_layer_incremental(scene_, view_layer_, ids);
+}
+
+void ViewLayerBuilderPipeline::build_relations_incremental(
+    DepsgraphRelationBuilder &relation_builder, const Set<ID *> &ids)
+{
+  relation_builder.build_view_layer_incremental(scene_, view_layer_, ids);
+}
+
 }  // namespace blender::deg
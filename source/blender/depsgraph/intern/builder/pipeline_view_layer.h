@@ -35,6 +35,12 @@ class ViewLayerBuilderPipeline : public AbstractBuilderPipeline {
  protected:
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
+
+  virtual bool supports_incremental_build() const override;
+  virtual void build_nodes_incremental(DepsgraphNodeBuilder &node_builder,
+                                       const Set<ID *> &ids) override;
+  virtual void build_relations_incremental(DepsgraphRelationBuilder &relation_builder,
+                                           const Set<ID *> &ids) override;
 };
 
 }  // namespace deg
@@ -34,6 +34,27 @@
 
 namespace blender::deg {
 
+DepsgraphBuildStats::DepsgraphBuildStats()
+{
+  reset();
+}
+
+void DepsgraphBuildStats::reset()
+{
+  is_incremental = false;
+  num_id_nodes = 0;
+  num_operations = 0;
+  num_relations = 0;
+  num_rna_path_resolves = 0;
+  num_rna_node_queries = 0;
+  num_animated_ids_initialized = 0;
+  num_animated_ids_cached = 0;
+  time_nodes = 0.0;
+  time_relations = 0.0;
+  time_finalize = 0.0;
+  time_total = 0.0;
+}
+
 DepsgraphDebug::DepsgraphDebug()
     : flags(G.debug), is_ever_evaluated(false), graph_evaluation_start_time_(0)
 {
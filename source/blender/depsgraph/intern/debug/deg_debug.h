@@ -33,6 +33,36 @@
 namespace blender {
 namespace deg {
 
+/* Statistics of the latest relations build of the dependency graph. */
+struct DepsgraphBuildStats {
+  DepsgraphBuildStats();
+
+  void reset();
+
+  /* Only IDs tagged with DEG_graph_id_tag_relations_update() were built. */
+  bool is_incremental;
+
+  /* Size of the graph after the build. */
+  int num_id_nodes;
+  int num_operations;
+  int num_relations;
+
+  /* Number of F-Curve RNA paths resolved to find out which properties are animated. */
+  int num_rna_path_resolves;
+  /* Number of RNA pointers and properties looked up for a node of the graph. */
+  int num_rna_node_queries;
+  /* Number of IDs whose animated properties were collected during the build, and number of IDs
+   * whose animated properties are known to the persistent builder cache. */
+  int num_animated_ids_initialized;
+  int num_animated_ids_cached;
+
+  /* Time spent in the builder pipeline steps, in seconds. */
+  double time_nodes;
+  double time_relations;
+  double time_finalize;
+  double time_total;
+};
+
 class DepsgraphDebug {
  public:
   DepsgraphDebug();
@@ -53,6 +83,8 @@ class DepsgraphDebug {
    * This is NOT an indication that depsgraph is at its evaluated state. */
   bool is_ever_evaluated;
 
+  DepsgraphBuildStats build_stats;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
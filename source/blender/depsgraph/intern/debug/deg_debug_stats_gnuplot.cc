@@ -29,6 +29,7 @@
 #include "BLI_compiler_attrs.h"
 #include "BLI_math_base.h"
 
+#include "intern/debug/deg_debug.h"
 #include "intern/depsgraph.h"
 #include "intern/node/deg_node_id.h"
 
@@ -126,16 +127,9 @@ void write_stats_data(const DebugContext &ctx)
   deg_debug_fprintf(ctx, "EOD" NL);
 }
 
-void deg_debug_stats_gnuplot(const DebugContext &ctx)
+void write_bar_plot_commands(const DebugContext &ctx)
 {
-  /* Data itself. */
-  write_stats_data(ctx);
-  /* Optional label. */
-  if (ctx.label && ctx.label[0]) {
-    deg_debug_fprintf(ctx, "set title \"%s\"" NL, ctx.label);
-  }
-  /* Rest of the commands.
-   * TODO(sergey): Need to decide on the resolution somehow. */
+  /* TODO(sergey): Need to decide on the resolution somehow. */
   deg_debug_fprintf(ctx, "set terminal pngcairo size 1920,1080" NL);
   deg_debug_fprintf(ctx, "set output \"%s\"" NL, ctx.output_filename);
   deg_debug_fprintf(ctx, "set grid" NL);
@@ -147,6 +141,55 @@ void deg_debug_stats_gnuplot(const DebugContext &ctx)
                     "with boxxyerrorbars t '' lt rgb \"#406090\"" NL);
 }
 
+void deg_debug_stats_gnuplot(const DebugContext &ctx)
+{
+  /* Data itself. */
+  write_stats_data(ctx);
+  /* Optional label. */
+  if (ctx.label && ctx.label[0]) {
+    deg_debug_fprintf(ctx, "set title \"%s\"" NL, ctx.label);
+  }
+  /* Rest of the commands. */
+  write_bar_plot_commands(ctx);
+}
+
+void write_build_stats_data(const DebugContext &ctx)
+{
+  const DepsgraphBuildStats &stats = ctx.graph->debug.build_stats;
+  /* Same order as the pipeline, from the bottom. */
+  deg_debug_fprintf(ctx, "$data << EOD" NL);
+  deg_debug_fprintf(ctx, "\"Finalize\",%f" NL, stats.time_finalize);
+  deg_debug_fprintf(ctx, "\"Relations\",%f" NL, stats.time_relations);
+  deg_debug_fprintf(ctx, "\"Nodes\",%f" NL, stats.time_nodes);
+  deg_debug_fprintf(ctx, "EOD" NL);
+}
+
+void deg_debug_build_stats_gnuplot(const DebugContext &ctx)
+{
+  const DepsgraphBuildStats &stats = ctx.graph->debug.build_stats;
+  write_build_stats_data(ctx);
+  /* Counters go to the title, they don't share units with the timing. */
+  deg_debug_fprintf(ctx, "set title \"");
+  if (ctx.label && ctx.label[0]) {
+    deg_debug_fprintf(ctx, "%s\\n", ctx.label);
+  }
+  deg_debug_fprintf(ctx,
+                    "%s build in %f seconds: %d IDs, %d operations, %d relations\\n",
+                    stats.is_incremental ? "Incremental" : "Full",
+                    stats.time_total,
+                    stats.num_id_nodes,
+                    stats.num_operations,
+                    stats.num_relations);
+  deg_debug_fprintf(ctx,
+                    "RNA paths resolved: %d, RNA node queries: %d, "
+                    "animated IDs collected: %d, cached: %d\"" NL,
+                    stats.num_rna_path_resolves,
+                    stats.num_rna_node_queries,
+                    stats.num_animated_ids_initialized,
+                    stats.num_animated_ids_cached);
+  write_bar_plot_commands(ctx);
+}
+
 }  // namespace
 }  // namespace blender::deg
 
@@ -165,3 +208,19 @@ void DEG_debug_stats_gnuplot(const Depsgraph *depsgraph,
   ctx.output_filename = output_filename;
   deg::deg_debug_stats_gnuplot(ctx);
 }
+
+void DEG_debug_build_stats_gnuplot(const Depsgraph *depsgraph,
+                                   FILE *fp,
+                                   const char *label,
+                                   const char *output_filename)
+{
+  if (depsgraph == nullptr) {
+    return;
+  }
+  deg::DebugContext ctx;
+  ctx.file = fp;
+  ctx.graph = (deg::Depsgraph *)depsgraph;
+  ctx.label = label;
+  ctx.output_filename = output_filename;
+  deg::deg_debug_build_stats_gnuplot(ctx);
+}
@@ -50,6 +50,17 @@ template<int MaxSamples> class AveragedTimeSampler {
     }
   }
 
+  void reset()
+  {
+    num_samples_ = 0;
+    next_sample_index_ = 0;
+  }
+
+  bool is_empty() const
+  {
+    return num_samples_ == 0;
+  }
+
   double get_averaged() const
   {
     double sum = 0.0;
@@ -41,6 +41,7 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_debug.h"
 
+#include "intern/builder/deg_builder_cache.h"
 #include "intern/depsgraph_physics.h"
 #include "intern/depsgraph_registry.h"
 #include "intern/depsgraph_relation.h"
@@ -70,7 +71,9 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       scene_cow(nullptr),
       is_active(false),
       is_evaluating(false),
-      is_render_pipeline_depsgraph(false)
+      scheduling_mode(DEG_SCHEDULING_DISCOVERY_ORDER),
+      is_render_pipeline_depsgraph(false),
+      builder_cache(new DepsgraphBuilderCache())
 {
   BLI_spin_init(&lock);
   memset(id_type_updated, 0, sizeof(id_type_updated));
@@ -84,6 +87,7 @@ Depsgraph::~Depsgraph()
 {
   clear_id_nodes();
   delete time_source;
+  delete builder_cache;
   BLI_spin_end(&lock);
 }
 
@@ -170,6 +174,50 @@ void Depsgraph::clear_id_nodes()
   clear_physics_relations(this);
 }
 
+void Depsgraph::remove_id_nodes(Span<IDNode *> id_nodes_to_remove)
+{
+  Set<const IDNode *> removed_id_nodes;
+  for (IDNode *id_node : id_nodes_to_remove) {
+    removed_id_nodes.add(id_node);
+    /* Relations are only freed from one side when nodes are deleted, so unlink all of them from
+     * the nodes which are kept. */
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        while (!op_node->inlinks.is_empty()) {
+          Relation *rel = op_node->inlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+        while (!op_node->outlinks.is_empty()) {
+          Relation *rel = op_node->outlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+        entry_tags.remove(op_node);
+      }
+    }
+    id_hash.remove(id_node->id_orig);
+  }
+  /* Keep order of the remaining nodes. */
+  int64_t num_operations = 0;
+  for (OperationNode *op_node : operations) {
+    if (!removed_id_nodes.contains(op_node->owner->owner)) {
+      operations[num_operations++] = op_node;
+    }
+  }
+  operations.resize(num_operations);
+  int64_t num_id_nodes = 0;
+  for (IDNode *id_node : id_nodes) {
+    if (!removed_id_nodes.contains(id_node)) {
+      id_nodes[num_id_nodes++] = id_node;
+    }
+  }
+  id_nodes.resize(num_id_nodes);
+  for (IDNode *id_node : id_nodes_to_remove) {
+    delete id_node;
+  }
+}
+
 /* Add new relation between two nodes */
 Relation *Depsgraph::add_new_relation(Node *from, Node *to, const char *description, int flags)
 {
@@ -201,6 +249,21 @@ Relation *Depsgraph::check_nodes_connected(const Node *from,
                                            const Node *to,
                                            const char *description)
 {
+  /* Look into the shorter list of relations, nodes like copy-on-write operations have relations
+   * to all operations of the ID. */
+  if (to->inlinks.size() < from->outlinks.size()) {
+    for (Relation *rel : to->inlinks) {
+      BLI_assert(rel->to == to);
+      if (rel->from != from) {
+        continue;
+      }
+      if (description != nullptr && !STREQ(rel->name, description)) {
+        continue;
+      }
+      return rel;
+    }
+    return nullptr;
+  }
   for (Relation *rel : from->outlinks) {
     BLI_assert(rel->from == from);
     if (rel->to != to) {
@@ -52,6 +52,7 @@ struct ViewLayer;
 namespace blender {
 namespace deg {
 
+class DepsgraphBuilderCache;
 struct IDNode;
 struct Node;
 struct OperationNode;
@@ -73,6 +74,9 @@ struct Depsgraph {
   IDNode *find_id_node(const ID *id) const;
   IDNode *add_id_node(ID *id, ID *id_cow_hint = nullptr);
   void clear_id_nodes();
+  /* Remove given ID nodes together with all relations of their operations.
+   * Copy-on-write datablock is only freed if the builder did not take ownership of it. */
+  void remove_id_nodes(Span<IDNode *> id_nodes_to_remove);
 
   /* Add new relationship between two nodes. */
   Relation *add_new_relation(Node *from, Node *to, const char *description, int flags = 0);
@@ -110,6 +114,10 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Original IDs whose relations were tagged for update with DEG_graph_id_tag_relations_update().
+   * Empty when relations of the whole graph are to be updated. */
+  Set<ID *> relations_update_ids;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -157,6 +165,9 @@ struct Depsgraph {
 
   bool is_evaluating;
 
+  /* Order in which ready operations are dispatched during threaded evaluation. */
+  eDepsgraphSchedulingMode scheduling_mode;
+
   /* Is set to truth for dependency graph which are used for post-processing (compositor and
    * sequencer).
    * Such dependency graph needs all view layers (so render pipeline can access names), but it
@@ -167,6 +178,10 @@ struct Depsgraph {
    * created along with relations, for fast lookup during evaluation. */
   Map<const ID *, ListBase *> *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
 
+  /* Data collected by relations builders which stays valid for the following incremental
+   * relations updates, such as the properties animated by F-Curves of IDs. */
+  DepsgraphBuilderCache *builder_cache;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("Depsgraph");
 };
 
@@ -73,6 +73,12 @@ void DEG_evaluate_on_refresh(Depsgraph *graph)
   deg_flush_updates_and_refresh(deg_graph);
 }
 
+void DEG_evaluate_scheduling_mode_set(Depsgraph *graph, eDepsgraphSchedulingMode mode)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  deg_graph->scheduling_mode = mode;
+}
+
 /* Frame-change happened for root scene that graph belongs to. */
 void DEG_evaluate_on_framechange(Depsgraph *graph, float ctime)
 {
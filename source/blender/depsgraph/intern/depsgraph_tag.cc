@@ -56,6 +56,7 @@
 #include "DEG_depsgraph_query.h"
 
 #include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_cache.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_registry.h"
 #include "intern/depsgraph_update.h"
@@ -619,6 +620,28 @@ void id_tag_update(Main *bmain, ID *id, int flag, eUpdateSource update_source)
   id->recalc_after_undo_push |= deg_recalc_flags_effective(nullptr, flag);
 }
 
+/* Forget properties known to be animated in the ID, unless the update can not change F-Curves of
+ * the ID nor the layout of its data. */
+static void graph_id_tag_invalidate_builder_cache(Depsgraph *graph,
+                                                  ID *id,
+                                                  int flag,
+                                                  eUpdateSource update_source)
+{
+  /* Tags issued by the graph itself after it is built only schedule evaluation of the IDs. */
+  if (update_source & (DEG_UPDATE_SOURCE_RELATIONS | DEG_UPDATE_SOURCE_VISIBILITY)) {
+    return;
+  }
+  const int keep_cache_flags = ID_RECALC_TRANSFORM | ID_RECALC_SHADING | ID_RECALC_SELECT |
+                               ID_RECALC_BASE_FLAGS | ID_RECALC_POINT_CACHE |
+                               ID_RECALC_EDITORS | ID_RECALC_AUDIO_SEEK | ID_RECALC_AUDIO_FPS |
+                               ID_RECALC_AUDIO_VOLUME | ID_RECALC_AUDIO_MUTE |
+                               ID_RECALC_AUDIO_LISTENER | ID_RECALC_AUDIO;
+  if (flag != 0 && (flag & ~keep_cache_flags) == 0) {
+    return;
+  }
+  graph->builder_cache->invalidateAnimatedPropertyStorage(id);
+}
+
 void graph_id_tag_update(
     Main *bmain, Depsgraph *graph, ID *id, int flag, eUpdateSource update_source)
 {
@@ -639,6 +662,7 @@ void graph_id_tag_update(
   IDNode *id_node = (graph != nullptr) ? graph->find_id_node(id) : nullptr;
   if (graph != nullptr) {
     DEG_graph_id_type_tag(reinterpret_cast<::Depsgraph *>(graph), GS(id->name));
+    graph_id_tag_invalidate_builder_cache(graph, id, flag, update_source);
   }
   if (flag == 0) {
     deg_graph_node_tag_zero(bmain, graph, id_node, update_source);
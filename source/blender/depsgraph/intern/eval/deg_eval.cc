@@ -29,7 +29,10 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
+#include "BLI_math_base.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -61,6 +64,7 @@ namespace {
 struct DepsgraphEvalState;
 
 void deg_task_run_func(TaskPool *pool, void *taskdata);
+void deg_task_run_ready_func(TaskPool *pool, void *taskdata);
 
 template<typename ScheduleFunction, typename... ScheduleFunctionArgs>
 void schedule_children(DepsgraphEvalState *state,
@@ -73,6 +77,8 @@ void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), Tas
   BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
 }
 
+void schedule_node_to_ready_heap(OperationNode *node, const int thread_id, TaskPool *pool);
+
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -95,6 +101,12 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Dispatch operations with the longest remaining chain of work first. */
+  bool use_critical_path;
+  /* Operations which are ready for evaluation, ordered by their critical path time.
+   * Used by the threaded stage when scheduling by the critical path. */
+  Heap *ready_heap;
+  SpinLock ready_heap_lock;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -104,7 +116,7 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
+  if (state->do_stats || state->use_critical_path) {
     const double start_time = PIL_check_seconds_timer();
     operation_node->evaluate(depsgraph);
     operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
@@ -127,6 +139,35 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   schedule_children(state, operation_node, schedule_node_to_pool, pool);
 }
 
+/* Every task evaluates the most important operation which is ready at the time the task is
+ * executed, rather than the operation which caused the task to be pushed. */
+void deg_task_run_ready_func(TaskPool *pool, void *UNUSED(taskdata))
+{
+  void *userdata_v = BLI_task_pool_user_data(pool);
+  DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
+
+  BLI_spin_lock(&state->ready_heap_lock);
+  OperationNode *operation_node = (OperationNode *)BLI_heap_pop_min(state->ready_heap);
+  BLI_spin_unlock(&state->ready_heap_lock);
+
+  evaluate_node(state, operation_node);
+  schedule_children(state, operation_node, schedule_node_to_ready_heap, pool);
+}
+
+void schedule_node_to_ready_heap(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  void *userdata_v = BLI_task_pool_user_data(pool);
+  DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
+
+  /* Heap is a min-heap, negate the time so the longest chain is popped first. */
+  BLI_spin_lock(&state->ready_heap_lock);
+  BLI_heap_insert(state->ready_heap, -(float)node->critical_path_time, node);
+  BLI_spin_unlock(&state->ready_heap_lock);
+
+  /* One task per ready operation, so the amount of pending work matches the heap size. */
+  BLI_task_pool_push(pool, deg_task_run_ready_func, nullptr, false, nullptr);
+}
+
 bool check_operation_node_visible(OperationNode *op_node)
 {
   const ComponentNode *comp_node = op_node->owner;
@@ -177,16 +218,71 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+/* Cost of an operation which was never timed. Is not zero, so that until timing is known the
+ * critical path is the chain with the most operations. */
+const double UNKNOWN_OPERATION_TIME = 1e-6;
+
+double estimate_operation_time(OperationNode *node)
+{
+  if (node->is_noop() || !check_operation_node_visible(node) ||
+      (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+    return 0.0;
+  }
+  if (node->stats.time_samples.is_empty()) {
+    return UNKNOWN_OPERATION_TIME;
+  }
+  return node->stats.time_samples.get_averaged();
+}
+
+/* Calculate time of the longest chain of operations starting at every operation, by walking
+ * relations backwards from operations without children. Cyclic relations are ignored, same as
+ * when counting pending parents. */
+void calculate_critical_path(Depsgraph *graph)
+{
+  Vector<OperationNode *> ready_nodes;
+  ready_nodes.reserve(graph->operations.size());
+  /* Use custom flags to count children which did not yet propagate their time. */
+  for (OperationNode *node : graph->operations) {
+    node->critical_path_time = 0.0;
+    node->custom_flags = 0;
+    for (Relation *rel : node->outlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        ++node->custom_flags;
+      }
+    }
+    if (node->custom_flags == 0) {
+      ready_nodes.append(node);
+    }
+  }
+  while (!ready_nodes.is_empty()) {
+    OperationNode *node = ready_nodes.pop_last();
+    node->critical_path_time += estimate_operation_time(node);
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      parent->critical_path_time = max_dd(parent->critical_path_time, node->critical_path_time);
+      if (--parent->custom_flags == 0) {
+        ready_nodes.append(parent);
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
-  const bool do_stats = state->do_stats;
+  const bool do_timing = state->do_stats || state->use_critical_path;
   calculate_pending_parents(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
-    if (do_stats) {
+    if (do_timing) {
       node->stats.reset_current();
     }
   }
+  if (state->use_critical_path) {
+    calculate_critical_path(graph);
+  }
 }
 
 bool is_metaball_object_operation(const OperationNode *operation_node)
@@ -379,6 +475,9 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.use_critical_path = (graph->scheduling_mode == DEG_SCHEDULING_CRITICAL_PATH);
+  state.ready_heap = nullptr;
+  BLI_spin_init(&state.ready_heap_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -393,9 +492,19 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
   task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
+  if (state.use_critical_path) {
+    state.ready_heap = BLI_heap_new_ex(graph->operations.size());
+    schedule_graph(&state, schedule_node_to_ready_heap, task_pool);
+  }
+  else {
+    schedule_graph(&state, schedule_node_to_pool, task_pool);
+  }
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
+  if (state.ready_heap != nullptr) {
+    BLI_assert(BLI_heap_is_empty(state.ready_heap));
+    BLI_heap_free(state.ready_heap, nullptr);
+  }
 
   if (state.need_single_thread_pass) {
     state.stage = EvaluationStage::SINGLE_THREADED_WORKAROUND;
@@ -405,9 +514,13 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
+  if (state.do_stats || state.use_critical_path) {
+    deg_eval_stats_add_time_samples(graph);
+  }
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  BLI_spin_end(&state.ready_heap_lock);
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
@@ -283,8 +283,8 @@ struct ValidateData {
 };
 
 /* Similar to generic BKE_id_copy() but does not require main and assumes pointer
- * is already allocated. */
-bool id_copy_inplace_no_main(const ID *id, ID *newid)
+ * is already allocated. Extra flags are passed to the copy on top of the localize ones. */
+bool id_copy_inplace_no_main(const ID *id, ID *newid, const int extra_flag = 0)
 {
   const ID *id_for_copy = id;
 
@@ -304,7 +304,8 @@ bool id_copy_inplace_no_main(const ID *id, ID *newid)
   bool result = (BKE_id_copy_ex(nullptr,
                                 (ID *)id_for_copy,
                                 &newid,
-                                LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE) != nullptr);
+                                LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE |
+                                    extra_flag) != nullptr);
 
 #ifdef NESTED_ID_NASTY_WORKAROUND
   if (result) {
@@ -863,8 +864,6 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
   }
   // BLI_assert(check_datablock_expanded(id_cow) == false);
   /* Copy data from original ID to a copied version. */
-  /* TODO(sergey): Avoid doing full ID copy somehow, make Mesh to reference
-   * original geometry arrays for until those are modified. */
   /* TODO(sergey): We do some trickery with temp bmain and extra ID pointer
    * just to be able to use existing API. Ideally we need to replace this with
    * in-place copy from existing datablock to a prepared memory.
@@ -888,10 +887,33 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
       break;
     }
     case ID_ME: {
-      /* TODO(sergey): Ideally we want to handle meshes in a special
-       * manner here to avoid initial copy of all the geometry arrays. */
+      /* Share geometry arrays with the original mesh, they are only copied once either side
+       * modifies them. Render depsgraphs keep a full copy, since the original can be edited
+       * while a render is running in another thread.
+       *
+       * Code modifying the original arrays in place has to unshare them first: transform, sculpt
+       * and paint modes, vertex group tools and the mesh data accessors of the Python API do. */
+      if (depsgraph->mode == DAG_EVAL_VIEWPORT) {
+        done = id_copy_inplace_no_main(id_orig, id_cow, LIB_ID_COPY_CD_SHARE);
+      }
+      break;
+    }
+    case ID_KE: {
+      /* Corrective shape keys only store the elements they move, which is all blending needs.
+       * The data of other key blocks is shared like mesh arrays. */
+      int flag = LIB_ID_COPY_KEY_SPARSE;
+      if (depsgraph->mode == DAG_EVAL_VIEWPORT) {
+        flag |= LIB_ID_COPY_CD_SHARE;
+      }
+      done = id_copy_inplace_no_main(id_orig, id_cow, flag);
       break;
     }
+    case ID_CU:
+      /* Share the points of nurbs, evaluation only deforms copies of them. */
+      if (depsgraph->mode == DAG_EVAL_VIEWPORT) {
+        done = id_copy_inplace_no_main(id_orig, id_cow, LIB_ID_COPY_CD_SHARE);
+      }
+      break;
     default:
       break;
   }
@@ -54,4 +54,15 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_add_time_samples(Depsgraph *graph)
+{
+  for (OperationNode *op_node : graph->operations) {
+    /* Operations which were not evaluated keep their samples from previous evaluations. */
+    if (!op_node->scheduled || op_node->is_noop()) {
+      continue;
+    }
+    op_node->stats.time_samples.add_sample(op_node->stats.current_time);
+  }
+}
+
 }  // namespace blender::deg
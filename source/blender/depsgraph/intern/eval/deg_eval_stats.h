@@ -31,5 +31,8 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Add timing of the current evaluation to the time samples of the evaluated operations. */
+void deg_eval_stats_add_time_samples(Depsgraph *graph);
+
 }  // namespace deg
 }  // namespace blender
@@ -0,0 +1,155 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include <cstring>
+
+#include "BLI_string.h"
+#include "BLI_vector.hh"
+
+#include "BKE_constraint.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+namespace blender::deg::tests {
+
+/* Chains of parented objects, with constraints between the chains. */
+class DepsgraphEvalTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  Vector<Object *> objects;
+  Vector<Object *> chain_roots;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = BKE_view_layer_default_view(scene);
+  }
+
+  void TearDown() override
+  {
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_main_free(bmain);
+  }
+
+  void objects_create(const int chains_num, const int chain_len)
+  {
+    Object *ob_prev_chain_tip = nullptr;
+    for (int chain = 0; chain < chains_num; chain++) {
+      Object *ob_parent = nullptr;
+      /* Longer chains towards the end, so their evaluation order differs between the modes. */
+      const int len = chain_len * (chain + 1);
+      for (int i = 0; i < len; i++) {
+        char name[MAX_ID_NAME - 2];
+        BLI_snprintf(name, sizeof(name), "Chain%d.%d", chain, i);
+        Object *ob = BKE_object_add(bmain, view_layer, OB_EMPTY, name);
+        ob->loc[0] = 0.1f * (i + 1);
+        ob->rot[2] = 0.05f * (chain + 1);
+        ob->parent = ob_parent;
+        if (ob_parent == nullptr) {
+          chain_roots.append(ob);
+          if (ob_prev_chain_tip != nullptr) {
+            bConstraint *con = BKE_constraint_add_for_object(
+                ob, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+            ((bLocateLikeConstraint *)con->data)->tar = ob_prev_chain_tip;
+          }
+        }
+        objects.append(ob);
+        ob_parent = ob;
+      }
+      ob_prev_chain_tip = ob_parent;
+    }
+  }
+
+  Depsgraph *depsgraph_build(const eDepsgraphSchedulingMode scheduling_mode)
+  {
+    Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_evaluate_scheduling_mode_set(graph, scheduling_mode);
+    DEG_graph_build_from_view_layer(graph);
+    return graph;
+  }
+
+  void expect_evaluated_objects_match(Depsgraph *graph_a, Depsgraph *graph_b)
+  {
+    for (Object *ob : objects) {
+      const Object *ob_a = DEG_get_evaluated_object(graph_a, ob);
+      const Object *ob_b = DEG_get_evaluated_object(graph_b, ob);
+      ASSERT_NE(ob_a, ob);
+      ASSERT_NE(ob_b, ob);
+      EXPECT_EQ(memcmp(ob_a->obmat, ob_b->obmat, sizeof(ob_a->obmat)), 0) << ob->id.name;
+    }
+  }
+};
+
+TEST_F(DepsgraphEvalTest, CriticalPathMatchesDiscoveryOrder)
+{
+  objects_create(4, 8);
+  Depsgraph *graph_discovery = depsgraph_build(DEG_SCHEDULING_DISCOVERY_ORDER);
+  Depsgraph *graph_critical = depsgraph_build(DEG_SCHEDULING_CRITICAL_PATH);
+
+  /* First evaluation has no timing of operations yet. */
+  DEG_evaluate_on_refresh(graph_discovery);
+  DEG_evaluate_on_refresh(graph_critical);
+  expect_evaluated_objects_match(graph_discovery, graph_critical);
+  float tip_mat_first[4][4];
+  memcpy(tip_mat_first,
+         DEG_get_evaluated_object(graph_critical, objects.last())->obmat,
+         sizeof(tip_mat_first));
+
+  /* Later evaluations are scheduled using the timing of the previous ones. */
+  for (int update = 0; update < 3; update++) {
+    for (Object *ob : chain_roots) {
+      ob->rot[0] += 0.3f;
+      DEG_graph_id_tag_update(bmain, graph_discovery, &ob->id, ID_RECALC_TRANSFORM);
+      DEG_graph_id_tag_update(bmain, graph_critical, &ob->id, ID_RECALC_TRANSFORM);
+    }
+    DEG_evaluate_on_refresh(graph_discovery);
+    DEG_evaluate_on_refresh(graph_critical);
+    expect_evaluated_objects_match(graph_discovery, graph_critical);
+  }
+
+  /* The updates were evaluated, the tip of the last chain depends on all chain roots. */
+  EXPECT_NE(memcmp(tip_mat_first,
+                   DEG_get_evaluated_object(graph_critical, objects.last())->obmat,
+                   sizeof(tip_mat_first)),
+            0);
+
+  DEG_graph_free(graph_discovery);
+  DEG_graph_free(graph_critical);
+}
+
+}  // namespace blender::deg::tests
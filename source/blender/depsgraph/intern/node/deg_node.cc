@@ -278,6 +278,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  time_samples.reset();
 }
 
 void Node::Stats::reset_current()
@@ -25,6 +25,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "intern/debug/deg_time_average.h"
 #include "intern/depsgraph_type.h"
 
 #include "BLI_utildefines.h"
@@ -163,6 +164,9 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Time spend on this node during last graph evaluations it was evaluated in, used to
+     * estimate cost of the node when prioritizing evaluation. */
+    AveragedTimeSampler<4> time_samples;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -266,6 +266,10 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time needed to evaluate the longest chain of operations starting with this one.
+   * Only calculated when the graph is evaluated with critical path scheduling. */
+  double critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
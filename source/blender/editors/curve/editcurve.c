@@ -478,7 +478,7 @@ static void switch_keys_direction(Curve *cu, Nurb *actnu)
   int a;
 
   LISTBASE_FOREACH (KeyBlock *, currkey, &cu->key->block) {
-    fp = currkey->data;
+    fp = BKE_keyblock_data_ensure_unshared(cu->key, currkey);
 
     LISTBASE_FOREACH (Nurb *, nu, nubase) {
       if (nu->bezt) {
@@ -875,9 +875,7 @@ static void calc_shapeKeys(Object *obedit, ListBase *newnurbs)
     }
 
     currkey->totelem = totvert;
-    if (currkey->data) {
-      MEM_freeN(currkey->data);
-    }
+    BKE_keyblock_data_free(currkey);
     currkey->data = newkey;
   }
 
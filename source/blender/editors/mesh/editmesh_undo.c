@@ -135,11 +135,17 @@ static struct {
 
 } um_arraystore = {{NULL}};
 
+/**
+ * \param add_params: When creating, the arrays to add to the array store are appended here
+ * (the layer data is then freed by the caller once added).
+ */
 static void um_arraystore_cd_compact(struct CustomData *cdata,
                                      const size_t data_len,
                                      bool create,
                                      const BArrayCustomData *bcd_reference,
-                                     BArrayCustomData **r_bcd_first)
+                                     BArrayCustomData **r_bcd_first,
+                                     BArrayStateAddParams *add_params,
+                                     uint *add_params_len)
 {
   if (data_len == 0) {
     if (create) {
@@ -208,12 +214,18 @@ static void um_arraystore_cd_compact(struct CustomData *cdata,
                                           i < bcd_reference_current->states_len) ?
                                              bcd_reference_current->states[i] :
                                              NULL;
-          bcd->states[i] = BLI_array_store_state_add(
-              bs, layer->data, (size_t)data_len * stride, state_reference);
+          add_params[(*add_params_len)++] = (BArrayStateAddParams){
+              .bs = bs,
+              .data = layer->data,
+              .data_len = (size_t)data_len * stride,
+              .state_reference = state_reference,
+              .r_state = &bcd->states[i],
+          };
         }
         else {
           bcd->states[i] = NULL;
         }
+        continue;
       }
 
       if (layer->data) {
@@ -287,14 +299,43 @@ static void um_arraystore_compact_ex(UndoMesh *um, const UndoMesh *um_ref, bool
 {
   Mesh *me = &um->me;
 
-  um_arraystore_cd_compact(
-      &me->vdata, me->totvert, create, um_ref ? um_ref->store.vdata : NULL, &um->store.vdata);
-  um_arraystore_cd_compact(
-      &me->edata, me->totedge, create, um_ref ? um_ref->store.edata : NULL, &um->store.edata);
-  um_arraystore_cd_compact(
-      &me->ldata, me->totloop, create, um_ref ? um_ref->store.ldata : NULL, &um->store.ldata);
-  um_arraystore_cd_compact(
-      &me->pdata, me->totpoly, create, um_ref ? um_ref->store.pdata : NULL, &um->store.pdata);
+  /* All arrays are added at once, so layers using different stores are added in parallel. */
+  BArrayStateAddParams *add_params = NULL;
+  uint add_params_len = 0;
+  if (create) {
+    const int add_params_len_max = me->vdata.totlayer + me->edata.totlayer + me->ldata.totlayer +
+                                   me->pdata.totlayer + (me->key ? me->key->totkey : 0) + 1;
+    add_params = MEM_malloc_arrayN(add_params_len_max, sizeof(*add_params), __func__);
+  }
+
+  um_arraystore_cd_compact(&me->vdata,
+                           me->totvert,
+                           create,
+                           um_ref ? um_ref->store.vdata : NULL,
+                           &um->store.vdata,
+                           add_params,
+                           &add_params_len);
+  um_arraystore_cd_compact(&me->edata,
+                           me->totedge,
+                           create,
+                           um_ref ? um_ref->store.edata : NULL,
+                           &um->store.edata,
+                           add_params,
+                           &add_params_len);
+  um_arraystore_cd_compact(&me->ldata,
+                           me->totloop,
+                           create,
+                           um_ref ? um_ref->store.ldata : NULL,
+                           &um->store.ldata,
+                           add_params,
+                           &add_params_len);
+  um_arraystore_cd_compact(&me->pdata,
+                           me->totpoly,
+                           create,
+                           um_ref ? um_ref->store.pdata : NULL,
+                           &um->store.pdata,
+                           add_params,
+                           &add_params_len);
 
   if (me->key && me->key->totkey) {
     const size_t stride = me->key->elemsize;
@@ -310,11 +351,15 @@ static void um_arraystore_compact_ex(UndoMesh *um, const UndoMesh *um_ref, bool
         BArrayState *state_reference = (um_ref && um_ref->me.key && (i < um_ref->me.key->totkey)) ?
                                            um_ref->store.keyblocks[i] :
                                            NULL;
-        um->store.keyblocks[i] = BLI_array_store_state_add(
-            bs, keyblock->data, (size_t)keyblock->totelem * stride, state_reference);
+        add_params[add_params_len++] = (BArrayStateAddParams){
+            .bs = bs,
+            .data = keyblock->data,
+            .data_len = (size_t)keyblock->totelem * stride,
+            .state_reference = state_reference,
+            .r_state = &um->store.keyblocks[i],
+        };
       }
-
-      if (keyblock->data) {
+      else if (keyblock->data) {
         MEM_freeN(keyblock->data);
         keyblock->data = NULL;
       }
@@ -328,17 +373,29 @@ static void um_arraystore_compact_ex(UndoMesh *um, const UndoMesh *um_ref, bool
       const size_t stride = sizeof(*me->mselect);
       BArrayStore *bs = BLI_array_store_at_size_ensure(
           &um_arraystore.bs_stride, stride, ARRAY_CHUNK_SIZE);
-      um->store.mselect = BLI_array_store_state_add(
-          bs, me->mselect, (size_t)me->totselect * stride, state_reference);
+      add_params[add_params_len++] = (BArrayStateAddParams){
+          .bs = bs,
+          .data = me->mselect,
+          .data_len = (size_t)me->totselect * stride,
+          .state_reference = state_reference,
+          .r_state = &um->store.mselect,
+      };
+    }
+    else {
+      /* keep me->totselect for validation */
+      MEM_freeN(me->mselect);
+      me->mselect = NULL;
     }
-
-    /* keep me->totselect for validation */
-    MEM_freeN(me->mselect);
-    me->mselect = NULL;
   }
 
   if (create) {
+    BLI_array_store_state_add_many(add_params, add_params_len);
+    MEM_freeN(add_params);
     um_arraystore.users += 1;
+
+    /* Now the arrays are stored, free them. */
+    um_arraystore_compact_ex(um, um_ref, false);
+    return;
   }
 
   BKE_mesh_update_customdata_pointers(me, false);
@@ -626,7 +683,7 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
 
       if (kb_act->totelem != um->me.totvert) {
         /* The current mesh has some extra/missing verts compared to the undo, adjust. */
-        MEM_SAFE_FREE(kb_act->data);
+        BKE_keyblock_data_free(kb_act);
         kb_act->data = MEM_mallocN((size_t)(key->elemsize) * bm->totvert, __func__);
         kb_act->totelem = um->me.totvert;
       }
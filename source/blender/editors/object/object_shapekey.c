@@ -125,6 +125,8 @@ static bool object_shape_key_mirror(
   if (kb) {
     char *tag_elem = MEM_callocN(sizeof(char) * kb->totelem, "shape_key_mirror");
 
+    BKE_keyblock_data_ensure_unshared(key, kb);
+
     if (ob->type == OB_MESH) {
       Mesh *me = ob->data;
       MVert *mv;
@@ -207,6 +207,8 @@ bool ED_vgroup_parray_alloc(ID *id,
 
           return true;
         }
+        /* The weights are edited in place, stop sharing them with evaluated meshes. */
+        BKE_mesh_layer_for_write(me, &me->vdata, CD_MDEFORMVERT);
         if (me->dvert) {
           MVert *mvert = me->mvert;
           MDeformVert *dvert = me->dvert;
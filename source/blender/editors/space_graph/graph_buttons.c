@@ -628,7 +628,7 @@ static void do_graph_region_driver_buttons(bContext *C, void *id_v, int event)
       AnimData *adt = BKE_animdata_from_id(id);
 
       /* rebuild depsgraph for the new deps, and ensure COW copies get flushed. */
-      DEG_relations_tag_update(bmain);
+      DEG_id_tag_relations_update(bmain, id);
       DEG_id_tag_update_ex(bmain, id, ID_RECALC_COPY_ON_WRITE);
       if (adt != NULL) {
         if (adt->action != NULL) {
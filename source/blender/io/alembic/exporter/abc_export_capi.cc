@@ -49,6 +49,7 @@ static CLG_LogRef LOG = {"io.alembic"};
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 struct ExportJobData {
   Main *bmain;
@@ -75,6 +76,43 @@ static void build_depsgraph(Depsgraph *depsgraph, const bool visible_objects_onl
   }
 }
 
+/* State shared by the frames of an animation export. */
+struct ExportFramesData {
+  ExportJobData *job_data;
+  ABCArchive *abc_archive;
+  ABCHierarchyIterator *iter;
+  short *stop;
+  short *do_update;
+  float *progress;
+  float progress_per_frame;
+};
+
+static void export_frames_build_depsgraph(Depsgraph *depsgraph, void *user_data)
+{
+  const ExportFramesData *frames_data = static_cast<ExportFramesData *>(user_data);
+  build_depsgraph(depsgraph, frames_data->job_data->params.visible_objects_only);
+}
+
+/* Write a frame that was evaluated in the given depsgraph. Returns false when the export was
+ * cancelled. */
+static bool export_frame(Depsgraph *depsgraph, double frame, void *user_data)
+{
+  ExportFramesData *frames_data = static_cast<ExportFramesData *>(user_data);
+  if (G.is_break || (frames_data->stop != nullptr && *frames_data->stop)) {
+    return false;
+  }
+
+  CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
+  ExportSubset export_subset = frames_data->abc_archive->export_subset_for_frame(frame);
+  frames_data->iter->set_depsgraph(depsgraph);
+  frames_data->iter->set_export_subset(export_subset);
+  frames_data->iter->iterate_and_write();
+
+  *frames_data->progress += frames_data->progress_per_frame;
+  *frames_data->do_update = true;
+  return true;
+}
+
 static void export_startjob(void *customdata,
                             /* Cannot be const, this function implements wm_jobs_start_callback.
                              * NOLINTNEXTLINE: readability-non-const-parameter. */
@@ -136,30 +174,44 @@ static void export_startjob(void *customdata,
   if (export_animation) {
     CLOG_INFO(&LOG, 2, "Exporting animation");
 
+    ExportFramesData frames_data;
+    frames_data.job_data = data;
+    frames_data.abc_archive = abc_archive.get();
+    frames_data.iter = &iter;
+    frames_data.stop = stop;
+    frames_data.do_update = do_update;
+    frames_data.progress = progress;
     /* Writing the animated frames is not 100% of the work, but it's our best guess. */
-    const float progress_per_frame = 1.0f / std::max(size_t(1), abc_archive->total_frame_count());
-    ABCArchive::Frames::const_iterator frame_it = abc_archive->frames_begin();
-    const ABCArchive::Frames::const_iterator frames_end = abc_archive->frames_end();
-
-    for (; frame_it != frames_end; frame_it++) {
-      double frame = *frame_it;
-
-      if (G.is_break || (stop != nullptr && *stop)) {
-        break;
+    frames_data.progress_per_frame = 1.0f /
+                                     std::max(size_t(1), abc_archive->total_frame_count());
+
+    const std::vector<double> frames(abc_archive->frames_begin(), abc_archive->frames_end());
+    const int graphs_num = BKE_scene_graph_evaluate_frames_num_graphs(int(frames.size()));
+
+    if (graphs_num > 1 && BKE_scene_graph_frames_are_independent(data->depsgraph)) {
+      /* Evaluate several frames at once, the frames are still written one after the other. */
+      BKE_scene_graph_evaluate_frames(data->depsgraph,
+                                      frames.data(),
+                                      int(frames.size()),
+                                      graphs_num,
+                                      export_frames_build_depsgraph,
+                                      export_frame,
+                                      &frames_data);
+      iter.set_depsgraph(data->depsgraph);
+    }
+    else {
+      for (double frame : frames) {
+        if (G.is_break || (stop != nullptr && *stop)) {
+          break;
+        }
+
+        /* Update the scene for the next frame to render. */
+        scene->r.cfra = static_cast<int>(frame);
+        scene->r.subframe = frame - scene->r.cfra;
+        BKE_scene_graph_update_for_newframe(data->depsgraph);
+
+        export_frame(data->depsgraph, frame, &frames_data);
       }
-
-      /* Update the scene for the next frame to render. */
-      scene->r.cfra = static_cast<int>(frame);
-      scene->r.subframe = frame - scene->r.cfra;
-      BKE_scene_graph_update_for_newframe(data->depsgraph);
-
-      CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
-      ExportSubset export_subset = abc_archive->export_subset_for_frame(frame);
-      iter.set_export_subset(export_subset);
-      iter.iterate_and_write();
-
-      *progress += progress_per_frame;
-      *do_update = true;
     }
   }
   else {
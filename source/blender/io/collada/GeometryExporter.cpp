@@ -134,6 +134,7 @@ void GeometryExporter::operator()(Object *ob)
       /* skip the basis */
       kb = kb->next;
       for (; kb; kb = kb->next) {
+        BKE_keyblock_data_ensure(key, kb);
         BKE_keyblock_convert_to_mesh(kb, me);
         export_key_mesh(ob, me, kb);
       }
@@ -61,6 +61,9 @@ class DupliParentFinder;
 struct HierarchyContext {
   /*********** Determined during hierarchy iteration: ***************/
   Object *object; /* Evaluated object. */
+  /* Depsgraph that evaluated the object for the current frame. Writers use this for anything that
+   * changes over time, see AbstractHierarchyIterator::set_depsgraph(). */
+  Depsgraph *depsgraph;
   Object *export_parent;
   Object *duplicator;
   PersistentID persistent_id;
@@ -250,6 +253,13 @@ class AbstractHierarchyIterator {
    * previous iteration. */
   void set_export_subset(ExportSubset export_subset_);
 
+  /* Iterate over a different depsgraph from now on, for exporting frames that were evaluated in
+   * their own depsgraph (see BKE_scene_graph_evaluate_frames()). The depsgraph must be built for
+   * the same scene and view layer. Every HierarchyContext points at the depsgraph of its
+   * iteration, writers should only query the depsgraph they were created with for data that
+   * doesn't change over time. */
+  void set_depsgraph(Depsgraph *depsgraph);
+
   /* Convert the given name to something that is valid for the exported file format.
    * This base implementation is a no-op; override in a concrete subclass. */
   virtual std::string make_valid_name(const std::string &name) const;
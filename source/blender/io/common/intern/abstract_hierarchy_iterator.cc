@@ -220,6 +220,11 @@ void AbstractHierarchyIterator::set_export_subset(ExportSubset export_subset)
   export_subset_ = export_subset;
 }
 
+void AbstractHierarchyIterator::set_depsgraph(Depsgraph *depsgraph)
+{
+  depsgraph_ = depsgraph;
+}
+
 std::string AbstractHierarchyIterator::make_valid_name(const std::string &name) const
 {
   return name;
@@ -421,6 +426,7 @@ void AbstractHierarchyIterator::visit_object(Object *object,
 {
   HierarchyContext *context = new HierarchyContext();
   context->object = object;
+  context->depsgraph = depsgraph_;
   context->export_name = get_object_name(object);
   context->export_parent = export_parent;
   context->duplicator = nullptr;
@@ -461,6 +467,7 @@ void AbstractHierarchyIterator::visit_dupli_object(DupliObject *dupli_object,
 {
   HierarchyContext *context = new HierarchyContext();
   context->object = dupli_object->ob;
+  context->depsgraph = depsgraph_;
   context->duplicator = duplicator;
   context->persistent_id = PersistentID(dupli_object);
   context->weak_export = false;
@@ -46,6 +46,8 @@
 #include "WM_api.h"
 #include "WM_types.h"
 
+#include <vector>
+
 namespace blender::io::usd {
 
 struct ExportJobData {
@@ -74,6 +76,51 @@ static void ensure_usd_plugin_path_registered()
   pxr::PlugRegistry::GetInstance().RegisterPlugins(blender_usd_datafiles + "/");
 }
 
+/* Construct the depsgraph for exporting. */
+static void build_depsgraph(Depsgraph *depsgraph, const bool visible_objects_only)
+{
+  if (visible_objects_only) {
+    DEG_graph_build_from_view_layer(depsgraph);
+  }
+  else {
+    DEG_graph_build_for_all_objects(depsgraph);
+  }
+}
+
+/* State shared by the frames of an animation export. */
+struct ExportFramesData {
+  ExportJobData *job_data;
+  USDHierarchyIterator *iter;
+  short *stop;
+  short *do_update;
+  float *progress;
+  float progress_per_frame;
+};
+
+static void export_frames_build_depsgraph(Depsgraph *depsgraph, void *user_data)
+{
+  const ExportFramesData *frames_data = static_cast<ExportFramesData *>(user_data);
+  build_depsgraph(depsgraph, frames_data->job_data->params.visible_objects_only);
+}
+
+/* Write a frame that was evaluated in the given depsgraph. Returns false when the export was
+ * cancelled. */
+static bool export_frame(Depsgraph *depsgraph, double frame, void *user_data)
+{
+  ExportFramesData *frames_data = static_cast<ExportFramesData *>(user_data);
+  if (G.is_break || (frames_data->stop != nullptr && *frames_data->stop)) {
+    return false;
+  }
+
+  frames_data->iter->set_depsgraph(depsgraph);
+  frames_data->iter->set_export_frame(static_cast<float>(frame));
+  frames_data->iter->iterate_and_write();
+
+  *frames_data->progress += frames_data->progress_per_frame;
+  *frames_data->do_update = true;
+  return true;
+}
+
 static void export_startjob(void *customdata,
                             /* Cannot be const, this function implements wm_jobs_start_callback.
                              * NOLINTNEXTLINE: readability-non-const-parameter. */
@@ -88,14 +135,8 @@ static void export_startjob(void *customdata,
   WM_set_locked_interface(data->wm, true);
   G.is_break = false;
 
-  /* Construct the depsgraph for exporting. */
   Scene *scene = DEG_get_input_scene(data->depsgraph);
-  if (data->params.visible_objects_only) {
-    DEG_graph_build_from_view_layer(data->depsgraph);
-  }
-  else {
-    DEG_graph_build_for_all_objects(data->depsgraph);
-  }
+  build_depsgraph(data->depsgraph, data->params.visible_objects_only);
   BKE_scene_graph_update_tagged(data->depsgraph, data->bmain);
 
   *progress = 0.0f;
@@ -130,24 +171,45 @@ static void export_startjob(void *customdata,
   USDHierarchyIterator iter(data->depsgraph, usd_stage, data->params);
 
   if (data->params.export_animation) {
+    ExportFramesData frames_data;
+    frames_data.job_data = data;
+    frames_data.iter = &iter;
+    frames_data.stop = stop;
+    frames_data.do_update = do_update;
+    frames_data.progress = progress;
     /* Writing the animated frames is not 100% of the work, but it's our best guess. */
-    float progress_per_frame = 1.0f / std::max(1, (scene->r.efra - scene->r.sfra + 1));
+    frames_data.progress_per_frame = 1.0f / std::max(1, (scene->r.efra - scene->r.sfra + 1));
 
-    for (float frame = scene->r.sfra; frame <= scene->r.efra; frame++) {
-      if (G.is_break || (stop != nullptr && *stop)) {
-        break;
+    std::vector<double> frames;
+    for (int frame = scene->r.sfra; frame <= scene->r.efra; frame++) {
+      frames.push_back(frame);
+    }
+    const int graphs_num = BKE_scene_graph_evaluate_frames_num_graphs(int(frames.size()));
+
+    if (graphs_num > 1 && BKE_scene_graph_frames_are_independent(data->depsgraph)) {
+      /* Evaluate several frames at once, the frames are still written one after the other. */
+      BKE_scene_graph_evaluate_frames(data->depsgraph,
+                                      frames.data(),
+                                      int(frames.size()),
+                                      graphs_num,
+                                      export_frames_build_depsgraph,
+                                      export_frame,
+                                      &frames_data);
+      iter.set_depsgraph(data->depsgraph);
+    }
+    else {
+      for (double frame : frames) {
+        if (G.is_break || (stop != nullptr && *stop)) {
+          break;
+        }
+
+        /* Update the scene for the next frame to render. */
+        scene->r.cfra = static_cast<int>(frame);
+        scene->r.subframe = frame - scene->r.cfra;
+        BKE_scene_graph_update_for_newframe(data->depsgraph);
+
+        export_frame(data->depsgraph, frame, &frames_data);
       }
-
-      /* Update the scene for the next frame to render. */
-      scene->r.cfra = static_cast<int>(frame);
-      scene->r.subframe = frame - scene->r.cfra;
-      BKE_scene_graph_update_for_newframe(data->depsgraph);
-
-      iter.set_export_frame(frame);
-      iter.iterate_and_write();
-
-      *progress += progress_per_frame;
-      *do_update = true;
     }
   }
   else {
@@ -41,6 +41,7 @@ struct GHash;
 struct Ipo;
 struct Key;
 struct Material;
+struct NurbSharing;
 struct Object;
 struct VFont;
 
@@ -185,6 +186,12 @@ typedef struct Nurb {
 
   /* only used for dynamically generated Nurbs created from OB_FONT's */
   int charidx;
+
+  /**
+   * Run-time only, set when the points (#bp or #bezt) are shared with nurbs of other curves (such
+   * as evaluated copies), the last nurb using them frees the points.
+   */
+  struct NurbSharing *sharing;
 } Nurb;
 
 typedef struct CharInfo {
@@ -31,6 +31,8 @@
 extern "C" {
 #endif
 
+struct CustomDataLayerSharing;
+
 /** Descriptor and storage for a custom data layer. */
 typedef struct CustomDataLayer {
   /** Type of data in layer. */
@@ -53,6 +55,11 @@ typedef struct CustomDataLayer {
   char name[64];
   /** Layer data. */
   void *data;
+  /**
+   * Run-time only, set when the layer data is shared with layers of other custom data (such as
+   * evaluated copies of the datablock), the last layer using it frees the data.
+   */
+  struct CustomDataLayerSharing *sharing;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
@@ -36,6 +36,13 @@ extern "C" {
 
 struct AnimData;
 struct Ipo;
+struct KeyBlockSharing;
+
+/** Element of a key block which differs from the relative key, see #KEYBLOCK_SPARSE. */
+typedef struct KeyBlockSparseElem {
+  int index;
+  float co[3];
+} KeyBlockSparseElem;
 
 typedef struct KeyBlock {
   struct KeyBlock *next, *prev;
@@ -62,8 +69,20 @@ typedef struct KeyBlock {
   /** for meshes only, match the unique number with the customdata layer */
   int uid;
 
-  /** array of shape key values, size is (Key->elemsize * KeyBlock->totelem) */
+  /**
+   * array of shape key values, size is (Key->elemsize * KeyBlock->totelem),
+   * may be NULL for #KEYBLOCK_SPARSE blocks, see #BKE_keyblock_data_ensure.
+   */
   void *data;
+  /** Elements which differ from the relative key, sorted by index (#KEYBLOCK_SPARSE only). */
+  KeyBlockSparseElem *sparse_elems;
+  int sparse_elems_len;
+  char _pad2[4];
+  /**
+   * Run-time only, set when #data is shared with key blocks of other keys (such as evaluated
+   * copies), the last block using it frees the data, see #BKE_keyblock_data_free.
+   */
+  struct KeyBlockSharing *sharing;
   /** MAX_NAME (unique name, user assigned) */
   char name[64];
   /** MAX_VGROUP_NAME (optional vertex group), array gets allocated into 'weights' when set */
@@ -150,6 +169,12 @@ enum {
   KEYBLOCK_MUTE = (1 << 0),
   KEYBLOCK_SEL = (1 << 1),
   KEYBLOCK_LOCKED = (1 << 2),
+  /**
+   * Only the elements which differ from the relative key are stored, in undo steps and in
+   * evaluated copies. Files always store the full data, older versions can't read sparse blocks.
+   * The relative key block itself is never sparse.
+   */
+  KEYBLOCK_SPARSE = (1 << 3),
 };
 
 #define KEYELEM_FLOAT_LEN_COORD 3
@@ -124,7 +124,11 @@ typedef struct Mesh_Runtime {
    */
   char wrapper_type_finalize;
 
-  char _pad[4];
+  /**
+   * Unique number given to each copy of the mesh, meshes evaluated from this one
+   * can only reference its arrays as long as it doesn't change.
+   */
+  int data_stamp;
 
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra;
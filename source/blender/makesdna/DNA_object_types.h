@@ -136,6 +136,10 @@ typedef struct Object_Runtime {
    */
   char is_data_eval_owned;
 
+  /** #Mesh_Runtime.data_stamp of the input mesh when data_eval was last calculated. */
+  int last_data_stamp;
+  char _pad3[4];
+
   /** Axis aligned boundbox (in localspace). */
   struct BoundBox *bb;
 
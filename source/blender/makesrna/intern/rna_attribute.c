@@ -65,6 +65,8 @@ const EnumPropertyItem rna_enum_attribute_domain_items[] = {
 
 #  include "BLI_math.h"
 
+#  include "BKE_mesh.h"
+
 #  include "DEG_depsgraph.h"
 
 #  include "BLT_translation.h"
@@ -147,6 +149,17 @@ static void rna_Attribute_data_begin(CollectionPropertyIterator *iter, PointerRN
   ID *id = ptr->owner_id;
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
 
+  if (GS(id->name) == ID_ME) {
+    /* Attributes can be edited in place, stop sharing this one with evaluated meshes. */
+    Mesh *me = (Mesh *)id;
+    CustomData *domains[] = {&me->vdata, &me->edata, &me->ldata, &me->pdata};
+    for (int i = 0; i < ARRAY_SIZE(domains); i++) {
+      if (ARRAY_HAS_ITEM(layer, domains[i]->layers, domains[i]->totlayer)) {
+        BKE_mesh_layer_named_for_write(me, domains[i], layer->type, layer->name);
+      }
+    }
+  }
+
   int length = BKE_id_attribute_data_length(id, layer);
   size_t struct_size;
 
@@ -392,9 +392,20 @@ static void rna_Nurb_type_set(PointerRNA *ptr, int value)
   }
 }
 
-static void rna_BPoint_array_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+/**
+ * The spline for accessors of points which can be edited in place, points shared with evaluated
+ * copies of the curve are copied first (see #BKE_nurb_ensure_unshared).
+ */
+static Nurb *rna_nurb_for_write(PointerRNA *ptr)
 {
   Nurb *nu = (Nurb *)ptr->data;
+  BKE_nurb_ensure_unshared(nu);
+  return nu;
+}
+
+static void rna_BPoint_array_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+{
+  Nurb *nu = rna_nurb_for_write(ptr);
   rna_iterator_array_begin(iter,
                            (void *)nu->bp,
                            sizeof(BPoint),
@@ -403,6 +414,12 @@ static void rna_BPoint_array_begin(CollectionPropertyIterator *iter, PointerRNA
                            NULL);
 }
 
+static void rna_BezTriple_array_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+{
+  Nurb *nu = rna_nurb_for_write(ptr);
+  rna_iterator_array_begin(iter, (void *)nu->bezt, sizeof(BezTriple), nu->pntsu, 0, NULL);
+}
+
 static void rna_Curve_update_data_id(Main *UNUSED(bmain), Scene *UNUSED(scene), ID *id)
 {
   DEG_id_tag_update(id, 0);
@@ -1895,6 +1912,15 @@ static void rna_def_curve_nurb(BlenderRNA *brna)
   prop = RNA_def_property(srna, "bezier_points", PROP_COLLECTION, PROP_NONE);
   RNA_def_property_struct_type(prop, "BezierSplinePoint");
   RNA_def_property_collection_sdna(prop, NULL, "bezt", "pntsu");
+  RNA_def_property_collection_funcs(prop,
+                                    "rna_BezTriple_array_begin",
+                                    "rna_iterator_array_next",
+                                    "rna_iterator_array_end",
+                                    "rna_iterator_array_get",
+                                    NULL,
+                                    NULL,
+                                    NULL,
+                                    NULL);
   RNA_def_property_ui_text(prop, "Bezier Points", "Collection of points for Bezier curves only");
   rna_def_curve_spline_bezpoints(brna, prop);
 
@@ -222,6 +222,7 @@ static void rna_KeyBlock_normals_vert_calc(ID *id,
 
   *normals = MEM_mallocN(sizeof(**normals) * (size_t)(*normals_len), __func__);
 
+  BKE_keyblock_data_ensure(rna_ShapeKey_find_key(id), data);
   BKE_keyblock_mesh_calc_normals(data, me, (float(*)[3])(*normals), NULL, NULL);
 }
 
@@ -251,6 +252,7 @@ static void rna_KeyBlock_normals_poly_calc(ID *id,
 
   *normals = MEM_mallocN(sizeof(**normals) * (size_t)(*normals_len), __func__);
 
+  BKE_keyblock_data_ensure(rna_ShapeKey_find_key(id), data);
   BKE_keyblock_mesh_calc_normals(data, me, NULL, (float(*)[3])(*normals), NULL);
 }
 
@@ -280,6 +282,7 @@ static void rna_KeyBlock_normals_loop_calc(ID *id,
 
   *normals = MEM_mallocN(sizeof(**normals) * (size_t)(*normals_len), __func__);
 
+  BKE_keyblock_data_ensure(rna_ShapeKey_find_key(id), data);
   BKE_keyblock_mesh_calc_normals(data, me, NULL, NULL, (float(*)[3])(*normals));
 }
 
@@ -570,6 +573,10 @@ static void rna_ShapeKey_data_begin(CollectionPropertyIterator *iter, PointerRNA
   KeyBlock *kb = (KeyBlock *)ptr->data;
   int tot = kb->totelem, size = key->elemsize;
 
+  /* Evaluated keys may only store the elements which differ from the relative key, the data of
+   * original keys may be shared with evaluated keys. */
+  BKE_keyblock_data_ensure_unshared(key, kb);
+
   if (GS(key->from->name) == ID_CU && tot > 0) {
     Curve *cu = (Curve *)key->from;
     StructRNA *type = NULL;
@@ -641,7 +648,7 @@ int rna_ShapeKey_data_lookup_int(PointerRNA *ptr, int index, PointerRNA *r_ptr)
   Key *key = rna_ShapeKey_find_key(ptr->owner_id);
   KeyBlock *kb = (KeyBlock *)ptr->data;
   int elemsize = key->elemsize;
-  char *databuf = kb->data;
+  char *databuf = BKE_keyblock_data_ensure_unshared(key, kb);
 
   memset(r_ptr, 0, sizeof(*r_ptr));
 
@@ -90,6 +90,18 @@ static Mesh *rna_mesh(PointerRNA *ptr)
   return me;
 }
 
+/**
+ * The data of a layer which can be edited in place. Data shared with evaluated copies
+ * (see #LIB_ID_COPY_CD_SHARE) is copied first, other layers keep sharing theirs.
+ */
+static void *rna_mesh_layer_data_for_write(Mesh *me, CustomData *data, CustomDataLayer *layer)
+{
+  if (me->edit_mesh) {
+    return layer->data;
+  }
+  return BKE_mesh_layer_named_for_write(me, data, layer->type, layer->name);
+}
+
 static CustomData *rna_mesh_vdata_helper(Mesh *me)
 {
   return (me->edit_mesh) ? &me->edit_mesh->bm->vdata : &me->vdata;
@@ -421,6 +433,10 @@ static void rna_MeshPolygon_flip(ID *id, MPoly *mp)
 {
   Mesh *me = (Mesh *)id;
 
+  /* All loop layers are flipped in place. */
+  if (CustomData_ensure_unshared_layers(&me->ldata, me->totloop)) {
+    BKE_mesh_update_customdata_pointers(me, false);
+  }
   BKE_mesh_polygon_flip(mp, me->mloop, &me->ldata);
   BKE_mesh_tessface_clear(me);
   BKE_mesh_runtime_clear_geometry(me);
@@ -525,7 +541,8 @@ static void rna_MeshVertex_groups_begin(CollectionPropertyIterator *iter, Pointe
 
   if (me->dvert) {
     MVert *mvert = (MVert *)ptr->data;
-    MDeformVert *dvert = me->dvert + (mvert - me->mvert);
+    MDeformVert *dvert = BKE_mesh_layer_for_write(me, &me->vdata, CD_MDEFORMVERT);
+    dvert += mvert - me->mvert;
 
     rna_iterator_array_begin(
         iter, (void *)dvert->dw, sizeof(MDeformWeight), dvert->totweight, 0, NULL);
@@ -655,6 +672,13 @@ static void rna_MPoly_freestyle_face_mark_set(PointerRNA *ptr, int value)
   }
 }
 
+/* vertices, edges, loops, polygons */
+
+DEFINE_MESH_ELEM_COLLECTION(vertices, MVert, MeshVertex, vdata, CD_MVERT, mvert, totvert)
+DEFINE_MESH_ELEM_COLLECTION(edges, MEdge, MeshEdge, edata, CD_MEDGE, medge, totedge)
+DEFINE_MESH_ELEM_COLLECTION(loops, MLoop, MeshLoop, ldata, CD_MLOOP, mloop, totloop)
+DEFINE_MESH_ELEM_COLLECTION(polygons, MPoly, MeshPolygon, pdata, CD_MPOLY, mpoly, totpoly)
+
 /* uv_layers */
 
 DEFINE_CUSTOMDATA_LAYER_COLLECTION(uv_layer, ldata, CD_MLOOPUV)
@@ -678,8 +702,9 @@ static void rna_MeshUVLoopLayer_data_begin(CollectionPropertyIterator *iter, Poi
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->ldata, layer);
   rna_iterator_array_begin(
-      iter, layer->data, sizeof(MLoopUV), (me->edit_mesh) ? 0 : me->totloop, 0, NULL);
+      iter, layer_data, sizeof(MLoopUV), (me->edit_mesh) ? 0 : me->totloop, 0, NULL);
 }
 
 static int rna_MeshUVLoopLayer_data_length(PointerRNA *ptr)
@@ -728,8 +753,9 @@ static void rna_MeshLoopColorLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->ldata, layer);
   rna_iterator_array_begin(
-      iter, layer->data, sizeof(MLoopCol), (me->edit_mesh) ? 0 : me->totloop, 0, NULL);
+      iter, layer_data, sizeof(MLoopCol), (me->edit_mesh) ? 0 : me->totloop, 0, NULL);
 }
 
 static int rna_MeshLoopColorLayer_data_length(PointerRNA *ptr)
@@ -768,8 +794,9 @@ static void rna_MeshVertColorLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->vdata, layer);
   rna_iterator_array_begin(
-      iter, layer->data, sizeof(MPropCol), (me->edit_mesh) ? 0 : me->totvert, 0, NULL);
+      iter, layer_data, sizeof(MPropCol), (me->edit_mesh) ? 0 : me->totvert, 0, NULL);
 }
 
 static int rna_MeshVertColorLayer_data_length(PointerRNA *ptr)
@@ -927,7 +954,8 @@ static void rna_MeshSkinVertexLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MVertSkin), me->totvert, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->vdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MVertSkin), me->totvert, 0, NULL);
 }
 
 static int rna_MeshSkinVertexLayer_data_length(PointerRNA *ptr)
@@ -958,7 +986,8 @@ static void rna_MeshPaintMaskLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MFloatProperty), me->totvert, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->vdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MFloatProperty), me->totvert, 0, NULL);
 }
 
 static int rna_MeshPaintMaskLayer_data_length(PointerRNA *ptr)
@@ -987,7 +1016,8 @@ static void rna_MeshFaceMapLayer_data_begin(CollectionPropertyIterator *iter, Po
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(int), me->totpoly, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->pdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(int), me->totpoly, 0, NULL);
 }
 
 static int rna_MeshFaceMapLayer_data_length(PointerRNA *ptr)
@@ -1301,14 +1331,16 @@ static void rna_MeshVertexFloatPropertyLayer_data_begin(CollectionPropertyIterat
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MFloatProperty), me->totvert, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->vdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MFloatProperty), me->totvert, 0, NULL);
 }
 static void rna_MeshPolygonFloatPropertyLayer_data_begin(CollectionPropertyIterator *iter,
                                                          PointerRNA *ptr)
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MFloatProperty), me->totpoly, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->pdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MFloatProperty), me->totpoly, 0, NULL);
 }
 
 static int rna_MeshVertexFloatPropertyLayer_data_length(PointerRNA *ptr)
@@ -1352,14 +1384,16 @@ static void rna_MeshVertexIntPropertyLayer_data_begin(CollectionPropertyIterator
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MIntProperty), me->totvert, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->vdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MIntProperty), me->totvert, 0, NULL);
 }
 static void rna_MeshPolygonIntPropertyLayer_data_begin(CollectionPropertyIterator *iter,
                                                        PointerRNA *ptr)
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MIntProperty), me->totpoly, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->pdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MIntProperty), me->totpoly, 0, NULL);
 }
 
 static int rna_MeshVertexIntPropertyLayer_data_length(PointerRNA *ptr)
@@ -1403,14 +1437,16 @@ static void rna_MeshVertexStringPropertyLayer_data_begin(CollectionPropertyItera
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MStringProperty), me->totvert, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->vdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MStringProperty), me->totvert, 0, NULL);
 }
 static void rna_MeshPolygonStringPropertyLayer_data_begin(CollectionPropertyIterator *iter,
                                                           PointerRNA *ptr)
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MStringProperty), me->totpoly, 0, NULL);
+  void *layer_data = rna_mesh_layer_data_for_write(me, &me->pdata, layer);
+  rna_iterator_array_begin(iter, layer_data, sizeof(MStringProperty), me->totpoly, 0, NULL);
 }
 
 static int rna_MeshVertexStringPropertyLayer_data_length(PointerRNA *ptr)
@@ -2927,6 +2963,15 @@ static void rna_def_mesh(BlenderRNA *brna)
 
   prop = RNA_def_property(srna, "vertices", PROP_COLLECTION, PROP_NONE);
   RNA_def_property_collection_sdna(prop, NULL, "mvert", "totvert");
+  RNA_def_property_collection_funcs(prop,
+                                    "rna_Mesh_vertices_begin",
+                                    "rna_iterator_array_next",
+                                    "rna_iterator_array_end",
+                                    "rna_iterator_array_get",
+                                    "rna_Mesh_vertices_length",
+                                    "rna_Mesh_vertices_lookup_int",
+                                    NULL,
+                                    NULL);
   RNA_def_property_struct_type(prop, "MeshVertex");
   RNA_def_property_override_flag(prop, PROPOVERRIDE_IGNORE);
   RNA_def_property_ui_text(prop, "Vertices", "Vertices of the mesh");
@@ -2934,6 +2979,15 @@ static void rna_def_mesh(BlenderRNA *brna)
 
   prop = RNA_def_property(srna, "edges", PROP_COLLECTION, PROP_NONE);
   RNA_def_property_collection_sdna(prop, NULL, "medge", "totedge");
+  RNA_def_property_collection_funcs(prop,
+                                    "rna_Mesh_edges_begin",
+                                    "rna_iterator_array_next",
+                                    "rna_iterator_array_end",
+                                    "rna_iterator_array_get",
+                                    "rna_Mesh_edges_length",
+                                    "rna_Mesh_edges_lookup_int",
+                                    NULL,
+                                    NULL);
   RNA_def_property_struct_type(prop, "MeshEdge");
   RNA_def_property_override_flag(prop, PROPOVERRIDE_IGNORE);
   RNA_def_property_ui_text(prop, "Edges", "Edges of the mesh");
@@ -2941,6 +2995,15 @@ static void rna_def_mesh(BlenderRNA *brna)
 
   prop = RNA_def_property(srna, "loops", PROP_COLLECTION, PROP_NONE);
   RNA_def_property_collection_sdna(prop, NULL, "mloop", "totloop");
+  RNA_def_property_collection_funcs(prop,
+                                    "rna_Mesh_loops_begin",
+                                    "rna_iterator_array_next",
+                                    "rna_iterator_array_end",
+                                    "rna_iterator_array_get",
+                                    "rna_Mesh_loops_length",
+                                    "rna_Mesh_loops_lookup_int",
+                                    NULL,
+                                    NULL);
   RNA_def_property_struct_type(prop, "MeshLoop");
   RNA_def_property_override_flag(prop, PROPOVERRIDE_IGNORE);
   RNA_def_property_ui_text(prop, "Loops", "Loops of the mesh (polygon corners)");
@@ -2948,6 +3011,15 @@ static void rna_def_mesh(BlenderRNA *brna)
 
   prop = RNA_def_property(srna, "polygons", PROP_COLLECTION, PROP_NONE);
   RNA_def_property_collection_sdna(prop, NULL, "mpoly", "totpoly");
+  RNA_def_property_collection_funcs(prop,
+                                    "rna_Mesh_polygons_begin",
+                                    "rna_iterator_array_next",
+                                    "rna_iterator_array_end",
+                                    "rna_iterator_array_get",
+                                    "rna_Mesh_polygons_length",
+                                    "rna_Mesh_polygons_lookup_int",
+                                    NULL,
+                                    NULL);
   RNA_def_property_struct_type(prop, "MeshPolygon");
   RNA_def_property_override_flag(prop, PROPOVERRIDE_IGNORE);
   RNA_def_property_ui_text(prop, "Polygons", "Polygons of the mesh");
@@ -38,6 +38,7 @@
 
 #  include "DNA_mesh_types.h"
 
+#  include "BKE_customdata.h"
 #  include "BKE_mesh.h"
 #  include "BKE_mesh_mapping.h"
 #  include "BKE_mesh_runtime.h"
@@ -181,6 +182,10 @@ static void rna_Mesh_transform(Mesh *mesh, float *mat, bool shape_keys)
 
 static void rna_Mesh_flip_normals(Mesh *mesh)
 {
+  /* All loop layers are flipped in place. */
+  if (CustomData_ensure_unshared_layers(&mesh->ldata, mesh->totloop)) {
+    BKE_mesh_update_customdata_pointers(mesh, false);
+  }
   BKE_mesh_polygons_flip(mesh->mpoly, mesh->mloop, &mesh->ldata, mesh->totpoly);
   BKE_mesh_tessface_clear(mesh);
   BKE_mesh_calc_normals(mesh);
@@ -122,3 +122,34 @@
       BKE_mesh_update_customdata_pointers(me, true); \
     } \
   }
+
+/* Define the accessors for a collection of mesh elements, which may be edited in place.
+ * Element pointers point into the array, so it stops being shared with evaluated copies once
+ * it's accessed, other arrays of the mesh keep being shared. */
+#define DEFINE_MESH_ELEM_COLLECTION( \
+    collection_name, elem_type, elem_struct, customdata, layer_type, array, totelem) \
+  /* begin */ \
+  static void rna_Mesh_##collection_name##_begin(CollectionPropertyIterator *iter, \
+                                                 PointerRNA *ptr) \
+  { \
+    Mesh *me = rna_mesh(ptr); \
+    BKE_mesh_layer_for_write(me, &me->customdata, layer_type); \
+    rna_iterator_array_begin(iter, (void *)me->array, sizeof(elem_type), me->totelem, 0, NULL); \
+  } \
+  /* length */ \
+  static int rna_Mesh_##collection_name##_length(PointerRNA *ptr) \
+  { \
+    return rna_mesh(ptr)->totelem; \
+  } \
+  /* lookup */ \
+  static int rna_Mesh_##collection_name##_lookup_int( \
+      PointerRNA *ptr, int index, PointerRNA *r_ptr) \
+  { \
+    Mesh *me = rna_mesh(ptr); \
+    if (index < 0 || index >= me->totelem) { \
+      return false; \
+    } \
+    BKE_mesh_layer_for_write(me, &me->customdata, layer_type); \
+    *r_ptr = rna_pointer_inherit_refine(ptr, &RNA_##elem_struct, &me->array[index]); \
+    return true; \
+  }
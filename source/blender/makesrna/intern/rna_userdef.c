@@ -6186,6 +6186,22 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "use_object_add_tool", 1);
   RNA_def_property_ui_text(
       prop, "Add Object Tool", "Show add object tool in the toolbar in Object Mode and Edit Mode");
+
+  prop = RNA_def_property(srna, "use_undo_skip_unchanged", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_undo_skip_unchanged", 1);
+  RNA_def_property_ui_text(prop,
+                           "Undo Skip Unchanged",
+                           "Re-use the undo data of data-blocks not tagged for update since the "
+                           "previous undo step, making undo steps faster in big scenes (changes "
+                           "that do not tag an update, to data other than the data-block's own "
+                           "settings, such as mesh elements, may not be undone correctly)");
+
+  prop = RNA_def_property(srna, "use_depsgraph_critical_path", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_depsgraph_critical_path", 1);
+  RNA_def_property_ui_text(prop,
+                           "Depsgraph Critical Path",
+                           "Evaluate the operations with the longest chain of dependent work "
+                           "first when updating the scene with multiple threads");
 }
 
 static void rna_def_userdef_addon_collection(BlenderRNA *brna, PropertyRNA *cprop)
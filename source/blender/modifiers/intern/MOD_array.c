@@ -28,6 +28,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -137,17 +138,50 @@ static int svert_sum_cmp(const void *e1, const void *e2)
   return 0;
 }
 
-static void svert_from_mvert(SortVertsElem *sv,
-                             const MVert *mv,
-                             const int i_begin,
-                             const int i_end)
+/**
+ * Fill \a sv with the vertices within the \a bounds.
+ * \return the number of vertices.
+ */
+static int svert_from_mvert(SortVertsElem *sv,
+                            const MVert *mv,
+                            const int i_begin,
+                            const int i_end,
+                            const float bounds_min[3],
+                            const float bounds_max[3])
 {
-  int i;
-  for (i = i_begin; i < i_end; i++, sv++, mv++) {
+  int i, sv_len = 0;
+  for (i = i_begin; i < i_end; i++, mv++) {
+    if (!(mv->co[0] >= bounds_min[0] && mv->co[1] >= bounds_min[1] &&
+          mv->co[2] >= bounds_min[2] && mv->co[0] <= bounds_max[0] &&
+          mv->co[1] <= bounds_max[1] && mv->co[2] <= bounds_max[2])) {
+      continue;
+    }
     sv->vertex_num = i;
     copy_v3_v3(sv->co, mv->co);
     sv->sum_co = sum_v3(mv->co);
+    sv++;
+    sv_len++;
   }
+  return sv_len;
+}
+
+/**
+ * Bounds of the vertices in range, expanded by \a dist.
+ */
+static void mvert_bounds_calc(const MVert *mv,
+                              const int verts_num,
+                              const float dist,
+                              float r_min[3],
+                              float r_max[3])
+{
+  INIT_MINMAX(r_min, r_max);
+  for (int i = 0; i < verts_num; i++, mv++) {
+    minmax_v3v3_v3(r_min, r_max, mv->co);
+  }
+  /* Margin for rounding errors, vertices at exactly the merge distance must be kept. */
+  const float margin = dist * 1.0001f + FLT_EPSILON;
+  add_v3_fl(r_max, margin);
+  add_v3_fl(r_min, -margin);
 }
 
 /**
@@ -156,6 +190,10 @@ static void svert_from_mvert(SortVertsElem *sv,
  * It builds a mapping for all vertices within source,
  * to vertices within target, or -1 if no double found.
  * The int doubles_map[num_verts_source] array must have been allocated by caller.
+ *
+ * Only vertices within the merge distance of the bounds of the other set can have doubles,
+ * with adjacent copies these are the vertices at the boundary between the copies,
+ * so only those are sorted and tested.
  */
 static void dm_mvert_map_doubles(int *doubles_map,
                                  const MVert *mverts,
@@ -174,19 +212,34 @@ static void dm_mvert_map_doubles(int *doubles_map,
   target_end = target_start + target_num_verts;
   source_end = source_start + source_num_verts;
 
+  float target_min[3], target_max[3], source_min[3], source_max[3];
+  mvert_bounds_calc(mverts + target_start, target_num_verts, dist, target_min, target_max);
+  mvert_bounds_calc(mverts + source_start, source_num_verts, dist, source_min, source_max);
+
   /* build array of MVerts to be tested for merging */
   sorted_verts_target = MEM_malloc_arrayN(target_num_verts, sizeof(SortVertsElem), __func__);
   sorted_verts_source = MEM_malloc_arrayN(source_num_verts, sizeof(SortVertsElem), __func__);
 
-  /* Copy target vertices index and cos into SortVertsElem array */
-  svert_from_mvert(sorted_verts_target, mverts + target_start, target_start, target_end);
+  /* Copy target vertices index and cos into SortVertsElem array,
+   * source vertices which aren't copied keep their mapping (no double when not yet mapped). */
+  const int target_num_sorted = svert_from_mvert(sorted_verts_target,
+                                                 mverts + target_start,
+                                                 target_start,
+                                                 target_end,
+                                                 source_min,
+                                                 source_max);
 
   /* Copy source vertices index and cos into SortVertsElem array */
-  svert_from_mvert(sorted_verts_source, mverts + source_start, source_start, source_end);
+  const int source_num_sorted = svert_from_mvert(sorted_verts_source,
+                                                 mverts + source_start,
+                                                 source_start,
+                                                 source_end,
+                                                 target_min,
+                                                 target_max);
 
   /* sort arrays according to sum of vertex coordinates (sumco) */
-  qsort(sorted_verts_target, target_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
-  qsort(sorted_verts_source, source_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
+  qsort(sorted_verts_target, target_num_sorted, sizeof(SortVertsElem), svert_sum_cmp);
+  qsort(sorted_verts_source, source_num_sorted, sizeof(SortVertsElem), svert_sum_cmp);
 
   sve_target_low_bound = sorted_verts_target;
   i_target_low_bound = 0;
@@ -194,7 +247,7 @@ static void dm_mvert_map_doubles(int *doubles_map,
 
   /* Scan source vertices, in SortVertsElem sorted array, */
   /* all the while maintaining the lower bound of possible doubles in target vertices */
-  for (i_source = 0, sve_source = sorted_verts_source; i_source < source_num_verts;
+  for (i_source = 0, sve_source = sorted_verts_source; i_source < source_num_sorted;
        i_source++, sve_source++) {
     int best_target_vertex = -1;
     float best_dist_sq = dist * dist;
@@ -215,13 +268,13 @@ static void dm_mvert_map_doubles(int *doubles_map,
 
     /* Skip all target vertices that are more than dist3 lower in terms of sumco */
     /* and advance the overall lower bound, applicable to all remaining vertices as well. */
-    while ((i_target_low_bound < target_num_verts) &&
+    while ((i_target_low_bound < target_num_sorted) &&
            (sve_target_low_bound->sum_co < sve_source_sumco - dist3)) {
       i_target_low_bound++;
       sve_target_low_bound++;
     }
     /* If end of target list reached, then no more possible doubles */
-    if (i_target_low_bound >= target_num_verts) {
+    if (i_target_low_bound >= target_num_sorted) {
       doubles_map[sve_source->vertex_num] = -1;
       target_scan_completed = true;
       continue;
@@ -234,7 +287,7 @@ static void dm_mvert_map_doubles(int *doubles_map,
     /* i_target will scan vertices in the
      * [v_source_sumco - dist3;  v_source_sumco + dist3] range */
 
-    while ((i_target < target_num_verts) && (sve_target->sum_co <= sve_source_sumco + dist3)) {
+    while ((i_target < target_num_sorted) && (sve_target->sum_co <= sve_source_sumco + dist3)) {
       /* Testing distance for candidate double in target */
       /* v_target is within dist3 of v_source in terms of sumco;  check real distance */
       float dist_sq;
@@ -353,16 +406,100 @@ static void mesh_merge_transform(Mesh *result,
   }
 }
 
+/* Below this number of elements to create, copies aren't worth splitting between threads. */
+#define ARRAY_PARALLEL_ELEM_MIN 10000
+
+typedef struct ArrayChunkData {
+  const Mesh *mesh;
+  Mesh *result;
+  const float (*chunk_offsets)[4][4];
+  const float *uv_offset;
+  bool use_recalc_normals;
+} ArrayChunkData;
+
+/**
+ * Create copy \a c of the source mesh, the first copy is made by the caller.
+ */
+static void array_chunk_create_fn(void *__restrict userdata,
+                                  const int c,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArrayChunkData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const int chunk_nverts = mesh->totvert;
+  const int chunk_nedges = mesh->totedge;
+  const int chunk_nloops = mesh->totloop;
+  const int chunk_npolys = mesh->totpoly;
+  const float(*current_offset)[4] = data->chunk_offsets[c];
+  int i;
+
+  /* copy customdata to new geometry */
+  CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
+  CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
+  CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
+  CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
+
+  MVert *mv = result->mvert + c * chunk_nverts;
+  MEdge *me = result->medge + c * chunk_nedges;
+  MLoop *ml = result->mloop + c * chunk_nloops;
+  MPoly *mp = result->mpoly + c * chunk_npolys;
+
+  /* apply offset to all new verts */
+  for (i = 0; i < chunk_nverts; i++, mv++) {
+    mul_m4_v3(current_offset, mv->co);
+
+    /* We have to correct normals too, if we do not tag them as dirty! */
+    if (!data->use_recalc_normals) {
+      float no[3];
+      normal_short_to_float_v3(no, mv->no);
+      mul_mat3_m4_v3(current_offset, no);
+      normalize_v3(no);
+      normal_float_to_short_v3(mv->no, no);
+    }
+  }
+
+  /* adjust edge vertex indices */
+  for (i = 0; i < chunk_nedges; i++, me++) {
+    me->v1 += c * chunk_nverts;
+    me->v2 += c * chunk_nverts;
+  }
+
+  for (i = 0; i < chunk_npolys; i++, mp++) {
+    mp->loopstart += c * chunk_nloops;
+  }
+
+  /* adjust loop vertex and edge indices */
+  for (i = 0; i < chunk_nloops; i++, ml++) {
+    ml->v += c * chunk_nverts;
+    ml->e += c * chunk_nedges;
+  }
+
+  /* handle UVs */
+  if (chunk_nloops > 0 && is_zero_v2(data->uv_offset) == false) {
+    const float uv_offset[2] = {
+        data->uv_offset[0] * (float)c,
+        data->uv_offset[1] * (float)c,
+    };
+    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
+    for (i = 0; i < totuv; i++) {
+      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
+      dmloopuv += c * chunk_nloops;
+      for (int l_index = 0; l_index < chunk_nloops; l_index++, dmloopuv++) {
+        dmloopuv->uv[0] += uv_offset[0];
+        dmloopuv->uv[1] += uv_offset[1];
+      }
+    }
+  }
+}
+
 static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                                    const ModifierEvalContext *ctx,
                                    Mesh *mesh)
 {
   const MVert *src_mvert;
-  MVert *mv, *mv_prev, *result_dm_verts;
+  MVert *result_dm_verts;
 
-  MEdge *me;
-  MLoop *ml;
-  MPoly *mp;
   int i, j, c, count;
   float length = amd->length;
   /* offset matrix */
@@ -569,110 +706,67 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   first_chunk_start = 0;
   first_chunk_nverts = chunk_nverts;
 
+  /* Cumulative offset of each copy. */
+  float(*chunk_offsets)[4][4] = MEM_malloc_arrayN(count, sizeof(*chunk_offsets), __func__);
   unit_m4(current_offset);
+  copy_m4_m4(chunk_offsets[0], current_offset);
   for (c = 1; c < count; c++) {
-    /* copy customdata to new geometry */
-    CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
-    CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
-    CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
-    CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
-
-    mv_prev = result_dm_verts;
-    mv = mv_prev + c * chunk_nverts;
-
-    /* recalculate cumulative offset here */
     mul_m4_m4m4(current_offset, current_offset, offset);
+    copy_m4_m4(chunk_offsets[c], current_offset);
+  }
 
-    /* apply offset to all new verts */
-    for (i = 0; i < chunk_nverts; i++, mv++, mv_prev++) {
-      mul_m4_v3(current_offset, mv->co);
-
-      /* We have to correct normals too, if we do not tag them as dirty! */
-      if (!use_recalc_normals) {
-        float no[3];
-        normal_short_to_float_v3(no, mv->no);
-        mul_mat3_m4_v3(current_offset, no);
-        normalize_v3(no);
-        normal_float_to_short_v3(mv->no, no);
-      }
-    }
-
-    /* adjust edge vertex indices */
-    me = result->medge + c * chunk_nedges;
-    for (i = 0; i < chunk_nedges; i++, me++) {
-      me->v1 += c * chunk_nverts;
-      me->v2 += c * chunk_nverts;
-    }
-
-    mp = result->mpoly + c * chunk_npolys;
-    for (i = 0; i < chunk_npolys; i++, mp++) {
-      mp->loopstart += c * chunk_nloops;
-    }
-
-    /* adjust loop vertex and edge indices */
-    ml = result->mloop + c * chunk_nloops;
-    for (i = 0; i < chunk_nloops; i++, ml++) {
-      ml->v += c * chunk_nverts;
-      ml->e += c * chunk_nedges;
-    }
-
-    /* Handle merge between chunk n and n-1 */
-    if (use_merge && (c >= 1)) {
-      if (!offset_has_scale && (c >= 2)) {
-        /* Mapping chunk 3 to chunk 2 is a translation of mapping 2 to 1
-         * ... that is except if scaling makes the distance grow */
-        int k;
-        int this_chunk_index = c * chunk_nverts;
-        int prev_chunk_index = (c - 1) * chunk_nverts;
-        for (k = 0; k < chunk_nverts; k++, this_chunk_index++, prev_chunk_index++) {
-          int target = full_doubles_map[prev_chunk_index];
-          if (target != -1) {
-            target += chunk_nverts; /* translate mapping */
-            while (target != -1 && !ELEM(full_doubles_map[target], -1, target)) {
-              /* If target is already mapped, we only follow that mapping if final target remains
-               * close enough from current vert (otherwise no mapping at all). */
-              if (compare_len_v3v3(result_dm_verts[this_chunk_index].co,
-                                   result_dm_verts[full_doubles_map[target]].co,
-                                   amd->merge_dist)) {
-                target = full_doubles_map[target];
-              }
-              else {
-                target = -1;
-              }
+  /* Create all copies, each one is independent from the others. */
+  ArrayChunkData chunk_data = {
+      .mesh = mesh,
+      .result = result,
+      .chunk_offsets = (const float(*)[4][4])chunk_offsets,
+      .uv_offset = amd->uv_offset,
+      .use_recalc_normals = use_recalc_normals,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ((size_t)(count - 1) * (size_t)(chunk_nverts + chunk_nloops)) >=
+                           ARRAY_PARALLEL_ELEM_MIN;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(1, count, &chunk_data, array_chunk_create_fn, &settings);
+  MEM_freeN(chunk_offsets);
+
+  /* Handle merge between chunk n and n-1 */
+  for (c = 1; use_merge && (c < count); c++) {
+    if (!offset_has_scale && (c >= 2)) {
+      /* Mapping chunk 3 to chunk 2 is a translation of mapping 2 to 1
+       * ... that is except if scaling makes the distance grow */
+      int k;
+      int this_chunk_index = c * chunk_nverts;
+      int prev_chunk_index = (c - 1) * chunk_nverts;
+      for (k = 0; k < chunk_nverts; k++, this_chunk_index++, prev_chunk_index++) {
+        int target = full_doubles_map[prev_chunk_index];
+        if (target != -1) {
+          target += chunk_nverts; /* translate mapping */
+          while (target != -1 && !ELEM(full_doubles_map[target], -1, target)) {
+            /* If target is already mapped, we only follow that mapping if final target remains
+             * close enough from current vert (otherwise no mapping at all). */
+            if (compare_len_v3v3(result_dm_verts[this_chunk_index].co,
+                                 result_dm_verts[full_doubles_map[target]].co,
+                                 amd->merge_dist)) {
+              target = full_doubles_map[target];
+            }
+            else {
+              target = -1;
             }
           }
-          full_doubles_map[this_chunk_index] = target;
         }
-      }
-      else {
-        dm_mvert_map_doubles(full_doubles_map,
-                             result_dm_verts,
-                             (c - 1) * chunk_nverts,
-                             chunk_nverts,
-                             c * chunk_nverts,
-                             chunk_nverts,
-                             amd->merge_dist);
+        full_doubles_map[this_chunk_index] = target;
       }
     }
-  }
-
-  /* handle UVs */
-  if (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false) {
-    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
-    for (i = 0; i < totuv; i++) {
-      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
-      dmloopuv += chunk_nloops;
-      for (c = 1; c < count; c++) {
-        const float uv_offset[2] = {
-            amd->uv_offset[0] * (float)c,
-            amd->uv_offset[1] * (float)c,
-        };
-        int l_index = chunk_nloops;
-        for (; l_index-- != 0; dmloopuv++) {
-          dmloopuv->uv[0] += uv_offset[0];
-          dmloopuv->uv[1] += uv_offset[1];
-        }
-      }
+    else {
+      dm_mvert_map_doubles(full_doubles_map,
+                           result_dm_verts,
+                           (c - 1) * chunk_nverts,
+                           chunk_nverts,
+                           c * chunk_nverts,
+                           chunk_nverts,
+                           amd->merge_dist);
     }
   }
 
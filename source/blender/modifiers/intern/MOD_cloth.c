@@ -123,9 +123,9 @@ static void deformVerts(ModifierData *md,
    * Also hopefully new cloth system will arrive soon..
    */
   if (mesh == NULL && clmd->sim_parms->shapekey_rest) {
-    KeyBlock *kb = BKE_keyblock_from_key(BKE_key_from_object(ctx->object),
-                                         clmd->sim_parms->shapekey_rest);
-    if (kb && kb->data != NULL) {
+    Key *key = BKE_key_from_object(ctx->object);
+    KeyBlock *kb = BKE_keyblock_from_key(key, clmd->sim_parms->shapekey_rest);
+    if (kb && BKE_keyblock_data_ensure(key, kb) != NULL) {
       float(*layerorco)[3];
       if (!(layerorco = CustomData_get_layer(&mesh_src->vdata, CD_CLOTH_ORCO))) {
         layerorco = CustomData_add_layer(
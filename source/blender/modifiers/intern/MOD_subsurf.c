@@ -66,6 +66,8 @@
 typedef struct SubsurfRuntimeData {
   /* Cached subdivision surface descriptor, with topology and settings. */
   struct Subdiv *subdiv;
+  /* Fingerprint of the mesh topology the descriptor was last used for. */
+  SubdivTopologyFingerprint topology_fingerprint;
 } SubsurfRuntimeData;
 
 static void initData(ModifierData *md)
@@ -179,8 +181,22 @@ static Subdiv *subdiv_descriptor_ensure(SubsurfModifierData *smd,
                                         const Mesh *mesh)
 {
   SubsurfRuntimeData *runtime_data = (SubsurfRuntimeData *)smd->modifier.runtime;
-  Subdiv *subdiv = BKE_subdiv_update_from_mesh(runtime_data->subdiv, subdiv_settings, mesh);
+  Subdiv *subdiv = runtime_data->subdiv;
+  /* For deformation-only changes the fingerprint matches, so the existing topology refiner is
+   * used without converting the mesh and comparing its topology, and only vertex data is pushed
+   * to the evaluator. */
+  SubdivTopologyFingerprint topology_fingerprint;
+  BKE_subdiv_topology_fingerprint_from_mesh(mesh, &topology_fingerprint);
+  if (subdiv != NULL && subdiv->topology_refiner != NULL &&
+      BKE_subdiv_topology_fingerprint_equal(&runtime_data->topology_fingerprint,
+                                            &topology_fingerprint) &&
+      BKE_subdiv_settings_equal(&subdiv->settings, subdiv_settings)) {
+    BKE_subdiv_stats_count(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_FINGERPRINT_MATCH);
+    return subdiv;
+  }
+  subdiv = BKE_subdiv_update_from_mesh(subdiv, subdiv_settings, mesh);
   runtime_data->subdiv = subdiv;
+  runtime_data->topology_fingerprint = topology_fingerprint;
   return subdiv;
 }
 
@@ -39,6 +39,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_kdtree.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -68,6 +69,9 @@
 
 #include "MOD_modifiertypes.h"
 #include "MOD_ui_common.h"
+#include "MOD_weld.h"
+
+#include "atomic_ops.h"
 
 /* Indicates when the element was not computed. */
 #define OUT_OF_CONTEXT (uint)(-1)
@@ -76,6 +80,11 @@
 /* indicates whether an edge or vertex in groups_map will be merged. */
 #define ELEM_MERGED (uint)(-2)
 
+/* Below this number of elements, the context is built on a single thread. */
+#define WELD_PARALLEL_ELEM_MIN 10000
+/* Number of elements of the original mesh handled by each task when creating the result. */
+#define WELD_RESULT_CHUNK_SIZE 4096
+
 /* Used to indicate a range in an array specifying a group. */
 struct WeldGroup {
   uint len;
@@ -464,12 +473,79 @@ static void weld_vert_groups_setup(const uint mvert_len,
 /** \name Weld Edge API
  * \{ */
 
+struct WeldEdgeOverlapData {
+  const struct WeldGroup *v_links;
+  const uint *link_edge_buffer;
+  WeldEdge *wedge;
+  uint *edge_dest_map;
+};
+
+/* Sum the kill counters of two tasks, stored as a single `uint`. */
+static void weld_kill_len_reduce(const void *__restrict UNUSED(userdata),
+                                 void *__restrict chunk_join,
+                                 void *__restrict chunk)
+{
+  *(uint *)chunk_join += *(uint *)chunk;
+}
+
+/**
+ * Merge an edge into the first edge (lowest context index) sharing both of its vertices.
+ *
+ * Only the tested edge is written to, so all edges can be tested in parallel. The result is the
+ * same as when every edge merges all following edges into itself in order.
+ */
+static void weld_edge_overlap_fn(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict tls)
+{
+  const struct WeldEdgeOverlapData *data = userdata;
+  WeldEdge *we = &data->wedge[i];
+  if (we->edge_dest != OUT_OF_CONTEXT) {
+    /* Collapsed edge. */
+    return;
+  }
+
+  const struct WeldGroup *link_a = &data->v_links[we->vert_a];
+  const struct WeldGroup *link_b = &data->v_links[we->vert_b];
+
+  uint edges_len_a = link_a->len;
+  uint edges_len_b = link_b->len;
+
+  if (edges_len_a <= 1 || edges_len_b <= 1) {
+    return;
+  }
+
+  /* Both link arrays are sorted, the first edge in both is the one to merge into.
+   * This edge is in both, so there is always a match. */
+  const uint *edges_ctx_a = &data->link_edge_buffer[link_a->ofs];
+  const uint *edges_ctx_b = &data->link_edge_buffer[link_b->ofs];
+  while (*edges_ctx_a != *edges_ctx_b) {
+    if (*edges_ctx_a < *edges_ctx_b) {
+      edges_ctx_a++;
+    }
+    else {
+      edges_ctx_b++;
+    }
+  }
+
+  const uint e_ctx = *edges_ctx_a;
+  if (e_ctx < (uint)i) {
+    const WeldEdge *we_dst = &data->wedge[e_ctx];
+    BLI_assert(ELEM(we_dst->vert_a, we->vert_a, we->vert_b));
+    BLI_assert(ELEM(we_dst->vert_b, we->vert_a, we->vert_b));
+    data->edge_dest_map[we->edge_orig] = we_dst->edge_orig;
+    we->edge_dest = we_dst->edge_orig;
+    (*(uint *)tls->userdata_chunk)++;
+  }
+}
+
 static void weld_edge_ctx_setup(const uint mvert_len,
                                 const uint wedge_len,
                                 struct WeldGroup *r_vlinks,
                                 uint *r_edge_dest_map,
                                 WeldEdge *r_wedge,
-                                uint *r_edge_kiil_len)
+                                uint *r_edge_kiil_len,
+                                const bool use_threading)
 {
   WeldEdge *we;
 
@@ -526,56 +602,23 @@ static void weld_edge_ctx_setup(const uint mvert_len,
       vl_iter->ofs -= vl_iter->len;
     }
 
-    we = &r_wedge[0];
-    for (uint i = 0; i < wedge_len; i++, we++) {
-      if (we->edge_dest != OUT_OF_CONTEXT) {
-        /* No need to retest edges.
-         * (Already includes collapsed edges). */
-        continue;
-      }
-
-      uint dst_vert_a = we->vert_a;
-      uint dst_vert_b = we->vert_b;
-
-      struct WeldGroup *link_a = &v_links[dst_vert_a];
-      struct WeldGroup *link_b = &v_links[dst_vert_b];
-
-      uint edges_len_a = link_a->len;
-      uint edges_len_b = link_b->len;
-
-      if (edges_len_a <= 1 || edges_len_b <= 1) {
-        continue;
-      }
-
-      uint *edges_ctx_a = &link_edge_buffer[link_a->ofs];
-      uint *edges_ctx_b = &link_edge_buffer[link_b->ofs];
-      uint edge_orig = we->edge_orig;
-
-      for (; edges_len_a--; edges_ctx_a++) {
-        uint e_ctx_a = *edges_ctx_a;
-        if (e_ctx_a == i) {
-          continue;
-        }
-        while (edges_len_b && *edges_ctx_b < e_ctx_a) {
-          edges_ctx_b++;
-          edges_len_b--;
-        }
-        if (edges_len_b == 0) {
-          break;
-        }
-        uint e_ctx_b = *edges_ctx_b;
-        if (e_ctx_a == e_ctx_b) {
-          WeldEdge *we_b = &r_wedge[e_ctx_b];
-          BLI_assert(ELEM(we_b->vert_a, dst_vert_a, dst_vert_b));
-          BLI_assert(ELEM(we_b->vert_b, dst_vert_a, dst_vert_b));
-          BLI_assert(we_b->edge_dest == OUT_OF_CONTEXT);
-          BLI_assert(we_b->edge_orig != edge_orig);
-          r_edge_dest_map[we_b->edge_orig] = edge_orig;
-          we_b->edge_dest = edge_orig;
-          edge_kill_len++;
-        }
-      }
-    }
+    struct WeldEdgeOverlapData data = {
+        .v_links = v_links,
+        .link_edge_buffer = link_edge_buffer,
+        .wedge = r_wedge,
+        .edge_dest_map = r_edge_dest_map,
+    };
+    uint overlap_kill_len = 0;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = use_threading && (wedge_len >= WELD_PARALLEL_ELEM_MIN);
+    settings.min_iter_per_thread = 1024;
+    settings.userdata_chunk = &overlap_kill_len;
+    settings.userdata_chunk_size = sizeof(overlap_kill_len);
+    settings.func_reduce = weld_kill_len_reduce;
+    BLI_task_parallel_range(0, wedge_len, &data, weld_edge_overlap_fn, &settings);
+    edge_kill_len += overlap_kill_len;
 
 #ifdef USE_WELD_DEBUG
     weld_assert_edge_kill_len(r_wedge, wedge_len, edge_kill_len);
@@ -1068,6 +1111,99 @@ static void weld_poly_split_recursive(const uint *vert_dest_map,
   }
 }
 
+struct WeldPolyOverlapData {
+  WeldPoly *wpoly;
+  const WeldLoop *wloop;
+  const MLoop *mloop;
+  const uint *loop_map;
+  const struct WeldGroup *v_links;
+  const uint *link_poly_buffer;
+};
+
+struct WeldPolyOverlapKillLen {
+  uint poly_kill_len;
+  uint loop_kill_len;
+};
+
+static void weld_poly_overlap_reduce(const void *__restrict UNUSED(userdata),
+                                     void *__restrict chunk_join,
+                                     void *__restrict chunk)
+{
+  struct WeldPolyOverlapKillLen *join = chunk_join;
+  const struct WeldPolyOverlapKillLen *kill_len = chunk;
+  join->poly_kill_len += kill_len->poly_kill_len;
+  join->loop_kill_len += kill_len->loop_kill_len;
+}
+
+/**
+ * Merge a polygon into the first polygon (lowest context index) using the same vertices.
+ *
+ * Polygons don't repeat vertices at this point, so two polygons of the same size use the same
+ * vertices when all vertices of one are linked to the other. Only the tested polygon is written
+ * to, so all polygons can be tested in parallel.
+ */
+static void weld_poly_overlap_fn(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict tls)
+{
+  const struct WeldPolyOverlapData *data = userdata;
+  WeldPoly *wp = &data->wpoly[i];
+  if (wp->poly_dst != OUT_OF_CONTEXT) {
+    /* Collapsed polygon. */
+    return;
+  }
+
+  const struct WeldGroup *v_links = data->v_links;
+  const uint *link_poly_buffer = data->link_poly_buffer;
+
+  WeldLoopOfPolyIter iter;
+  weld_iter_loop_of_poly_begin(&iter, wp, data->wloop, data->mloop, data->loop_map, NULL);
+  weld_iter_loop_of_poly_next(&iter);
+  const struct WeldGroup *link_a = &v_links[iter.v];
+  uint polys_len_a = link_a->len;
+  if (polys_len_a == 1) {
+    BLI_assert(link_poly_buffer[link_a->ofs] == (uint)i);
+    return;
+  }
+  const uint wp_len = wp->len;
+  const uint *polys_ctx_a = &link_poly_buffer[link_a->ofs];
+  for (; polys_len_a--; polys_ctx_a++) {
+    const uint p_ctx_a = *polys_ctx_a;
+    if (p_ctx_a >= (uint)i) {
+      /* Only polygons before this one are candidates, the link arrays are sorted. */
+      break;
+    }
+
+    const WeldPoly *wp_tmp = &data->wpoly[p_ctx_a];
+    if (wp_tmp->len != wp_len) {
+      continue;
+    }
+
+    bool is_match = true;
+    WeldLoopOfPolyIter iter_b = iter;
+    while (weld_iter_loop_of_poly_next(&iter_b)) {
+      const struct WeldGroup *link_b = &v_links[iter_b.v];
+      const uint *polys_ctx_b = &link_poly_buffer[link_b->ofs];
+      uint polys_len_b = link_b->len;
+      while (polys_len_b && *polys_ctx_b < p_ctx_a) {
+        polys_ctx_b++;
+        polys_len_b--;
+      }
+      if (polys_len_b == 0 || *polys_ctx_b != p_ctx_a) {
+        is_match = false;
+        break;
+      }
+    }
+    if (is_match) {
+      wp->poly_dst = wp_tmp->poly_orig;
+      struct WeldPolyOverlapKillLen *kill_len = tls->userdata_chunk;
+      kill_len->poly_kill_len++;
+      kill_len->loop_kill_len += wp_len;
+      return;
+    }
+  }
+}
+
 static void weld_poly_loop_ctx_setup(const MLoop *mloop,
 #ifdef USE_WELD_DEBUG
                                      const MPoly *mpoly,
@@ -1078,7 +1214,8 @@ static void weld_poly_loop_ctx_setup(const MLoop *mloop,
                                      const uint *vert_dest_map,
                                      const uint remain_edge_ctx_len,
                                      struct WeldGroup *r_vlinks,
-                                     WeldMesh *r_weld_mesh)
+                                     WeldMesh *r_weld_mesh,
+                                     const bool use_threading)
 {
   uint poly_kill_len, loop_kill_len, wpoly_len, wpoly_new_len;
 
@@ -1207,78 +1344,26 @@ static void weld_poly_loop_ctx_setup(const MLoop *mloop,
         vl_iter->ofs -= vl_iter->len;
       }
 
-      uint polys_len_a, polys_len_b, *polys_ctx_a, *polys_ctx_b, p_ctx_a, p_ctx_b;
-      polys_len_b = p_ctx_b = 0; /* silence warnings */
-
-      wp = &wpoly[0];
-      for (uint i = 0; i < wpoly_and_new_len; i++, wp++) {
-        if (wp->poly_dst != OUT_OF_CONTEXT) {
-          /* No need to retest poly.
-           * (Already includes collapsed polygons). */
-          continue;
-        }
-
-        WeldLoopOfPolyIter iter;
-        weld_iter_loop_of_poly_begin(&iter, wp, wloop, mloop, loop_map, NULL);
-        weld_iter_loop_of_poly_next(&iter);
-        struct WeldGroup *link_a = &v_links[iter.v];
-        polys_len_a = link_a->len;
-        if (polys_len_a == 1) {
-          BLI_assert(link_poly_buffer[link_a->ofs] == i);
-          continue;
-        }
-        uint wp_len = wp->len;
-        polys_ctx_a = &link_poly_buffer[link_a->ofs];
-        for (; polys_len_a--; polys_ctx_a++) {
-          p_ctx_a = *polys_ctx_a;
-          if (p_ctx_a == i) {
-            continue;
-          }
-
-          WeldPoly *wp_tmp = &wpoly[p_ctx_a];
-          if (wp_tmp->len != wp_len) {
-            continue;
-          }
-
-          WeldLoopOfPolyIter iter_b = iter;
-          while (weld_iter_loop_of_poly_next(&iter_b)) {
-            struct WeldGroup *link_b = &v_links[iter_b.v];
-            polys_len_b = link_b->len;
-            if (polys_len_b == 1) {
-              BLI_assert(link_poly_buffer[link_b->ofs] == i);
-              polys_len_b = 0;
-              break;
-            }
-
-            polys_ctx_b = &link_poly_buffer[link_b->ofs];
-            for (; polys_len_b; polys_len_b--, polys_ctx_b++) {
-              p_ctx_b = *polys_ctx_b;
-              if (p_ctx_b < p_ctx_a) {
-                continue;
-              }
-              if (p_ctx_b >= p_ctx_a) {
-                if (p_ctx_b > p_ctx_a) {
-                  polys_len_b = 0;
-                }
-                break;
-              }
-            }
-            if (polys_len_b == 0) {
-              break;
-            }
-          }
-          if (polys_len_b == 0) {
-            continue;
-          }
-          BLI_assert(p_ctx_a > i);
-          BLI_assert(p_ctx_a == p_ctx_b);
-          BLI_assert(wp_tmp->poly_dst == OUT_OF_CONTEXT);
-          BLI_assert(wp_tmp != wp);
-          wp_tmp->poly_dst = wp->poly_orig;
-          loop_kill_len += wp_tmp->len;
-          poly_kill_len++;
-        }
-      }
+      struct WeldPolyOverlapData data = {
+          .wpoly = wpoly,
+          .wloop = wloop,
+          .mloop = mloop,
+          .loop_map = loop_map,
+          .v_links = v_links,
+          .link_poly_buffer = link_poly_buffer,
+      };
+      struct WeldPolyOverlapKillLen overlap_kill_len = {0, 0};
+
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.use_threading = use_threading && (wpoly_and_new_len >= WELD_PARALLEL_ELEM_MIN);
+      settings.min_iter_per_thread = 1024;
+      settings.userdata_chunk = &overlap_kill_len;
+      settings.userdata_chunk_size = sizeof(overlap_kill_len);
+      settings.func_reduce = weld_poly_overlap_reduce;
+      BLI_task_parallel_range(0, wpoly_and_new_len, &data, weld_poly_overlap_fn, &settings);
+      poly_kill_len += overlap_kill_len.poly_kill_len;
+      loop_kill_len += overlap_kill_len.loop_kill_len;
       MEM_freeN(link_poly_buffer);
     }
   }
@@ -1321,6 +1406,7 @@ static void weld_poly_loop_ctx_setup(const MLoop *mloop,
 static void weld_mesh_context_create(const Mesh *mesh,
                                      uint *vert_dest_map,
                                      const uint vert_kill_len,
+                                     const bool use_threading,
                                      WeldMesh *r_weld_mesh)
 {
   const MEdge *medge = mesh->medge;
@@ -1345,8 +1431,13 @@ static void weld_mesh_context_create(const Mesh *mesh,
   weld_edge_ctx_alloc(
       medge, medge_len, vert_dest_map, edge_dest_map, &edge_ctx_map, &wedge, &wedge_len);
 
-  weld_edge_ctx_setup(
-      mvert_len, wedge_len, v_links, edge_dest_map, wedge, &r_weld_mesh->edge_kill_len);
+  weld_edge_ctx_setup(mvert_len,
+                      wedge_len,
+                      v_links,
+                      edge_dest_map,
+                      wedge,
+                      &r_weld_mesh->edge_kill_len,
+                      use_threading);
 
   weld_poly_loop_ctx_alloc(
       mpoly, mpoly_len, mloop, mloop_len, vert_dest_map, edge_dest_map, r_weld_mesh);
@@ -1361,7 +1452,8 @@ static void weld_mesh_context_create(const Mesh *mesh,
                            vert_dest_map,
                            wedge_len - r_weld_mesh->edge_kill_len,
                            v_links,
-                           r_weld_mesh);
+                           r_weld_mesh,
+                           use_threading);
 
   weld_vert_groups_setup(mvert_len,
                          wvert_len,
@@ -1408,28 +1500,30 @@ static void weld_mesh_context_free(WeldMesh *weld_mesh)
 /** \name Weld CustomData
  * \{ */
 
-static void customdata_weld(
-    const CustomData *source, CustomData *dest, const uint *src_indices, int count, int dest_index)
+/**
+ * Merge the custom data of \a groups_len groups of \a group_len source elements each
+ * (consecutive in \a src_indices), into consecutive final elements starting at \a dest_index.
+ */
+static void customdata_weld(const CustomData *source,
+                            CustomData *dest,
+                            const uint *src_indices,
+                            const int group_len,
+                            const int dest_index,
+                            const int groups_len)
 {
-  if (count == 1) {
-    CustomData_copy_data(source, dest, src_indices[0], dest_index, 1);
+  if (group_len == 1) {
+    CustomData_copy_data_indices(source, dest, (const int *)src_indices, dest_index, groups_len);
     return;
   }
 
-  CustomData_interp(source, dest, (const int *)src_indices, NULL, NULL, count, dest_index);
+  CustomData_interp_indices(
+      source, dest, (const int *)src_indices, NULL, group_len, dest_index, groups_len);
 
+  const float fac = 1.0f / group_len;
   int src_i, dest_i;
-  int j;
+  int g, j;
 
-  float co[3] = {0.0f, 0.0f, 0.0f};
-#ifdef USE_WELD_NORMALS
-  float no[3] = {0.0f, 0.0f, 0.0f};
-#endif
-  uint crease = 0;
-  uint bweight = 0;
-  short flag = 0;
-
-  /* interpolates a layer at a time */
+  /* merges a layer at a time */
   dest_i = 0;
   for (src_i = 0; src_i < source->totlayer; src_i++) {
     const int type = source->layers[src_i].type;
@@ -1446,47 +1540,91 @@ static void customdata_weld(
       break;
     }
 
-    /* if we found a matching layer, add the data */
+    /* if we found a matching layer, merge the data */
     if (dest->layers[dest_i].type == type) {
-      void *src_data = source->layers[src_i].data;
+      const void *src_data = source->layers[src_i].data;
+      void *dst_data = dest->layers[dest_i].data;
+      const uint *group = src_indices;
 
       if (type == CD_MVERT) {
-        for (j = 0; j < count; j++) {
-          MVert *mv_src = &((MVert *)src_data)[src_indices[j]];
-          add_v3_v3(co, mv_src->co);
+        for (g = 0; g < groups_len; g++, group += group_len) {
+          float co[3] = {0.0f, 0.0f, 0.0f};
+#ifdef USE_WELD_NORMALS
+          float no[3] = {0.0f, 0.0f, 0.0f};
+#endif
+          uint bweight = 0;
+          short flag = 0;
+          for (j = 0; j < group_len; j++) {
+            const MVert *mv_src = &((const MVert *)src_data)[group[j]];
+            add_v3_v3(co, mv_src->co);
+#ifdef USE_WELD_NORMALS
+            const short *mv_src_no = mv_src->no;
+            no[0] += mv_src_no[0];
+            no[1] += mv_src_no[1];
+            no[2] += mv_src_no[2];
+#endif
+            bweight += mv_src->bweight;
+            flag |= mv_src->flag;
+          }
+
+          MVert *mv = &((MVert *)dst_data)[dest_index + g];
+          mul_v3_fl(co, fac);
+          bweight *= fac;
+          CLAMP_MAX(bweight, 255);
+
+          copy_v3_v3(mv->co, co);
 #ifdef USE_WELD_NORMALS
-          short *mv_src_no = mv_src->no;
-          no[0] += mv_src_no[0];
-          no[1] += mv_src_no[1];
-          no[2] += mv_src_no[2];
+          mul_v3_fl(no, fac);
+          short *mv_no = mv->no;
+          mv_no[0] = (short)no[0];
+          mv_no[1] = (short)no[1];
+          mv_no[2] = (short)no[2];
 #endif
-          bweight += mv_src->bweight;
-          flag |= mv_src->flag;
+
+          mv->flag = (char)flag;
+          mv->bweight = (char)bweight;
         }
       }
       else if (type == CD_MEDGE) {
-        for (j = 0; j < count; j++) {
-          MEdge *me_src = &((MEdge *)src_data)[src_indices[j]];
-          crease += me_src->crease;
-          bweight += me_src->bweight;
-          flag |= me_src->flag;
+        for (g = 0; g < groups_len; g++, group += group_len) {
+          uint crease = 0;
+          uint bweight = 0;
+          short flag = 0;
+          for (j = 0; j < group_len; j++) {
+            const MEdge *me_src = &((const MEdge *)src_data)[group[j]];
+            crease += me_src->crease;
+            bweight += me_src->bweight;
+            flag |= me_src->flag;
+          }
+
+          MEdge *me = &((MEdge *)dst_data)[dest_index + g];
+          crease *= fac;
+          bweight *= fac;
+          CLAMP_MAX(crease, 255);
+          CLAMP_MAX(bweight, 255);
+
+          me->crease = (char)crease;
+          me->bweight = (char)bweight;
+          me->flag = flag;
         }
       }
       else if (CustomData_layer_has_interp(dest, dest_i)) {
-        /* Already calculated.
-         * TODO: Optimize by exposing `typeInfo->interp`. */
+        /* Already calculated by #CustomData_interp_indices. */
       }
       else if (CustomData_layer_has_math(dest, dest_i)) {
         const int size = CustomData_sizeof(type);
-        void *dst_data = dest->layers[dest_i].data;
-        void *v_dst = POINTER_OFFSET(dst_data, (size_t)dest_index * size);
-        for (j = 0; j < count; j++) {
-          CustomData_data_add(
-              type, v_dst, POINTER_OFFSET(src_data, (size_t)src_indices[j] * size));
+        for (g = 0; g < groups_len; g++, group += group_len) {
+          void *v_dst = POINTER_OFFSET(dst_data, (size_t)(dest_index + g) * size);
+          for (j = 0; j < group_len; j++) {
+            CustomData_data_add(type, v_dst, POINTER_OFFSET(src_data, (size_t)group[j] * size));
+          }
+          CustomData_data_multiply(type, v_dst, fac);
         }
       }
       else {
-        CustomData_copy_layer_type_data(source, dest, type, src_indices[0], dest_index, 1);
+        for (g = 0; g < groups_len; g++, group += group_len) {
+          CustomData_copy_layer_type_data(source, dest, type, group[0], dest_index + g, 1);
+        }
       }
 
       /* if there are multiple source & dest layers of the same type,
@@ -1496,51 +1634,121 @@ static void customdata_weld(
       dest_i++;
     }
   }
+}
 
-  float fac = 1.0f / count;
+/* Number of groups, and of source indices of all groups, merged at once by a #WeldGroupBatch. */
+#define WELD_GROUP_BATCH_LEN 64
+#define WELD_GROUP_BATCH_INDICES_LEN 256
 
-  for (dest_i = 0; dest_i < dest->totlayer; dest_i++) {
-    CustomDataLayer *layer_dst = &dest->layers[dest_i];
-    const int type = layer_dst->type;
-    if (type == CD_MVERT) {
-      MVert *mv = &((MVert *)layer_dst->data)[dest_index];
-      mul_v3_fl(co, fac);
-      bweight *= fac;
-      CLAMP_MAX(bweight, 255);
+/**
+ * Groups are found one at a time, but usually in runs of groups of the same size merged into
+ * consecutive final elements. Their custom data is merged with a single #customdata_weld call,
+ * so layers are only looked up once for the whole run.
+ */
+typedef struct WeldGroupBatch {
+  /* Final index of the first group. */
+  int dest_index;
+  int group_len;
+  int groups_len;
+  /* Source indices of all groups, #group_len for each. Points to #src_indices_buf, or to the group
+   * itself for a single group which doesn't fit in it. */
+  const uint *src_indices;
+  uint src_indices_buf[WELD_GROUP_BATCH_INDICES_LEN];
+  /* Vertices of edges, or the vertex and edge of loops. Set once the custom data is merged,
+   * since merging a group of one element copies the whole element. */
+  uint elem_refs[WELD_GROUP_BATCH_LEN][2];
+} WeldGroupBatch;
+
+static bool weld_group_batch_fits(const WeldGroupBatch *batch,
+                                  const int group_len,
+                                  const int dest_index)
+{
+  if (batch->groups_len == 0) {
+    return true;
+  }
+  return (group_len == batch->group_len) && (dest_index == batch->dest_index + batch->groups_len) &&
+         (batch->groups_len < WELD_GROUP_BATCH_LEN) &&
+         ((batch->groups_len + 1) * group_len <= WELD_GROUP_BATCH_INDICES_LEN);
+}
 
-      copy_v3_v3(mv->co, co);
-#ifdef USE_WELD_NORMALS
-      mul_v3_fl(no, fac);
-      short *mv_no = mv->no;
-      mv_no[0] = (short)no[0];
-      mv_no[1] = (short)no[1];
-      mv_no[2] = (short)no[2];
-#endif
+/**
+ * Add a group, the batch must be flushed first when #weld_group_batch_fits fails.
+ *
+ * \return True when the batch has to be flushed right away, because it uses \a group in place.
+ */
+static bool weld_group_batch_add(WeldGroupBatch *batch,
+                                 const uint *group,
+                                 const int group_len,
+                                 const int dest_index,
+                                 const uint elem_ref_a,
+                                 const uint elem_ref_b)
+{
+  BLI_assert(weld_group_batch_fits(batch, group_len, dest_index));
+  const int index = batch->groups_len++;
+  if (index == 0) {
+    batch->dest_index = dest_index;
+    batch->group_len = group_len;
+    batch->src_indices = batch->src_indices_buf;
+  }
+  batch->elem_refs[index][0] = elem_ref_a;
+  batch->elem_refs[index][1] = elem_ref_b;
+  if (group_len > WELD_GROUP_BATCH_INDICES_LEN) {
+    batch->src_indices = group;
+    return true;
+  }
+  memcpy(&batch->src_indices_buf[index * group_len], group, sizeof(*group) * (size_t)group_len);
+  return false;
+}
 
-      mv->flag = (char)flag;
-      mv->bweight = (char)bweight;
-    }
-    else if (type == CD_MEDGE) {
-      MEdge *me = &((MEdge *)layer_dst->data)[dest_index];
-      crease *= fac;
-      bweight *= fac;
-      CLAMP_MAX(crease, 255);
-      CLAMP_MAX(bweight, 255);
-
-      me->crease = (char)crease;
-      me->bweight = (char)bweight;
-      me->flag = flag;
-    }
-    else if (CustomData_layer_has_interp(dest, dest_i)) {
-      /* Already calculated. */
-    }
-    else if (CustomData_layer_has_math(dest, dest_i)) {
-      const int size = CustomData_sizeof(type);
-      void *dst_data = layer_dst->data;
-      void *v_dst = POINTER_OFFSET(dst_data, (size_t)dest_index * size);
-      CustomData_data_multiply(type, v_dst, fac);
-    }
+static void weld_vert_batch_flush(WeldGroupBatch *batch,
+                                  const CustomData *vdata,
+                                  CustomData *r_vdata)
+{
+  if (batch->groups_len == 0) {
+    return;
+  }
+  customdata_weld(
+      vdata, r_vdata, batch->src_indices, batch->group_len, batch->dest_index, batch->groups_len);
+  batch->groups_len = 0;
+}
+
+static void weld_edge_batch_flush(WeldGroupBatch *batch, const CustomData *edata, Mesh *result)
+{
+  if (batch->groups_len == 0) {
+    return;
+  }
+  customdata_weld(edata,
+                  &result->edata,
+                  batch->src_indices,
+                  batch->group_len,
+                  batch->dest_index,
+                  batch->groups_len);
+  MEdge *me = &result->medge[batch->dest_index];
+  for (int i = 0; i < batch->groups_len; i++, me++) {
+    me->v1 = batch->elem_refs[i][0];
+    me->v2 = batch->elem_refs[i][1];
+    me->flag |= ME_LOOSEEDGE;
+  }
+  batch->groups_len = 0;
+}
+
+static void weld_loop_batch_flush(WeldGroupBatch *batch, const CustomData *ldata, Mesh *result)
+{
+  if (batch->groups_len == 0) {
+    return;
   }
+  customdata_weld(ldata,
+                  &result->ldata,
+                  batch->src_indices,
+                  batch->group_len,
+                  batch->dest_index,
+                  batch->groups_len);
+  MLoop *ml = &result->mloop[batch->dest_index];
+  for (int i = 0; i < batch->groups_len; i++, ml++) {
+    ml->v = batch->elem_refs[i][0];
+    ml->e = batch->elem_refs[i][1];
+  }
+  batch->groups_len = 0;
 }
 
 /** \} */
@@ -1565,15 +1773,258 @@ static bool bvhtree_weld_overlap_cb(void *userdata, int index_a, int index_b, in
   }
   return false;
 }
+
+struct WeldVertUnionData {
+  const BVHTreeOverlap *overlap;
+  uint *vert_dest_map;
+};
+
+static uint weld_vert_root_find(uint *vert_dest_map, uint v)
+{
+  uint v_dst;
+  while ((v_dst = vert_dest_map[v]) != v) {
+    v = v_dst;
+  }
+  return v;
+}
+
+/**
+ * Lock-free union of the sets of both vertices of an overlap pair.
+ *
+ * Roots are only ever linked to a root with a lower index, so the root of every set is its
+ * lowest vertex, independent of the order the pairs are handled in. The number of successful
+ * unions is the number of vertices killed.
+ */
+static void weld_vert_union_fn(void *__restrict userdata,
+                               const int i,
+                               const TaskParallelTLS *__restrict tls)
+{
+  const struct WeldVertUnionData *data = userdata;
+  uint *vert_dest_map = data->vert_dest_map;
+  uint va_dst = data->overlap[i].indexA;
+  uint vb_dst = data->overlap[i].indexB;
+  BLI_assert(va_dst < vb_dst);
+
+  while (true) {
+    va_dst = weld_vert_root_find(vert_dest_map, va_dst);
+    vb_dst = weld_vert_root_find(vert_dest_map, vb_dst);
+    if (va_dst == vb_dst) {
+      return;
+    }
+    if (va_dst > vb_dst) {
+      SWAP(uint, va_dst, vb_dst);
+    }
+    /* Fails when another thread linked `vb_dst` in the meantime, look for the new root. */
+    if (atomic_cas_uint32(&vert_dest_map[vb_dst], vb_dst, va_dst) == vb_dst) {
+      (*(uint *)tls->userdata_chunk)++;
+      return;
+    }
+  }
+}
+
+static void weld_vert_root_flatten_fn(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldVertUnionData *data = userdata;
+  uint *vert_dest_map = data->vert_dest_map;
+  /* Other threads only read this while looking for the root, which doesn't change anymore. */
+  vert_dest_map[i] = weld_vert_root_find(vert_dest_map, (uint)i);
+}
 #endif
 
-static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContext *ctx, Mesh *mesh)
+struct WeldResultChunkData {
+  const Mesh *mesh;
+  Mesh *result;
+  const WeldMesh *weld_mesh;
+  /* Final vertex indices, used by edges. */
+  const uint *vert_final;
+  /* From the original element being processed to its group,
+   * overwritten with the final index. */
+  uint *index_map;
+  uint elem_len;
+  /* First final index of every chunk. */
+  uint *chunk_dest_offsets;
+  uint chunks_len;
+  bool use_threading;
+};
+
+/* Number of final elements created by a chunk: all but the merged ones. */
+static void weld_result_chunk_len_fn(void *__restrict userdata,
+                                     const int chunk,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  Mesh *result = mesh;
+  struct WeldResultChunkData *data = userdata;
+  const uint start = (uint)chunk * WELD_RESULT_CHUNK_SIZE;
+  const uint end = MIN2(start + WELD_RESULT_CHUNK_SIZE, data->elem_len);
+  uint dest_len = 0;
+  for (uint i = start; i < end; i++) {
+    if (data->index_map[i] != ELEM_MERGED) {
+      dest_len++;
+    }
+  }
+  data->chunk_dest_offsets[chunk + 1] = dest_len;
+}
 
-  Object *ob = ctx->object;
-  BLI_bitmap *v_mask = NULL;
-  int v_mask_act = 0;
+static void weld_result_vert_chunk_fn(void *__restrict userdata,
+                                      const int chunk,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldResultChunkData *data = userdata;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const CustomData *vdata = &data->mesh->vdata;
+  CustomData *r_vdata = &data->result->vdata;
+  const uint end = MIN2((uint)(chunk + 1) * WELD_RESULT_CHUNK_SIZE, data->elem_len);
+  WeldGroupBatch batch;
+  batch.groups_len = 0;
+
+  uint *index_iter = &data->index_map[(uint)chunk * WELD_RESULT_CHUNK_SIZE];
+  int dest_index = (int)data->chunk_dest_offsets[chunk];
+  for (uint i = (uint)chunk * WELD_RESULT_CHUNK_SIZE; i < end; i++, index_iter++) {
+    int source_index = i;
+    int count = 0;
+    while (i < end && *index_iter == OUT_OF_CONTEXT) {
+      *index_iter = dest_index + count;
+      index_iter++;
+      count++;
+      i++;
+    }
+    if (count) {
+      CustomData_copy_data(vdata, r_vdata, source_index, dest_index, count);
+      dest_index += count;
+    }
+    if (i == end) {
+      break;
+    }
+    if (*index_iter != ELEM_MERGED) {
+      struct WeldGroup *wgroup = &weld_mesh->vert_groups[*index_iter];
+      const int group_len = (int)wgroup->len;
+      if (!weld_group_batch_fits(&batch, group_len, dest_index)) {
+        weld_vert_batch_flush(&batch, vdata, r_vdata);
+      }
+      if (weld_group_batch_add(&batch,
+                               &weld_mesh->vert_groups_buffer[wgroup->ofs],
+                               group_len,
+                               dest_index,
+                               0,
+                               0)) {
+        weld_vert_batch_flush(&batch, vdata, r_vdata);
+      }
+      *index_iter = dest_index;
+      dest_index++;
+    }
+  }
+  weld_vert_batch_flush(&batch, vdata, r_vdata);
+
+  BLI_assert(dest_index == (int)data->chunk_dest_offsets[chunk + 1]);
+}
+
+static void weld_result_edge_chunk_fn(void *__restrict userdata,
+                                      const int chunk,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldResultChunkData *data = userdata;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const CustomData *edata = &data->mesh->edata;
+  CustomData *r_edata = &data->result->edata;
+  const uint *vert_final = data->vert_final;
+  const uint end = MIN2((uint)(chunk + 1) * WELD_RESULT_CHUNK_SIZE, data->elem_len);
+  WeldGroupBatch batch;
+  batch.groups_len = 0;
+
+  uint *index_iter = &data->index_map[(uint)chunk * WELD_RESULT_CHUNK_SIZE];
+  int dest_index = (int)data->chunk_dest_offsets[chunk];
+  for (uint i = (uint)chunk * WELD_RESULT_CHUNK_SIZE; i < end; i++, index_iter++) {
+    int source_index = i;
+    int count = 0;
+    while (i < end && *index_iter == OUT_OF_CONTEXT) {
+      *index_iter = dest_index + count;
+      index_iter++;
+      count++;
+      i++;
+    }
+    if (count) {
+      CustomData_copy_data(edata, r_edata, source_index, dest_index, count);
+      MEdge *me = &data->result->medge[dest_index];
+      dest_index += count;
+      for (; count--; me++) {
+        me->v1 = vert_final[me->v1];
+        me->v2 = vert_final[me->v2];
+      }
+    }
+    if (i == end) {
+      break;
+    }
+    if (*index_iter != ELEM_MERGED) {
+      struct WeldGroupEdge *wegrp = &weld_mesh->edge_groups[*index_iter];
+      const int group_len = (int)wegrp->group.len;
+      if (!weld_group_batch_fits(&batch, group_len, dest_index)) {
+        weld_edge_batch_flush(&batch, edata, data->result);
+      }
+      if (weld_group_batch_add(&batch,
+                               &weld_mesh->edge_groups_buffer[wegrp->group.ofs],
+                               group_len,
+                               dest_index,
+                               vert_final[wegrp->v1],
+                               vert_final[wegrp->v2])) {
+        weld_edge_batch_flush(&batch, edata, data->result);
+      }
+
+      *index_iter = dest_index;
+      dest_index++;
+    }
+  }
+  weld_edge_batch_flush(&batch, edata, data->result);
+
+  BLI_assert(dest_index == (int)data->chunk_dest_offsets[chunk + 1]);
+}
+
+/**
+ * Create the final elements of \a index_map (vertices or edges) in parallel chunks.
+ * The first final index of every chunk is known up-front from the number of merged elements,
+ * so every chunk merges its groups through #customdata_weld independently.
+ *
+ * \note Allocates `data->chunk_dest_offsets`, to be freed by the caller.
+ */
+static void weld_result_chunks_create(struct WeldResultChunkData *data,
+                                      uint *index_map,
+                                      const uint elem_len,
+                                      TaskParallelRangeFunc chunk_fn)
+{
+  const uint chunks_len = (elem_len + WELD_RESULT_CHUNK_SIZE - 1) / WELD_RESULT_CHUNK_SIZE;
+  data->index_map = index_map;
+  data->elem_len = elem_len;
+  data->chunks_len = chunks_len;
+  data->chunk_dest_offsets = MEM_malloc_arrayN(
+      chunks_len + 1, sizeof(*data->chunk_dest_offsets), __func__);
+  data->chunk_dest_offsets[0] = 0;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = data->use_threading && (elem_len >= WELD_PARALLEL_ELEM_MIN);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, chunks_len, data, weld_result_chunk_len_fn, &settings);
+
+  for (uint chunk = 0; chunk < chunks_len; chunk++) {
+    data->chunk_dest_offsets[chunk + 1] += data->chunk_dest_offsets[chunk];
+  }
+
+  BLI_task_parallel_range(0, chunks_len, data, chunk_fn, &settings);
+}
+
+/**
+ * Merge vertices closer than \a merge_dist, only the ones enabled in \a v_mask when given.
+ * Returns \a mesh itself when no vertices are merged.
+ *
+ * \param use_threading: The result is the same without threading, only used by tests.
+ */
+Mesh *MOD_weld_mesh_merge_by_distance(Mesh *mesh,
+                                      const float merge_dist,
+                                      const BLI_bitmap *v_mask,
+                                      const int v_mask_act,
+                                      const bool use_threading)
+{
+  Mesh *result = mesh;
 
   const MVert *mvert;
   const MLoop *mloop;
@@ -1583,25 +2034,6 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
   mvert = mesh->mvert;
   totvert = mesh->totvert;
 
-  /* Vertex Group. */
-  const int defgrp_index = BKE_object_defgroup_name_index(ob, wmd->defgrp_name);
-  if (defgrp_index != -1) {
-    MDeformVert *dvert, *dv;
-    dvert = CustomData_get_layer(&mesh->vdata, CD_MDEFORMVERT);
-    if (dvert) {
-      const bool invert_vgroup = (wmd->flag & MOD_WELD_INVERT_VGROUP) != 0;
-      dv = &dvert[0];
-      v_mask = BLI_BITMAP_NEW(totvert, __func__);
-      for (uint i = 0; i < totvert; i++, dv++) {
-        const bool found = BKE_defvert_find_weight(dv, defgrp_index) > 0.0f;
-        if (found != invert_vgroup) {
-          BLI_BITMAP_ENABLE(v_mask, i);
-          v_mask_act++;
-        }
-      }
-    }
-  }
-
   /* From the original index of the vertex.
    * This indicates which vert it is or is going to be merged. */
   uint *vert_dest_map = MEM_malloc_arrayN(totvert, sizeof(*vert_dest_map), __func__);
@@ -1616,7 +2048,7 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
                                                   false,
                                                   v_mask,
                                                   v_mask_act,
-                                                  wmd->merge_dist / 2,
+                                                  merge_dist / 2,
                                                   2,
                                                   6,
                                                   0,
@@ -1626,7 +2058,7 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     if (bvhtree) {
       struct WeldOverlapData data;
       data.mvert = mvert;
-      data.merge_dist_sq = square_f(wmd->merge_dist);
+      data.merge_dist_sq = square_f(merge_dist);
 
       uint overlap_len;
       BVHTreeOverlap *overlap = BLI_bvhtree_overlap_ex(bvhtree,
@@ -1641,43 +2073,37 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
       if (overlap) {
         range_vn_u(vert_dest_map, totvert, 0);
 
-        const BVHTreeOverlap *overlap_iter = &overlap[0];
-        for (uint i = 0; i < overlap_len; i++, overlap_iter++) {
-          uint indexA = overlap_iter->indexA;
-          uint indexB = overlap_iter->indexB;
-
-          BLI_assert(indexA < indexB);
-
-          uint va_dst = vert_dest_map[indexA];
-          while (va_dst != vert_dest_map[va_dst]) {
-            va_dst = vert_dest_map[va_dst];
-          }
-          uint vb_dst = vert_dest_map[indexB];
-          while (vb_dst != vert_dest_map[vb_dst]) {
-            vb_dst = vert_dest_map[vb_dst];
-          }
-          if (va_dst == vb_dst) {
-            continue;
-          }
-          if (va_dst > vb_dst) {
-            SWAP(uint, va_dst, vb_dst);
-          }
-          vert_kill_len++;
-          vert_dest_map[vb_dst] = va_dst;
-        }
+        struct WeldVertUnionData union_data = {
+            .overlap = overlap,
+            .vert_dest_map = vert_dest_map,
+        };
+
+        TaskParallelSettings settings;
+        BLI_parallel_range_settings_defaults(&settings);
+        settings.use_threading = use_threading && (overlap_len >= WELD_PARALLEL_ELEM_MIN);
+        settings.min_iter_per_thread = 1024;
+        settings.userdata_chunk = &vert_kill_len;
+        settings.userdata_chunk_size = sizeof(vert_kill_len);
+        settings.func_reduce = weld_kill_len_reduce;
+        BLI_task_parallel_range(0, overlap_len, &union_data, weld_vert_union_fn, &settings);
+
+        /* Point all vertices directly to their root. */
+        settings.use_threading = use_threading && (totvert >= WELD_PARALLEL_ELEM_MIN);
+        settings.userdata_chunk = NULL;
+        settings.userdata_chunk_size = 0;
+        settings.func_reduce = NULL;
+        BLI_task_parallel_range(0, totvert, &union_data, weld_vert_root_flatten_fn, &settings);
 
         /* Fix #r_vert_dest_map for next step. */
         for (uint i = 0; i < totvert; i++) {
-          if (i == vert_dest_map[i]) {
-            vert_dest_map[i] = OUT_OF_CONTEXT;
+          const uint v = vert_dest_map[i];
+          if (v != i) {
+            /* Roots are visited before their vertices. */
+            BLI_assert(v < i);
+            vert_dest_map[v] = v;
           }
           else {
-            uint v = i;
-            while (v != vert_dest_map[v] && vert_dest_map[v] != OUT_OF_CONTEXT) {
-              v = vert_dest_map[v];
-            }
-            vert_dest_map[v] = v;
-            vert_dest_map[i] = v;
+            vert_dest_map[i] = OUT_OF_CONTEXT;
           }
         }
 
@@ -1697,18 +2123,14 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
 
     BLI_kdtree_3d_balance(tree);
     vert_kill_len = BLI_kdtree_3d_calc_duplicates_fast(
-        tree, wmd->merge_dist, false, (int *)vert_dest_map);
+        tree, merge_dist, false, (int *)vert_dest_map);
     BLI_kdtree_3d_free(tree);
   }
 #endif
 
-  if (v_mask) {
-    MEM_freeN(v_mask);
-  }
-
   if (vert_kill_len) {
     WeldMesh weld_mesh;
-    weld_mesh_context_create(mesh, vert_dest_map, vert_kill_len, &weld_mesh);
+    weld_mesh_context_create(mesh, vert_dest_map, vert_kill_len, use_threading, &weld_mesh);
 
     mloop = mesh->mloop;
     mpoly = mesh->mpoly;
@@ -1725,85 +2147,31 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     result = BKE_mesh_new_nomain_from_template(
         mesh, result_nverts, result_nedges, 0, result_nloops, result_npolys);
 
+    /* Vertices and edges are created in chunks of the original elements, in parallel. */
+
+    struct WeldResultChunkData chunk_data = {
+        .mesh = mesh,
+        .result = result,
+        .weld_mesh = &weld_mesh,
+        .vert_final = vert_dest_map,
+        .use_threading = use_threading,
+    };
+
     /* Vertices */
 
     uint *vert_final = vert_dest_map;
-    uint *index_iter = &vert_final[0];
-    int dest_index = 0;
-    for (uint i = 0; i < totvert; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totvert && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->vdata, &result->vdata, source_index, dest_index, count);
-        dest_index += count;
-      }
-      if (i == totvert) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroup *wgroup = &weld_mesh.vert_groups[*index_iter];
-        customdata_weld(&mesh->vdata,
-                        &result->vdata,
-                        &weld_mesh.vert_groups_buffer[wgroup->ofs],
-                        wgroup->len,
-                        dest_index);
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
+    weld_result_chunks_create(&chunk_data, vert_final, totvert, weld_result_vert_chunk_fn);
 
-    BLI_assert(dest_index == result_nverts);
+    BLI_assert((int)chunk_data.chunk_dest_offsets[chunk_data.chunks_len] == result_nverts);
+    MEM_freeN(chunk_data.chunk_dest_offsets);
 
     /* Edges */
 
     uint *edge_final = weld_mesh.edge_groups_map;
-    index_iter = &edge_final[0];
-    dest_index = 0;
-    for (uint i = 0; i < totedge; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totedge && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->edata, &result->edata, source_index, dest_index, count);
-        MEdge *me = &result->medge[dest_index];
-        dest_index += count;
-        for (; count--; me++) {
-          me->v1 = vert_final[me->v1];
-          me->v2 = vert_final[me->v2];
-        }
-      }
-      if (i == totedge) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroupEdge *wegrp = &weld_mesh.edge_groups[*index_iter];
-        customdata_weld(&mesh->edata,
-                        &result->edata,
-                        &weld_mesh.edge_groups_buffer[wegrp->group.ofs],
-                        wegrp->group.len,
-                        dest_index);
-        MEdge *me = &result->medge[dest_index];
-        me->v1 = vert_final[wegrp->v1];
-        me->v2 = vert_final[wegrp->v2];
-        me->flag |= ME_LOOSEEDGE;
-
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
+    weld_result_chunks_create(&chunk_data, edge_final, totedge, weld_result_edge_chunk_fn);
 
-    BLI_assert(dest_index == result_nedges);
+    BLI_assert((int)chunk_data.chunk_dest_offsets[chunk_data.chunks_len] == result_nedges);
+    MEM_freeN(chunk_data.chunk_dest_offsets);
 
     /* Polys/Loops */
 
@@ -1813,6 +2181,8 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     uint r_i = 0;
     int loop_cur = 0;
     uint *group_buffer = BLI_array_alloca(group_buffer, weld_mesh.max_poly_len);
+    WeldGroupBatch loop_batch;
+    loop_batch.groups_len = 0;
     for (uint i = 0; i < totpoly; i++, mp++) {
       int loop_start = loop_cur;
       uint poly_ctx = weld_mesh.poly_map[i];
@@ -1837,11 +2207,15 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
           continue;
         }
         while (weld_iter_loop_of_poly_next(&iter)) {
-          customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
           uint v = vert_final[iter.v];
           uint e = edge_final[iter.e];
-          r_ml->v = v;
-          r_ml->e = e;
+          if (!weld_group_batch_fits(&loop_batch, (int)iter.group_len, loop_cur)) {
+            weld_loop_batch_flush(&loop_batch, &mesh->ldata, result);
+          }
+          if (weld_group_batch_add(
+                  &loop_batch, group_buffer, (int)iter.group_len, loop_cur, v, e)) {
+            weld_loop_batch_flush(&loop_batch, &mesh->ldata, result);
+          }
           r_ml++;
           loop_cur++;
           if (iter.type) {
@@ -1871,11 +2245,15 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
         continue;
       }
       while (weld_iter_loop_of_poly_next(&iter)) {
-        customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
         uint v = vert_final[iter.v];
         uint e = edge_final[iter.e];
-        r_ml->v = v;
-        r_ml->e = e;
+        if (!weld_group_batch_fits(&loop_batch, (int)iter.group_len, loop_cur)) {
+          weld_loop_batch_flush(&loop_batch, &mesh->ldata, result);
+        }
+        if (weld_group_batch_add(
+                &loop_batch, group_buffer, (int)iter.group_len, loop_cur, v, e)) {
+          weld_loop_batch_flush(&loop_batch, &mesh->ldata, result);
+        }
         r_ml++;
         loop_cur++;
         if (iter.type) {
@@ -1889,6 +2267,7 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
       r_mp++;
       r_i++;
     }
+    weld_loop_batch_flush(&loop_batch, &mesh->ldata, result);
 
     BLI_assert((int)r_i == result_npolys);
     BLI_assert(loop_cur == result_nloops);
@@ -1904,6 +2283,40 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
   return result;
 }
 
+static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContext *ctx, Mesh *mesh)
+{
+  Object *ob = ctx->object;
+  BLI_bitmap *v_mask = NULL;
+  int v_mask_act = 0;
+
+  /* Vertex Group. */
+  const int defgrp_index = BKE_object_defgroup_name_index(ob, wmd->defgrp_name);
+  if (defgrp_index != -1) {
+    MDeformVert *dvert, *dv;
+    dvert = CustomData_get_layer(&mesh->vdata, CD_MDEFORMVERT);
+    if (dvert) {
+      const bool invert_vgroup = (wmd->flag & MOD_WELD_INVERT_VGROUP) != 0;
+      dv = &dvert[0];
+      v_mask = BLI_BITMAP_NEW(mesh->totvert, __func__);
+      for (uint i = 0; i < (uint)mesh->totvert; i++, dv++) {
+        const bool found = BKE_defvert_find_weight(dv, defgrp_index) > 0.0f;
+        if (found != invert_vgroup) {
+          BLI_BITMAP_ENABLE(v_mask, i);
+          v_mask_act++;
+        }
+      }
+    }
+  }
+
+  Mesh *result = MOD_weld_mesh_merge_by_distance(
+      mesh, wmd->merge_dist, v_mask, v_mask_act, true);
+
+  if (v_mask) {
+    MEM_freeN(v_mask);
+  }
+  return result;
+}
+
 static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
 {
   WeldModifierData *wmd = (WeldModifierData *)md;
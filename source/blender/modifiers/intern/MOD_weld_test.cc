@@ -0,0 +1,186 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "MOD_weld.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::modifiers::tests {
+
+class WeldTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+static const float weld_test_merge_dist = 0.01f;
+
+/* Stacked copies of a grid of `size * size` quads, each copy slightly above the previous one so
+ * all of its vertices, edges and faces overlap those of the first copy. Columns are grouped by
+ * `column_group_len`, columns within a group are closer than the merge distance, so merging them
+ * chains through the group and collapses the faces in between. */
+static Mesh *weld_test_mesh_create(const int size, const int copies, const int column_group_len)
+{
+  Mesh *mesh = bke::tests::test_grid_mesh_create(size, copies);
+  const int grid_verts_len = (size + 1) * (size + 1);
+  for (int i = 0; i < mesh->totvert; i++) {
+    float *co = mesh->mvert[i].co;
+    const int x = (int)co[0];
+    co[0] = (float)(x / column_group_len) +
+            (float)(x % column_group_len) * weld_test_merge_dist * 0.6f;
+    co[2] = (float)(i / grid_verts_len) * weld_test_merge_dist * 0.2f;
+  }
+  return mesh;
+}
+
+static void weld_test_expect_meshes_equal(const Mesh *a, const Mesh *b)
+{
+  ASSERT_EQ(a->totvert, b->totvert);
+  ASSERT_EQ(a->totedge, b->totedge);
+  ASSERT_EQ(a->totloop, b->totloop);
+  ASSERT_EQ(a->totpoly, b->totpoly);
+  for (int i = 0; i < a->totvert; i++) {
+    EXPECT_EQ(memcmp(a->mvert[i].co, b->mvert[i].co, sizeof(float[3])), 0);
+  }
+  for (int i = 0; i < a->totedge; i++) {
+    EXPECT_EQ(a->medge[i].v1, b->medge[i].v1);
+    EXPECT_EQ(a->medge[i].v2, b->medge[i].v2);
+    EXPECT_EQ(a->medge[i].flag, b->medge[i].flag);
+  }
+  for (int i = 0; i < a->totloop; i++) {
+    EXPECT_EQ(a->mloop[i].v, b->mloop[i].v);
+    EXPECT_EQ(a->mloop[i].e, b->mloop[i].e);
+  }
+  for (int i = 0; i < a->totpoly; i++) {
+    EXPECT_EQ(a->mpoly[i].loopstart, b->mpoly[i].loopstart);
+    EXPECT_EQ(a->mpoly[i].totloop, b->mpoly[i].totloop);
+  }
+}
+
+/* No degenerate elements are left after merging. */
+static void weld_test_expect_mesh_valid(const Mesh *mesh)
+{
+  for (int i = 0; i < mesh->totedge; i++) {
+    EXPECT_NE(mesh->medge[i].v1, mesh->medge[i].v2);
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mesh->mpoly[i];
+    EXPECT_GE(mp->totloop, 3);
+    for (int j = 0; j < mp->totloop; j++) {
+      const MLoop *ml = &mesh->mloop[mp->loopstart + j];
+      const MLoop *ml_next = &mesh->mloop[mp->loopstart + (j + 1) % mp->totloop];
+      EXPECT_NE(ml->v, ml_next->v);
+      const MEdge *me = &mesh->medge[ml->e];
+      EXPECT_TRUE((me->v1 == ml->v && me->v2 == ml_next->v) ||
+                  (me->v2 == ml->v && me->v1 == ml_next->v));
+    }
+  }
+}
+
+static void weld_test_merge_and_compare(Mesh *mesh, Mesh **r_result)
+{
+  Mesh *result_serial = MOD_weld_mesh_merge_by_distance(
+      mesh, weld_test_merge_dist, nullptr, 0, false);
+  Mesh *result_parallel = MOD_weld_mesh_merge_by_distance(
+      mesh, weld_test_merge_dist, nullptr, 0, true);
+  ASSERT_NE(result_serial, mesh);
+  ASSERT_NE(result_parallel, mesh);
+
+  weld_test_expect_meshes_equal(result_serial, result_parallel);
+  weld_test_expect_mesh_valid(result_parallel);
+
+  BKE_id_free(nullptr, result_serial);
+  *r_result = result_parallel;
+}
+
+/* Every element overlaps one of the first copy, the result is a single grid. */
+TEST_F(WeldTest, OverlappingCopies)
+{
+  const int size = 100;
+  Mesh *mesh = weld_test_mesh_create(size, 3, 1);
+  Mesh *result = nullptr;
+  weld_test_merge_and_compare(mesh, &result);
+  ASSERT_NE(result, nullptr);
+
+  EXPECT_EQ(result->totvert, (size + 1) * (size + 1));
+  EXPECT_EQ(result->totedge, size * (size + 1) * 2);
+  EXPECT_EQ(result->totpoly, size * size);
+  EXPECT_EQ(result->totloop, size * size * 4);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+/* Merges chaining through groups of columns, on top of overlapping copies. */
+TEST_F(WeldTest, ChainedMerges)
+{
+  Mesh *mesh = weld_test_mesh_create(100, 2, 4);
+  Mesh *result = nullptr;
+  weld_test_merge_and_compare(mesh, &result);
+  ASSERT_NE(result, nullptr);
+
+  EXPECT_LT(result->totvert, mesh->totvert / 2);
+  EXPECT_LT(result->totpoly, mesh->totpoly / 2);
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+/* Vertices outside of the mask are not merged. */
+TEST_F(WeldTest, MaskedMerges)
+{
+  const int size = 100;
+  Mesh *mesh = weld_test_mesh_create(size, 2, 1);
+  BLI_bitmap *v_mask = BLI_BITMAP_NEW(mesh->totvert, __func__);
+  int v_mask_act = 0;
+  for (int i = 0; i < mesh->totvert; i++) {
+    if (mesh->mvert[i].co[0] < size / 2) {
+      BLI_BITMAP_ENABLE(v_mask, i);
+      v_mask_act++;
+    }
+  }
+
+  Mesh *result_serial = MOD_weld_mesh_merge_by_distance(
+      mesh, weld_test_merge_dist, v_mask, v_mask_act, false);
+  Mesh *result_parallel = MOD_weld_mesh_merge_by_distance(
+      mesh, weld_test_merge_dist, v_mask, v_mask_act, true);
+  weld_test_expect_meshes_equal(result_serial, result_parallel);
+  weld_test_expect_mesh_valid(result_parallel);
+  EXPECT_EQ(result_parallel->totvert, mesh->totvert - v_mask_act / 2);
+
+  BKE_id_free(nullptr, result_serial);
+  BKE_id_free(nullptr, result_parallel);
+  MEM_freeN(v_mask);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::modifiers::tests
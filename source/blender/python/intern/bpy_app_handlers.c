@@ -186,6 +186,14 @@ static PyTypeObject BPyPersistent_Type = {
 
 static PyObject *py_cb_array[BKE_CB_EVT_TOT] = {NULL};
 
+/* Like #bpy_app_generic_callback, the list size is read without the GIL, this is only used to
+ * skip work when no handlers are registered. */
+static bool bpy_app_generic_callback_is_used(void *arg)
+{
+  PyObject *cb_list = py_cb_array[POINTER_AS_INT(arg)];
+  return PyList_GET_SIZE(cb_list) > 0;
+}
+
 static PyObject *make_app_cb_info(void)
 {
   PyObject *app_cb_info;
@@ -245,6 +253,7 @@ PyObject *BPY_app_handlers_struct(void)
       funcstore->func = bpy_app_generic_callback;
       funcstore->alloc = 0;
       funcstore->arg = POINTER_FROM_INT(pos);
+      funcstore->is_used = bpy_app_generic_callback_is_used;
       BKE_callback_add(funcstore, pos);
     }
   }
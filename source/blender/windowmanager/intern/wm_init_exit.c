@@ -649,6 +649,10 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   DNA_sdna_current_free();
 
+  if (G.debug & G_DEBUG_JOBS) {
+    BLI_task_parallel_adaptive_stats_print();
+  }
+
   BLI_threadapi_exit();
   BLI_task_scheduler_exit();
 